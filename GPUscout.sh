@@ -11,11 +11,27 @@ usage() {
     echo "  -a | --args : Arguments for running the binary. e.g. --args=\"64 2 2 temp_64 power_64 output_64.txt\""
     echo "  --sm_count : Can be used to specify the number of streaming multiprocessors of the current GPU, as this will be used in calculations (default: 16)"
     echo "  -j | --json : Save a JSON-formatted version of the output (Needed for the use of GPUscout-GUI)"
+    echo "  --kernel_regex : Only sample warp stalls and collect metrics for kernels whose (mangled) name matches the regex, e.g. --kernel_regex=\"matmul\""
+    echo "  --launch_range : Only sample warp stalls for the given launch indices of each kernel (counted from 0), e.g. --launch_range=\"0:9,100:109\""
+    echo "  --launch_buckets : Compare the warp stalls between launches, merging the given number of consecutive launches into one profile (e.g. --launch_buckets=1)"
+    echo "  --stall_reasons : Only sample the given warp stall reasons, e.g. --stall_reasons=\"long_scoreboard,barrier\" (default: all)"
+    echo "  --correlation_threads : Number of threads resolving the source lines of the sampled PCs (default: 1). More threads rely on the CUPTI source correlation being thread safe"
+    echo "  --rank_template : Rank of this process in a multi-process (MPI) run, evaluated in every process, e.g. --rank_template='\${SLURM_NODEID}_\${SLURM_LOCALID}' (default: OMPI_COMM_WORLD_RANK, PMI_RANK, PMIX_RANK or SLURM_PROCID)"
+    echo "  --merge_ranks : Combine the results of all ranks found in the given GPUscout TMP directory into one report, e.g. --merge_ranks=tmp-gpuscout"
+    echo "Usage: $0 diff old.json new.json [--threshold percent] [--top N] [--json file] [--fail_on_regression]"
+    echo "  Compares two result files (--json), e.g. before and after applying a recommendation"
     exit 1
 }
 
+# Compare two result files, no profiling is done
+if [ "$1" = "diff" ]; then
+    gpuscout_dir="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+    shift
+    exec ${gpuscout_dir}/analysis/gpuscout_diff "$@"
+fi
+
 # Parse command-line options
-options=$(getopt -o hve:c:a:j -l help,dry_run,verbose,executable:,cubin:,args:,sm_count:,json -- "$@")
+options=$(getopt -o hve:c:a:j -l help,dry_run,verbose,executable:,cubin:,args:,sm_count:,json,kernel_regex:,launch_range:,stall_reasons:,launch_buckets:,correlation_threads:,rank_template:,merge_ranks: -- "$@")
 
 if [ $? -ne 0 ]; then
     echo "Error: Invalid option."
@@ -31,6 +47,13 @@ executable=""
 cubin=""
 args=""
 sms=16
+kernel_regex=""
+launch_range=""
+stall_reasons=""
+launch_buckets=""
+correlation_threads=""
+rank_template=""
+merge_ranks=""
 while true; do
     case "$1" in
         -h | --help)
@@ -64,6 +87,34 @@ while true; do
             sms="$2"
             shift 2
             ;;
+        --kernel_regex)
+            kernel_regex="$2"
+            shift 2
+            ;;
+        --launch_range)
+            launch_range="$2"
+            shift 2
+            ;;
+        --stall_reasons)
+            stall_reasons="$2"
+            shift 2
+            ;;
+        --launch_buckets)
+            launch_buckets="$2"
+            shift 2
+            ;;
+        --correlation_threads)
+            correlation_threads="$2"
+            shift 2
+            ;;
+        --rank_template)
+            rank_template="$2"
+            shift 2
+            ;;
+        --merge_ranks)
+            merge_ranks="$2"
+            shift 2
+            ;;
         --)
             shift
             break
@@ -75,6 +126,32 @@ while true; do
     esac
 done
 
+gpuscout_dir="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+
+# Combine the per-rank results of a previous multi-process run, no profiling is done
+if [ -n "$merge_ranks" ]; then
+    if [ ! -d "$merge_ranks" ]; then
+        echo "GPUscout TMP directory not found at: $merge_ranks"
+        exit 1
+    fi
+    merge_ranks="$( cd "$merge_ranks" && pwd )"
+    rank_list=${merge_ranks}/ranks.txt
+    rm -f ${rank_list}
+    for rank_dir in $(ls -d ${merge_ranks}/rank* 2>/dev/null | sort -V); do
+        rank=${rank_dir##*/rank}
+        rank_sampling=$(ls ${rank_dir}/pcsampling_*_rank${rank}.txt 2>/dev/null | head -n 1)
+        rank_metrics=$(ls ${rank_dir}/*_rank${rank}_metrics_list 2>/dev/null | head -n 1)
+        echo "rank: ${rank}, samplingFile: ${rank_sampling}, metricsFile: ${rank_metrics}" >> ${rank_list}
+    done
+    if [ ! -f ${rank_list} ]; then
+        echo "No rank directories (rank<rank>) found in: $merge_ranks"
+        exit 1
+    fi
+    echo "Combining the results of $(wc -l < ${rank_list}) ranks . . . . . . . . . . . . . . . "
+    ${gpuscout_dir}/analysis/merge_rank_results ${rank_list} ${merge_ranks}/rank_summary.json
+    exit $?
+fi
+
 #check the params
 if [ -z "$executable" ]; then
     echo "No executable specified (-e ..)"
@@ -84,6 +161,25 @@ executable_filename=$(basename "$executable")
 executable_dir="$( cd "$( dirname "$executable" )" && pwd )"
 executable="$executable_dir/$executable_filename"
 run_prefix=$executable_filename
+
+# In multi-process (MPI) runs every rank gets its own TMP directory and file names, as they share the GPUscout directory
+rank=""
+if [ -n "$rank_template" ]; then
+    rank=$(eval echo "$rank_template")
+elif [ -n "$OMPI_COMM_WORLD_RANK" ]; then
+    rank=$OMPI_COMM_WORLD_RANK
+elif [ -n "$PMI_RANK" ]; then
+    rank=$PMI_RANK
+elif [ -n "$PMIX_RANK" ]; then
+    rank=$PMIX_RANK
+elif [ -n "$SLURM_PROCID" ] && [ "${SLURM_NTASKS:-1}" -gt 1 ]; then
+    rank=$SLURM_PROCID
+fi
+rank=$(echo "$rank" | tr -c 'A-Za-z0-9_.\n-' '_')
+if [ -n "$rank" ]; then
+    run_prefix="${executable_filename}_rank${rank}"
+fi
+
 if [ ! -f "$executable" ]; then
     echo "Executable not found at: $executable"
     exit 1
@@ -103,8 +199,35 @@ if [ ! -f "$cubin" ]; then
     exit 1
 fi
 
-gpuscout_dir="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+# Options restricting the PC sampling (and the metrics collection) to the launches of interest
+sampling_filter_options=()
+ncu_filter_options=()
+if [ -n "$kernel_regex" ]; then
+    sampling_filter_options+=(--kernel-regex "$kernel_regex")
+    # The PC sampling matches the mangled symbol names, so Nsight Compute has to match the same names
+    ncu_filter_options+=(--kernel-name-base mangled --kernel-name "regex:${kernel_regex}")
+fi
+if [ -n "$launch_range" ]; then
+    sampling_filter_options+=(--launch-range "$launch_range")
+fi
+if [ -n "$stall_reasons" ]; then
+    sampling_filter_options+=(--stall-reasons "$stall_reasons")
+fi
+# Options of the utility resolving the sampled PCs to source lines
+sampling_utility_options=()
+if [ -n "$correlation_threads" ]; then
+    sampling_utility_options+=(--correlation-threads "$correlation_threads")
+fi
+# Per-launch stall profiles need the records flushed at every launch
+sampling_launch_options=()
+if [ -n "$launch_buckets" ]; then
+    sampling_launch_options+=(--flush-every-launch)
+fi
+
 gpuscout_tmp_dir="${gpuscout_dir}/tmp-gpuscout"
+if [ -n "$rank" ]; then
+    gpuscout_tmp_dir="${gpuscout_tmp_dir}/rank${rank}"
+fi
 gpuscout_output_dir="${gpuscout_tmp_dir}/output"
 # Save metrics in a seperate directory
 echo "======================================================================================================"
@@ -115,6 +238,14 @@ if [ "$json" = true ]; then
     mkdir -p ${gpuscout_output_dir}
 fi
 
+# Runtime, CPU time, peak memory and I/O of every stage of GPUscout itself, summarized at the end of the run
+export GPUSCOUT_RUNTIME_FILE=${gpuscout_tmp_dir}/gpuscout_runtime_${run_prefix}.jsonl
+rm -f ${GPUSCOUT_RUNTIME_FILE}
+# Usage: run_stage <stage name> <command> [arguments ...]
+run_stage() {
+    ${gpuscout_dir}/analysis/gpuscout_runtime run "$@"
+}
+
 # Note: when you compile the code with nvcc, create 2 executables
 # 1. without -cubin flag: <executable name>
 # 2. with -cubin flag: prefix the name of the executable with cubin-<executable name>
@@ -125,6 +256,12 @@ echo "==== Arguments for the executable file: \"$args\""
 echo "==== Dry-run: $dry_run"
 echo "==== Verbose: $verbose"
 echo "==== JSON Output: $json"
+if [ -n "$rank" ]; then
+    echo "==== Rank: $rank"
+fi
+if [ ${#sampling_filter_options[@]} -gt 0 ]; then
+    echo "==== Sampling filter: ${sampling_filter_options[*]}"
+fi
 echo "======================================================================================================"
 
 
@@ -205,11 +342,11 @@ echo "Setting up profiling . . . . . . . . . . . . . . . "
 
 cd ${gpuscout_dir}
 echo -e "Generating binaries . . . . . . . . . . . . . . . . . . . ."
-nvdisasm -g -c ${cubin} > ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt #TODO this line necessary?
-nvdisasm -g -c ${cubin} > ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt
-cuobjdump -ptx ${executable} > ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt
-nvdisasm -g -c -lrm=count ${cubin} > ${gpuscout_tmp_dir}/nvdisasm-registers-hpctoolkit-${run_prefix}-sass.txt #TODO this line necessary?
-nvdisasm -g -c -lrm=count ${cubin} > ${gpuscout_tmp_dir}/nvdisasm-registers-executable-${run_prefix}-sass.txt
+run_stage nvdisasm_hpctoolkit_sass nvdisasm -g -c ${cubin} > ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt #TODO this line necessary?
+run_stage nvdisasm_sass nvdisasm -g -c ${cubin} > ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt
+run_stage cuobjdump_ptx cuobjdump -ptx ${executable} > ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt
+run_stage nvdisasm_hpctoolkit_registers nvdisasm -g -c -lrm=count ${cubin} > ${gpuscout_tmp_dir}/nvdisasm-registers-hpctoolkit-${run_prefix}-sass.txt #TODO this line necessary?
+run_stage nvdisasm_registers nvdisasm -g -c -lrm=count ${cubin} > ${gpuscout_tmp_dir}/nvdisasm-registers-executable-${run_prefix}-sass.txt
 
 
 # Run the generate_sampling_stalls script inside the sampling_utilities directory
@@ -217,12 +354,21 @@ if [ "$dry_run" = false ]; then
     echo "Getting warp stall reasons . . . . . . . . . . . . . . . "
     source ${gpuscout_dir}/sampling_utilities/generate_sampling_stalls.sh
     cp ${gpuscout_dir}/sampling_utilities/sampling_utility/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt
+    cp ${gpuscout_dir}/sampling_utilities/sampling_utility/pcsampling_${run_prefix}_ctx*.txt ${gpuscout_tmp_dir}/ 2>/dev/null
+    cp ${gpuscout_dir}/sampling_utilities/sampling_utility/pcsampling_${run_prefix}_devices.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}_devices.txt
+    if [ -n "$launch_buckets" ]; then
+        cp ${gpuscout_dir}/sampling_utilities/sampling_utility/pcsampling_${run_prefix}_launches.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}_launches.txt
+    fi
 fi
 
 # Get the measurements and analysis from the measurements script
 echo "Measurements and Analysis . . . . . . . . . . . . . . . (${gpuscout_dir}/analysis/measurements.sh)"
 source ${gpuscout_dir}/analysis/measurements.sh
 
+echo "GPUscout runtime . . . . . . . . . . . . . . . "
+${gpuscout_dir}/analysis/gpuscout_runtime summary ${GPUSCOUT_RUNTIME_FILE}
+echo "======================================================================================================"
+
 # Exit
 echo -e "Profiling complete! Starting cleanup . . . . . . . . . . . . . . . . . . . ."
 
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+#@(#) Starts a command as several local processes with the rank environment of an MPI launcher, to test multi-process runs of GPUscout
+#     e.g. ./fake_mpirun -n 4 ./GPUscout -e ../executable/app --json && ./GPUscout --merge_ranks=tmp-gpuscout
+
+usage() {
+    echo "Usage: $0 -n ranks command [arguments]"
+    echo "  -n : Number of ranks to start. Rank i runs with OMPI_COMM_WORLD_RANK=i and PMI_RANK=i, its output is prefixed with [rank i]"
+    exit 1
+}
+
+if [ "$1" != "-n" ] || [ -z "$2" ] || [ -z "$3" ]; then
+    usage
+fi
+ranks=$2
+shift 2
+
+pids=()
+for ((rank = 0; rank < ranks; rank++)); do
+    (
+        set -o pipefail
+        OMPI_COMM_WORLD_RANK=$rank OMPI_COMM_WORLD_SIZE=$ranks PMI_RANK=$rank PMI_SIZE=$ranks "$@" 2>&1 | sed "s/^/[rank $rank] /"
+    ) &
+    pids+=($!)
+done
+
+failed=0
+for ((rank = 0; rank < ranks; rank++)); do
+    if ! wait ${pids[$rank]}; then
+        echo "[rank $rank] failed"
+        failed=$((failed + 1))
+    fi
+done
+
+exit $failed
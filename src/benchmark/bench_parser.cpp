@@ -0,0 +1,159 @@
+/**
+ * Runs one parser on the given files, so that the benchmark can time it in its own process
+ * The SASS parsers define helper functions with the same names, hence this file is built once per parser (BENCH_PARSER_<NAME>)
+ *
+ * @author Soumya Sen
+ */
+
+#include <iostream>
+#include <string>
+#include <cstring>
+
+#if defined(BENCH_PARSER_PCSAMPLING)
+#include "parser_pcsampling.hpp"
+#elif defined(BENCH_PARSER_METRICS)
+#include "parser_metrics.hpp"
+#elif defined(BENCH_PARSER_LIVEREGISTERS)
+#include "parser_liveregisters.hpp"
+#elif defined(BENCH_PARSER_PTX_GLOBAL_ATOMICS)
+#include "parser_ptx_global_atomics.hpp"
+#elif defined(BENCH_PARSER_PTX_ASYNC_COPY)
+#include "parser_ptx_async_copy.hpp"
+#elif defined(BENCH_PARSER_PTX_LOCAL_MEMORY)
+#include "parser_ptx_local_memory.hpp"
+#elif defined(BENCH_PARSER_SASS_DATATYPE_CONVERSION)
+#include "parser_sass_datatype_conversion.hpp"
+#elif defined(BENCH_PARSER_SASS_DEADLOCK_DETECTION)
+#include "parser_sass_deadlock_detection.hpp"
+#elif defined(BENCH_PARSER_SASS_DIVERGENCE)
+#include "parser_sass_divergence.hpp"
+#elif defined(BENCH_PARSER_SASS_REGISTER_SPILLING)
+#include "parser_sass_register_spilling.hpp"
+#elif defined(BENCH_PARSER_SASS_RESTRICT)
+#include "parser_sass_restrict.hpp"
+#elif defined(BENCH_PARSER_SASS_USE_SHARED)
+#include "parser_sass_use_shared.hpp"
+#elif defined(BENCH_PARSER_SASS_USE_TEXTURE)
+#include "parser_sass_use_texture.hpp"
+#elif defined(BENCH_PARSER_SASS_VECTORIZED)
+#include "parser_sass_vectorized.hpp"
+#elif defined(BENCH_PARSER_SASS_IR)
+#include "parser_sass_ir.hpp"
+#elif defined(BENCH_PARSER_SASS_BANK_CONFLICTS)
+#include "parser_sass_bank_conflicts.hpp"
+#elif defined(BENCH_PARSER_SASS_COALESCING)
+#include "parser_sass_coalescing.hpp"
+#elif defined(BENCH_PARSER_SASS_PREDICATION)
+#include "parser_sass_predication.hpp"
+#elif defined(BENCH_PARSER_SASS_UNIFORM_LOADS)
+#include "parser_sass_uniform_loads.hpp"
+#elif defined(BENCH_PARSER_SASS_TENSOR_CORES)
+#include "parser_sass_tensor_cores.hpp"
+#elif defined(BENCH_PARSER_SASS_ASYNC_COPY)
+#include "parser_sass_async_copy.hpp"
+#elif defined(BENCH_PARSER_SASS_BARRIERS)
+#include "parser_sass_barriers.hpp"
+#elif defined(BENCH_PARSER_SASS_INTEGER_ARITHMETIC)
+#include "parser_sass_integer_arithmetic.hpp"
+#elif defined(BENCH_PARSER_SASS_FP64)
+#include "parser_sass_fp64.hpp"
+#elif defined(BENCH_PARSER_SASS_REDUNDANT_LOADS)
+#include "parser_sass_redundant_loads.hpp"
+#elif defined(BENCH_PARSER_SASS_WARP_REDUCTIONS)
+#include "parser_sass_warp_reductions.hpp"
+#elif defined(BENCH_PARSER_SASS_DEVICE_CALLS)
+#include "parser_sass_device_calls.hpp"
+#elif defined(BENCH_PARSER_SASS_GENERIC_MEMORY)
+#include "parser_sass_generic_memory.hpp"
+#else
+#error "Define the parser to benchmark (BENCH_PARSER_<NAME>)"
+#endif
+
+int main(int argc, char **argv)
+{
+    // argv[1]: function to run, argv[2..]: input files
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " function file [file ...]" << std::endl;
+        return 1;
+    }
+    std::string function = argv[1];
+    size_t result_size = 0;
+
+#if defined(BENCH_PARSER_PCSAMPLING)
+    if (function == "get_warp_stalls" && argc > 3)
+    {
+        result_size = get_warp_stalls(argv[2], argv[3], analysis_kind::ALL).size();
+    }
+    else if (function == "get_kernel_stalls")
+    {
+        result_size = get_kernel_stalls(argv[2]).size();
+    }
+    else if (function == "get_launch_bucket_stalls")
+    {
+        result_size = get_launch_bucket_stalls(argv[2]).size();
+    }
+    else
+    {
+        std::cout << "Unknown function: " << function << std::endl;
+        return 1;
+    }
+#elif defined(BENCH_PARSER_METRICS)
+    result_size = create_metrics(argv[2]).size();
+#elif defined(BENCH_PARSER_LIVEREGISTERS)
+    result_size = live_registers_analysis(argv[2]).size();
+#elif defined(BENCH_PARSER_PTX_GLOBAL_ATOMICS)
+    result_size = std::get<0>(global_mem_atomics_analysis(argv[2])).size();
+#elif defined(BENCH_PARSER_PTX_ASYNC_COPY)
+    result_size = ptx_async_copy_analysis(argv[2]).size();
+#elif defined(BENCH_PARSER_PTX_LOCAL_MEMORY)
+    result_size = ptx_local_memory_analysis(argv[2]).size();
+#elif defined(BENCH_PARSER_SASS_DATATYPE_CONVERSION)
+    result_size = datatype_conversions_analysis(argv[2]).size();
+#elif defined(BENCH_PARSER_SASS_DEADLOCK_DETECTION)
+    result_size = deadlock_detection_analysis(argv[2]).size();
+#elif defined(BENCH_PARSER_SASS_DIVERGENCE)
+    result_size = std::get<0>(branches_detection(argv[2])).size();
+#elif defined(BENCH_PARSER_SASS_REGISTER_SPILLING)
+    result_size = std::get<0>(register_spilling_analysis(argv[2])).size();
+#elif defined(BENCH_PARSER_SASS_RESTRICT)
+    result_size = restrict_analysis(argv[2]).size();
+#elif defined(BENCH_PARSER_SASS_USE_SHARED)
+    result_size = std::get<0>(use_shared_analysis(argv[2])).size();
+#elif defined(BENCH_PARSER_SASS_USE_TEXTURE)
+    result_size = use_texture_analysis(argv[2]).size();
+#elif defined(BENCH_PARSER_SASS_VECTORIZED)
+    result_size = std::get<0>(vectorized_analysis(argv[2])).size();
+#elif defined(BENCH_PARSER_SASS_IR)
+    result_size = parse_sass_ir(argv[2]).size();
+#elif defined(BENCH_PARSER_SASS_BANK_CONFLICTS)
+    result_size = bank_conflict_analysis(argv[2]).size();
+#elif defined(BENCH_PARSER_SASS_COALESCING)
+    result_size = coalescing_analysis(argv[2]).size();
+#elif defined(BENCH_PARSER_SASS_PREDICATION)
+    result_size = predication_analysis(argv[2]).size();
+#elif defined(BENCH_PARSER_SASS_UNIFORM_LOADS)
+    result_size = uniform_load_analysis(argv[2]).size();
+#elif defined(BENCH_PARSER_SASS_TENSOR_CORES)
+    result_size = std::get<0>(tensor_core_analysis(argv[2])).size();
+#elif defined(BENCH_PARSER_SASS_ASYNC_COPY)
+    result_size = std::get<0>(async_copy_analysis(argv[2])).size();
+#elif defined(BENCH_PARSER_SASS_BARRIERS)
+    result_size = barrier_analysis(argv[2]).size();
+#elif defined(BENCH_PARSER_SASS_INTEGER_ARITHMETIC)
+    result_size = std::get<0>(integer_arithmetic_analysis(argv[2])).size();
+#elif defined(BENCH_PARSER_SASS_FP64)
+    result_size = std::get<0>(fp64_analysis(argv[2])).size();
+#elif defined(BENCH_PARSER_SASS_REDUNDANT_LOADS)
+    result_size = std::get<0>(redundant_load_analysis(argv[2])).size();
+#elif defined(BENCH_PARSER_SASS_WARP_REDUCTIONS)
+    result_size = std::get<0>(warp_reduction_analysis(argv[2])).size();
+#elif defined(BENCH_PARSER_SASS_DEVICE_CALLS)
+    result_size = std::get<0>(device_call_analysis(argv[2])).size();
+#elif defined(BENCH_PARSER_SASS_GENERIC_MEMORY)
+    result_size = generic_memory_analysis(argv[2]).size();
+#endif
+
+    std::cout << function << ": " << result_size << " kernels" << std::endl;
+    return 0;
+}
@@ -0,0 +1,313 @@
+/**
+ * Benchmark of the GPUscout parsers and analyses on a synthetic corpus, runs without a GPU
+ * Every parser (bench_parser_*) and analysis (merge_analysis_*, save_to_json, merge_rank_results) is run in its own process,
+ * the wall time, CPU time and peak resident memory are taken from wait4() and reported per MB of input
+ *
+ * @author Soumya Sen
+ */
+
+#include "corpus_generator.hpp"
+#include "utilities/json.hpp"
+#include <filesystem>
+#include <chrono>
+#include <iomanip>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+using json = nlohmann::json;
+
+#ifndef GPUSCOUT_BENCHMARK_DIR
+#define GPUSCOUT_BENCHMARK_DIR "."
+#endif
+#ifndef GPUSCOUT_ANALYSIS_DIR
+#define GPUSCOUT_ANALYSIS_DIR ".."
+#endif
+
+/// @brief One benchmarked program with its arguments and the files it reads
+struct benchmark_case
+{
+    std::string name;
+    std::string executable;
+    std::vector<std::string> arguments;
+    std::vector<std::string> inputs;
+};
+
+struct benchmark_result
+{
+    double wall_seconds;
+    double cpu_seconds;
+    double peak_rss_mb;
+    bool success;
+};
+
+double file_size_mb(const std::string &filename)
+{
+    std::error_code error;
+    auto size = std::filesystem::file_size(filename, error);
+    return error ? 0 : size / (1024.0 * 1024.0);
+}
+
+/// @brief Run the program in a child process, with its output discarded (failures show in the exit status)
+benchmark_result run_case(const benchmark_case &bench)
+{
+    std::vector<char *> argv;
+    argv.push_back(const_cast<char *>(bench.executable.c_str()));
+    for (const auto &argument : bench.arguments)
+    {
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        int dev_null = open("/dev/null", O_WRONLY);
+        dup2(dev_null, STDOUT_FILENO);
+        dup2(dev_null, STDERR_FILENO);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage = {};
+    wait4(pid, &status, 0, &usage);
+    auto end = std::chrono::steady_clock::now();
+
+    benchmark_result result;
+    result.wall_seconds = std::chrono::duration<double>(end - start).count();
+    result.cpu_seconds = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    result.peak_rss_mb = usage.ru_maxrss / 1024.0; // ru_maxrss is in KB on Linux
+    result.success = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    return result;
+}
+
+/// @brief The parsers and analyses to benchmark on the corpus
+std::vector<benchmark_case> get_benchmark_cases(const corpus_files &files, const std::string &benchmark_dir, const std::string &analysis_dir)
+{
+    std::string output_dir = files.directory + "/output";
+    std::filesystem::create_directories(output_dir);
+
+    auto parser = [&](const std::string &name, const std::string &function, const std::vector<std::string> &inputs)
+    {
+        std::vector<std::string> arguments = {function};
+        arguments.insert(arguments.end(), inputs.begin(), inputs.end());
+        return benchmark_case{"parser_" + name + (function != "-" ? " (" + function + ")" : ""), benchmark_dir + "/bench_parser_" + name, arguments, inputs};
+    };
+    std::vector<benchmark_case> cases = {
+        parser("pcsampling", "get_warp_stalls", {files.sampling, files.sass}),
+        parser("pcsampling", "get_kernel_stalls", {files.sampling}),
+        parser("pcsampling", "get_launch_bucket_stalls", {files.sampling_launches}),
+        parser("metrics", "-", {files.metrics}),
+        parser("liveregisters", "-", {files.sass_registers}),
+        parser("ptx_global_atomics", "-", {files.ptx}),
+        parser("ptx_async_copy", "-", {files.ptx}),
+        parser("ptx_local_memory", "-", {files.ptx}),
+        parser("sass_datatype_conversion", "-", {files.sass}),
+        parser("sass_deadlock_detection", "-", {files.sass}),
+        parser("sass_divergence", "-", {files.sass}),
+        parser("sass_register_spilling", "-", {files.sass}),
+        parser("sass_restrict", "-", {files.sass}),
+        parser("sass_use_shared", "-", {files.sass}),
+        parser("sass_use_texture", "-", {files.sass}),
+        parser("sass_vectorized", "-", {files.sass}),
+        parser("sass_ir", "-", {files.sass}),
+        parser("sass_bank_conflicts", "-", {files.sass}),
+        parser("sass_coalescing", "-", {files.sass}),
+        parser("sass_predication", "-", {files.sass}),
+        parser("sass_uniform_loads", "-", {files.sass}),
+        parser("sass_tensor_cores", "-", {files.sass}),
+        parser("sass_async_copy", "-", {files.sass}),
+        parser("sass_barriers", "-", {files.sass}),
+        parser("sass_integer_arithmetic", "-", {files.sass}),
+        parser("sass_fp64", "-", {files.sass}),
+        parser("sass_redundant_loads", "-", {files.sass}),
+        parser("sass_warp_reductions", "-", {files.sass}),
+        parser("sass_device_calls", "-", {files.sass}),
+        parser("sass_generic_memory", "-", {files.sass}),
+    };
+
+    // Arguments of the merge analyses, as passed by measurements.sh
+    std::vector<std::string> common = {files.sass, files.sass, files.ptx, files.sampling, files.metrics};
+    auto analysis = [&](const std::string &name, const std::vector<std::string> &extra, const std::vector<std::string> &extra_inputs)
+    {
+        std::vector<std::string> arguments = common;
+        arguments.insert(arguments.end(), extra.begin(), extra.end());
+        std::vector<std::string> inputs = {files.sass, files.ptx, files.sampling, files.metrics};
+        inputs.insert(inputs.end(), extra_inputs.begin(), extra_inputs.end());
+        return benchmark_case{name, analysis_dir + "/" + name, arguments, inputs};
+    };
+    cases.push_back(analysis("merge_analysis_register_spilling", {files.sass_registers, "true", output_dir, "16"}, {files.sass_registers}));
+    cases.push_back(analysis("merge_analysis_use_restrict", {files.sass_registers, "true", output_dir}, {files.sass_registers}));
+    cases.push_back(analysis("merge_analysis_vectorization", {files.sass_registers, "true", output_dir}, {files.sass_registers}));
+    for (const std::string name : {"merge_analysis_global_atomics", "merge_analysis_warp_divergence", "merge_analysis_use_texture", "merge_analysis_use_shared",
+                                   "merge_analysis_datatype_conversion", "merge_analysis_deadlock_detection", "merge_analysis_bank_conflicts",
+                                   "merge_analysis_coalescing", "merge_analysis_predication", "merge_analysis_uniform_loads",
+                                   "merge_analysis_tensor_cores", "merge_analysis_async_copy", "merge_analysis_barriers",
+                                   "merge_analysis_integer_arithmetic", "merge_analysis_fp64", "merge_analysis_redundant_loads",
+                                   "merge_analysis_warp_reductions", "merge_analysis_device_calls", "merge_analysis_generic_memory"})
+    {
+        cases.push_back(analysis(name, {"true", output_dir}, {}));
+    }
+    cases.push_back(analysis("merge_analysis_launch_variability", {"true", output_dir, files.sampling_launches}, {files.sampling_launches}));
+    cases.push_back(analysis("merge_analysis_roofline", {"true", output_dir}, {}));
+    cases.push_back(analysis("merge_analysis_occupancy", {files.sass_registers, "true", output_dir, "16"}, {files.sass_registers}));
+    cases.push_back(analysis("merge_analysis_device_balance", {"true", output_dir, files.sampling_devices}, {files.sampling}));
+
+    cases.push_back({"save_to_json", analysis_dir + "/save_to_json",
+                     {output_dir, files.directory + "/result-bench", files.sass, files.sass_registers, files.ptx, files.sampling, files.metrics, "16"},
+                     {files.sass, files.sass_registers, files.ptx, files.sampling, files.metrics}});
+
+    benchmark_case ranks = {"merge_rank_results", analysis_dir + "/merge_rank_results", {files.ranks, files.directory + "/rank_summary.json"}, {}};
+    std::ifstream rank_list(files.ranks);
+    std::string line;
+    while (std::getline(rank_list, line))
+    {
+        ranks.inputs.push_back(files.sampling);
+        ranks.inputs.push_back(files.metrics);
+    }
+    cases.push_back(ranks);
+
+    return cases;
+}
+
+void print_usage(const char *name)
+{
+    std::cout << "Usage: " << name << " [corpus options] [--repeat N] [--filter text] [--corpus-dir dir] [--bin-dir dir] [--analysis-dir dir] [--json file]" << std::endl;
+    std::cout << "  corpus options : --kernels, --instructions, --samples, --launches, --contexts, --ranks, --seed (see generate_corpus)" << std::endl;
+    std::cout << "  --repeat : Runs of every case, the median time is reported (default: 3)" << std::endl;
+    std::cout << "  --filter : Only run the cases whose name contains the text" << std::endl;
+    std::cout << "  --corpus-dir : Directory for the generated corpus (default: a new temporary directory, removed afterwards)" << std::endl;
+    std::cout << "  --bin-dir : Directory of the bench_parser_* programs (default: " << GPUSCOUT_BENCHMARK_DIR << ")" << std::endl;
+    std::cout << "  --analysis-dir : Directory of the merge_analysis_* programs (default: " << GPUSCOUT_ANALYSIS_DIR << ")" << std::endl;
+    std::cout << "  --json : Also save the results as JSON" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    corpus_options options;
+    int repeat = 3;
+    std::string filter, corpus_dir, json_file;
+    std::string benchmark_dir = GPUSCOUT_BENCHMARK_DIR, analysis_dir = GPUSCOUT_ANALYSIS_DIR;
+
+    int i = 1;
+    while (i < argc)
+    {
+        int next = parse_corpus_options(argc, argv, i, options);
+        if (next != i)
+        {
+            i = next;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+        std::string option = argv[i], value = argv[i + 1];
+        if (option == "--repeat")
+            repeat = std::max(1, std::stoi(value));
+        else if (option == "--filter")
+            filter = value;
+        else if (option == "--corpus-dir")
+            corpus_dir = value;
+        else if (option == "--bin-dir")
+            benchmark_dir = value;
+        else if (option == "--analysis-dir")
+            analysis_dir = value;
+        else if (option == "--json")
+            json_file = value;
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+        i += 2;
+    }
+
+    bool remove_corpus = corpus_dir.empty();
+    if (remove_corpus)
+    {
+        char corpus_template[] = "/tmp/gpuscout-benchmark-XXXXXX";
+        corpus_dir = mkdtemp(corpus_template);
+    }
+    std::filesystem::create_directories(corpus_dir);
+
+    auto generation_start = std::chrono::steady_clock::now();
+    corpus_files files = generate_corpus(corpus_dir, options);
+    double generation_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - generation_start).count();
+    std::cout << "Corpus: " << options.kernels << " kernels x " << options.instructions << " instructions, " << options.samples << " PC sampling records, seed "
+              << options.seed << " (" << std::fixed << std::setprecision(2) << file_size_mb(files.sass) << " MB SASS, " << file_size_mb(files.sampling)
+              << " MB PC sampling, generated in " << generation_seconds << " s)" << std::endl;
+
+    json result = {
+        {"corpus", {{"kernels", options.kernels}, {"instructions", options.instructions}, {"samples", options.samples}, {"seed", options.seed}}},
+        {"cases", json::array()}
+    };
+
+    std::cout << std::left << std::setw(56) << "Stage" << std::right << std::setw(10) << "Input MB" << std::setw(10) << "Wall s" << std::setw(10) << "CPU s"
+              << std::setw(10) << "s/MB" << std::setw(12) << "Peak MB" << std::setw(12) << "Peak MB/MB" << std::endl;
+    int failures = 0;
+    for (const auto &bench : get_benchmark_cases(files, benchmark_dir, analysis_dir))
+    {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        if (access(bench.executable.c_str(), X_OK) != 0)
+        {
+            std::cout << std::left << std::setw(56) << bench.name << "not found: " << bench.executable << std::endl;
+            continue;
+        }
+
+        double input_mb = 0;
+        for (const auto &input : bench.inputs)
+        {
+            input_mb += file_size_mb(input);
+        }
+
+        std::vector<double> wall, cpu;
+        double peak_rss_mb = 0;
+        bool success = true;
+        for (int r = 0; r < repeat; r++)
+        {
+            benchmark_result run = run_case(bench);
+            wall.push_back(run.wall_seconds);
+            cpu.push_back(run.cpu_seconds);
+            peak_rss_mb = std::max(peak_rss_mb, run.peak_rss_mb);
+            success = success && run.success;
+        }
+        std::sort(wall.begin(), wall.end());
+        std::sort(cpu.begin(), cpu.end());
+        double wall_median = wall[wall.size() / 2], cpu_median = cpu[cpu.size() / 2];
+
+        std::cout << std::left << std::setw(56) << bench.name << std::right << std::setprecision(2) << std::setw(10) << input_mb << std::setprecision(3)
+                  << std::setw(10) << wall_median << std::setw(10) << cpu_median << std::setw(10) << (input_mb > 0 ? wall_median / input_mb : 0)
+                  << std::setprecision(1) << std::setw(12) << peak_rss_mb << std::setw(12) << (input_mb > 0 ? peak_rss_mb / input_mb : 0)
+                  << (success ? "" : "   FAILED") << std::endl;
+        failures += !success;
+
+        result["cases"].push_back({
+            {"name", bench.name},
+            {"input_mb", input_mb},
+            {"wall_seconds", wall_median},
+            {"cpu_seconds", cpu_median},
+            {"peak_rss_mb", peak_rss_mb},
+            {"success", success}
+        });
+    }
+
+    if (!json_file.empty())
+    {
+        std::ofstream file(json_file);
+        file << result.dump(4);
+    }
+    if (remove_corpus)
+    {
+        std::filesystem::remove_all(corpus_dir);
+    }
+
+    return failures ? 1 : 0;
+}
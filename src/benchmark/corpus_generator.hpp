@@ -0,0 +1,546 @@
+/**
+ * Synthetic input corpus for the GPUscout parsers and analyses
+ * Writes nvdisasm SASS (with and without -lrm=count), PTX, PC sampling and Nsight Compute files in the format
+ * GPUscout reads them, so that the analyses can be run and timed without a GPU
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef CORPUS_GENERATOR_HPP
+#define CORPUS_GENERATOR_HPP
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <algorithm>
+#include <map>
+#include <cstring>
+
+/// @brief Size of the generated corpus
+struct corpus_options
+{
+    int kernels = 8;
+    int instructions = 2000;   // SASS instructions per kernel
+    int samples = 100000;      // PC sampling records over all kernels
+    int launches = 16;         // launches per kernel in the per-launch sampling file
+    int contexts = 2;          // CUDA contexts (devices) the samples are spread over
+    int ranks = 4;             // ranks listed for the rank merge
+    unsigned int seed = 1;
+};
+
+/// @brief Files of a generated corpus, named like in the GPUscout TMP directory
+struct corpus_files
+{
+    std::string directory;
+    std::string prefix;
+    std::string sass;
+    std::string sass_registers;
+    std::string ptx;
+    std::string sampling;
+    std::string sampling_launches;
+    std::string sampling_devices;
+    std::string metrics;
+    std::string ranks;
+};
+
+/// @brief One generated SASS instruction
+struct corpus_instruction
+{
+    int pc_offset;
+    int line_number;
+    std::string label;       // branch target label placed before the instruction, may be empty
+    std::string instruction;
+    int live_registers[3];   // general, predicate and uniform registers
+};
+
+/// @brief Weighted instruction templates, every %d is replaced by a register number
+const std::vector<std::pair<int, std::string>> corpus_instruction_templates = {
+    {12, "IMAD R%d, R%d, c[0x0][0x0], R%d ;"},
+    {10, "IADD3 R%d, R%d, 0x1, RZ ;"},
+    {10, "FFMA R%d, R%d, R%d, R%d ;"},
+    {6, "FADD R%d, R%d, R%d ;"},
+    {6, "FMUL R%d, R%d, R%d ;"},
+    {6, "ISETP.GE.AND P0, PT, R%d, c[0x0][0x168], PT ;"},
+    {8, "LDG.E R%d, [R%d.64] ;"},
+    {2, "LDG.E.64 R%d, [R%d.64+0x8] ;"},
+    {2, "LDG.E.128 R%d, [R%d.64+0x10] ;"},
+    {2, "LDG.E.CONSTANT R%d, [R%d.64] ;"},
+    {4, "STG.E [R%d.64], R%d ;"},
+    {3, "LDS R%d, [R%d] ;"},
+    {2, "STS [R%d], R%d ;"},
+    {2, "LDL R%d, [R1+0x10] ;"},
+    {2, "STL [R1+0x10], R%d ;"},
+    {1, "BAR.SYNC 0x0 ;"},
+    {1, "ATOMG.E.ADD.STRONG.GPU PT, R%d, [R%d.64], R%d ;"},
+    {1, "RED.E.ADD.STRONG.GPU [R%d.64], R%d ;"},
+    {1, "ATOMS.ADD RZ, [R%d], R%d ;"},
+    {1, "I2F R%d, R%d ;"},
+    {1, "F2I.TRUNC.NTZ R%d, R%d ;"},
+    {1, "F2F.F64.F32 R%d, R%d ;"},
+    {1, "MUFU.RCP R%d, R%d ;"},
+    {1, "LDGSTS.E [R%d], [R%d.64] ;"},
+    {1, "TEX.SCR.LL R%d, R%d, R%d, 0x0, 0x58, 2D, 0x1 ;"},
+    {1, "SHFL.BFLY PT, R%d, R%d, 0x10, 0x1f ;"},
+    {1, "S2R R%d, SR_TID.X ;"},
+    {1, "LEA R%d, R%d, R%d, 0x2 ;"},
+    {1, "IMAD.SHL.U32 R%d, R%d, 0x80, RZ ;"},
+    {1, "LDS.U.64 R%d, [R%d.X4+0x100] ;"},
+};
+
+/// @brief Stall reasons reported by CUPTI
+const std::vector<std::string> corpus_stall_reasons = {
+    "smsp__pcsamp_warps_issue_stalled_long_scoreboard", "smsp__pcsamp_warps_issue_stalled_wait", "smsp__pcsamp_warps_issue_stalled_selected",
+    "smsp__pcsamp_warps_issue_stalled_not_selected", "smsp__pcsamp_warps_issue_stalled_short_scoreboard", "smsp__pcsamp_warps_issue_stalled_mio_throttle",
+    "smsp__pcsamp_warps_issue_stalled_lg_throttle", "smsp__pcsamp_warps_issue_stalled_barrier", "smsp__pcsamp_warps_issue_stalled_math_pipe_throttle",
+    "smsp__pcsamp_warps_issue_stalled_branch_resolving", "smsp__pcsamp_warps_issue_stalled_tex_throttle", "smsp__pcsamp_warps_issue_stalled_membar",
+};
+
+/// @brief Metrics collected by measurements.sh
+const std::vector<std::string> corpus_metrics = {
+    "smsp__warps_active.sum", "smsp__sass_inst_executed_op_global.sum", "smsp__sass_inst_executed.sum", "l1tex__t_sectors_pipe_lsu_mem_global_op_st.sum",
+    "smsp__warp_issue_stalled_barrier_per_warp_active.pct", "smsp__warp_issue_stalled_membar_per_warp_active.pct", "smsp__warp_issue_stalled_short_scoreboard_per_warp_active.pct",
+    "smsp__warp_issue_stalled_wait_per_warp_active.pct", "smsp__thread_inst_executed_per_inst_executed.ratio", "sm__sass_branch_targets.avg",
+    "sm__sass_branch_targets_threads_divergent.avg", "smsp__warp_issue_stalled_imc_miss_per_warp_active.pct", "smsp__warp_issue_stalled_long_scoreboard_per_warp_active.pct",
+    "sm__warps_active.avg.pct_of_peak_sustained_active", "smsp__warp_issue_stalled_lg_throttle_per_warp_active.pct", "smsp__warp_issue_stalled_mio_throttle_per_warp_active.pct",
+    "smsp__warp_issue_stalled_tex_throttle_per_warp_active.pct", "sm__sass_inst_executed_op_global_red.sum", "sm__sass_inst_executed_op_shared_atom.sum",
+    "l1tex__data_pipe_lsu_wavefronts_mem_shared_op_ld.sum", "sm__sass_inst_executed_op_shared_ld.sum", "l1tex__data_pipe_lsu_wavefronts_mem_shared_op_st.sum",
+    "sm__sass_inst_executed_op_shared_st.sum", "smsp__sass_average_data_bytes_per_wavefront_mem_shared.pct", "l1tex__t_sector_hit_rate.pct", "lts__t_sectors_op_atom.sum",
+    "lts__t_sectors_op_read.sum", "lts__t_sectors_op_red.sum", "lts__t_sectors_op_write.sum", "smsp__inst_executed_op_local_ld.sum", "smsp__inst_executed_op_local_st.sum",
+    "sm__sass_inst_executed_op_global_ld.sum", "sm__sass_inst_executed_op_local_ld.sum", "l1tex__t_sectors_pipe_lsu_mem_global_op_ld.sum",
+    "l1tex__t_sector_pipe_lsu_mem_global_op_ld_hit_rate.pct", "lts__t_sector_op_read_hit_rate.pct", "l1tex__t_sectors_pipe_lsu_mem_local_op_ld.sum",
+    "l1tex__t_sector_pipe_lsu_mem_local_op_ld_hit_rate.pct", "l1tex__t_sectors_pipe_lsu_mem_global_op_red.sum", "l1tex__t_sectors_pipe_lsu_mem_global_op_atom.sum",
+    "l1tex__t_sector_pipe_lsu_mem_global_op_red_hit_rate.pct", "l1tex__t_sector_pipe_lsu_mem_global_op_atom_hit_rate.pct", "lts__t_sector_op_red_hit_rate.pct",
+    "lts__t_sector_op_atom_hit_rate.pct", "sm__sass_data_bytes_mem_shared_op_atom.sum", "l1tex__m_xbar2l1tex_read_sectors_mem_lg_op_ld.sum.pct_of_peak_sustained_elapsed",
+    "l1tex__average_t_sectors_per_request_pipe_lsu_mem_global_op_ld.ratio", "smsp__inst_executed_op_global_ld.sum", "memory_l2_theoretical_sectors_global",
+    "memory_l2_theoretical_sectors_global_ideal", "memory_l1_wavefronts_shared", "memory_l1_wavefronts_shared_ideal", "sm__sass_inst_executed_op_texture.sum",
+    "l1tex__t_sectors_pipe_tex_mem_texture.sum", "l1tex__t_sector_pipe_tex_mem_texture_op_tex_hit_rate.pct", "smsp__sass_average_data_bytes_per_wavefront_mem_shared_op_ld.pct",
+    "l1tex__t_sectors_pipe_lsu_mem_local_op_st.sum", "l1tex__t_sector_pipe_lsu_mem_local_op_st_hit_rate.pct", "l1tex__t_sector_pipe_lsu_mem_global_op_st_hit_rate.pct",
+    "lts__t_sector_op_write_hit_rate.pct", "lts__t_sector_hit_rate.pct", "sm__sass_inst_executed_op_global_st.sum", "sm__sass_inst_executed_op_local_st.sum",
+    "smsp__inst_executed_op_ldgsts.sum", "smsp__sass_thread_inst_executed_op_fadd_pred_on.sum", "smsp__sass_thread_inst_executed_op_fmul_pred_on.sum",
+    "smsp__sass_thread_inst_executed_op_ffma_pred_on.sum", "smsp__sass_thread_inst_executed_op_dadd_pred_on.sum", "smsp__sass_thread_inst_executed_op_dmul_pred_on.sum",
+    "smsp__sass_thread_inst_executed_op_dfma_pred_on.sum", "smsp__sass_thread_inst_executed_op_hadd_pred_on.sum", "smsp__sass_thread_inst_executed_op_hmul_pred_on.sum",
+    "smsp__sass_thread_inst_executed_op_hfma_pred_on.sum", "sm__inst_executed_pipe_tensor.sum", "sm__sass_thread_inst_executed_op_ffma_pred_on.sum.peak_sustained",
+    "sm__sass_thread_inst_executed_op_dfma_pred_on.sum.peak_sustained", "sm__sass_thread_inst_executed_op_hfma_pred_on.sum.peak_sustained", "dram__bytes_read.sum",
+    "dram__bytes_write.sum", "dram__bytes.sum.peak_sustained", "dram__cycles_elapsed.avg.per_second", "sm__cycles_elapsed.avg", "sm__cycles_elapsed.avg.per_second",
+    "gpu__time_duration.sum", "sm__throughput.avg.pct_of_peak_sustained_elapsed", "gpu__compute_memory_throughput.avg.pct_of_peak_sustained_elapsed",
+    "launch__block_size", "launch__grid_size", "launch__registers_per_thread", "launch__shared_mem_per_block_static", "launch__shared_mem_per_block_dynamic",
+    "launch__shared_mem_config_size", "device__attribute_max_warps_per_multiprocessor", "device__attribute_max_blocks_per_multiprocessor",
+    "device__attribute_max_registers_per_multiprocessor", "device__attribute_max_shared_memory_per_multiprocessor",
+};
+
+std::string corpus_kernel_name(int kernel)
+{
+    std::string name = "bench_kernel_" + std::to_string(kernel);
+    return "_Z" + std::to_string(name.size()) + name + "PfPKfi";
+}
+
+/// @brief Fill the %d placeholders of an instruction template with random registers
+std::string corpus_fill_registers(const std::string &instruction_template, int register_count, std::mt19937 &rng)
+{
+    std::string instruction;
+    std::uniform_int_distribution<int> reg(2, register_count - 1);
+    for (size_t i = 0; i < instruction_template.size(); i++)
+    {
+        if (instruction_template[i] == '%' && i + 1 < instruction_template.size() && instruction_template[i + 1] == 'd')
+        {
+            instruction += std::to_string(reg(rng) & ~1); // 64 bit addresses use even register pairs
+            i++;
+        }
+        else
+        {
+            instruction += instruction_template[i];
+        }
+    }
+    return instruction;
+}
+
+/// @brief Generate the SASS instructions of one kernel, with loops (backward branches), forward branches and line information
+std::vector<corpus_instruction> corpus_generate_kernel(int instructions, std::mt19937 &rng)
+{
+    std::vector<int> weights;
+    for (const auto &[weight, instruction_template] : corpus_instruction_templates)
+    {
+        weights.push_back(weight);
+    }
+    std::discrete_distribution<int> pick(weights.begin(), weights.end());
+    std::uniform_int_distribution<int> percent(0, 99);
+    int register_count = 16 + 8 * (rng() % 7);
+
+    std::vector<corpus_instruction> kernel;
+    int label_count = 0;
+    int line_number = 10;
+    std::vector<std::pair<std::string, int>> open_loops; // label, line number of the loop head
+    std::vector<std::string> pending_forward_labels;
+    int live[3] = {4, 1, 0};
+
+    for (int i = 0; i < instructions; i++)
+    {
+        corpus_instruction instruction_obj;
+        instruction_obj.pc_offset = 16 * i;
+
+        if (percent(rng) < 15)
+        {
+            line_number += 1 + rng() % 3;
+        }
+
+        if (!pending_forward_labels.empty() && percent(rng) < 10)
+        {
+            instruction_obj.label = pending_forward_labels.back();
+            pending_forward_labels.pop_back();
+        }
+        else if (percent(rng) < 2 && i + 8 < instructions)
+        {
+            instruction_obj.label = ".L_x_" + std::to_string(label_count++);
+            open_loops.push_back({instruction_obj.label, line_number});
+        }
+
+        int roll = percent(rng);
+        if (i == instructions - 1)
+        {
+            instruction_obj.instruction = "EXIT ;";
+        }
+        else if (!open_loops.empty() && roll < 4)
+        {
+            instruction_obj.instruction = "@P0 BRA `(" + open_loops.back().first + ") ;";
+            open_loops.pop_back();
+        }
+        else if (roll < 6)
+        {
+            std::string label = ".L_x_" + std::to_string(label_count++);
+            pending_forward_labels.push_back(label);
+            instruction_obj.instruction = "@!P0 BRA `(" + label + ") ;";
+        }
+        else
+        {
+            instruction_obj.instruction = corpus_fill_registers(corpus_instruction_templates[pick(rng)].second, register_count, rng);
+        }
+
+        live[0] = std::clamp(live[0] + (int)(rng() % 5) - 2, 2, register_count);
+        live[1] = std::clamp(live[1] + (int)(rng() % 3) - 1, 0, 7);
+        live[2] = std::clamp(live[2] + (int)(rng() % 3) - 1, 0, 4);
+        std::copy(live, live + 3, instruction_obj.live_registers);
+        instruction_obj.line_number = line_number;
+        kernel.push_back(instruction_obj);
+    }
+
+    // Place the branch targets which were not reached yet at the end of the kernel
+    while (!pending_forward_labels.empty())
+    {
+        corpus_instruction instruction_obj = {16 * (int)kernel.size(), line_number, pending_forward_labels.back(), "NOP ;", {2, 0, 0}};
+        pending_forward_labels.pop_back();
+        kernel.push_back(instruction_obj);
+    }
+
+    return kernel;
+}
+
+/// @brief Write the kernels like nvdisasm -g -c (and -lrm=count, if with_registers)
+void corpus_write_sass(const std::string &filename, const std::vector<std::vector<corpus_instruction>> &kernels, bool with_registers)
+{
+    std::ofstream file(filename);
+    file << "\t.headerflags\t@\"EF_CUDA_TEXMODE_UNIFIED EF_CUDA_64BIT_ADDRESS EF_CUDA_SM80 EF_CUDA_VIRTUAL_SM(EF_CUDA_SM80)\"\n";
+    file << "\t.elftype\t@\"ET_EXEC\"\n\n";
+
+    char buffer[512];
+    for (size_t k = 0; k < kernels.size(); k++)
+    {
+        std::string name = corpus_kernel_name(k);
+        std::string end_label = ".L_x_end" + std::to_string(k);
+        file << "//--------------------- .text." << name << " --------------------------\n";
+        file << "\t.section\t.text." << name << ",\"ax\",@progbits\n";
+        file << "\t.sectioninfo\t@\"SHI_REGISTERS=" << 32 << "\"\n";
+        file << "\t.align\t128\n";
+        file << "        .global         " << name << "\n";
+        file << "        .type           " << name << ",@function\n";
+        file << "        .size           " << name << ",(" << end_label << " - " << name << ")\n";
+        file << name << ":\n";
+        file << ".text." << name << ":\n";
+
+        int last_line = -1;
+        for (const auto &instruction : kernels[k])
+        {
+            if (!instruction.label.empty())
+            {
+                file << instruction.label << ":\n";
+            }
+            if (instruction.line_number != last_line)
+            {
+                file << "\t//## File \"/bench/kernel_" << k << ".cu\", line " << instruction.line_number << "\n";
+                last_line = instruction.line_number;
+            }
+            std::snprintf(buffer, sizeof(buffer), "        /*%04x*/                   %-60s", instruction.pc_offset, instruction.instruction.c_str());
+            file << buffer;
+            if (with_registers)
+            {
+                std::snprintf(buffer, sizeof(buffer), " // | %3d | %2d | %2d |", instruction.live_registers[0], instruction.live_registers[1], instruction.live_registers[2]);
+                file << buffer;
+            }
+            file << "\n";
+        }
+        int end_offset = 16 * kernels[k].size();
+        file << end_label << ":\n";
+        std::snprintf(buffer, sizeof(buffer), "        /*%04x*/                   BRA `(%s);\n", end_offset, end_label.c_str());
+        file << buffer << "\n";
+        file << "\t.section\t.nv.shared." << name << ",\"aw\",@nobits\n";
+        file << "\t.align\t4\n";
+        file << "\t.zero\t\t4096\n\n";
+    }
+}
+
+/// @brief Write PTX (cuobjdump -ptx) matching the kernels, with line information, loops and atomics
+void corpus_write_ptx(const std::string &filename, const std::vector<std::vector<corpus_instruction>> &kernels, std::mt19937 &rng)
+{
+    std::ofstream file(filename);
+    file << "//\n// Generated by NVIDIA NVVM Compiler\n//\n\n.version 7.8\n.target sm_80\n.address_size 64\n\n";
+    for (size_t k = 0; k < kernels.size(); k++)
+    {
+        file << ".visible .entry " << corpus_kernel_name(k) << "(\n";
+        file << "\t.param .u64 " << corpus_kernel_name(k) << "_param_0,\n\t.param .u64 " << corpus_kernel_name(k) << "_param_1,\n";
+        file << "\t.param .u32 " << corpus_kernel_name(k) << "_param_2\n)\n{\n";
+        file << "\t.reg .pred \t%p<4>;\n\t.reg .f32 \t%f<16>;\n\t.reg .b32 \t%r<16>;\n\t.reg .b64 \t%rd<16>;\n\n";
+
+        int block = 0;
+        for (size_t i = 0; i < kernels[k].size(); i++)
+        {
+            const auto &instruction = kernels[k][i];
+            if (i == 0 || instruction.line_number != kernels[k][i - 1].line_number)
+            {
+                file << "\t.loc\t1 " << instruction.line_number << " 5\n";
+            }
+            if (!instruction.label.empty())
+            {
+                file << "$L__BB" << k << "_" << block++ << ":\n";
+            }
+            const std::string &sass = instruction.instruction;
+            if (sass.find("LDG") != std::string::npos)
+            {
+                file << "\tld.global.f32 \t%f1, [%rd" << rng() % 16 << "];\n";
+            }
+            else if (sass.find("STG") != std::string::npos)
+            {
+                file << "\tst.global.f32 \t[%rd" << rng() % 16 << "], %f2;\n";
+            }
+            else if (sass.find("ATOMG") != std::string::npos || sass.find("RED.") != std::string::npos)
+            {
+                file << "\tatom.global.add.u32 \t%r1, [%rd" << rng() % 16 << "], 1;\n";
+            }
+            else if (sass.find("ATOMS") != std::string::npos)
+            {
+                file << "\tatom.shared.add.u32 \t%r2, [%r" << rng() % 16 << "], 1;\n";
+            }
+            else if (sass.find("BRA") != std::string::npos && block > 0)
+            {
+                file << "\t@%p1 bra $L__BB" << k << "_" << rng() % block << ";\n";
+            }
+            else
+            {
+                file << "\tfma.rn.f32 \t%f3, %f4, %f5, %f6;\n";
+            }
+        }
+        file << "\tret;\n\n}\n";
+    }
+    file << "\t.file\t1 \"/bench/kernel.cu\"\n";
+}
+
+/// @brief Sampled pcs of every kernel, with the stall reasons
+struct corpus_sample
+{
+    int kernel;
+    int pc_offset;
+    int line_number;
+    std::vector<std::pair<int, int>> stalls; // stall reason index, samples
+};
+
+std::vector<corpus_sample> corpus_generate_samples(const std::vector<std::vector<corpus_instruction>> &kernels, int samples, std::mt19937 &rng)
+{
+    std::vector<corpus_sample> records;
+    // Most samples fall on few kernels and pcs, like in real applications
+    std::geometric_distribution<int> hot_kernel(0.3);
+    std::uniform_int_distribution<int> stall_count(1, 4);
+    std::geometric_distribution<int> stall_reason(0.35);
+    std::geometric_distribution<int> stall_samples(0.2);
+    for (int i = 0; i < samples; i++)
+    {
+        corpus_sample sample;
+        sample.kernel = hot_kernel(rng) % kernels.size();
+        const auto &instruction = kernels[sample.kernel][rng() % kernels[sample.kernel].size()];
+        sample.pc_offset = instruction.pc_offset;
+        sample.line_number = instruction.line_number;
+        int count = stall_count(rng);
+        for (int j = 0; j < count; j++)
+        {
+            int reason = stall_reason(rng) % corpus_stall_reasons.size();
+            if (std::find_if(sample.stalls.begin(), sample.stalls.end(), [reason](const auto &stall) { return stall.first == reason; }) == sample.stalls.end())
+            {
+                sample.stalls.push_back({reason, 1 + stall_samples(rng)});
+            }
+        }
+        records.push_back(sample);
+    }
+    return records;
+}
+
+void corpus_write_sample(std::ostream &file, const corpus_sample &sample)
+{
+    file << "functionName: " << corpus_kernel_name(sample.kernel) << ", functionIndex: " << sample.kernel << ", pcOffset: " << sample.pc_offset
+         << ", lineNumber: " << sample.line_number << ", fileName: kernel_" << sample.kernel << ".cu, dirName: /bench, stallReasonCount: " << sample.stalls.size();
+    for (const auto &[reason, count] : sample.stalls)
+    {
+        file << ", " << corpus_stall_reasons[reason] << ": " << count;
+    }
+    file << "\n";
+}
+
+/// @brief Write the records like pc_sampling_utility, split into buffers of 5000 records
+void corpus_write_sampling(const std::string &filename, const std::vector<corpus_sample> &records, size_t first, size_t last)
+{
+    std::ofstream file(filename);
+    const size_t buffer_size = 5000;
+    for (size_t begin = first, buffer = 1; begin < last; begin += buffer_size, buffer++)
+    {
+        size_t end = std::min(begin + buffer_size, last);
+        file << "========================== PC Records Buffer Info ==========================\n";
+        file << "Buffer Number: " << buffer << ", Range Id: 0, Count of PC records: " << end - begin << ", Total Samples: " << end - begin << ", Total Dropped Samples: 0\n";
+        for (size_t i = begin; i < end; i++)
+        {
+            corpus_write_sample(file, records[i]);
+        }
+    }
+}
+
+/// @brief Write the records like pc_sampling_utility --launch-file, one launch bucket per launch
+void corpus_write_sampling_launches(const std::string &filename, const std::vector<corpus_sample> &records, int launches)
+{
+    std::ofstream file(filename);
+    size_t per_launch = std::max<size_t>(1, records.size() / std::max(1, launches));
+    for (int launch = 0; launch < launches; launch++)
+    {
+        file << "Launch Bucket: " << launch << ", First Launch Id: " << launch << ", Last Launch Id: " << launch << ", First Correlation Id: " << 10 + launch
+             << ", Last Correlation Id: " << 10 + launch << ", Buffers: 1, Context Id: 1\n";
+        for (size_t i = launch * per_launch; i < std::min(records.size(), (launch + 1) * per_launch); i++)
+        {
+            corpus_write_sample(file, records[i]);
+        }
+    }
+}
+
+const std::map<std::string, double> corpus_launch_metrics = {
+    {"launch__block_size", 256}, {"launch__grid_size", 1024}, {"launch__registers_per_thread", 32}, {"launch__shared_mem_per_block_static", 4096},
+    {"launch__shared_mem_per_block_dynamic", 0}, {"launch__shared_mem_config_size", 167936}, {"device__attribute_max_warps_per_multiprocessor", 64},
+    {"device__attribute_max_blocks_per_multiprocessor", 32}, {"device__attribute_max_registers_per_multiprocessor", 65536},
+    {"device__attribute_max_shared_memory_per_multiprocessor", 167936},
+};
+
+/// @brief Write the metrics like ncu --csv --print-units base, in the German number format GPUscout parses
+void corpus_write_metrics(const std::string &filename, int kernels, std::mt19937 &rng)
+{
+    std::ofstream file(filename);
+    std::uniform_real_distribution<double> value(0, 100);
+    file << "==PROF== Connected to process 4242 (/bench/app)\n";
+    file << "\"ID\",\"Process ID\",\"Process Name\",\"Host Name\",\"Kernel Name\",\"Context\",\"Stream\",\"Block Size\",\"Grid Size\",\"Device\",\"CC\",\"Section Name\",\"Metric Name\",\"Metric Unit\",\"Metric Value\"\n";
+    for (int k = 0; k < kernels; k++)
+    {
+        for (const auto &metric : corpus_metrics)
+        {
+            double v = value(rng);
+            if (metric.find(".sum") != std::string::npos || metric.find("memory_") == 0)
+            {
+                v *= 100000;
+            }
+            // The launch configuration and the device limits of an A100
+            if (corpus_launch_metrics.count(metric))
+            {
+                v = corpus_launch_metrics.at(metric);
+            }
+            std::string v_string = std::to_string(v);
+            std::replace(v_string.begin(), v_string.end(), '.', ',');
+            file << "\"" << k << "\",\"4242\",\"app\",\"bench\",\"" << corpus_kernel_name(k) << "\",\"1\",\"7\",\"(256, 1, 1)\",\"(1024, 1, 1)\",\"0\",\"8.0\",\"Command line profiler metrics\",\""
+                 << metric << "\",\"" << (metric.find(".pct") != std::string::npos ? "%" : "") << "\",\"" << v_string << "\"\n";
+        }
+    }
+}
+
+/// @brief Generate a complete corpus in the directory
+/// @param directory Output directory (has to exist)
+/// @param options Size of the corpus
+/// @return The generated files
+corpus_files generate_corpus(const std::string &directory, const corpus_options &options)
+{
+    std::mt19937 rng(options.seed);
+    corpus_files files;
+    files.directory = directory;
+    files.prefix = "bench";
+    files.sass = directory + "/nvdisasm-executable-bench-sass.txt";
+    files.sass_registers = directory + "/nvdisasm-registers-executable-bench-sass.txt";
+    files.ptx = directory + "/nvdisasm-executable-bench-ptx.txt";
+    files.sampling = directory + "/pcsampling_bench.txt";
+    files.sampling_launches = directory + "/pcsampling_bench_launches.txt";
+    files.sampling_devices = directory + "/pcsampling_bench_devices.txt";
+    files.metrics = directory + "/bench_metrics_list";
+    files.ranks = directory + "/ranks.txt";
+
+    std::vector<std::vector<corpus_instruction>> kernels;
+    for (int k = 0; k < options.kernels; k++)
+    {
+        kernels.push_back(corpus_generate_kernel(options.instructions, rng));
+    }
+    corpus_write_sass(files.sass, kernels, false);
+    corpus_write_sass(files.sass_registers, kernels, true);
+    corpus_write_ptx(files.ptx, kernels, rng);
+
+    std::vector<corpus_sample> records = corpus_generate_samples(kernels, options.samples, rng);
+    corpus_write_sampling(files.sampling, records, 0, records.size());
+    corpus_write_sampling_launches(files.sampling_launches, records, options.launches);
+
+    std::ofstream devices(files.sampling_devices);
+    size_t per_context = (records.size() + options.contexts - 1) / std::max(1, options.contexts);
+    for (int context = 0; context < options.contexts; context++)
+    {
+        std::string context_file = "pcsampling_bench_ctx" + std::to_string(context + 1) + ".txt";
+        corpus_write_sampling(directory + "/" + context_file, records, std::min(records.size(), context * per_context), std::min(records.size(), (context + 1) * per_context));
+        devices << "contextUid: " << context + 1 << "\ndeviceId: " << context << "\ndeviceName: Synthetic GPU, 80GB\ncomputeCapability: 80\nsamplingFile: " << context_file << "\nsassMatched: true\n\n";
+    }
+
+    corpus_write_metrics(files.metrics, options.kernels, rng);
+
+    std::ofstream ranks(files.ranks);
+    for (int rank = 0; rank < options.ranks; rank++)
+    {
+        ranks << "rank: " << rank << ", samplingFile: " << files.sampling << ", metricsFile: " << files.metrics << "\n";
+    }
+
+    return files;
+}
+
+/// @brief Parse the corpus size options (--kernels, --instructions, --samples, --launches, --contexts, --ranks, --seed)
+/// @return Index of the first argument which is not a corpus option
+int parse_corpus_options(int argc, char **argv, int first, corpus_options &options)
+{
+    int i = first;
+    for (; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--kernels") == 0)
+            options.kernels = std::stoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--instructions") == 0)
+            options.instructions = std::stoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--samples") == 0)
+            options.samples = std::stoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--launches") == 0)
+            options.launches = std::stoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--contexts") == 0)
+            options.contexts = std::stoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--ranks") == 0)
+            options.ranks = std::stoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--seed") == 0)
+            options.seed = std::stoul(argv[i + 1]);
+        else
+            break;
+    }
+    return i;
+}
+
+#endif // CORPUS_GENERATOR_HPP
@@ -0,0 +1,44 @@
+/**
+ * Writes a synthetic input corpus for the GPUscout analyses into a directory, e.g. to run single analyses on it by hand
+ *
+ * @author Soumya Sen
+ */
+
+#include "corpus_generator.hpp"
+#include <filesystem>
+
+void print_usage(const char *name)
+{
+    std::cout << "Usage: " << name << " directory [--kernels N] [--instructions N] [--samples N] [--launches N] [--contexts N] [--ranks N] [--seed N]" << std::endl;
+    std::cout << "  --kernels : Number of kernels (default: 8)" << std::endl;
+    std::cout << "  --instructions : SASS instructions per kernel (default: 2000)" << std::endl;
+    std::cout << "  --samples : PC sampling records over all kernels (default: 100000)" << std::endl;
+    std::cout << "  --launches : Launch buckets in the per-launch sampling file (default: 16)" << std::endl;
+    std::cout << "  --contexts : CUDA contexts the samples are spread over (default: 2)" << std::endl;
+    std::cout << "  --ranks : Ranks listed for the rank merge (default: 4)" << std::endl;
+    std::cout << "  --seed : Seed of the random generator (default: 1)" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argv[1][0] == '-')
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    corpus_options options;
+    if (parse_corpus_options(argc, argv, 2, options) != argc)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::string directory = argv[1];
+    std::filesystem::create_directories(directory);
+    corpus_files files = generate_corpus(directory, options);
+
+    std::cout << "Generated corpus in " << directory << " (" << options.kernels << " kernels, " << options.instructions << " instructions per kernel, "
+              << options.samples << " PC sampling records)" << std::endl;
+    return 0;
+}
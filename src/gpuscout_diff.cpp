@@ -0,0 +1,436 @@
+/**
+ * Compares two GPUscout result files (result-*.json), e.g. before and after applying a recommendation
+ * Kernels are matched by their mangled name, findings by their source line and pc offset
+ * Reports the changes of the stall samples per reason, of the memory flow metrics and of the findings, ranked by improvement or regression
+ *
+ * @author Soumya Sen
+ */
+
+#include "utilities/json.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using json = nlohmann::json;
+
+/// @brief Change of one value of a kernel between the two result files
+struct diff_change
+{
+    std::string kernel;
+    std::string category; // stalls, metrics or findings
+    std::string name;
+    double old_value;
+    double new_value;
+    double score; // > 0 improvement, < 0 regression, relative to the old value
+    std::vector<int> introduced_lines;
+    std::vector<int> resolved_lines;
+};
+
+/// @brief Load a result file without the binaries and source files, which are not compared and make up most of the file
+json load_result(const std::string &filename)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        std::cout << "Could not open the file: " << filename << std::endl;
+        return json();
+    }
+
+    json::parser_callback_t skip_files = [](int depth, json::parse_event_t event, json &parsed)
+    {
+        return !(depth == 1 && event == json::parse_event_t::key &&
+                 (parsed == "binary_files" || parsed == "source_files" || parsed == "gpuscout_runtime"));
+    };
+    json result = json::parse(file, skip_files, false);
+    if (result.is_discarded())
+    {
+        std::cout << "Not a GPUscout result file: " << filename << std::endl;
+        return json();
+    }
+    return result;
+}
+
+/// @brief All kernels (mangled names) found in the result
+std::map<std::string, bool> get_kernels(const json &result)
+{
+    std::map<std::string, bool> kernels;
+    for (const char *section : {"kernels", "stalls", "metrics"})
+    {
+        if (result.contains(section))
+        {
+            for (const auto &[kernel, v] : result[section].items())
+            {
+                kernels[kernel] = true;
+            }
+        }
+    }
+    if (result.contains("analyses"))
+    {
+        for (const auto &[analysis, kernel_results] : result["analyses"].items())
+        {
+            for (const auto &[kernel, v] : kernel_results.items())
+            {
+                kernels[kernel] = true;
+            }
+        }
+    }
+    kernels.erase("");
+    return kernels;
+}
+
+/// @brief Stall samples per reason of a kernel, summed over all pc offsets
+std::map<std::string, double> get_stall_samples(const json &result, const std::string &kernel)
+{
+    std::map<std::string, double> stall_samples;
+    if (!result.contains("stalls") || !result["stalls"].contains(kernel))
+    {
+        return stall_samples;
+    }
+    for (const auto &sample : result["stalls"][kernel])
+    {
+        if (!sample.contains("stalls"))
+        {
+            continue;
+        }
+        // Stalls of a pc offset are stored as [stall name, samples] pairs
+        for (const auto &stall : sample["stalls"])
+        {
+            if (stall.is_array() && stall.size() == 2 && stall[0].is_string() && stall[1].is_number())
+            {
+                stall_samples[stall[0].get<std::string>()] += stall[1].get<double>();
+            }
+        }
+    }
+    return stall_samples;
+}
+
+/// @brief Numeric memory flow metrics of a kernel as group.metric (the raw Nsight Compute metrics in misc are left out)
+std::map<std::string, double> get_memory_metrics(const json &result, const std::string &kernel)
+{
+    std::map<std::string, double> metrics;
+    if (!result.contains("metrics") || !result["metrics"].contains(kernel))
+    {
+        return metrics;
+    }
+    for (const auto &[group, values] : result["metrics"][kernel].items())
+    {
+        if (group == "misc" || !values.is_object())
+        {
+            continue;
+        }
+        for (const auto &[metric, value] : values.items())
+        {
+            if (value.is_number())
+            {
+                metrics[group + "." + metric] = value.get<double>();
+            }
+        }
+    }
+    return metrics;
+}
+
+/// @brief Findings (occurrences) of an analysis for a kernel, as source line and pc offset
+std::vector<std::pair<int, std::string>> get_findings(const json &result, const std::string &analysis, const std::string &kernel)
+{
+    std::vector<std::pair<int, std::string>> findings;
+    if (!result.contains("analyses") || !result["analyses"].contains(analysis) || !result["analyses"][analysis].contains(kernel))
+    {
+        return findings;
+    }
+    const json &kernel_result = result["analyses"][analysis][kernel];
+    if (!kernel_result.is_object() || !kernel_result.contains("occurrences"))
+    {
+        return findings;
+    }
+    for (const auto &occurrence : kernel_result["occurrences"])
+    {
+        int line_number = occurrence.contains("line_number") && occurrence["line_number"].is_number() ? occurrence["line_number"].get<int>() : 0;
+        std::string pc_offset = occurrence.contains("pc_offset") && occurrence["pc_offset"].is_string() ? occurrence["pc_offset"].get<std::string>() : "";
+        findings.push_back({line_number, pc_offset});
+    }
+    return findings;
+}
+
+/// @brief Match the findings of both files by source line and pc offset, then the remaining ones by source line only
+/// (the code around a fix usually moves, then the pc offset of an unchanged finding changes)
+/// @return Source lines of the introduced and of the resolved findings
+std::pair<std::vector<int>, std::vector<int>> match_findings(const std::vector<std::pair<int, std::string>> &old_findings,
+                                                             const std::vector<std::pair<int, std::string>> &new_findings)
+{
+    std::unordered_map<std::string, int> open_findings;
+    for (const auto &[line_number, pc_offset] : old_findings)
+    {
+        open_findings[std::to_string(line_number) + ":" + pc_offset]++;
+    }
+
+    std::vector<std::pair<int, std::string>> unmatched;
+    for (const auto &finding : new_findings)
+    {
+        auto it = open_findings.find(std::to_string(finding.first) + ":" + finding.second);
+        if (it != open_findings.end() && it->second > 0)
+        {
+            it->second--;
+        }
+        else
+        {
+            unmatched.push_back(finding);
+        }
+    }
+
+    std::unordered_map<int, int> open_lines;
+    for (const auto &[key, count] : open_findings)
+    {
+        open_lines[std::stoi(key.substr(0, key.find(':')))] += count;
+    }
+    std::vector<int> introduced, resolved;
+    for (const auto &[line_number, pc_offset] : unmatched)
+    {
+        auto it = open_lines.find(line_number);
+        if (it != open_lines.end() && it->second > 0)
+        {
+            it->second--;
+        }
+        else
+        {
+            introduced.push_back(line_number);
+        }
+    }
+    for (const auto &[line_number, count] : open_lines)
+    {
+        resolved.insert(resolved.end(), count, line_number);
+    }
+    std::sort(introduced.begin(), introduced.end());
+    std::sort(resolved.begin(), resolved.end());
+    return {introduced, resolved};
+}
+
+/// @brief Relative change, positive if the value improved
+/// @param higher_is_better Direction of the value, e.g. true for cache hit rates
+double get_score(double old_value, double new_value, double reference, bool higher_is_better)
+{
+    double scale = std::max(std::abs(reference), 1.0);
+    return (higher_is_better ? new_value - old_value : old_value - new_value) / scale;
+}
+
+/// @brief Compare the two results kernel by kernel
+std::vector<diff_change> diff_results(const json &old_result, const json &new_result)
+{
+    std::vector<diff_change> changes;
+    std::map<std::string, bool> old_kernels = get_kernels(old_result), new_kernels = get_kernels(new_result);
+
+    for (const auto &[kernel, v] : old_kernels)
+    {
+        if (!new_kernels.count(kernel))
+        {
+            std::cout << "INFO  ::  Kernel only in the old result: " << kernel << std::endl;
+        }
+    }
+    for (const auto &[kernel, v] : new_kernels)
+    {
+        if (!old_kernels.count(kernel))
+        {
+            std::cout << "INFO  ::  Kernel only in the new result: " << kernel << std::endl;
+        }
+    }
+
+    std::map<std::string, bool> analyses;
+    for (const json *result : {&old_result, &new_result})
+    {
+        if (result->contains("analyses"))
+        {
+            for (const auto &[analysis, v] : (*result)["analyses"].items())
+            {
+                analyses[analysis] = true;
+            }
+        }
+    }
+
+    for (const auto &[kernel, v] : old_kernels)
+    {
+        if (!new_kernels.count(kernel))
+        {
+            continue;
+        }
+
+        // Stall samples per reason, relative to all samples of the kernel in the old result (the sampling period is the same in both runs)
+        std::map<std::string, double> old_stalls = get_stall_samples(old_result, kernel), new_stalls = get_stall_samples(new_result, kernel);
+        double old_total = 0, new_total = 0;
+        std::map<std::string, bool> stall_names;
+        for (const auto &[stall, count] : old_stalls)
+        {
+            old_total += count;
+            stall_names[stall] = true;
+        }
+        for (const auto &[stall, count] : new_stalls)
+        {
+            new_total += count;
+            stall_names[stall] = true;
+        }
+        if (old_total > 0 || new_total > 0)
+        {
+            changes.push_back({kernel, "stalls", "total_samples", old_total, new_total, get_score(old_total, new_total, old_total, false), {}, {}});
+        }
+        for (const auto &[stall, s] : stall_names)
+        {
+            double old_count = old_stalls.count(stall) ? old_stalls[stall] : 0, new_count = new_stalls.count(stall) ? new_stalls[stall] : 0;
+            changes.push_back({kernel, "stalls", stall, old_count, new_count, get_score(old_count, new_count, old_total, false), {}, {}});
+        }
+
+        // Memory flow metrics, hit rates are better when higher, bytes and instructions when lower
+        std::map<std::string, double> old_metrics = get_memory_metrics(old_result, kernel), new_metrics = get_memory_metrics(new_result, kernel);
+        for (const auto &[metric, old_value] : old_metrics)
+        {
+            auto it = new_metrics.find(metric);
+            if (it == new_metrics.end())
+            {
+                continue;
+            }
+            bool higher_is_better = metric.find("hit_perc") != std::string::npos;
+            changes.push_back({kernel, "metrics", metric, old_value, it->second, get_score(old_value, it->second, old_value, higher_is_better), {}, {}});
+        }
+
+        // Findings of every analysis
+        for (const auto &[analysis, a] : analyses)
+        {
+            auto old_findings = get_findings(old_result, analysis, kernel), new_findings = get_findings(new_result, analysis, kernel);
+            if (old_findings.empty() && new_findings.empty())
+            {
+                continue;
+            }
+            auto [introduced, resolved] = match_findings(old_findings, new_findings);
+            if (introduced.empty() && resolved.empty())
+            {
+                continue;
+            }
+            // Every finding counts as much as the whole old set, a resolved single finding is a full improvement
+            double score = (1.0 * resolved.size() - 1.0 * introduced.size()) / std::max<size_t>(old_findings.size(), 1);
+            changes.push_back({kernel, "findings", analysis, (double)old_findings.size(), (double)new_findings.size(), score, introduced, resolved});
+        }
+    }
+
+    return changes;
+}
+
+std::string join_lines(const std::vector<int> &lines)
+{
+    std::string joined;
+    for (int line : lines)
+    {
+        joined += (joined.empty() ? "" : ", ") + std::to_string(line);
+    }
+    return joined;
+}
+
+void print_change(const diff_change &change)
+{
+    std::cout << (change.score > 0 ? "INFO  ::  improved  " : "WARNING   ::  regressed ") << std::showpos << std::fixed << std::setprecision(1)
+              << 100.0 * change.score << std::noshowpos << " %  " << change.kernel << "  " << change.category << "  " << change.name << ": "
+              << std::setprecision(2) << change.old_value << " -> " << change.new_value;
+    if (!change.resolved_lines.empty())
+    {
+        std::cout << " (resolved at lines " << join_lines(change.resolved_lines) << ")";
+    }
+    if (!change.introduced_lines.empty())
+    {
+        std::cout << " (new at lines " << join_lines(change.introduced_lines) << ")";
+    }
+    std::cout << std::endl;
+}
+
+void print_usage(const char *name)
+{
+    std::cout << "Usage: " << name << " old.json new.json [--threshold percent] [--top N] [--json file] [--fail_on_regression]" << std::endl;
+    std::cout << "  --threshold : Only report changes of at least the given percent (default: 5)" << std::endl;
+    std::cout << "  --top : Number of improvements and of regressions to print (default: 20, 0: all)" << std::endl;
+    std::cout << "  --json : Save all changes as JSON" << std::endl;
+    std::cout << "  --fail_on_regression : Exit with 2 if any regression is reported, e.g. to run the comparison on every commit" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+    std::string filename_old = argv[1], filename_new = argv[2], json_file;
+    double threshold = 0.05;
+    size_t top = 20;
+    bool fail_on_regression = false;
+    for (int i = 3; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--fail_on_regression") == 0)
+            fail_on_regression = true;
+        else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+            threshold = std::stod(argv[++i]) / 100;
+        else if (std::strcmp(argv[i], "--top") == 0 && i + 1 < argc)
+            top = std::stoul(argv[++i]);
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            json_file = argv[++i];
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    json old_result = load_result(filename_old), new_result = load_result(filename_new);
+    if (old_result.is_null() || new_result.is_null())
+    {
+        return 1;
+    }
+
+    std::cout << "--------------------- Comparing " << filename_old << " -> " << filename_new << "   --------------------- " << std::endl;
+    std::vector<diff_change> changes = diff_results(old_result, new_result);
+
+    std::vector<diff_change> improvements, regressions;
+    for (const auto &change : changes)
+    {
+        if (change.score >= threshold)
+            improvements.push_back(change);
+        else if (change.score <= -threshold)
+            regressions.push_back(change);
+    }
+    std::sort(improvements.begin(), improvements.end(), [](const diff_change &a, const diff_change &b) { return a.score > b.score; });
+    std::sort(regressions.begin(), regressions.end(), [](const diff_change &a, const diff_change &b) { return a.score < b.score; });
+
+    std::cout << "--------------------- Improvements (" << improvements.size() << ")   --------------------- " << std::endl;
+    for (size_t i = 0; i < improvements.size() && (top == 0 || i < top); i++)
+    {
+        print_change(improvements[i]);
+    }
+    std::cout << "--------------------- Regressions (" << regressions.size() << ")   --------------------- " << std::endl;
+    for (size_t i = 0; i < regressions.size() && (top == 0 || i < top); i++)
+    {
+        print_change(regressions[i]);
+    }
+
+    if (!json_file.empty())
+    {
+        json result = json::array();
+        for (const auto &change : changes)
+        {
+            result.push_back({
+                {"kernel", change.kernel},
+                {"category", change.category},
+                {"name", change.name},
+                {"old", change.old_value},
+                {"new", change.new_value},
+                {"score", change.score},
+                {"introduced_lines", change.introduced_lines},
+                {"resolved_lines", change.resolved_lines}
+            });
+        }
+        std::ofstream file(json_file);
+        file << result.dump(4);
+    }
+
+    return (fail_on_regression && !regressions.empty()) ? 2 : 0;
+}
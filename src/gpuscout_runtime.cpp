@@ -0,0 +1,79 @@
+/**
+ * Records the runtime of the stages of a GPUscout run (see gpuscout_runtime.hpp)
+ * run - runs a command (nvdisasm, the PC sampling, ncu, an analysis, ...) as a named stage, its children are included
+ * summary - prints the table of the recorded stages
+ *
+ * @author Soumya Sen
+ */
+
+#include "gpuscout_runtime.hpp"
+#include <cerrno>
+#include <unistd.h>
+#include <sys/wait.h>
+
+void print_usage(const char *name)
+{
+    std::cout << "Usage: " << name << " run stage command [arguments ...]" << std::endl;
+    std::cout << "       " << name << " summary runtime_file" << std::endl;
+    std::cout << "The records are appended to the file in GPUSCOUT_RUNTIME_FILE, without it the command is only run" << std::endl;
+}
+
+/// @brief Run the command as child process and record the stage
+/// @return Exit code of the command
+int run_stage(const std::string &stage, char **command)
+{
+    runtime_counters start = get_runtime_counters(RUSAGE_CHILDREN);
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        setenv("GPUSCOUT_RUNTIME_STAGE", stage.c_str(), 1);
+        execvp(command[0], command);
+        std::cerr << "Could not run: " << command[0] << std::endl;
+        _exit(127);
+    }
+    if (pid < 0)
+    {
+        std::cerr << "Could not start: " << command[0] << std::endl;
+        return 127;
+    }
+
+    // The rusage of wait4 and the I/O counters of this process include the command and all children it waited for
+    int status = 0;
+    struct rusage usage = {};
+    while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR)
+    {
+    }
+    runtime_counters end = get_runtime_counters(RUSAGE_CHILDREN);
+    end.cpu_seconds = start.cpu_seconds + get_cpu_seconds(usage);
+    record_stage(stage, start, end, usage.ru_maxrss / 1024.0);
+
+    if (WIFSIGNALED(status))
+    {
+        return 128 + WTERMSIG(status);
+    }
+    return WEXITSTATUS(status);
+}
+
+int main(int argc, char **argv)
+{
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "run" && argc > 3)
+    {
+        return run_stage(argv[2], argv + 3);
+    }
+    if (mode == "summary" && argc > 2)
+    {
+        json records = get_runtime_records(argv[2]);
+        if (records.empty())
+        {
+            std::cout << "No runtime records in: " << argv[2] << std::endl;
+            return 1;
+        }
+        print_runtime_summary(records);
+        return 0;
+    }
+
+    print_usage(argv[0]);
+    return 1;
+}
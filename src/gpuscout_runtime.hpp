@@ -0,0 +1,179 @@
+/**
+ * Self-profiling of GPUscout: wall time, CPU time, peak resident memory and bytes read/written of every stage
+ * If GPUSCOUT_RUNTIME_FILE is set, every stage appends one JSON line to it, the file is summarized by gpuscout_runtime
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef GPUSCOUT_RUNTIME_HPP
+#define GPUSCOUT_RUNTIME_HPP
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <sys/resource.h>
+#include "utilities/json.hpp"
+
+using json = nlohmann::json;
+
+/// @brief Resource usage of a process (or of its waited-for children) at one point in time
+struct runtime_counters
+{
+    std::chrono::steady_clock::time_point time;
+    double cpu_seconds;
+    double peak_rss_mb;
+    long long read_bytes;  // rchar of /proc/<pid>/io, includes reads served from the page cache
+    long long write_bytes; // wchar of /proc/<pid>/io
+};
+
+/// @brief Get the bytes read and written by this process and by its waited-for children from /proc/self/io
+inline std::pair<long long, long long> get_io_bytes()
+{
+    long long read_bytes = 0, write_bytes = 0;
+    std::ifstream io_file("/proc/self/io");
+    std::string key;
+    long long value;
+    while (io_file >> key >> value)
+    {
+        if (key == "rchar:")
+            read_bytes = value;
+        else if (key == "wchar:")
+            write_bytes = value;
+    }
+    return {read_bytes, write_bytes};
+}
+
+inline double get_cpu_seconds(const struct rusage &usage)
+{
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+/// @brief Current counters of this process
+/// @param who RUSAGE_SELF for this process, RUSAGE_CHILDREN for its waited-for children
+inline runtime_counters get_runtime_counters(int who = RUSAGE_SELF)
+{
+    struct rusage usage = {};
+    getrusage(who, &usage);
+    auto [read_bytes, write_bytes] = get_io_bytes();
+    // ru_maxrss is in KB on Linux
+    return {std::chrono::steady_clock::now(), get_cpu_seconds(usage), usage.ru_maxrss / 1024.0, read_bytes, write_bytes};
+}
+
+/// @brief Append the record of a stage to GPUSCOUT_RUNTIME_FILE, nothing is done if it is not set
+/// @param stage Name of the stage
+/// @param start Counters at the start of the stage
+/// @param end Counters at the end of the stage
+/// @param peak_rss_mb Peak resident memory during the stage
+inline void record_stage(const std::string &stage, const runtime_counters &start, const runtime_counters &end, double peak_rss_mb)
+{
+    const char *runtime_file = std::getenv("GPUSCOUT_RUNTIME_FILE");
+    if (runtime_file == nullptr || runtime_file[0] == '\0')
+    {
+        return;
+    }
+
+    // Stages inside a process started by "gpuscout_runtime run" are listed under the stage of the process
+    const char *parent = std::getenv("GPUSCOUT_RUNTIME_STAGE");
+    json record = {
+        {"stage", stage},
+        {"parent", parent != nullptr ? parent : ""},
+        {"wall_seconds", std::chrono::duration<double>(end.time - start.time).count()},
+        {"cpu_seconds", end.cpu_seconds - start.cpu_seconds},
+        {"peak_rss_mb", peak_rss_mb},
+        {"read_bytes", end.read_bytes - start.read_bytes},
+        {"write_bytes", end.write_bytes - start.write_bytes}
+    };
+
+    // One line per record, appended at once so that the records of concurrent processes do not interleave
+    std::ofstream file(runtime_file, std::ios::app);
+    file << record.dump() + "\n" << std::flush;
+}
+
+/// @brief Run a function of an analysis as a named stage and record its runtime
+/// @param stage Name of the stage, e.g. the name of the function
+/// @param function Function to run
+/// @return Result of the function
+/// The peak resident memory is the one of the process up to the end of the stage, memory is rarely returned to the system before the process ends
+template <typename Function>
+auto profile_stage(const std::string &stage, Function &&function)
+{
+    runtime_counters start = get_runtime_counters();
+    if constexpr (std::is_void_v<std::invoke_result_t<Function>>)
+    {
+        function();
+        runtime_counters end = get_runtime_counters();
+        record_stage(stage, start, end, end.peak_rss_mb);
+    }
+    else
+    {
+        auto result = function();
+        runtime_counters end = get_runtime_counters();
+        record_stage(stage, start, end, end.peak_rss_mb);
+        return result;
+    }
+}
+
+/// @brief Read the stage records of a runtime file
+inline json get_runtime_records(const std::string &filename_runtime)
+{
+    json records = json::array();
+    std::ifstream file(filename_runtime);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+        json record = json::parse(line, nullptr, false);
+        if (!record.is_discarded())
+        {
+            records.push_back(record);
+        }
+    }
+    return records;
+}
+
+/// @brief Print the records as table, stages of a process are listed below the process
+inline void print_runtime_summary(const json &records)
+{
+    std::cout << std::left << std::setw(56) << "Stage" << std::right << std::setw(10) << "Wall s" << std::setw(10) << "CPU s" << std::setw(12) << "Peak MB"
+              << std::setw(12) << "Read MB" << std::setw(12) << "Written MB" << std::endl;
+
+    auto print_record = [](const json &record, const std::string &indent)
+    {
+        std::cout << std::left << std::setw(56) << indent + record["stage"].get<std::string>() << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(10) << record["wall_seconds"].get<double>() << std::setw(10) << record["cpu_seconds"].get<double>() << std::setprecision(1)
+                  << std::setw(12) << record["peak_rss_mb"].get<double>() << std::setw(12) << record["read_bytes"].get<double>() / (1024 * 1024)
+                  << std::setw(12) << record["write_bytes"].get<double>() / (1024 * 1024) << std::endl;
+    };
+
+    double wall_seconds = 0, cpu_seconds = 0;
+    for (const auto &record : records)
+    {
+        if (record["parent"] != "")
+        {
+            continue;
+        }
+        print_record(record, "");
+        for (const auto &child : records)
+        {
+            if (child["parent"] == record["stage"])
+            {
+                print_record(child, "  ");
+            }
+        }
+        wall_seconds += record["wall_seconds"].get<double>();
+        cpu_seconds += record["cpu_seconds"].get<double>();
+    }
+    std::cout << std::left << std::setw(56) << "Total" << std::right << std::setprecision(3) << std::setw(10) << wall_seconds << std::setw(10) << cpu_seconds
+              << std::endl;
+}
+
+#endif
@@ -8,7 +8,7 @@ if [ "$dry_run" = false ]; then
     echo "Collecting NCU metrics . . . . . . . . . . . . . . . "
 
     # Extract all the metrics in one pass
-    ncu -f --csv --log-file ${run_prefix}_metrics_list --print-units base --print-kernel-base mangled --metrics \
+    run_stage ncu ncu -f --csv --log-file ${run_prefix}_metrics_list --print-units base --print-kernel-base mangled "${ncu_filter_options[@]}" --metrics \
 smsp__warps_active.sum,\
 smsp__sass_inst_executed_op_global.sum,\
 smsp__sass_inst_executed.sum,\
@@ -72,7 +72,39 @@ lts__t_sector_op_write_hit_rate.pct,\
 lts__t_sector_hit_rate.pct,\
 sm__sass_inst_executed_op_global_st.sum,\
 sm__sass_inst_executed_op_local_st.sum,\
-smsp__inst_executed_op_ldgsts.sum \
+smsp__inst_executed_op_ldgsts.sum,\
+smsp__sass_thread_inst_executed_op_fadd_pred_on.sum,\
+smsp__sass_thread_inst_executed_op_fmul_pred_on.sum,\
+smsp__sass_thread_inst_executed_op_ffma_pred_on.sum,\
+smsp__sass_thread_inst_executed_op_dadd_pred_on.sum,\
+smsp__sass_thread_inst_executed_op_dmul_pred_on.sum,\
+smsp__sass_thread_inst_executed_op_dfma_pred_on.sum,\
+smsp__sass_thread_inst_executed_op_hadd_pred_on.sum,\
+smsp__sass_thread_inst_executed_op_hmul_pred_on.sum,\
+smsp__sass_thread_inst_executed_op_hfma_pred_on.sum,\
+sm__inst_executed_pipe_tensor.sum,\
+sm__sass_thread_inst_executed_op_ffma_pred_on.sum.peak_sustained,\
+sm__sass_thread_inst_executed_op_dfma_pred_on.sum.peak_sustained,\
+sm__sass_thread_inst_executed_op_hfma_pred_on.sum.peak_sustained,\
+dram__bytes_read.sum,\
+dram__bytes_write.sum,\
+dram__bytes.sum.peak_sustained,\
+dram__cycles_elapsed.avg.per_second,\
+sm__cycles_elapsed.avg,\
+sm__cycles_elapsed.avg.per_second,\
+gpu__time_duration.sum,\
+sm__throughput.avg.pct_of_peak_sustained_elapsed,\
+gpu__compute_memory_throughput.avg.pct_of_peak_sustained_elapsed,\
+launch__block_size,\
+launch__grid_size,\
+launch__registers_per_thread,\
+launch__shared_mem_per_block_static,\
+launch__shared_mem_per_block_dynamic,\
+launch__shared_mem_config_size,\
+device__attribute_max_warps_per_multiprocessor,\
+device__attribute_max_blocks_per_multiprocessor,\
+device__attribute_max_registers_per_multiprocessor,\
+device__attribute_max_shared_memory_per_multiprocessor \
 \
 ${executable} ${args}
 
@@ -86,47 +118,121 @@ echo "==========================================================================
 echo "Combining above results for register spilling analysis . . . . . . . . . . . . . . . "
 #g++ -std=c++17 ../merge_analysis_register_spilling.cpp -o merge_analysis_register_spilling
 # nvcc --generate-line-info merge_analysis_register_spilling.cpp -o merge_analysis_register_spilling -lcuda -l:libcufilt.a
-./merge_analysis_register_spilling ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${executable_filename}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${gpuscout_tmp_dir}/nvdisasm-registers-executable-${executable_filename}-sass.txt ${json} ${gpuscout_output_dir} ${sms}
+run_stage merge_analysis_register_spilling ./merge_analysis_register_spilling ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${gpuscout_tmp_dir}/nvdisasm-registers-executable-${run_prefix}-sass.txt ${json} ${gpuscout_output_dir} ${sms}
+
+echo "======================================================================================================"
+echo "Combining above results for device function call analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_device_calls ./merge_analysis_device_calls ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
 
 echo "======================================================================================================"
 echo "Combining above results for using __restrict__ analysis . . . . . . . . . . . . . . . "
 #g++ -std=c++17 ../merge_analysis_use_restrict.cpp -o merge_analysis_use_restrict
-./merge_analysis_use_restrict ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${executable_filename}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${gpuscout_tmp_dir}/nvdisasm-registers-hpctoolkit-${executable_filename}-sass.txt ${json} ${gpuscout_output_dir}
+run_stage merge_analysis_use_restrict ./merge_analysis_use_restrict ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${gpuscout_tmp_dir}/nvdisasm-registers-hpctoolkit-${run_prefix}-sass.txt ${json} ${gpuscout_output_dir}
+
+echo "======================================================================================================"
+echo "Combining above results for redundant global load analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_redundant_loads ./merge_analysis_redundant_loads ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+
+echo "======================================================================================================"
+echo "Combining above results for generic memory access analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_generic_memory ./merge_analysis_generic_memory ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
 
 echo "======================================================================================================"
 echo "Combining above results for vectorization analysis . . . . . . . . . . . . . . . "
 #g++ -std=c++17 ../merge_analysis_vectorization.cpp -o merge_analysis_vectorization
-./merge_analysis_vectorization ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${executable_filename}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${gpuscout_tmp_dir}/nvdisasm-registers-hpctoolkit-${executable_filename}-sass.txt ${json} ${gpuscout_output_dir}
+run_stage merge_analysis_vectorization ./merge_analysis_vectorization ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${gpuscout_tmp_dir}/nvdisasm-registers-hpctoolkit-${run_prefix}-sass.txt ${json} ${gpuscout_output_dir}
 
 echo "======================================================================================================"
 echo "Combining above results for global atomics analysis . . . . . . . . . . . . . . . "
 #g++ -std=c++17 ../merge_analysis_global_atomics.cpp -o merge_analysis_global_atomics
-./merge_analysis_global_atomics ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${executable_filename}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+run_stage merge_analysis_global_atomics ./merge_analysis_global_atomics ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+
+echo "======================================================================================================"
+echo "Combining above results for warp reduction analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_warp_reductions ./merge_analysis_warp_reductions ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
 
 echo "======================================================================================================"
 echo "Combining above results for warp divergence analysis . . . . . . . . . . . . . . . "
 #g++ -std=c++17 ../merge_analysis_warp_divergence.cpp -o merge_analysis_warp_divergence
-./merge_analysis_warp_divergence ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${executable_filename}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+run_stage merge_analysis_warp_divergence ./merge_analysis_warp_divergence ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+
+echo "======================================================================================================"
+echo "Combining above results for branch predication analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_predication ./merge_analysis_predication ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
 
 echo "======================================================================================================"
 echo "Combining above results for using texture memory analysis . . . . . . . . . . . . . . . "
 #g++ -std=c++17 ../merge_analysis_use_texture.cpp -o merge_analysis_use_texture
-./merge_analysis_use_texture ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${executable_filename}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+run_stage merge_analysis_use_texture ./merge_analysis_use_texture ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
 
 echo "======================================================================================================"
 echo "Combining above results for using shared memory analysis . . . . . . . . . . . . . . . "
 #g++ -std=c++17 ../merge_analysis_use_shared.cpp -o merge_analysis_use_shared
-./merge_analysis_use_shared ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${executable_filename}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+run_stage merge_analysis_use_shared ./merge_analysis_use_shared ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+
+echo "======================================================================================================"
+echo "Combining above results for asynchronous copy pipeline analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_async_copy ./merge_analysis_async_copy ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+
+echo "======================================================================================================"
+echo "Combining above results for barrier analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_barriers ./merge_analysis_barriers ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+
+echo "======================================================================================================"
+echo "Combining above results for shared memory bank conflict analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_bank_conflicts ./merge_analysis_bank_conflicts ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+
+echo "======================================================================================================"
+echo "Combining above results for global memory coalescing analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_coalescing ./merge_analysis_coalescing ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+
+echo "======================================================================================================"
+echo "Combining above results for uniform load (constant memory) analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_uniform_loads ./merge_analysis_uniform_loads ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
 
 echo "======================================================================================================"
 echo "Combining above results for datatype conversion analysis . . . . . . . . . . . . . . . "
 #g++ -std=c++17 ../merge_analysis_datatype_conversion.cpp -o merge_analysis_datatype_conversion
-./merge_analysis_datatype_conversion ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${executable_filename}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+run_stage merge_analysis_datatype_conversion ./merge_analysis_datatype_conversion ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+
+echo "======================================================================================================"
+echo "Combining above results for double precision analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_fp64 ./merge_analysis_fp64 ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
 
 echo "======================================================================================================"
 echo "Combining above results for deadlock detection . . . . . . . . . . . . . . . "
 #g++ -std=c++17 ../merge_analysis_deadlock_detection.cpp -o merge_analysis_deadlock_detection
-./merge_analysis_deadlock_detection ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${executable_filename}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+run_stage merge_analysis_deadlock_detection ./merge_analysis_deadlock_detection ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+
+if [ -n "$launch_buckets" ] && [ "$dry_run" = false ]; then
+echo "======================================================================================================"
+echo "Combining above results for launch variability analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_launch_variability ./merge_analysis_launch_variability ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir} ${gpuscout_tmp_dir}/pcsampling_${run_prefix}_launches.txt
+fi
+
+if [ "$dry_run" = false ]; then
+echo "======================================================================================================"
+echo "Combining above results for roofline analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_roofline ./merge_analysis_roofline ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+fi
+
+echo "======================================================================================================"
+echo "Combining above results for occupancy analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_occupancy ./merge_analysis_occupancy ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${gpuscout_tmp_dir}/nvdisasm-registers-executable-${run_prefix}-sass.txt ${json} ${gpuscout_output_dir} ${sms}
+
+echo "======================================================================================================"
+echo "Combining above results for tensor core opportunity analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_tensor_cores ./merge_analysis_tensor_cores ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+
+echo "======================================================================================================"
+echo "Combining above results for integer arithmetic analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_integer_arithmetic ./merge_analysis_integer_arithmetic ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir}
+
+if [ "$dry_run" = false ]; then
+echo "======================================================================================================"
+echo "Combining above results for device balance analysis . . . . . . . . . . . . . . . "
+run_stage merge_analysis_device_balance ./merge_analysis_device_balance ${gpuscout_tmp_dir}/nvdisasm-hpctoolkit-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${json} ${gpuscout_output_dir} ${gpuscout_tmp_dir}/pcsampling_${run_prefix}_devices.txt
+fi
 
 # Merge all individual JSON files
 
@@ -135,7 +241,7 @@ if [ "$json" = true ]; then
 echo "======================================================================================================"
 echo "Generating JSON output . . . . . . . . . . . . . . . "
 
-./save_to_json ${gpuscout_output_dir} ${gpuscout_tmp_dir}/result-${run_prefix} ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-registers-executable-${executable_filename}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${executable_filename}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${executable_filename}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${sms}
+run_stage save_to_json ./save_to_json ${gpuscout_output_dir} ${gpuscout_tmp_dir}/result-${run_prefix} ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-registers-executable-${run_prefix}-sass.txt ${gpuscout_tmp_dir}/nvdisasm-executable-${run_prefix}-ptx.txt ${gpuscout_tmp_dir}/pcsampling_${run_prefix}.txt ${gpuscout_tmp_dir}/${run_prefix}_metrics_list ${sms}
 
 fi
 
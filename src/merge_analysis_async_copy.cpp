@@ -0,0 +1,261 @@
+/**
+ * Merge analysis for the pipelines of asynchronous global to shared memory copies (cp.async)
+ * SASS analysis - loops with copies (instruction LDGSTS, LDGDEPBAR, DEPBAR, BAR) -> pipeline stages, instructions overlapping a copy, barrier after the wait
+ * PTX analysis - copies (instruction cp.async, cp.async.commit_group, cp.async.wait_group) -> wait groups with code line numbers, copies compiled to synchronous loads
+ * PC Sampling analysis - pc stalls (all instructions of the loop) -> samples of the waits and barriers, long scoreboard samples of the loop
+ * Metric analysis - get metrics for entire kernel -> executed LDGSTS instructions, barrier and long scoreboard stalls
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_async_copy.hpp"
+#include "parser_ptx_async_copy.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Instructions between the commit of a copy and its wait below which the copy latency is likely exposed
+const int async_copy_min_overlap_instructions = 64;
+// Share of the kernel samples on the waits and barriers of a loop from which a pipeline is reported as WARNING
+const double async_copy_sample_share_threshold = 0.01;
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Sum of the samples of the instructions, optionally of one stall reason
+int get_pc_offsets_samples(const std::vector<std::string> &pc_offsets, const std::unordered_map<int, pc_issue_samples> &samples_by_pc, const std::string &stall_reason = "")
+{
+    int count = 0;
+    for (const auto &pc_offset : pc_offsets)
+    {
+        auto samples = samples_by_pc.find(std::stoi(pc_offset, nullptr, 16));
+        count += samples != samples_by_pc.end() ? get_sample_count(samples->second, stall_reason) : 0;
+    }
+    return count;
+}
+
+/// @brief Merge analysis (SASS, PTX, CUPTI, Metrics) for the pipelines of asynchronous copies
+/// @param loop_map Loops with copies of every kernel
+/// @param counter_map Copy instructions of every kernel in the SASS
+/// @param ptx_counter_map Copy instructions of every kernel in the PTX
+/// @param pc_stall_map CUPTI warp stalls
+/// @param metric_map Metric analysis
+json merge_analysis_async_copy(std::unordered_map<std::string, std::vector<async_copy_loop>> loop_map, std::unordered_map<std::string, async_copy_counter> counter_map,
+                               std::unordered_map<std::string, ptx_async_copy_counter> ptx_counter_map, std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map,
+                               std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+
+    for (auto [k_sass, v_sass] : counter_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Asynchronous copy pipeline analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        const ptx_async_copy_counter &ptx_obj = ptx_counter_map[k_sass];
+        if (v_sass.copy_count == 0)
+        {
+            if (ptx_obj.copy_count > 0)
+            {
+                std::cout << "WARNING   ::  The PTX contains " << ptx_obj.copy_count << " cp.async instructions, but the SASS has no LDGSTS: "
+                          << "the architecture (before sm_80) executes them as synchronous global loads and shared stores, so the copies do not overlap the computation" << std::endl;
+            }
+            else if (ptx_obj.bulk_copy_count > 0)
+            {
+                std::cout << "INFO  ::  The kernel uses " << ptx_obj.bulk_copy_count << " bulk asynchronous copies (cp.async.bulk, TMA), whose pipeline is synchronized with mbarriers" << std::endl;
+            }
+            else
+            {
+                std::cout << "INFO  ::  No asynchronous global to shared memory copies (LDGSTS)" << std::endl;
+            }
+            result[k_sass] = kernel_result;
+            continue;
+        }
+
+        std::cout << "INFO  ::  " << v_sass.copy_count << " LDGSTS, " << v_sass.commit_count << " LDGDEPBAR (commit) and " << v_sass.wait_count << " DEPBAR (wait) instructions, "
+                  << v_sass.copies_outside_loops << " of the copies outside of loops" << std::endl;
+        if (!ptx_obj.waits.empty())
+        {
+            std::cout << "The PTX waits with";
+            for (const auto &[line_number, pending] : ptx_obj.waits)
+            {
+                std::cout << (pending < 0 ? " cp.async.wait_all" : " cp.async.wait_group " + std::to_string(pending)) << " (line number " << line_number << ")";
+            }
+            std::cout << std::endl;
+        }
+
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        int kernel_samples = 0;
+        for (const auto &j : pc_stall_map[k_sass])
+        {
+            kernel_samples += get_sample_count(j);
+        }
+
+        for (const auto &index_sass : loop_map[k_sass])
+        {
+            int wait_samples = get_pc_offsets_samples(index_sass.wait_pc_offsets, samples_by_pc);
+            int barrier_samples = get_pc_offsets_samples(index_sass.barrier_pc_offsets, samples_by_pc);
+            int loop_samples = get_pc_offsets_samples(index_sass.pc_offsets, samples_by_pc);
+            int long_scoreboard_samples = get_pc_offsets_samples(index_sass.pc_offsets, samples_by_pc, "long_scoreboard");
+            double sample_share = kernel_samples > 0 ? (double)(wait_samples + barrier_samples) / kernel_samples : 0;
+
+            bool exposed = index_sass.has_wait && (index_sass.prefetch_distance == 0 || index_sass.overlap_instructions < async_copy_min_overlap_instructions);
+            // Copies completing on an mbarrier are made visible to the block by the mbarrier wait itself, no __syncthreads is needed
+            bool missing_barrier = index_sass.has_wait && !index_sass.uses_mbarrier && !index_sass.barrier_after_wait;
+            bool important = (exposed || missing_barrier) && (kernel_samples == 0 || sample_share >= async_copy_sample_share_threshold);
+
+            std::cout << (important ? "WARNING   ::  " : "INFO  ::  ") << "The loop starting at line number " << index_sass.line_number << " (pcOffset " << index_sass.start_pcOffset << " to "
+                      << index_sass.end_pcOffset << ") issues " << index_sass.copy_count << " asynchronous copies (" << index_sass.copy_bytes << " bytes per thread) and "
+                      << index_sass.commit_count << " commits per iteration, " << index_sass.prologue_commits << " copy groups are committed before the loop" << std::endl;
+            if (index_sass.uses_mbarrier)
+            {
+                std::cout << "The copies complete on an mbarrier (cuda::pipeline or cuda::barrier), the waits are not analyzed" << std::endl;
+            }
+            else if (!index_sass.has_wait)
+            {
+                std::cout << "The loop does not wait for its copies, they are only waited for after the loop" << std::endl;
+            }
+            else
+            {
+                std::cout << "The wait at line number " << index_sass.wait_line_number << " (pcOffset " << index_sass.wait_pcOffset << ", DEPBAR.LE SB0, " << index_sass.wait_pending
+                          << ") lets " << index_sass.wait_pending << " copy groups stay in flight: a copy is waited for " << index_sass.prefetch_distance << " iterations after it is issued ("
+                          << index_sass.stages << " pipeline stages), overlapping " << index_sass.overlap_instructions << " instructions of " << index_sass.instructions << " per iteration" << std::endl;
+                if (index_sass.prefetch_distance == 0)
+                {
+                    std::cout << "Every iteration waits for the copies it has just issued, so the load latency is fully exposed. Issue the copies of the next stage before computing on the current one: "
+                              << "load the first stage before the loop, use two or more shared memory buffers and wait with cp.async.wait_group(stages - 2) (__pipeline_wait_prior, cuda::pipeline)" << std::endl;
+                }
+                else if (index_sass.overlap_instructions < async_copy_min_overlap_instructions)
+                {
+                    std::cout << "Only a few instructions overlap a copy, which is likely not enough to hide the global memory latency. Increase the number of stages or the work per stage" << std::endl;
+                }
+            }
+            if (missing_barrier)
+            {
+                std::cout << "No barrier (__syncthreads) between the wait and the shared memory loads of the loop: a thread only sees its own copies after the wait, "
+                          << "the copies of the other threads of the block are not guaranteed to be visible" << std::endl;
+            }
+            if (loop_samples > 0)
+            {
+                std::cout << "The loop has " << loop_samples << " samples, " << long_scoreboard_samples << " in long scoreboard stalls. The waits have " << wait_samples << " and the "
+                          << index_sass.barrier_pc_offsets.size() << " barriers " << barrier_samples << " samples (" << 100 * sample_share << " % of the kernel)" << std::endl;
+                auto samples = samples_by_pc.find(index_sass.has_wait ? std::stoi(index_sass.wait_pcOffset, nullptr, 16) : -1);
+                if (samples != samples_by_pc.end())
+                {
+                    print_stalls_percentage(samples->second);
+                }
+            }
+
+            kernel_result["occurrences"].push_back({
+                {"severity", important ? "WARNING" : "INFO"},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.start_pcOffset},
+                {"end_pc_offset", index_sass.end_pcOffset},
+                {"instructions", index_sass.instructions},
+                {"copy_count", index_sass.copy_count},
+                {"copy_bytes", index_sass.copy_bytes},
+                {"commit_count", index_sass.commit_count},
+                {"prologue_commits", index_sass.prologue_commits},
+                {"has_wait", index_sass.has_wait},
+                {"wait_pending", index_sass.wait_pending},
+                {"wait_line_number", index_sass.wait_line_number},
+                {"wait_pc_offset", index_sass.wait_pcOffset},
+                {"prefetch_distance", index_sass.prefetch_distance},
+                {"stages", index_sass.stages},
+                {"overlap_instructions", index_sass.overlap_instructions},
+                {"exposed", exposed},
+                {"barriers", index_sass.barrier_pc_offsets.size()},
+                {"barrier_after_wait", index_sass.barrier_after_wait},
+                {"missing_barrier", missing_barrier},
+                {"uses_mbarrier", index_sass.uses_mbarrier},
+                {"samples", loop_samples},
+                {"wait_samples", wait_samples},
+                {"barrier_samples", barrier_samples},
+                {"long_scoreboard_samples", long_scoreboard_samples},
+                {"sample_share", sample_share}
+            });
+        }
+        if (loop_map[k_sass].empty())
+        {
+            std::cout << "INFO  ::  The copies are not part of a loop, so they only overlap the instructions until their wait" << std::endl;
+        }
+
+        // Map kernel with metrics collected
+        if (metric_map.count(k_sass))
+        {
+            const cuda_metrics &m = metric_map[k_sass].metrics_list;
+            std::cout << "INFO  ::  Executed LDGSTS instructions: " << m.smsp__inst_executed_op_ldgsts << ", barrier stalls: " << m.smsp__warp_issue_stalled_barrier_per_warp_active
+                      << " % and long scoreboard stalls: " << m.smsp__warp_issue_stalled_long_scoreboard_per_warp_active << " % per warp active" << std::endl;
+            kernel_result["metrics"] = {
+                {"ldgsts_instructions", m.smsp__inst_executed_op_ldgsts},
+                {"barrier_perc", m.smsp__warp_issue_stalled_barrier_per_warp_active},
+                {"long_scoreboard_perc", m.smsp__warp_issue_stalled_long_scoreboard_per_warp_active}
+            };
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    auto async_copy_tuple = profile_stage("async_copy_analysis", [&] { return async_copy_analysis(filename_hpctoolkit_sass); });
+    std::unordered_map<std::string, std::vector<async_copy_loop>> loop_map = std::get<0>(async_copy_tuple);
+    std::unordered_map<std::string, async_copy_counter> counter_map = std::get<1>(async_copy_tuple);
+
+    std::string filename_ptx = argv[3];
+    std::unordered_map<std::string, ptx_async_copy_counter> ptx_counter_map = profile_stage("ptx_async_copy_analysis", [&] { return ptx_async_copy_analysis(filename_ptx); });
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::ALL); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_async_copy", [&] { return merge_analysis_async_copy(loop_map, counter_map, ptx_counter_map, pc_stall_map, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/async_copy.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
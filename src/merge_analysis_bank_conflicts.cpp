@@ -0,0 +1,229 @@
+/**
+ * Merge analysis for shared memory bank conflicts
+ * SASS analysis - shared memory accesses (instruction LDS, STS, ATOMS) -> stride between the lanes, predicted n-way bank conflict and padding
+ * PC Sampling analysis - pc stalls (instruction LDS, STS, ATOMS) -> samples and stall reasons of the conflicting accesses
+ * Metric analysis - get metrics for entire kernel -> measured shared memory wavefronts per request, compared to the prediction
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_bank_conflicts.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Relative difference between the predicted and measured wavefronts per request up to which the prediction is seen as confirmed
+const double bank_conflict_prediction_tolerance = 0.25;
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Compare the predicted wavefronts per request with the measured ones
+/// @return json object of the comparison, null if nothing was measured
+json cross_check_bank_conflicts(const std::string &access_kind, double predicted, double wavefronts, double requests)
+{
+    if (requests == 0 || predicted == 0)
+    {
+        return json();
+    }
+    double measured = wavefronts / requests;
+    std::cout << "INFO  ::  Shared memory " << access_kind << "s: measured " << measured << " wavefronts per request, predicted " << predicted << std::endl;
+    if (std::abs(measured - predicted) <= bank_conflict_prediction_tolerance * predicted)
+    {
+        std::cout << "INFO  ::  The measured " << access_kind << " bank conflicts match the prediction" << std::endl;
+    }
+    else if (measured > predicted)
+    {
+        std::cout << "WARNING   ::  More " << access_kind << " bank conflicts were measured than predicted, e.g. from addresses which could not be traced "
+                  << "or from a block size with blockDim.x smaller than 32" << std::endl;
+    }
+    else
+    {
+        std::cout << "INFO  ::  Fewer " << access_kind << " bank conflicts were measured than predicted, e.g. the conflicting instructions are executed rarely" << std::endl;
+    }
+    return {{"measured_wavefronts_per_request", measured}, {"predicted_wavefronts_per_request", predicted}};
+}
+
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for shared memory bank conflicts
+/// @param access_map Predicted bank conflicts of every shared memory instruction
+/// @param pc_stall_map CUPTI warp stalls
+/// @param metric_map Metric analysis
+json merge_analysis_bank_conflicts(std::unordered_map<std::string, std::vector<shared_memory_access>> access_map, std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map, std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+
+    for (auto [k_sass, v_sass] : access_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "" || v_sass.empty())
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Shared memory bank conflict analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+
+        // Average predicted wavefronts per request, weighted by the samples of the instructions (or equally, without samples)
+        std::map<std::string, std::pair<double, double>> predicted_wavefronts; // access kind -> weighted wavefronts, weights
+        int conflict_count = 0, unknown_count = 0;
+
+        for (const auto &index_sass : v_sass)
+        {
+            int pc_offset = std::stoi(index_sass.pcOffset, nullptr, 16);
+            auto samples = samples_by_pc.find(pc_offset);
+            int sample_count = samples != samples_by_pc.end() ? get_sample_count(samples->second) : 0;
+
+            json line_result = {
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.pcOffset},
+                {"access", index_sass.access_kind},
+                {"access_bytes", index_sass.access_bytes},
+                {"loop_depth", index_sass.loop_depth},
+                {"samples", sample_count}
+            };
+
+            if (!index_sass.stride_known)
+            {
+                unknown_count++;
+                continue;
+            }
+
+            double weight = pc_stall_map[k_sass].empty() ? 1 : sample_count;
+            predicted_wavefronts[index_sass.access_kind].first += weight * index_sass.wavefronts;
+            predicted_wavefronts[index_sass.access_kind].second += weight;
+
+            int conflict_ways = index_sass.wavefronts / index_sass.ideal_wavefronts;
+            line_result.update({
+                {"stride_bytes", index_sass.stride},
+                {"wavefronts", index_sass.wavefronts},
+                {"ideal_wavefronts", index_sass.ideal_wavefronts},
+                {"conflict_ways", conflict_ways},
+                {"padding_bytes", index_sass.padding_bytes}
+            });
+
+            if (index_sass.wavefronts <= index_sass.ideal_wavefronts)
+            {
+                continue;
+            }
+            conflict_count++;
+            line_result["severity"] = "WARNING";
+
+            std::cout << "WARNING   ::  Shared memory " << index_sass.access_kind << " at line number " << index_sass.line_number << " (pcOffset " << index_sass.pcOffset
+                      << ", " << index_sass.sass_instruction << ") has a stride of " << index_sass.stride << " bytes between the threads of a warp, which causes a "
+                      << conflict_ways << "-way bank conflict (" << index_sass.wavefronts << " instead of " << index_sass.ideal_wavefronts << " wavefronts)";
+            if (index_sass.loop_depth > 0)
+            {
+                std::cout << ", inside a loop";
+            }
+            std::cout << std::endl;
+            if (index_sass.access_kind == "atomic" && index_sass.stride == 0)
+            {
+                std::cout << "All threads of a warp update the same address, which serializes the atomics. Combine the values within the warp first "
+                          << "(e.g. with __reduce_add_sync or __shfl_down_sync) and let one thread per warp update the shared memory" << std::endl;
+            }
+            else if (index_sass.padding_bytes > 0)
+            {
+                std::cout << "Pad every row of the shared memory array by " << index_sass.padding_bytes << " bytes (" << index_sass.padding_bytes / index_sass.access_bytes
+                          << " elements, e.g. tile[N][M + " << index_sass.padding_bytes / index_sass.access_bytes << "]) to make the access conflict free" << std::endl;
+            }
+            else
+            {
+                std::cout << "Padding does not remove this conflict, change the data layout (e.g. an XOR swizzle of the index) or let neighbouring threads access neighbouring elements" << std::endl;
+            }
+            if (sample_count > 0)
+            {
+                std::cout << "This instruction has " << sample_count << " samples, " << get_sample_count(samples->second, "mio_throttle") + get_sample_count(samples->second, "short_scoreboard")
+                          << " of them in MIO throttle or short scoreboard stalls" << std::endl;
+                print_stalls_percentage(samples->second);
+            }
+            kernel_result["occurrences"].push_back(line_result);
+        }
+
+        if (conflict_count == 0)
+        {
+            std::cout << "INFO  ::  No bank conflicts predicted for the " << v_sass.size() - unknown_count << " shared memory accesses whose address could be traced" << std::endl;
+        }
+        if (unknown_count > 0)
+        {
+            std::cout << "INFO  ::  The address of " << unknown_count << " of " << v_sass.size() << " shared memory accesses could not be traced to the thread index" << std::endl;
+        }
+        std::cout << "The prediction assumes that blockDim.x is a multiple of 32, so that the lanes of a warp differ in threadIdx.x only" << std::endl;
+
+        // Map kernel with metrics collected
+        json metrics;
+        if (metric_map.count(k_sass))
+        {
+            const cuda_metrics &m = metric_map[k_sass].metrics_list;
+            auto predicted = [&](const std::string &access_kind)
+            { return predicted_wavefronts[access_kind].second > 0 ? predicted_wavefronts[access_kind].first / predicted_wavefronts[access_kind].second : 0; };
+            json load_check = cross_check_bank_conflicts("load", predicted("load"), m.l1tex__data_pipe_lsu_wavefronts_mem_shared_op_ld, m.sm__sass_inst_executed_op_shared_ld);
+            json store_check = cross_check_bank_conflicts("store", predicted("store"), m.l1tex__data_pipe_lsu_wavefronts_mem_shared_op_st, m.sm__sass_inst_executed_op_shared_st);
+            if (!load_check.is_null())
+                metrics["load"] = load_check;
+            if (!store_check.is_null())
+                metrics["store"] = store_check;
+        }
+        if (!metrics.is_null())
+        {
+            kernel_result["metrics"] = metrics;
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    std::unordered_map<std::string, std::vector<shared_memory_access>> access_map = profile_stage("bank_conflict_analysis", [&] { return bank_conflict_analysis(filename_hpctoolkit_sass); });
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::SHARED_MEMORY_ACCESS); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_bank_conflicts", [&] { return merge_analysis_bank_conflicts(access_map, pc_stall_map, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/bank_conflicts.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
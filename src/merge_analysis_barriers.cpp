@@ -0,0 +1,207 @@
+/**
+ * Merge analysis for the cost of barriers
+ * SASS analysis - barriers (instruction BAR, WARPSYNC, MEMBAR) -> loop depth, instructions and memory accesses since the previous barrier, redundant barriers, divergent branches
+ * PC Sampling analysis - pc stalls (all instructions) -> barrier and membar samples of every barrier, share of the kernel samples
+ * Metric analysis - get metrics for entire kernel -> barrier and membar stalls
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_barriers.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Share of the kernel samples from which a barrier is reported as WARNING
+const double barrier_sample_share_threshold = 0.01;
+// Instructions between the barriers of a loop below which the synchronization is not amortized
+const int barrier_min_loop_instructions = 32;
+// Share of the instructions since the previous barrier which only a part of the threads executes, from which the barrier waits for divergent work
+const double barrier_divergent_work_share = 0.25;
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for the cost of barriers
+/// @param barrier_map Barriers of every kernel
+/// @param pc_stall_map CUPTI warp stalls
+/// @param metric_map Metric analysis
+json merge_analysis_barriers(std::unordered_map<std::string, std::vector<barrier_instruction>> barrier_map, std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map,
+                             std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+
+    for (auto [k_sass, v_sass] : barrier_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Barrier analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        if (v_sass.empty())
+        {
+            std::cout << "INFO  ::  No barriers (__syncthreads, __syncwarp) or memory fences" << std::endl;
+            result[k_sass] = kernel_result;
+            continue;
+        }
+
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        int kernel_samples = 0;
+        for (const auto &j : pc_stall_map[k_sass])
+        {
+            kernel_samples += get_sample_count(j);
+        }
+
+        int total_barrier_samples = 0;
+        std::map<std::string, int> kind_count;
+        for (const auto &index_sass : v_sass)
+        {
+            kind_count[index_sass.kind]++;
+            auto samples = samples_by_pc.find(std::stoi(index_sass.pcOffset, nullptr, 16));
+            int sample_count = samples != samples_by_pc.end() ? get_sample_count(samples->second) : 0;
+            int barrier_samples = samples != samples_by_pc.end() ? get_sample_count(samples->second, "barrier") : 0;
+            int membar_samples = samples != samples_by_pc.end() ? get_sample_count(samples->second, "membar") : 0;
+            total_barrier_samples += sample_count;
+            double sample_share = kernel_samples > 0 ? (double)sample_count / kernel_samples : 0;
+            bool hot = kernel_samples == 0 || sample_share >= barrier_sample_share_threshold;
+
+            bool in_divergent_branch = index_sass.kind == "block" && !index_sass.divergent_branch_pcOffset.empty();
+            bool divergent_work = index_sass.kind == "block" && index_sass.divergent_instructions > 0 &&
+                                  index_sass.divergent_instructions >= barrier_divergent_work_share * index_sass.instructions_since_previous;
+            bool short_loop_phase = index_sass.kind == "block" && index_sass.loop_depth > 0 && index_sass.instructions_since_previous < barrier_min_loop_instructions;
+            bool important = in_divergent_branch || (hot && (index_sass.redundant || divergent_work || short_loop_phase));
+
+            std::cout << (important ? "WARNING   ::  " : "INFO  ::  ") << (index_sass.kind == "fence" ? "Memory fence" : "Barrier") << " at line number " << index_sass.line_number
+                      << " (pcOffset " << index_sass.pcOffset << ", " << index_sass.sass_instruction << ")";
+            if (index_sass.loop_depth > 0)
+            {
+                std::cout << " inside the loop starting at line number " << index_sass.loop_line_number << " (pcOffset " << index_sass.loop_pcOffset << ", loop depth " << index_sass.loop_depth << ")";
+            }
+            if (index_sass.kind == "block")
+            {
+                std::cout << ", " << index_sass.instructions_since_previous << " instructions and " << index_sass.memory_instructions_since_previous << " memory accesses since the "
+                          << (index_sass.previous_pcOffset.empty() ? "start of the kernel" : "previous barrier at pcOffset " + index_sass.previous_pcOffset);
+            }
+            std::cout << std::endl;
+
+            if (in_divergent_branch)
+            {
+                std::cout << "The barrier is inside the divergent branch at pcOffset " << index_sass.divergent_branch_pcOffset << ", so not all threads of the block reach it: "
+                          << "__syncthreads() in conditional code is only allowed if the condition is the same for the whole block, otherwise the kernel can hang or produce wrong results" << std::endl;
+            }
+            if (index_sass.redundant)
+            {
+                std::cout << "No shared or global memory is accessed since the previous barrier, so this barrier does not order any accesses and can likely be removed" << std::endl;
+            }
+            if (divergent_work)
+            {
+                std::cout << index_sass.divergent_instructions << " of the instructions since the previous barrier are only executed by a part of the threads (divergent branches), the other threads wait at the barrier. "
+                          << "If the active threads shrink step by step (e.g. a tree reduction), finish the last 32 elements within a warp with __shfl_down_sync instead of block barriers" << std::endl;
+            }
+            if (short_loop_phase)
+            {
+                std::cout << "Only " << index_sass.instructions_since_previous << " instructions separate the barriers of the loop, so the synchronization is not amortized. "
+                          << "Process more elements per thread between the barriers, merge the phases of the loop, or use double buffering to remove one of the barriers" << std::endl;
+            }
+            if (sample_count > 0)
+            {
+                std::cout << "The " << (index_sass.kind == "fence" ? "fence" : "barrier") << " has " << sample_count << " samples (" << 100 * sample_share << " % of the kernel), " << barrier_samples
+                          << " in barrier and " << membar_samples << " in membar stalls" << std::endl;
+                print_stalls_percentage(samples->second);
+            }
+
+            kernel_result["occurrences"].push_back({
+                {"severity", important ? "WARNING" : "INFO"},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.pcOffset},
+                {"kind", index_sass.kind},
+                {"loop_depth", index_sass.loop_depth},
+                {"loop_pc_offset", index_sass.loop_pcOffset},
+                {"previous_barrier_pc_offset", index_sass.previous_pcOffset},
+                {"instructions_since_previous", index_sass.instructions_since_previous},
+                {"memory_instructions_since_previous", index_sass.memory_instructions_since_previous},
+                {"redundant", index_sass.redundant},
+                {"divergent_branch_pc_offset", index_sass.divergent_branch_pcOffset},
+                {"divergent_instructions", index_sass.divergent_instructions},
+                {"samples", sample_count},
+                {"barrier_samples", barrier_samples},
+                {"membar_samples", membar_samples},
+                {"sample_share", sample_share}
+            });
+        }
+
+        std::cout << "INFO  ::  " << kind_count["block"] << " block barriers, " << kind_count["arrive"] << " barrier arrives, " << kind_count["warp"] << " warp barriers and " << kind_count["fence"]
+                  << " memory fences with " << total_barrier_samples << " samples (" << (kernel_samples > 0 ? 100.0 * total_barrier_samples / kernel_samples : 0) << " % of the kernel)" << std::endl;
+
+        // Map kernel with metrics collected
+        if (metric_map.count(k_sass))
+        {
+            const cuda_metrics &m = metric_map[k_sass].metrics_list;
+            std::cout << "INFO  ::  Barrier stalls: " << m.smsp__warp_issue_stalled_barrier_per_warp_active << " % and membar stalls: " << m.smsp__warp_issue_stalled_membar_per_warp_active
+                      << " % per warp active" << std::endl;
+            kernel_result["metrics"] = {
+                {"barrier_perc", m.smsp__warp_issue_stalled_barrier_per_warp_active},
+                {"membar_perc", m.smsp__warp_issue_stalled_membar_per_warp_active}
+            };
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    std::unordered_map<std::string, std::vector<barrier_instruction>> barrier_map = profile_stage("barrier_analysis", [&] { return barrier_analysis(filename_hpctoolkit_sass); });
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::ALL); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_barriers", [&] { return merge_analysis_barriers(barrier_map, pc_stall_map, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/barriers.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
@@ -0,0 +1,245 @@
+/**
+ * Merge analysis for the coalescing of global memory accesses
+ * SASS analysis - global memory accesses (instruction LDG, STG) -> stride between the lanes, alignment and predicted sectors per request
+ * PC Sampling analysis - pc stalls (instruction LDG, STG) -> share of the kernel samples, which weights the severity of every access
+ * Metric analysis - get metrics for entire kernel -> measured sectors per request, compared to the prediction
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_coalescing.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Share of the kernel samples below which an uncoalesced access is only reported as INFO
+const double coalescing_sample_share_threshold = 0.01;
+// Relative difference between the predicted and measured sectors per request up to which the prediction is seen as confirmed
+const double coalescing_prediction_tolerance = 0.25;
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Compare the predicted sectors per request with the measured ones
+/// @return json object of the comparison, null if nothing was measured
+json cross_check_coalescing(const std::string &access_kind, double predicted, double sectors, double requests)
+{
+    if (requests == 0 || predicted == 0)
+    {
+        return json();
+    }
+    double measured = sectors / requests;
+    std::cout << "INFO  ::  Global memory " << access_kind << "s: measured " << measured << " sectors per request, predicted " << predicted << std::endl;
+    if (std::abs(measured - predicted) <= coalescing_prediction_tolerance * predicted)
+    {
+        std::cout << "INFO  ::  The measured " << access_kind << " sectors per request match the prediction" << std::endl;
+    }
+    else if (measured > predicted)
+    {
+        std::cout << "WARNING   ::  More " << access_kind << " sectors per request were measured than predicted, e.g. from gather/scatter accesses, "
+                  << "misaligned pointers or a block size with blockDim.x smaller than 32" << std::endl;
+    }
+    else
+    {
+        std::cout << "INFO  ::  Fewer " << access_kind << " sectors per request were measured than predicted, e.g. the uncoalesced instructions are executed rarely "
+                  << "or only by a part of the warp" << std::endl;
+    }
+    return {{"measured_sectors_per_request", measured}, {"predicted_sectors_per_request", predicted}};
+}
+
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for the coalescing of global memory accesses
+/// @param access_map Predicted coalescing of every global memory instruction
+/// @param pc_stall_map CUPTI warp stalls
+/// @param kernel_stalls Samples of the whole kernels
+/// @param metric_map Metric analysis
+json merge_analysis_coalescing(std::unordered_map<std::string, std::vector<global_memory_access>> access_map, std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map,
+                               std::unordered_map<std::string, std::unordered_map<std::string, int>> kernel_stalls, std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+
+    for (auto [k_sass, v_sass] : access_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "" || v_sass.empty())
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Global memory coalescing analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        int kernel_samples = 0;
+        for (const auto &[stall_name, count] : kernel_stalls[k_sass])
+        {
+            kernel_samples += count;
+        }
+
+        // Average predicted sectors per request, weighted by the samples of the instructions (or equally, without samples)
+        std::map<std::string, std::pair<double, double>> predicted_sectors; // access kind -> weighted sectors, weights
+        std::map<std::string, int> pattern_count;
+
+        for (const auto &index_sass : v_sass)
+        {
+            int pc_offset = std::stoi(index_sass.pcOffset, nullptr, 16);
+            auto samples = samples_by_pc.find(pc_offset);
+            int sample_count = samples != samples_by_pc.end() ? get_sample_count(samples->second) : 0;
+            double sample_share = kernel_samples > 0 ? (double)sample_count / kernel_samples : 0;
+            pattern_count[index_sass.pattern]++;
+
+            json line_result = {
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.pcOffset},
+                {"access", index_sass.access_kind},
+                {"pattern", index_sass.pattern},
+                {"access_bytes", index_sass.access_bytes},
+                {"loop_depth", index_sass.loop_depth},
+                {"sectors_per_request", index_sass.sectors},
+                {"ideal_sectors_per_request", index_sass.ideal_sectors},
+                {"samples", sample_count},
+                {"sample_share", sample_share}
+            };
+
+            if (index_sass.stride_known)
+            {
+                double weight = pc_stall_map[k_sass].empty() ? 1 : sample_count;
+                predicted_sectors[index_sass.access_kind].first += weight * index_sass.sectors;
+                predicted_sectors[index_sass.access_kind].second += weight;
+                line_result["stride_bytes"] = index_sass.stride;
+                line_result["sector_offset"] = index_sass.sector_offset;
+            }
+
+            if (index_sass.sectors <= index_sass.ideal_sectors)
+            {
+                continue;
+            }
+
+            // Without samples (dry run), every uncoalesced access is a warning
+            bool important = kernel_samples == 0 || sample_share >= coalescing_sample_share_threshold;
+            line_result["severity"] = important && index_sass.pattern != "coalesced" ? "WARNING" : "INFO";
+            std::cout << (line_result["severity"] == "WARNING" ? "WARNING   ::  " : "INFO  ::  ") << "Global memory " << index_sass.access_kind << " at line number " << index_sass.line_number
+                      << " (pcOffset " << index_sass.pcOffset << ", " << index_sass.sass_instruction << ")";
+            if (index_sass.pattern == "gather/scatter")
+            {
+                std::cout << " is a gather/scatter access, its address depends on values loaded at runtime or could not be traced to the thread index. "
+                          << "It touches up to " << index_sass.sectors << " sectors per request instead of " << index_sass.ideal_sectors;
+            }
+            else if (index_sass.pattern == "strided")
+            {
+                std::cout << " has a stride of " << index_sass.stride << " bytes between the threads of a warp, which touches " << index_sass.sectors << " sectors per request instead of "
+                          << index_sass.ideal_sectors << " (" << 100.0 * index_sass.ideal_sectors / index_sass.sectors << " % of the bytes transferred are used)";
+            }
+            else
+            {
+                std::cout << " is coalesced, but starts " << index_sass.sector_offset << " bytes into a sector, which touches " << index_sass.sectors << " sectors per request instead of "
+                          << index_sass.ideal_sectors;
+            }
+            if (index_sass.loop_depth > 0)
+            {
+                std::cout << ", inside a loop";
+            }
+            std::cout << std::endl;
+
+            if (index_sass.pattern == "gather/scatter")
+            {
+                std::cout << "If the indices are known in advance, sorting them or grouping the threads by the accessed data improves the coalescing" << std::endl;
+            }
+            else if (index_sass.pattern == "strided")
+            {
+                std::cout << "Let neighbouring threads access neighbouring elements, e.g. by swapping the index computed from threadIdx.x, using a structure of arrays "
+                          << "instead of an array of structures, or by staging the data through shared memory with a coalesced access" << std::endl;
+            }
+            else
+            {
+                std::cout << "Align the accessed array to 32 bytes (e.g. pad the rows) or shift the index range, so that a warp starts at a sector boundary" << std::endl;
+            }
+            if (sample_count > 0)
+            {
+                std::cout << "This instruction has " << sample_count << " samples (" << 100 * sample_share << " % of the kernel), "
+                          << get_sample_count(samples->second, "long_scoreboard") + get_sample_count(samples->second, "lg_throttle") << " of them in long scoreboard or LG throttle stalls" << std::endl;
+                print_stalls_percentage(samples->second);
+            }
+            kernel_result["occurrences"].push_back(line_result);
+        }
+
+        std::cout << "INFO  ::  " << v_sass.size() << " global memory accesses: " << pattern_count["coalesced"] << " coalesced, " << pattern_count["uniform"] << " uniform, "
+                  << pattern_count["strided"] << " strided, " << pattern_count["gather/scatter"] << " gather/scatter" << std::endl;
+        std::cout << "The prediction assumes that blockDim.x is a multiple of 32 and that the pointers and the offsets of the blocks are aligned to 32 bytes" << std::endl;
+
+        // Map kernel with metrics collected
+        json metrics;
+        if (metric_map.count(k_sass))
+        {
+            const cuda_metrics &m = metric_map[k_sass].metrics_list;
+            auto predicted = [&](const std::string &access_kind)
+            { return predicted_sectors[access_kind].second > 0 ? predicted_sectors[access_kind].first / predicted_sectors[access_kind].second : 0; };
+            json load_check = cross_check_coalescing("load", predicted("load"), m.l1tex__t_sectors_pipe_lsu_mem_global_op_ld, m.sm__sass_inst_executed_op_global_ld);
+            json store_check = cross_check_coalescing("store", predicted("store"), m.l1tex__t_sectors_pipe_lsu_mem_global_op_st, m.sm__sass_inst_executed_op_global_st);
+            if (!load_check.is_null())
+                metrics["load"] = load_check;
+            if (!store_check.is_null())
+                metrics["store"] = store_check;
+        }
+        if (!metrics.is_null())
+        {
+            kernel_result["metrics"] = metrics;
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    std::unordered_map<std::string, std::vector<global_memory_access>> access_map = profile_stage("coalescing_analysis", [&] { return coalescing_analysis(filename_hpctoolkit_sass); });
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::GLOBAL_MEMORY_ACCESS); });
+    std::unordered_map<std::string, std::unordered_map<std::string, int>> kernel_stalls = profile_stage("get_kernel_stalls", [&] { return get_kernel_stalls(filename_sampling); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_coalescing", [&] { return merge_analysis_coalescing(access_map, pc_stall_map, kernel_stalls, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/coalescing.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
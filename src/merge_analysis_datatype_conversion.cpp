@@ -11,6 +11,7 @@
 #include "parser_pcsampling.hpp"
 #include "parser_metrics.hpp"
 #include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
 #include <cstring>
 #include <fstream>
 
@@ -138,18 +139,18 @@ json merge_analysis_datatype_conversion(std::unordered_map<std::string, datatype
 int main(int argc, char **argv)
 {
     std::string filename_hpctoolkit_sass = argv[1];
-    std::unordered_map<std::string, datatype_conversions_counter> datatype_conversion_map = datatype_conversions_analysis(filename_hpctoolkit_sass);
+    std::unordered_map<std::string, datatype_conversions_counter> datatype_conversion_map = profile_stage("datatype_conversions_analysis", [&] { return datatype_conversions_analysis(filename_hpctoolkit_sass); });
 
     std::string filename_sampling = argv[4];
-    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::DATATYPE_CONVERSION);
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::DATATYPE_CONVERSION); });
 
     std::string filename_metrics = argv[5];
-    std::unordered_map<std::string, kernel_metrics> metric_map = create_metrics(filename_metrics);
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
 
     int save_as_json = std::strcmp(argv[6], "true") == 0;
     std::string json_output_dir = argv[7];
 
-    json result = merge_analysis_datatype_conversion(datatype_conversion_map, pc_stall_map, metric_map);
+    json result = profile_stage("merge_analysis_datatype_conversion", [&] { return merge_analysis_datatype_conversion(datatype_conversion_map, pc_stall_map, metric_map); });
 
     if (save_as_json)
     {
@@ -9,6 +9,7 @@
 
 #include "parser_sass_deadlock_detection.hpp"
 #include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
 #include <cstring>
 #include <cstring>
 #include <fstream>
@@ -46,12 +47,12 @@ json merge_analysis_deadlock_detection(std::unordered_map<std::string, deadlock_
 int main(int argc, char **argv)
 {
     std::string filename_executable_sass = argv[2];
-    std::unordered_map<std::string, deadlock_detect> detection_map = deadlock_detection_analysis(filename_executable_sass);
+    std::unordered_map<std::string, deadlock_detect> detection_map = profile_stage("deadlock_detection_analysis", [&] { return deadlock_detection_analysis(filename_executable_sass); });
 
     int save_as_json = std::strcmp(argv[6], "true") == 0;
     std::string json_output_dir = argv[7];
 
-    json result = merge_analysis_deadlock_detection(detection_map);
+    json result = profile_stage("merge_analysis_deadlock_detection", [&] { return merge_analysis_deadlock_detection(detection_map); });
 
     if (save_as_json)
     {
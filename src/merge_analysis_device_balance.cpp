@@ -0,0 +1,224 @@
+/**
+ * Merge analysis for the balance of the work between the GPUs of a multi-GPU application
+ * SASS analysis - N/A
+ * PC Sampling analysis - pc stalls per CUDA context -> samples and stall profile of every kernel on every device
+ * Metric analysis - N/A
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_pcsampling.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+#include <map>
+
+using json = nlohmann::json;
+
+// Devices sampling this much more than the average device are reported as a warning
+const double imbalance_warning_threshold = 1.2;
+// Stall profiles further apart than this (total variation distance) are reported as a warning
+const double profile_warning_threshold = 0.2;
+
+/// @brief Samples and stall profile of one kernel on one device
+struct device_profile
+{
+    std::string device_id;
+    std::string device_name;
+    std::string compute_capability;
+    std::vector<std::string> context_ids;
+    int total_samples;
+    std::map<std::string, int> stall_samples;
+};
+
+/// @brief Fraction of the samples per stall reason
+std::map<std::string, double> stall_fractions(const std::map<std::string, int> &stall_samples, int total_samples)
+{
+    std::map<std::string, double> fractions;
+    for (const auto &[stall, samples] : stall_samples)
+    {
+        fractions[stall] = total_samples ? (1.0 * samples) / total_samples : 0;
+    }
+    return fractions;
+}
+
+/// @brief Merge analysis (CUPTI) comparing the samples of every kernel between the devices
+/// @param contexts Sampled CUDA contexts with their devices and sampling files
+json merge_analysis_device_balance(const std::vector<sampling_context> &contexts)
+{
+    json result;
+
+    // device -> kernel -> profile, contexts on the same device are added up
+    std::map<std::string, std::map<std::string, device_profile>> device_kernel_profiles;
+    std::map<std::string, device_profile> devices;
+    for (const auto &context : contexts)
+    {
+        device_profile &device = devices[context.device_id];
+        device.device_id = context.device_id;
+        device.device_name = context.device_name;
+        device.compute_capability = context.compute_capability;
+        device.context_ids.push_back(context.context_id);
+
+        for (const auto &[kernel, stalls] : get_kernel_stalls(context.sampling_file))
+        {
+            device_profile &profile = device_kernel_profiles[context.device_id][kernel];
+            for (const auto &[stall, samples] : stalls)
+            {
+                profile.stall_samples[stall] += samples;
+                profile.total_samples += samples;
+            }
+        }
+    }
+
+    std::map<std::string, bool> kernels;
+    for (const auto &[device_id, kernel_profiles] : device_kernel_profiles)
+    {
+        for (const auto &[kernel, profile] : kernel_profiles)
+        {
+            kernels[kernel] = true;
+        }
+    }
+
+    for (const auto &[k_sampling, v_sampling] : kernels)
+    {
+        json kernel_result = {
+            {"devices", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sampling == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Device balance analysis for kernel: " << k_sampling << "   --------------------- " << std::endl;
+
+        // Every device counts, a device on which the kernel was never sampled did not get any of its work
+        std::vector<device_profile> profiles;
+        device_profile combined = {"", "", "", {}, 0, {}};
+        for (const auto &[device_id, device] : devices)
+        {
+            device_profile profile = device;
+            profile.total_samples = 0;
+            auto it = device_kernel_profiles[device_id].find(k_sampling);
+            if (it != device_kernel_profiles[device_id].end())
+            {
+                profile.total_samples = it->second.total_samples;
+                profile.stall_samples = it->second.stall_samples;
+            }
+            for (const auto &[stall, samples] : profile.stall_samples)
+            {
+                combined.stall_samples[stall] += samples;
+            }
+            combined.total_samples += profile.total_samples;
+            profiles.push_back(profile);
+        }
+
+        double mean_samples = (1.0 * combined.total_samples) / profiles.size();
+        std::map<std::string, double> combined_fraction = stall_fractions(combined.stall_samples, combined.total_samples);
+
+        const device_profile *most_loaded = &profiles.front(), *least_loaded = &profiles.front();
+        double max_distance = 0;
+        const device_profile *most_different = &profiles.front();
+        for (const auto &profile : profiles)
+        {
+            if (profile.total_samples > most_loaded->total_samples)
+            {
+                most_loaded = &profile;
+            }
+            if (profile.total_samples < least_loaded->total_samples)
+            {
+                least_loaded = &profile;
+            }
+
+            std::map<std::string, double> fraction = stall_fractions(profile.stall_samples, profile.total_samples);
+            double distance = profile.total_samples ? profile_distance(fraction, combined_fraction) : 0;
+            if (distance > max_distance)
+            {
+                max_distance = distance;
+                most_different = &profile;
+            }
+
+            double share = combined.total_samples ? (1.0 * profile.total_samples) / combined.total_samples : 0;
+            auto top_stall = std::max_element(fraction.begin(), fraction.end(), [](const auto &lhs, const auto &rhs) { return lhs.second < rhs.second; });
+            std::cout << "INFO  ::  Device " << profile.device_id << " (" << profile.device_name << ", sm_" << profile.compute_capability << "): "
+                      << profile.total_samples << " samples (" << 100.0 * share << " % of the kernel)";
+            if (top_stall != fraction.end())
+            {
+                std::cout << ", mostly " << top_stall->first << " (" << 100.0 * top_stall->second << " %)";
+            }
+            std::cout << std::endl;
+
+            kernel_result["devices"].push_back({
+                {"device_id", profile.device_id},
+                {"device_name", profile.device_name},
+                {"compute_capability", profile.compute_capability},
+                {"context_ids", profile.context_ids},
+                {"total_samples", profile.total_samples},
+                {"sample_share", share},
+                {"stall_samples", profile.stall_samples},
+                {"distance_to_combined", distance}
+            });
+        }
+
+        // Ratio of the busiest device to the average device, 1 means perfectly balanced
+        double imbalance = mean_samples > 0 ? most_loaded->total_samples / mean_samples : 1;
+        if (profiles.size() < 2)
+        {
+            std::cout << "INFO  ::  The kernel was only sampled on one device, nothing to compare" << std::endl;
+        }
+        else
+        {
+            if (imbalance > imbalance_warning_threshold)
+            {
+                std::cout << "WARNING   ::  The work is imbalanced between the GPUs. Device " << most_loaded->device_id << " collects "
+                          << 100.0 * (imbalance - 1) << " % more samples than the average device, device " << least_loaded->device_id
+                          << " only " << least_loaded->total_samples << " samples." << std::endl;
+            }
+            else
+            {
+                std::cout << "INFO  ::  The work is balanced between the GPUs (busiest device " << 100.0 * (imbalance - 1) << " % above the average)" << std::endl;
+            }
+            if (max_distance > profile_warning_threshold)
+            {
+                std::cout << "WARNING   ::  The kernel stalls differently on device " << most_different->device_id << ", its stall profile differs by "
+                          << 100.0 * max_distance << " % from the combined profile of all devices." << std::endl;
+            }
+        }
+
+        kernel_result["metrics"] = {
+            {"device_count", profiles.size()},
+            {"total_samples", combined.total_samples},
+            {"imbalance", imbalance},
+            {"most_loaded_device", most_loaded->device_id},
+            {"least_loaded_device", least_loaded->device_id},
+            {"max_profile_distance", max_distance}
+        };
+
+        result[k_sampling] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    std::string filename_devices = argv[8];
+    std::vector<sampling_context> contexts = profile_stage("get_sampling_contexts", [&] { return get_sampling_contexts(filename_devices); });
+
+    json result = profile_stage("merge_analysis_device_balance", [&] { return merge_analysis_device_balance(contexts); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/device_balance.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
@@ -0,0 +1,270 @@
+/**
+ * Merge analysis for the calls of non-inlined device functions
+ * SASS analysis - calls (instruction CALL) with their argument and return value moves, ABI overhead of the called functions (stack pointer, saved and restored registers, RET)
+ * PC Sampling analysis - pc stalls (the call site, the overhead instructions of the called function) -> samples which inlining would recover, ranking of the calls
+ * Metric analysis - get metrics for entire kernel -> elapsed cycles, to turn the share of the samples into cycles
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_device_calls.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Share of the kernel samples on the call overhead from which a call is reported as WARNING
+const double device_call_sample_share_threshold = 0.01;
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Sum of the samples of the instructions
+int get_instruction_samples(const std::unordered_map<int, pc_issue_samples> &samples_by_pc, const std::vector<std::string> &pc_offsets)
+{
+    int sample_count = 0;
+    for (const auto &pc_offset : pc_offsets)
+    {
+        auto samples = samples_by_pc.find(std::stoi(pc_offset, nullptr, 16));
+        sample_count += samples != samples_by_pc.end() ? get_sample_count(samples->second) : 0;
+    }
+    return sample_count;
+}
+
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for the calls of device functions
+/// @param call_map Calls of every kernel and device function
+/// @param function_map Called device functions with their ABI overhead
+/// @param pc_stall_map CUPTI warp stalls, the samples of a device function are recorded under its own name
+/// @param metric_map Metric analysis
+json merge_analysis_device_calls(std::unordered_map<std::string, std::vector<device_call>> call_map, std::unordered_map<std::string, device_function> function_map,
+                                 std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map, std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+
+    // Samples of every call site, to split the samples of a function between its callers (evenly if the call sites have no samples)
+    std::unordered_map<std::string, std::unordered_map<int, pc_issue_samples>> samples_by_function;
+    std::unordered_map<std::string, int> call_site_samples;
+    for (const auto &[k_caller, v_calls] : call_map)
+    {
+        samples_by_function[k_caller] = get_samples_by_pc(pc_stall_map[k_caller]);
+        for (const auto &call_obj : v_calls)
+        {
+            call_site_samples[call_obj.callee] += get_instruction_samples(samples_by_function[k_caller], call_obj.pc_offsets);
+        }
+    }
+    for (auto &[k_function, v_function] : function_map)
+    {
+        if (!samples_by_function.count(k_function))
+        {
+            samples_by_function[k_function] = get_samples_by_pc(pc_stall_map[k_function]);
+        }
+    }
+
+    for (auto [k_sass, v_sass] : call_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Device function call analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        if (v_sass.empty())
+        {
+            std::cout << "INFO  ::  No calls of device functions" << std::endl;
+            result[k_sass] = kernel_result;
+            continue;
+        }
+
+        const std::unordered_map<int, pc_issue_samples> &samples_by_pc = samples_by_function[k_sass];
+        double kernel_samples = 0;
+        for (const auto &j : pc_stall_map[k_sass])
+        {
+            kernel_samples += get_sample_count(j);
+        }
+
+        // Share of every called function attributed to this call site, and the samples of the kernel including its part of the called functions
+        std::vector<double> weights;
+        std::vector<int> site_samples;
+        for (const auto &index_sass : v_sass)
+        {
+            site_samples.push_back(get_instruction_samples(samples_by_pc, index_sass.pc_offsets));
+            double weight = 0;
+            if (index_sass.kind == "direct")
+            {
+                const device_function &function_obj = function_map[index_sass.callee];
+                weight = call_site_samples[index_sass.callee] > 0 ? (double)site_samples.back() / call_site_samples[index_sass.callee] : 1.0 / function_obj.call_sites;
+                kernel_samples += weight * get_instruction_samples(samples_by_function[index_sass.callee], function_obj.pc_offsets);
+            }
+            weights.push_back(weight);
+        }
+
+        // Calls ranked by the samples which inlining would recover, the static overhead for calls without samples
+        std::vector<int> ranking(v_sass.size());
+        std::vector<double> recoverable_samples(v_sass.size());
+        std::vector<int> overhead_instructions(v_sass.size());
+        for (size_t i = 0; i < v_sass.size(); i++)
+        {
+            ranking[i] = i;
+            const device_call &call_obj = v_sass[i];
+            overhead_instructions[i] = call_obj.pc_offsets.size();
+            recoverable_samples[i] = site_samples[i];
+            if (call_obj.kind == "direct")
+            {
+                const device_function &function_obj = function_map[call_obj.callee];
+                overhead_instructions[i] += function_obj.overhead_pc_offsets.size();
+                recoverable_samples[i] += weights[i] * get_instruction_samples(samples_by_function[call_obj.callee], function_obj.overhead_pc_offsets);
+            }
+        }
+        std::sort(ranking.begin(), ranking.end(), [&](int a, int b)
+                  { return recoverable_samples[a] != recoverable_samples[b] ? recoverable_samples[a] > recoverable_samples[b]
+                                                                            : overhead_instructions[a] * (v_sass[a].loop_depth + 1) > overhead_instructions[b] * (v_sass[b].loop_depth + 1); });
+
+        double cycles = metric_map.count(k_sass) ? metric_map[k_sass].metrics_list.sm__cycles_elapsed : 0;
+        int rank = 0;
+        for (int i : ranking)
+        {
+            const device_call &index_sass = v_sass[i];
+            rank++;
+            double sample_share = kernel_samples > 0 ? recoverable_samples[i] / kernel_samples : 0;
+            double recoverable_cycles = sample_share * cycles;
+            bool important = index_sass.kind != "external" && (kernel_samples > 0 ? sample_share >= device_call_sample_share_threshold : index_sass.loop_depth > 0);
+
+            std::cout << (important ? "WARNING   ::  " : "INFO  ::  ") << "#" << rank << " " << (index_sass.kind == "indirect" ? "Indirect call" : "Call of " + index_sass.callee) << " at line number "
+                      << index_sass.line_number << " (pcOffset " << index_sass.pcOffset << ", " << index_sass.sass_instruction << ")" << (index_sass.loop_depth > 0 ? " in a loop" : "")
+                      << ": " << index_sass.argument_moves << " argument moves, " << index_sass.result_moves << " result moves";
+            const device_function *function_obj = index_sass.kind == "direct" ? &function_map[index_sass.callee] : nullptr;
+            if (function_obj != nullptr)
+            {
+                std::cout << "; the function (" << function_obj->instructions << " instructions, " << function_obj->call_sites << " call sites) saves " << function_obj->saved_registers
+                          << " and restores " << function_obj->restored_registers << " registers on the stack, with " << function_obj->stack_adjustments << " stack pointer adjustments";
+                if (function_obj->other_local_accesses > 0)
+                {
+                    std::cout << " and " << function_obj->other_local_accesses << " other local memory accesses";
+                }
+            }
+            std::cout << std::endl;
+
+            if (index_sass.kind == "direct")
+            {
+                std::cout << "Declaring the function __forceinline__ removes the call, the moves and the stack traffic, and lets the compiler optimize across the call "
+                          << "(it may need more registers). If it is defined in another translation unit (-rdc), link time optimization (-dlto) can inline it" << std::endl;
+            }
+            else if (index_sass.kind == "indirect")
+            {
+                std::cout << "Function pointers and virtual functions cannot be inlined, and every call saves the registers the callee may use. "
+                          << "If the targets are known, dispatch with a switch or a template parameter instead" << std::endl;
+            }
+            else
+            {
+                std::cout << "The called function (e.g. printf or malloc) has no SASS in the binary and cannot be inlined, avoid it in hot code" << std::endl;
+            }
+            if (recoverable_samples[i] > 0)
+            {
+                std::cout << "Inlining would recover about " << recoverable_samples[i] << " samples (" << 100 * sample_share << " % of the kernel including its calls)";
+                if (recoverable_cycles > 0)
+                {
+                    std::cout << ", estimated " << recoverable_cycles << " cycles";
+                }
+                std::cout << std::endl;
+            }
+            auto call_samples = samples_by_pc.find(std::stoi(index_sass.pcOffset, nullptr, 16));
+            if (call_samples != samples_by_pc.end())
+            {
+                print_stalls_percentage(call_samples->second);
+            }
+
+            kernel_result["occurrences"].push_back({
+                {"severity", important ? "WARNING" : "INFO"},
+                {"rank", rank},
+                {"kind", index_sass.kind},
+                {"callee", index_sass.callee},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.pcOffset},
+                {"loop_depth", index_sass.loop_depth},
+                {"loop_pc_offset", index_sass.loop_pcOffset},
+                {"argument_moves", index_sass.argument_moves},
+                {"result_moves", index_sass.result_moves},
+                {"callee_instructions", function_obj != nullptr ? function_obj->instructions : 0},
+                {"callee_call_sites", function_obj != nullptr ? function_obj->call_sites : 0},
+                {"saved_registers", function_obj != nullptr ? function_obj->saved_registers : 0},
+                {"restored_registers", function_obj != nullptr ? function_obj->restored_registers : 0},
+                {"stack_adjustments", function_obj != nullptr ? function_obj->stack_adjustments : 0},
+                {"overhead_instructions", overhead_instructions[i]},
+                {"samples", site_samples[i]},
+                {"recoverable_samples", recoverable_samples[i]},
+                {"sample_share", sample_share},
+                {"recoverable_cycles", recoverable_cycles}
+            });
+        }
+
+        std::cout << "INFO  ::  " << v_sass.size() << " calls of device functions" << std::endl;
+
+        // Map kernel with metrics collected
+        if (metric_map.count(k_sass))
+        {
+            std::cout << "INFO  ::  Elapsed cycles of the kernel: " << cycles << std::endl;
+            kernel_result["metrics"] = {
+                {"cycles", cycles}
+            };
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    auto device_call_tuple = profile_stage("device_call_analysis", [&] { return device_call_analysis(filename_hpctoolkit_sass); });
+    std::unordered_map<std::string, std::vector<device_call>> call_map = std::get<0>(device_call_tuple);
+    std::unordered_map<std::string, device_function> function_map = std::get<1>(device_call_tuple);
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::ALL); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_device_calls", [&] { return merge_analysis_device_calls(call_map, function_map, pc_stall_map, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/device_calls.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
@@ -0,0 +1,233 @@
+/**
+ * Merge analysis for the cost of double precision arithmetic
+ * SASS analysis - double precision instructions (DADD, DMUL, DFMA, DSETP, MUFU.RCP64H, F2F.F64, ...) of every innermost loop, operations on promoted floats and double literals
+ * PC Sampling analysis - pc stalls (all instructions of the loop) -> share of the kernel samples in the loop and on the double precision instructions
+ * Metric analysis - get metrics for entire kernel -> executed double and single precision operations
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_fp64.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Share of the kernel samples in the region below which it is only reported as INFO
+const double fp64_sample_share_threshold = 0.01;
+// Estimated speedup in single precision below which a region without promoted floats is only reported as INFO
+const double fp64_min_speedup = 1.2;
+
+/// @brief Single precision instructions executed per double precision instruction in the same time, from the NVIDIA architecture whitepapers and CUDA programming guide
+/// (GP100, V100, A100, H100 and B200 1:2; the GeForce, Quadro, T- and L-series and the embedded GPUs 1:32 or 1:64)
+double get_fp32_fp64_ratio(int sm_version)
+{
+    std::map<int, double> architectures = {{35, 3}, {50, 32}, {60, 2}, {61, 32}, {70, 2}, {72, 32}, {75, 32}, {80, 2}, {86, 64}, {90, 2}, {120, 64}};
+
+    // Unknown (newer) architectures use the ratio of the closest older one
+    auto architecture_it = architectures.upper_bound(sm_version);
+    if (architecture_it == architectures.begin())
+    {
+        return 32;
+    }
+    return std::prev(architecture_it)->second;
+}
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for double precision arithmetic
+/// @param region_map Innermost loops and code outside of loops with double precision instructions of every kernel
+/// @param sm_version SM version of the SASS
+/// @param pc_stall_map CUPTI warp stalls
+/// @param metric_map Metric analysis
+json merge_analysis_fp64(std::unordered_map<std::string, std::vector<fp64_region>> region_map, int sm_version, std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map,
+                         std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+    double ratio = get_fp32_fp64_ratio(sm_version);
+
+    for (auto [k_sass, v_sass] : region_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Double precision analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        if (v_sass.empty())
+        {
+            std::cout << "INFO  ::  No double precision instructions" << std::endl;
+            result[k_sass] = kernel_result;
+            continue;
+        }
+
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        int kernel_samples = 0;
+        for (const auto &j : pc_stall_map[k_sass])
+        {
+            kernel_samples += get_sample_count(j);
+        }
+
+        for (const auto &index_sass : v_sass)
+        {
+            // Issue time of the region in single precision instructions, before and after moving to single precision (the promotions and demotions disappear)
+            int other_instructions = index_sass.instructions - index_sass.fp64_instructions - index_sass.conversions;
+            double fp64_time = other_instructions + (index_sass.fp64_instructions + index_sass.conversions) * ratio;
+            double fp32_time = other_instructions + index_sass.fp64_instructions + index_sass.conversions - index_sass.promotions - index_sass.demotions;
+            double speedup = fp32_time > 0 ? fp64_time / fp32_time : 1;
+
+            int region_samples = 0, fp64_samples = 0;
+            const pc_issue_samples *hottest = nullptr;
+            for (const auto &pc_offset : index_sass.pc_offsets)
+            {
+                auto samples = samples_by_pc.find(std::stoi(pc_offset, nullptr, 16));
+                region_samples += samples != samples_by_pc.end() ? get_sample_count(samples->second) : 0;
+            }
+            for (const auto &pc_offset : index_sass.fp64_pc_offsets)
+            {
+                auto samples = samples_by_pc.find(std::stoi(pc_offset, nullptr, 16));
+                if (samples != samples_by_pc.end())
+                {
+                    fp64_samples += get_sample_count(samples->second);
+                    hottest = hottest == nullptr || get_sample_count(samples->second) > get_sample_count(*hottest) ? &samples->second : hottest;
+                }
+            }
+            double sample_share = kernel_samples > 0 ? (double)region_samples / kernel_samples : 0;
+            bool hot = kernel_samples == 0 || sample_share >= fp64_sample_share_threshold;
+            bool loop = !index_sass.start_pcOffset.empty();
+            bool important = loop && hot && (speedup >= fp64_min_speedup || index_sass.promoted_operations > 0);
+
+            std::cout << (important ? "WARNING   ::  " : "INFO  ::  ");
+            if (loop)
+            {
+                std::cout << "The loop starting at line number " << index_sass.line_number << " (pcOffset " << index_sass.start_pcOffset << " to " << index_sass.end_pcOffset << ", loop depth "
+                          << index_sass.loop_depth << ")";
+            }
+            else
+            {
+                std::cout << "The code outside of loops (first at line number " << index_sass.line_number << ")";
+            }
+            std::cout << " executes " << index_sass.fp64_instructions << " double precision instructions (";
+            for (auto it = index_sass.fp64_count.begin(); it != index_sass.fp64_count.end(); it++)
+            {
+                std::cout << (it == index_sass.fp64_count.begin() ? "" : ", ") << it->second << " " << it->first;
+            }
+            std::cout << ") and " << index_sass.conversions << " conversions from or to double of " << index_sass.instructions << " instructions" << std::endl;
+            std::cout << "sm_" << sm_version << " executes double precision at 1/" << ratio << " of the single precision throughput, estimated speedup in single precision: " << speedup
+                      << "x (if the region is bound by the instruction throughput)" << std::endl;
+            if (index_sass.promoted_operations > 0)
+            {
+                std::cout << index_sass.promotions << " floats are promoted to double (F2F.F64.F32) and " << index_sass.demotions << " results converted back to float (F2F.F32.F64); "
+                          << index_sass.promoted_operations << " double precision instructions compute with promoted floats and " << index_sass.literal_operations << " with double literals. "
+                          << "This is usually unintended: write float literals with an f suffix (0.5f instead of 0.5) and use the float math functions (sqrtf, expf, fabsf)" << std::endl;
+            }
+            else if (speedup >= fp64_min_speedup)
+            {
+                std::cout << "If single precision is accurate enough, use float for the variables of the region, or keep only the accumulators in double" << std::endl;
+            }
+            if (region_samples > 0)
+            {
+                std::cout << "The " << (loop ? "loop" : "code") << " has " << region_samples << " samples (" << 100 * sample_share << " % of the kernel), " << fp64_samples
+                          << " of them on the double precision instructions" << std::endl;
+            }
+            if (hottest != nullptr)
+            {
+                print_stalls_percentage(*hottest);
+            }
+
+            kernel_result["occurrences"].push_back({
+                {"severity", important ? "WARNING" : "INFO"},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.start_pcOffset},
+                {"end_pc_offset", index_sass.end_pcOffset},
+                {"loop_depth", index_sass.loop_depth},
+                {"instructions", index_sass.instructions},
+                {"fp64_count", index_sass.fp64_count},
+                {"fp64_instructions", index_sass.fp64_instructions},
+                {"conversions", index_sass.conversions},
+                {"promotions", index_sass.promotions},
+                {"demotions", index_sass.demotions},
+                {"promoted_operations", index_sass.promoted_operations},
+                {"literal_operations", index_sass.literal_operations},
+                {"fp32_fp64_ratio", ratio},
+                {"estimated_speedup", speedup},
+                {"samples", region_samples},
+                {"fp64_samples", fp64_samples},
+                {"sample_share", sample_share}
+            });
+        }
+
+        // Map kernel with metrics collected
+        if (metric_map.count(k_sass))
+        {
+            const cuda_metrics &m = metric_map[k_sass].metrics_list;
+            double fp64_operations = m.smsp__sass_thread_inst_executed_op_dadd_pred_on + m.smsp__sass_thread_inst_executed_op_dmul_pred_on + m.smsp__sass_thread_inst_executed_op_dfma_pred_on;
+            double fp32_operations = m.smsp__sass_thread_inst_executed_op_fadd_pred_on + m.smsp__sass_thread_inst_executed_op_fmul_pred_on + m.smsp__sass_thread_inst_executed_op_ffma_pred_on;
+            std::cout << "INFO  ::  Executed double precision operations (DADD, DMUL, DFMA): " << fp64_operations << ", single precision operations (FADD, FMUL, FFMA): " << fp32_operations << std::endl;
+            kernel_result["metrics"] = {
+                {"fp64_operations", fp64_operations},
+                {"fp32_operations", fp32_operations}
+            };
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    auto fp64_tuple = profile_stage("fp64_analysis", [&] { return fp64_analysis(filename_hpctoolkit_sass); });
+    std::unordered_map<std::string, std::vector<fp64_region>> region_map = std::get<0>(fp64_tuple);
+    int sm_version = std::get<1>(fp64_tuple);
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::ALL); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_fp64", [&] { return merge_analysis_fp64(region_map, sm_version, pc_stall_map, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/fp64.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
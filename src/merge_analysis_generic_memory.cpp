@@ -0,0 +1,221 @@
+/**
+ * Merge analysis for generic memory accesses
+ * SASS analysis - generic loads, stores and atomics (instruction LD, ST, ATOM) -> origin of the pointer (shared or local window, kernel parameter, loaded from memory, argument of a device function)
+ * PC Sampling analysis - pc stalls (the generic access) -> samples of the access and share of the kernel samples
+ * Metric analysis - get metrics for entire kernel -> executed global and shared loads and stores
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_generic_memory.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Share of the kernel samples on a generic access from which it is reported as WARNING
+const double generic_access_sample_share_threshold = 0.01;
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Specialized instruction for a generic access to the address space, e.g. LDS for LD to shared memory
+std::string get_specialized_opcode(const std::string &opcode, const std::string &space)
+{
+    if (space == "shared")
+        return opcode == "LD" ? "LDS" : opcode == "ST" ? "STS" : "ATOMS";
+    if (space == "local")
+        return opcode == "LD" ? "LDL" : opcode == "ST" ? "STL" : "";
+    if (space == "global")
+        return opcode == "LD" ? "LDG" : opcode == "ST" ? "STG" : "ATOMG";
+    return "";
+}
+
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for generic memory accesses
+/// @param access_map Generic memory accesses of every kernel
+/// @param pc_stall_map CUPTI warp stalls
+/// @param metric_map Metric analysis
+json merge_analysis_generic_memory(std::unordered_map<std::string, std::vector<generic_access>> access_map, std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map,
+                                   std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+
+    for (auto [k_sass, v_sass] : access_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Generic memory access analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        if (v_sass.empty())
+        {
+            std::cout << "INFO  ::  No generic loads, stores or atomics" << std::endl;
+            result[k_sass] = kernel_result;
+            continue;
+        }
+
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        int kernel_samples = 0;
+        for (const auto &j : pc_stall_map[k_sass])
+        {
+            kernel_samples += get_sample_count(j);
+        }
+
+        std::map<std::string, int> origin_count;
+        for (const auto &index_sass : v_sass)
+        {
+            origin_count[index_sass.origin]++;
+            auto samples = samples_by_pc.find(std::stoi(index_sass.pcOffset, nullptr, 16));
+            int sample_count = samples != samples_by_pc.end() ? get_sample_count(samples->second) : 0;
+            double sample_share = kernel_samples > 0 ? (double)sample_count / kernel_samples : 0;
+            std::string specialized = get_specialized_opcode(index_sass.opcode, index_sass.origin);
+            bool important = !specialized.empty() && (kernel_samples == 0 || sample_share >= generic_access_sample_share_threshold);
+
+            std::cout << (important ? "WARNING   ::  " : "INFO  ::  ") << "Generic " << (index_sass.opcode == "LD" ? "load" : index_sass.opcode == "ST" ? "store" : "atomic") << " at line number "
+                      << index_sass.line_number << " (pcOffset " << index_sass.pcOffset << ", " << index_sass.sass_instruction << ")";
+            if (!specialized.empty())
+            {
+                std::cout << " accesses " << index_sass.origin << " memory: the pointer comes from " << (index_sass.origin == "global" ? "a kernel parameter" : "the " + index_sass.origin + " window")
+                          << " (pcOffset " << index_sass.origin_pcOffset << (index_sass.origin_function != k_sass ? " in " + index_sass.origin_function : "") << ")" << std::endl;
+                std::cout << "The address space is resolved at runtime for every access, and the compiler cannot use the optimizations of " << specialized;
+                if (index_sass.origin == "global")
+                {
+                    std::cout << " (e.g. the read-only cache)";
+                }
+                std::cout << ". ";
+                if (index_sass.origin_function != k_sass)
+                {
+                    std::cout << "The pointer is passed to a device function: inline it (__forceinline__), or access the " << index_sass.origin << " memory in the caller";
+                }
+                else
+                {
+                    std::cout << "The pointer is converted to a generic one, e.g. by a cast, a pointer selected between address spaces or a pointer stored in a struct: "
+                              << "access the " << (index_sass.origin == "shared" ? "__shared__ array" : index_sass.origin == "local" ? "local array" : "kernel parameter") << " directly";
+                }
+                if (index_sass.origin == "shared")
+                {
+                    std::cout << ", or make the address space explicit with __cvta_generic_to_shared";
+                }
+                std::cout << " so that " << specialized << " is used" << std::endl;
+            }
+            else if (index_sass.origin == "mixed")
+            {
+                std::cout << ": the pointer may point to different address spaces, e.g. shared or global memory depending on a condition. "
+                          << "Separate code paths (e.g. a template parameter for the address space) allow specialized accesses" << std::endl;
+            }
+            else if (index_sass.origin == "loaded")
+            {
+                std::cout << ": the pointer is loaded from memory (pcOffset " << index_sass.origin_pcOffset << "), its address space is unknown at compile time. "
+                          << "If it always points to global memory, pass it as kernel parameter or convert it with __cvta_generic_to_global" << std::endl;
+            }
+            else if (index_sass.origin == "argument")
+            {
+                std::cout << ": the pointer is an argument of " << index_sass.origin_function << ", which is not called in the SASS of the binary (e.g. only with -rdc)" << std::endl;
+            }
+            else
+            {
+                std::cout << ": the origin of the pointer is unknown" << std::endl;
+            }
+
+            if (sample_count > 0)
+            {
+                std::cout << "The access has " << sample_count << " samples (" << 100 * sample_share << " % of the kernel)" << std::endl;
+                print_stalls_percentage(samples->second);
+            }
+
+            kernel_result["occurrences"].push_back({
+                {"severity", important ? "WARNING" : "INFO"},
+                {"opcode", index_sass.opcode},
+                {"origin", index_sass.origin},
+                {"origin_pc_offset", index_sass.origin_pcOffset},
+                {"origin_function", index_sass.origin_function},
+                {"specialized_opcode", specialized},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.pcOffset},
+                {"loop_depth", index_sass.loop_depth},
+                {"access_bytes", index_sass.access_bytes},
+                {"samples", sample_count},
+                {"sample_share", sample_share}
+            });
+        }
+
+        std::cout << "INFO  ::  " << v_sass.size() << " generic accesses:";
+        for (const auto &[origin, count] : origin_count)
+        {
+            std::cout << " " << count << " " << origin;
+        }
+        std::cout << std::endl;
+
+        // Map kernel with metrics collected
+        if (metric_map.count(k_sass))
+        {
+            const cuda_metrics &m = metric_map[k_sass].metrics_list;
+            std::cout << "INFO  ::  Executed global loads: " << m.sm__sass_inst_executed_op_global_ld << ", global stores: " << m.sm__sass_inst_executed_op_global_st
+                      << ", shared loads: " << m.sm__sass_inst_executed_op_shared_ld << ", shared stores: " << m.sm__sass_inst_executed_op_shared_st << std::endl;
+            kernel_result["metrics"] = {
+                {"global_ld", m.sm__sass_inst_executed_op_global_ld},
+                {"global_st", m.sm__sass_inst_executed_op_global_st},
+                {"shared_ld", m.sm__sass_inst_executed_op_shared_ld},
+                {"shared_st", m.sm__sass_inst_executed_op_shared_st}
+            };
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    std::unordered_map<std::string, std::vector<generic_access>> access_map = profile_stage("generic_memory_analysis", [&] { return generic_memory_analysis(filename_hpctoolkit_sass); });
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::ALL); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_generic_memory", [&] { return merge_analysis_generic_memory(access_map, pc_stall_map, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/generic_memory.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
@@ -11,6 +11,7 @@
 #include "parser_pcsampling.hpp"
 #include "parser_metrics.hpp"
 #include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
 #include <cstring>
 #include <iostream>
 
@@ -197,20 +198,20 @@ int main(int argc, char **argv)
 {
     std::string filename_hpctoolkit_sass = argv[1];
     std::string filename_ptx = argv[3];
-    auto atomics_analysis_tuple = global_mem_atomics_analysis(filename_ptx);
+    auto atomics_analysis_tuple = profile_stage("global_mem_atomics_analysis", [&] { return global_mem_atomics_analysis(filename_ptx); });
     std::unordered_map<std::string, atomic_counter> ptx_atomic_map = std::get<0>(atomics_analysis_tuple);
     std::unordered_map<std::string, std::vector<branch_counter>> branch_map = std::get<1>(atomics_analysis_tuple);
 
     std::string filename_sampling = argv[4];
-    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::ATOMICS_GLOBAL);
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::ATOMICS_GLOBAL); });
 
     std::string filename_metrics = argv[5];
-    std::unordered_map<std::string, kernel_metrics> metric_map = create_metrics(filename_metrics);
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
 
     int save_as_json = std::strcmp(argv[6], "true") == 0;
     std::string json_output_dir = argv[7];
 
-    json result = merge_analysis_global_shared_atomic(ptx_atomic_map, branch_map, pc_stall_map, metric_map);
+    json result = profile_stage("merge_analysis_global_shared_atomic", [&] { return merge_analysis_global_shared_atomic(ptx_atomic_map, branch_map, pc_stall_map, metric_map); });
 
     if (save_as_json)
     {
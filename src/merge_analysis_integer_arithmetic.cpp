@@ -0,0 +1,275 @@
+/**
+ * Merge analysis for expensive integer arithmetic
+ * SASS analysis - integer division and modulo by a variable (I2F.RP, MUFU.RCP, IMAD.HI sequences, __cuda_sm20_div/rem subroutines), 64 bit index arithmetic (ISETP.EX, SHF.U64, LEA.HI.X, IMAD.WIDE.U32)
+ * PC Sampling analysis - pc stalls (all instructions) -> samples of the division sequences and the 64 bit instructions, share of the kernel samples
+ * Metric analysis - get metrics for entire kernel -> executed instructions, short scoreboard stalls
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_integer_arithmetic.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Share of the kernel samples from which an occurrence in a loop is reported as WARNING
+const double integer_arithmetic_sample_share_threshold = 0.01;
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Samples of the instructions
+/// @param samples_by_pc Samples of the kernel by pcOffset
+/// @param pc_offsets pcOffsets of the instructions
+/// @param hottest Samples of the instruction with the most samples, nullptr if there are none
+int get_instruction_samples(const std::unordered_map<int, pc_issue_samples> &samples_by_pc, const std::vector<std::string> &pc_offsets, const pc_issue_samples *&hottest)
+{
+    int samples = 0, hottest_samples = 0;
+    hottest = nullptr;
+    for (const auto &pc_offset : pc_offsets)
+    {
+        auto pc_samples = samples_by_pc.find(std::stoi(pc_offset, nullptr, 16));
+        if (pc_samples != samples_by_pc.end())
+        {
+            int count = get_sample_count(pc_samples->second);
+            samples += count;
+            if (count > hottest_samples)
+            {
+                hottest_samples = count;
+                hottest = &pc_samples->second;
+            }
+        }
+    }
+    return samples;
+}
+
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for integer divisions and 64 bit index arithmetic
+/// @param division_map Integer divisions of every kernel
+/// @param wide_index_map 64 bit index arithmetic of every kernel
+/// @param pc_stall_map CUPTI warp stalls
+/// @param metric_map Metric analysis
+json merge_analysis_integer_arithmetic(std::unordered_map<std::string, std::vector<integer_division>> division_map,
+                                       std::unordered_map<std::string, std::vector<wide_index_arithmetic>> wide_index_map,
+                                       std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map, std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+
+    for (auto [k_sass, v_sass] : division_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Integer arithmetic analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        const std::vector<wide_index_arithmetic> &wide_index_vec = wide_index_map[k_sass];
+        if (v_sass.empty() && wide_index_vec.empty())
+        {
+            std::cout << "INFO  ::  No integer division or modulo by a variable and no 64 bit index arithmetic" << std::endl;
+            result[k_sass] = kernel_result;
+            continue;
+        }
+
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        int kernel_samples = 0;
+        for (const auto &j : pc_stall_map[k_sass])
+        {
+            kernel_samples += get_sample_count(j);
+        }
+
+        // The instructions of a division subroutine are shared by all its calls, its samples are split evenly between them and counted once in the total
+        std::set<std::string> counted_pc_offsets;
+        std::map<std::string, int> subroutine_calls;
+        for (const auto &index_sass : v_sass)
+        {
+            counted_pc_offsets.insert(index_sass.pc_offsets.begin(), index_sass.pc_offsets.end());
+            if (index_sass.divisor.empty())
+            {
+                subroutine_calls[index_sass.kind]++;
+            }
+        }
+
+        for (const auto &index_sass : v_sass)
+        {
+            const pc_issue_samples *hottest = nullptr;
+            int sample_count = get_instruction_samples(samples_by_pc, index_sass.pc_offsets, hottest);
+            if (index_sass.divisor.empty() && subroutine_calls[index_sass.kind] > 1)
+            {
+                const pc_issue_samples *hottest_call = nullptr;
+                int call_samples = get_instruction_samples(samples_by_pc, {index_sass.pc_offsets.front()}, hottest_call);
+                sample_count = call_samples + (sample_count - call_samples) / subroutine_calls[index_sass.kind];
+            }
+            double sample_share = kernel_samples > 0 ? (double)sample_count / kernel_samples : 0;
+            bool subroutine = index_sass.divisor.empty();
+            bool important = index_sass.loop_depth > 0 && (kernel_samples == 0 || sample_share >= integer_arithmetic_sample_share_threshold);
+
+            std::cout << (important ? "WARNING   ::  " : "INFO  ::  ") << "Integer division or modulo by a variable at line number " << index_sass.line_number << " (pcOffset " << index_sass.pcOffset << ", "
+                      << index_sass.sass_instruction << ")";
+            if (index_sass.loop_depth > 0)
+            {
+                std::cout << " at loop depth " << index_sass.loop_depth;
+            }
+            if (subroutine)
+            {
+                std::cout << ": the 64 bit operation calls the subroutine " << index_sass.kind << " with " << index_sass.pc_offsets.size() - 1 << " instructions" << std::endl;
+                std::cout << "Use 32 bit operands if the values fit, the inline 32 bit sequence is several times shorter" << std::endl;
+            }
+            else
+            {
+                std::cout << ": the " << index_sass.kind << " division of the divisor " << index_sass.divisor << " takes " << index_sass.pc_offsets.size()
+                          << " instructions (I2F, MUFU.RCP, IMAD.HI and corrections) instead of one" << std::endl;
+                if (index_sass.divisor_loop_invariant && index_sass.loop_depth > 0)
+                {
+                    std::cout << "The divisor does not change in the loop: compute its reciprocal (magic number and shift, e.g. a fast divmod) once before the loop and replace the division by IMAD.HI and a shift";
+                }
+                else if (index_sass.divisor_uniform)
+                {
+                    std::cout << "The divisor is the same for all threads: precompute its reciprocal (magic number and shift) on the host and pass it as a kernel parameter";
+                }
+                else
+                {
+                    std::cout << "The divisor differs between the threads: avoid the division where possible, e.g. by counting the quotient and remainder incrementally";
+                }
+                std::cout << ". If the divisor is a power of two, pass its logarithm and use x >> log2 and x & (divisor - 1), or make it a compile-time constant" << std::endl;
+            }
+            if (sample_count > 0)
+            {
+                std::cout << "The instructions have " << sample_count << " samples (" << 100 * sample_share << " % of the kernel)"
+                          << (subroutine && subroutine_calls[index_sass.kind] > 1 ? ", the samples of the subroutine are split between its " + std::to_string(subroutine_calls[index_sass.kind]) + " calls" : "")
+                          << std::endl;
+                print_stalls_percentage(*hottest);
+            }
+
+            kernel_result["occurrences"].push_back({
+                {"severity", important ? "WARNING" : "INFO"},
+                {"type", "division"},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.pcOffset},
+                {"kind", index_sass.kind},
+                {"loop_depth", index_sass.loop_depth},
+                {"divisor", index_sass.divisor},
+                {"divisor_uniform", index_sass.divisor_uniform},
+                {"divisor_loop_invariant", index_sass.divisor_loop_invariant},
+                {"instructions", index_sass.pc_offsets.size()},
+                {"samples", sample_count},
+                {"sample_share", sample_share}
+            });
+        }
+
+        for (const auto &index_sass : wide_index_vec)
+        {
+            const pc_issue_samples *hottest = nullptr;
+            int sample_count = get_instruction_samples(samples_by_pc, index_sass.pc_offsets, hottest);
+            counted_pc_offsets.insert(index_sass.pc_offsets.begin(), index_sass.pc_offsets.end());
+            double sample_share = kernel_samples > 0 ? (double)sample_count / kernel_samples : 0;
+            bool important = index_sass.loop_depth > 0 && (kernel_samples == 0 || sample_share >= integer_arithmetic_sample_share_threshold);
+
+            std::cout << (important ? "WARNING   ::  " : "INFO  ::  ") << "64 bit index arithmetic at line number " << index_sass.line_number << " (pcOffset " << index_sass.pcOffset << ")";
+            if (index_sass.loop_depth > 0)
+            {
+                std::cout << " in the loop at pcOffset " << index_sass.loop_pcOffset << " (loop depth " << index_sass.loop_depth << ")";
+            }
+            std::cout << ": " << index_sass.comparisons << " 64 bit comparisons, " << index_sass.index_instructions << " 64 bit shifts, scaled additions or multiplications and "
+                      << index_sass.carry_instructions << " additions of the upper 32 bits" << std::endl;
+            std::cout << "Every 64 bit integer operation takes two or more instructions. If the indices and bounds fit into 32 bits, use int (or unsigned) for them and only add the final offset to the pointer, "
+                      << "e.g. a 32 bit loop counter with a size_t bound converted once before the loop" << std::endl;
+            if (sample_count > 0)
+            {
+                std::cout << "The instructions have " << sample_count << " samples (" << 100 * sample_share << " % of the kernel)" << std::endl;
+                print_stalls_percentage(*hottest);
+            }
+
+            kernel_result["occurrences"].push_back({
+                {"severity", important ? "WARNING" : "INFO"},
+                {"type", "wide_index"},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.pcOffset},
+                {"loop_depth", index_sass.loop_depth},
+                {"loop_pc_offset", index_sass.loop_pcOffset},
+                {"comparisons", index_sass.comparisons},
+                {"index_instructions", index_sass.index_instructions},
+                {"carry_instructions", index_sass.carry_instructions},
+                {"instructions", index_sass.pc_offsets.size()},
+                {"samples", sample_count},
+                {"sample_share", sample_share}
+            });
+        }
+
+        const pc_issue_samples *hottest = nullptr;
+        int total_samples = get_instruction_samples(samples_by_pc, std::vector<std::string>(counted_pc_offsets.begin(), counted_pc_offsets.end()), hottest);
+        std::cout << "INFO  ::  " << v_sass.size() << " integer divisions and " << wide_index_vec.size() << " lines with 64 bit index arithmetic with " << total_samples << " samples ("
+                  << (kernel_samples > 0 ? 100.0 * total_samples / kernel_samples : 0) << " % of the kernel)" << std::endl;
+
+        // Map kernel with metrics collected
+        if (metric_map.count(k_sass))
+        {
+            const cuda_metrics &m = metric_map[k_sass].metrics_list;
+            std::cout << "INFO  ::  Executed instructions: " << m.smsp__sass_inst_executed << ", short scoreboard stalls (MUFU): " << m.smsp__warp_issue_stalled_short_scoreboard_per_warp_active
+                      << " % per warp active" << std::endl;
+            kernel_result["metrics"] = {
+                {"inst_executed", m.smsp__sass_inst_executed},
+                {"short_scoreboard_perc", m.smsp__warp_issue_stalled_short_scoreboard_per_warp_active}
+            };
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    auto integer_arithmetic_tuple = profile_stage("integer_arithmetic_analysis", [&] { return integer_arithmetic_analysis(filename_hpctoolkit_sass); });
+    std::unordered_map<std::string, std::vector<integer_division>> division_map = std::get<0>(integer_arithmetic_tuple);
+    std::unordered_map<std::string, std::vector<wide_index_arithmetic>> wide_index_map = std::get<1>(integer_arithmetic_tuple);
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::ALL); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_integer_arithmetic", [&] { return merge_analysis_integer_arithmetic(division_map, wide_index_map, pc_stall_map, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/integer_arithmetic.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+/**
+ * Merge analysis for the variability of the warp stalls between kernel launches
+ * SASS analysis - N/A
+ * PC Sampling analysis - pc stalls per launch bucket (continuous mode, flushed at every launch) -> stall profile of every bucket
+ * Metric analysis - N/A
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_pcsampling.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+#include <cmath>
+#include <map>
+
+using json = nlohmann::json;
+
+// Stall profiles further apart than this (total variation distance) are reported as a warning
+const double variability_warning_threshold = 0.2;
+
+/// @brief Stall profile of one kernel in one launch bucket
+struct bucket_profile
+{
+    std::string context_id;
+    int bucket;
+    long first_launch_id;
+    long last_launch_id;
+    int total_samples;
+    std::map<std::string, double> stall_fraction;
+};
+
+/// @brief Name of the launch bucket in the output, with its context if the launches of several contexts were sampled
+std::string get_bucket_name(const bucket_profile &profile)
+{
+    return "Launch bucket " + std::to_string(profile.bucket) + (profile.context_id.empty() ? "" : " of context " + profile.context_id);
+}
+
+/// @brief Merge analysis (CUPTI) comparing the stall profiles of the launch buckets of every kernel
+/// @param buckets CUPTI warp stalls per launch bucket
+json merge_analysis_launch_variability(const std::vector<launch_bucket_stalls> &buckets)
+{
+    json result;
+
+    // kernel -> profiles of the buckets in which the kernel was sampled
+    std::map<std::string, std::vector<bucket_profile>> kernel_profiles;
+    for (const auto &bucket : buckets)
+    {
+        for (const auto &[kernel, stalls] : bucket.kernel_stalls)
+        {
+            bucket_profile profile = {bucket.context_id, bucket.bucket, bucket.first_launch_id, bucket.last_launch_id, 0, {}};
+            for (const auto &[stall, samples] : stalls)
+            {
+                profile.total_samples += samples;
+            }
+            for (const auto &[stall, samples] : stalls)
+            {
+                profile.stall_fraction[stall] = profile.total_samples ? (1.0 * samples) / profile.total_samples : 0;
+            }
+            kernel_profiles[kernel].push_back(profile);
+        }
+    }
+
+    for (const auto &[k_sampling, profiles] : kernel_profiles)
+    {
+        json kernel_result = {
+            {"buckets", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sampling == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Launch variability analysis for kernel: " << k_sampling << "   --------------------- " << std::endl;
+
+        // Average profile over all buckets, every bucket weighted equally
+        std::map<std::string, double> mean_fraction;
+        double mean_samples = 0;
+        for (const auto &profile : profiles)
+        {
+            mean_samples += profile.total_samples;
+            for (const auto &[stall, fraction] : profile.stall_fraction)
+            {
+                mean_fraction[stall] += fraction / profiles.size();
+            }
+        }
+        mean_samples /= profiles.size();
+
+        double samples_variance = 0;
+        double max_distance = 0, mean_distance = 0;
+        const bucket_profile *most_different = &profiles.front();
+        for (const auto &profile : profiles)
+        {
+            samples_variance += std::pow(profile.total_samples - mean_samples, 2) / profiles.size();
+
+            double distance = profile_distance(profile.stall_fraction, mean_fraction);
+            mean_distance += distance / profiles.size();
+            if (distance > max_distance)
+            {
+                max_distance = distance;
+                most_different = &profile;
+            }
+
+            auto top_stall = std::max_element(profile.stall_fraction.begin(), profile.stall_fraction.end(), [](const auto &lhs, const auto &rhs) { return lhs.second < rhs.second; });
+            std::cout << "INFO  ::  " << get_bucket_name(profile) << " (launches " << profile.first_launch_id << "-" << profile.last_launch_id << "): "
+                      << profile.total_samples << " samples";
+            if (top_stall != profile.stall_fraction.end())
+            {
+                std::cout << ", mostly " << top_stall->first << " (" << 100.0 * top_stall->second << " %)";
+            }
+            std::cout << ", distance to the average profile: " << 100.0 * distance << " %" << std::endl;
+
+            kernel_result["buckets"].push_back({
+                {"context_id", profile.context_id},
+                {"bucket", profile.bucket},
+                {"first_launch_id", profile.first_launch_id},
+                {"last_launch_id", profile.last_launch_id},
+                {"total_samples", profile.total_samples},
+                {"stall_fraction", profile.stall_fraction},
+                {"distance_to_mean", distance}
+            });
+        }
+
+        // Spread of every stall reason over the buckets
+        json stall_spread;
+        for (const auto &[stall, mean] : mean_fraction)
+        {
+            double variance = 0, min = 1, max = 0;
+            for (const auto &profile : profiles)
+            {
+                auto it = profile.stall_fraction.find(stall);
+                double fraction = (it != profile.stall_fraction.end()) ? it->second : 0;
+                variance += std::pow(fraction - mean, 2) / profiles.size();
+                min = std::min(min, fraction);
+                max = std::max(max, fraction);
+            }
+            stall_spread[stall] = {
+                {"mean", mean},
+                {"stddev", std::sqrt(variance)},
+                {"min", min},
+                {"max", max}
+            };
+        }
+
+        double samples_cv = mean_samples > 0 ? std::sqrt(samples_variance) / mean_samples : 0;
+        if (profiles.size() < 2)
+        {
+            std::cout << "INFO  ::  Only one launch bucket was sampled, nothing to compare" << std::endl;
+        }
+        else if (max_distance > variability_warning_threshold)
+        {
+            std::cout << "WARNING   ::  The stall profile changes between launches. " << get_bucket_name(*most_different)
+                      << " (launches " << most_different->first_launch_id << "-" << most_different->last_launch_id << ") differs by "
+                      << 100.0 * max_distance << " % from the average profile (mean difference " << 100.0 * mean_distance << " %)." << std::endl;
+            for (const auto &[stall, mean] : mean_fraction)
+            {
+                auto it = most_different->stall_fraction.find(stall);
+                double fraction = (it != most_different->stall_fraction.end()) ? it->second : 0;
+                if (std::abs(fraction - mean) > variability_warning_threshold / 2)
+                {
+                    std::cout << "              " << stall << ": " << 100.0 * fraction << " % in this bucket vs. " << 100.0 * mean << " % on average" << std::endl;
+                }
+            }
+        }
+        else
+        {
+            std::cout << "INFO  ::  The stall profile is stable between launches (largest difference " << 100.0 * max_distance << " %)" << std::endl;
+        }
+        std::cout << "INFO  ::  Samples per launch bucket vary by " << 100.0 * samples_cv << " % (coefficient of variation)" << std::endl;
+
+        kernel_result["metrics"] = {
+            {"bucket_count", profiles.size()},
+            {"max_distance", max_distance},
+            {"mean_distance", mean_distance},
+            {"most_different_bucket", most_different->bucket},
+            {"most_different_context_id", most_different->context_id},
+            {"samples_coefficient_of_variation", samples_cv},
+            {"stall_spread", stall_spread}
+        };
+
+        result[k_sampling] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    std::string filename_launch_sampling = argv[8];
+    std::vector<launch_bucket_stalls> buckets = profile_stage("get_launch_bucket_stalls", [&] { return get_launch_bucket_stalls(filename_launch_sampling); });
+
+    json result = profile_stage("merge_analysis_launch_variability", [&] { return merge_analysis_launch_variability(buckets); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/launch_variability.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
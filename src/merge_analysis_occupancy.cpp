@@ -0,0 +1,359 @@
+/**
+ * Merge analysis for the theoretical occupancy of every kernel
+ * SASS analysis - allocated registers, static shared memory and live registers of every instruction
+ * PC Sampling analysis - N/A
+ * Metric analysis - launch configuration, dynamic shared memory, device limits and achieved occupancy
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_liveregisters.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+#include <map>
+
+using json = nlohmann::json;
+
+// Part of the peak of live registers, above which instructions belong to the peak register pressure region
+const double register_pressure_peak_ratio = 0.95;
+
+/// @brief Per-SM limits of an architecture, which bound the number of resident blocks
+struct occupancy_limits
+{
+    int max_warps;
+    int max_blocks;
+    int max_registers;
+    int max_shared;             // bytes of shared memory per SM usable by blocks
+    int register_granularity;   // registers are allocated per warp in units of this many registers
+    int warp_granularity;       // the register file is split between the SM sub-partitions, warps get registers in groups of this many
+    int shared_granularity;     // bytes, shared memory is allocated per block in units of this size
+    int reserved_shared;        // bytes of shared memory reserved by the system for every block
+};
+
+/// @brief The occupancy of a kernel and the limit of every resource
+struct kernel_occupancy
+{
+    int block_size;
+    int grid_size;
+    int registers;
+    int shared_per_block;
+    int warps_per_block;
+    std::map<std::string, int> block_limits; // resident blocks per SM allowed by every resource
+    int blocks_per_sm;
+    double theoretical_occupancy; // in %
+    std::vector<std::string> limiting_resources;
+};
+
+/// @brief Get the SM version of the SASS, e.g. 80 for EF_CUDA_SM80
+int get_sm_version(const std::string &filename)
+{
+    std::string line;
+    std::fstream file(filename, std::ios::in);
+    while (std::getline(file, line))
+    {
+        size_t position = line.find("EF_CUDA_SM");
+        if (position != std::string::npos)
+        {
+            return std::atoi(line.c_str() + position + 10);
+        }
+    }
+    return 0;
+}
+
+/// @brief Limits of the architecture, from the CUDA occupancy calculator
+occupancy_limits get_occupancy_limits(int sm_version)
+{
+    // max warps, max blocks, max shared memory (KB) per SM
+    std::map<int, std::tuple<int, int, int>> architectures = {
+        {60, {64, 32, 64}}, {61, {64, 32, 96}}, {62, {64, 32, 64}}, {70, {64, 32, 96}}, {72, {64, 32, 96}}, {75, {32, 16, 64}},
+        {80, {64, 32, 164}}, {86, {48, 16, 100}}, {87, {48, 16, 164}}, {89, {48, 24, 100}}, {90, {64, 32, 228}}};
+
+    // Unknown (newer) architectures use the limits of the closest older one
+    auto architecture_it = architectures.upper_bound(sm_version);
+    if (architecture_it != architectures.begin())
+    {
+        architecture_it--;
+    }
+    auto [max_warps, max_blocks, max_shared_kb] = architecture_it->second;
+
+    occupancy_limits limits = {max_warps, max_blocks, 65536, max_shared_kb * 1024, 256, 4, 256, 0};
+    if (sm_version >= 80)
+    {
+        limits.shared_granularity = 128;
+        limits.reserved_shared = 1024;
+    }
+    return limits;
+}
+
+/// @brief Number of resident blocks per SM allowed by the registers, like the occupancy calculator of Nsight Compute
+/// The registers of a warp are rounded up to the allocation unit, the warps which fit into the register file down to the warp allocation granularity
+int get_register_block_limit(int registers, int warps_per_block, const occupancy_limits &limits)
+{
+    if (registers == 0)
+    {
+        return limits.max_blocks;
+    }
+    int registers_per_warp = (registers * 32 + limits.register_granularity - 1) / limits.register_granularity * limits.register_granularity;
+    int warps_per_sm = limits.max_registers / registers_per_warp / limits.warp_granularity * limits.warp_granularity;
+    return warps_per_sm / warps_per_block;
+}
+
+/// @brief Compute the theoretical occupancy of a kernel
+kernel_occupancy get_occupancy(int block_size, int grid_size, int registers, int shared_per_block, const occupancy_limits &limits)
+{
+    kernel_occupancy occupancy = {};
+    occupancy.block_size = block_size;
+    occupancy.grid_size = grid_size;
+    occupancy.registers = registers;
+    occupancy.shared_per_block = shared_per_block;
+    occupancy.warps_per_block = (block_size + 31) / 32;
+
+    int allocated_shared = shared_per_block + limits.reserved_shared;
+    allocated_shared = (allocated_shared + limits.shared_granularity - 1) / limits.shared_granularity * limits.shared_granularity;
+
+    occupancy.block_limits["warps"] = limits.max_warps / occupancy.warps_per_block;
+    occupancy.block_limits["blocks"] = limits.max_blocks;
+    occupancy.block_limits["registers"] = get_register_block_limit(registers, occupancy.warps_per_block, limits);
+    occupancy.block_limits["shared memory"] = shared_per_block > 0 ? limits.max_shared / allocated_shared : limits.max_blocks;
+
+    occupancy.blocks_per_sm = limits.max_blocks;
+    for (const auto &[resource, block_limit] : occupancy.block_limits)
+    {
+        occupancy.blocks_per_sm = std::min(occupancy.blocks_per_sm, block_limit);
+    }
+    for (const auto &[resource, block_limit] : occupancy.block_limits)
+    {
+        if (block_limit == occupancy.blocks_per_sm)
+        {
+            occupancy.limiting_resources.push_back(resource);
+        }
+    }
+    occupancy.theoretical_occupancy = 100.0 * occupancy.blocks_per_sm * occupancy.warps_per_block / limits.max_warps;
+
+    return occupancy;
+}
+
+/// @brief Print the occupancy of every kernel, its limiting resource and the region of the peak register pressure
+/// @param resource_map Allocated registers and static shared memory of every kernel
+/// @param live_register_map Live registers of every SASS instruction
+/// @param metric_map Metrics of every kernel
+/// @param sm_version SM version of the SASS
+/// @param sm_count Number of SMs of the GPU
+/// @return Occupancy and register pressure of every kernel
+json merge_analysis_occupancy(const std::unordered_map<std::string, kernel_resources> &resource_map,
+                              const std::unordered_map<std::string, std::vector<live_registers>> &live_register_map,
+                              const std::unordered_map<std::string, kernel_metrics> &metric_map, int sm_version, int sm_count)
+{
+    json result;
+
+    // Sorted by kernel name for a stable output
+    std::map<std::string, kernel_resources> kernels(resource_map.begin(), resource_map.end());
+    for (const auto &[k_resource, v_resource] : kernels)
+    {
+        if (k_resource == "")
+        {
+            continue;
+        }
+        std::cout << "--------------------- Occupancy analysis for kernel: " << k_resource << "   --------------------- " << std::endl;
+
+        // Launch configuration and device limits measured by Nsight Compute take precedence over the SASS and the architecture table
+        cuda_metrics m = {};
+        if (metric_map.count(k_resource))
+        {
+            m = metric_map.at(k_resource).metrics_list;
+        }
+        occupancy_limits limits = get_occupancy_limits(sm_version);
+        if (m.device__attribute_max_warps_per_multiprocessor > 0)
+            limits.max_warps = m.device__attribute_max_warps_per_multiprocessor;
+        if (m.device__attribute_max_blocks_per_multiprocessor > 0)
+            limits.max_blocks = m.device__attribute_max_blocks_per_multiprocessor;
+        if (m.device__attribute_max_registers_per_multiprocessor > 0)
+            limits.max_registers = m.device__attribute_max_registers_per_multiprocessor;
+        // The configured carveout of the launch is the shared memory actually available
+        if (m.launch__shared_mem_config_size > 0)
+            limits.max_shared = m.launch__shared_mem_config_size;
+        else if (m.device__attribute_max_shared_memory_per_multiprocessor > 0)
+            limits.max_shared = m.device__attribute_max_shared_memory_per_multiprocessor;
+
+        int registers = m.launch__registers_per_thread > 0 ? m.launch__registers_per_thread : v_resource.registers;
+        int static_shared = m.launch__shared_mem_per_block_static > 0 ? m.launch__shared_mem_per_block_static : v_resource.static_shared;
+        int dynamic_shared = m.launch__shared_mem_per_block_dynamic;
+
+        json kernel_result;
+        kernel_result["metrics"] = {
+            {"registers_per_thread", registers},
+            {"static_shared_memory", static_shared},
+            {"dynamic_shared_memory", dynamic_shared}
+        };
+
+        if (m.launch__block_size <= 0)
+        {
+            std::cout << "INFO  ::  No launch configuration was measured for this kernel (launch__block_size), the occupancy cannot be computed. "
+                      << "It uses " << registers << " registers per thread and " << static_shared << " bytes of static shared memory per block" << std::endl;
+        }
+        else
+        {
+            kernel_occupancy occupancy = get_occupancy(m.launch__block_size, m.launch__grid_size, registers, static_shared + dynamic_shared, limits);
+
+            std::cout << "INFO  ::  Block size " << occupancy.block_size << ", " << registers << " registers per thread, " << static_shared << " bytes static and "
+                      << dynamic_shared << " bytes dynamic shared memory per block" << std::endl;
+            std::cout << "INFO  ::  Resident blocks per SM allowed by";
+            for (const auto &[resource, block_limit] : occupancy.block_limits)
+            {
+                std::cout << " " << resource << ": " << block_limit << ",";
+            }
+            std::cout << " -> " << occupancy.blocks_per_sm << " blocks (" << occupancy.blocks_per_sm * occupancy.warps_per_block << " of " << limits.max_warps << " warps)" << std::endl;
+
+            std::string limiting_resource;
+            for (const auto &resource : occupancy.limiting_resources)
+            {
+                limiting_resource += (limiting_resource.empty() ? "" : ", ") + resource;
+            }
+            std::cout << "INFO  ::  Theoretical occupancy " << occupancy.theoretical_occupancy << " %, achieved occupancy " << m.sm__warps_active
+                      << " %, limited by: " << limiting_resource << std::endl;
+
+            if (occupancy.blocks_per_sm == 0)
+            {
+                std::cout << "WARNING   ::  The block does not fit on an SM, the launch fails. Reduce the " << limiting_resource << " per block" << std::endl;
+            }
+
+            // Find the register count for the next occupancy step, saving registers only helps if they are the only limit
+            int registers_to_save = 0;
+            double next_occupancy = occupancy.theoretical_occupancy;
+            if (occupancy.block_limits["registers"] == occupancy.blocks_per_sm && occupancy.theoretical_occupancy < 100 && registers > 0)
+            {
+                for (int r = registers - 1; r > 0; r--)
+                {
+                    if (get_register_block_limit(r, occupancy.warps_per_block, limits) > occupancy.block_limits["registers"])
+                    {
+                        kernel_occupancy next = get_occupancy(occupancy.block_size, occupancy.grid_size, r, occupancy.shared_per_block, limits);
+                        registers_to_save = registers - r;
+                        next_occupancy = next.theoretical_occupancy;
+                        break;
+                    }
+                }
+                if (registers_to_save > 0 && next_occupancy > occupancy.theoretical_occupancy)
+                {
+                    std::cout << "WARNING   ::  The occupancy is limited by the registers. Saving " << registers_to_save << " registers per thread (" << registers - registers_to_save
+                              << " instead of " << registers << ") raises the theoretical occupancy to " << next_occupancy
+                              << " %, e.g. with __launch_bounds__ or -maxrregcount, or by shortening the live ranges in the peak register pressure region below" << std::endl;
+                }
+                else if (registers_to_save > 0)
+                {
+                    std::cout << "INFO  ::  Saving " << registers_to_save << " registers per thread does not raise the occupancy, it is also limited by: " << limiting_resource << std::endl;
+                    registers_to_save = 0;
+                }
+            }
+            if (occupancy.block_limits["shared memory"] == occupancy.blocks_per_sm && occupancy.theoretical_occupancy < 100)
+            {
+                std::cout << "WARNING   ::  The occupancy is limited by the shared memory (" << occupancy.shared_per_block << " bytes per block of " << limits.max_shared
+                          << " per SM). Use smaller tiles or a larger shared memory carveout" << std::endl;
+            }
+            if ((occupancy.block_limits["blocks"] == occupancy.blocks_per_sm || occupancy.block_limits["warps"] == occupancy.blocks_per_sm) && occupancy.theoretical_occupancy < 100)
+            {
+                std::cout << "WARNING   ::  The block size of " << occupancy.block_size << " threads leaves warps of the SM unused. Use a block size which is a multiple of "
+                          << limits.max_warps * 32 / limits.max_blocks << " threads" << std::endl;
+            }
+
+            // Too few blocks cannot fill the GPU, whatever the occupancy is
+            if (occupancy.grid_size > 0 && occupancy.blocks_per_sm > 0)
+            {
+                double waves = (double)occupancy.grid_size / (occupancy.blocks_per_sm * sm_count);
+                std::cout << "INFO  ::  " << occupancy.grid_size << " blocks in " << waves << " waves on " << sm_count << " SMs" << std::endl;
+                if (waves < 1)
+                {
+                    std::cout << "WARNING   ::  The grid does not fill the " << sm_count << " SMs at the theoretical occupancy, the achieved occupancy is bounded by the grid size" << std::endl;
+                }
+            }
+            if (m.sm__warps_active > 0 && m.sm__warps_active < 0.8 * occupancy.theoretical_occupancy)
+            {
+                std::cout << "INFO  ::  The achieved occupancy is well below the theoretical one, e.g. due to imbalanced blocks, tail effects or a small grid" << std::endl;
+            }
+
+            kernel_result["metrics"].update({
+                {"block_size", occupancy.block_size},
+                {"grid_size", occupancy.grid_size},
+                {"blocks_per_sm", occupancy.blocks_per_sm},
+                {"block_limits", occupancy.block_limits},
+                {"theoretical_occupancy_perc", occupancy.theoretical_occupancy},
+                {"achieved_occupancy_perc", m.sm__warps_active},
+                {"limiting_resources", occupancy.limiting_resources},
+                {"registers_to_save", registers_to_save},
+                {"next_occupancy_perc", next_occupancy}
+            });
+        }
+
+        // Region around the first instruction with the most live registers
+        if (live_register_map.count(k_resource) && !live_register_map.at(k_resource).empty())
+        {
+            const std::vector<live_registers> &live_register_vec = live_register_map.at(k_resource);
+            auto peak_it = std::max_element(live_register_vec.begin(), live_register_vec.end(), [](const live_registers &a, const live_registers &b)
+                                            { return a.gen_reg < b.gen_reg; });
+            int threshold = std::max(1, (int)(register_pressure_peak_ratio * peak_it->gen_reg));
+            auto start_it = peak_it, end_it = peak_it;
+            while (start_it != live_register_vec.begin() && std::prev(start_it)->gen_reg >= threshold)
+            {
+                start_it--;
+            }
+            while (std::next(end_it) != live_register_vec.end() && std::next(end_it)->gen_reg >= threshold)
+            {
+                end_it++;
+            }
+            int first_line = start_it->line_number, last_line = start_it->line_number;
+            for (auto it = start_it; it <= end_it; it++)
+            {
+                first_line = std::min(first_line, it->line_number);
+                last_line = std::max(last_line, it->line_number);
+            }
+
+            std::cout << "INFO  ::  Peak register pressure of " << peak_it->gen_reg << " live registers at pcOffset " << peak_it->pcOffset << " (line " << peak_it->line_number
+                      << "), " << std::distance(start_it, end_it) + 1 << " instructions with at least " << threshold << " live registers from pcOffset " << start_it->pcOffset
+                      << " to " << end_it->pcOffset << " (lines " << first_line << " to " << last_line << ")" << std::endl;
+
+            kernel_result["register_pressure"] = {
+                {"peak_live_registers", peak_it->gen_reg},
+                {"peak_pc_offset", peak_it->pcOffset},
+                {"peak_line_number", peak_it->line_number},
+                {"region_start_pc_offset", start_it->pcOffset},
+                {"region_end_pc_offset", end_it->pcOffset},
+                {"region_first_line", first_line},
+                {"region_last_line", last_line},
+                {"region_instructions", std::distance(start_it, end_it) + 1}
+            };
+        }
+
+        result[k_resource] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    std::string filename_registers = argv[6];
+    std::unordered_map<std::string, std::vector<live_registers>> live_register_map = profile_stage("live_registers_analysis", [&] { return live_registers_analysis(filename_registers); });
+    std::unordered_map<std::string, kernel_resources> resource_map = profile_stage("get_kernel_resources", [&] { return get_kernel_resources(filename_registers); });
+    int sm_version = get_sm_version(filename_registers);
+
+    int save_as_json = std::strcmp(argv[7], "true") == 0;
+    std::string json_output_dir = argv[8];
+    int sm_count = std::stoi(argv[9]);
+
+    json result = profile_stage("merge_analysis_occupancy", [&] { return merge_analysis_occupancy(resource_map, live_register_map, metric_map, sm_version, sm_count); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/occupancy.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
@@ -0,0 +1,201 @@
+/**
+ * Merge analysis for replacing short divergent branches by predication
+ * SASS analysis - conditional regions (instruction BRA, BSSY, BSYNC) -> instructions between the branch and its reconvergence point, branch overhead
+ * PC Sampling analysis - pc stalls (instruction BRA, BSSY, BSYNC) -> stalled_branch samples of the branch overhead, share of the kernel samples
+ * Metric analysis - get metrics for entire kernel -> branch divergence percentage
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_predication.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Largest region (then and else part) which is recommended to be predicated
+const int predication_max_instructions = 8;
+// Share of the kernel samples on the branch overhead from which a region counts as hot
+const double predication_sample_share_threshold = 0.01;
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for replacing short divergent branches by predication
+/// @param region_map Conditional regions of every kernel
+/// @param pc_stall_map CUPTI warp stalls
+/// @param kernel_stalls Samples of the whole kernels
+/// @param metric_map Metric analysis
+json merge_analysis_predication(std::unordered_map<std::string, std::vector<conditional_region>> region_map, std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map,
+                                std::unordered_map<std::string, std::unordered_map<std::string, int>> kernel_stalls, std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+
+    for (auto [k_sass, v_sass] : region_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "" || v_sass.empty())
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Branch predication analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        int kernel_samples = 0;
+        for (const auto &[stall_name, count] : kernel_stalls[k_sass])
+        {
+            kernel_samples += count;
+        }
+
+        int candidate_count = 0, uniform_count = 0, large_count = 0;
+        for (const auto &index_sass : v_sass)
+        {
+            int region_instructions = index_sass.then_instructions + index_sass.else_instructions;
+            if (!index_sass.predicable || region_instructions > predication_max_instructions)
+            {
+                large_count++;
+                continue;
+            }
+            if (!index_sass.divergent)
+            {
+                uniform_count++;
+                continue;
+            }
+            candidate_count++;
+
+            // Samples of the branch overhead, which predication removes
+            int overhead_samples = 0, branch_samples = 0;
+            const pc_issue_samples *branch_stalls = nullptr;
+            for (const auto &pc_offset : index_sass.overhead_pc_offsets)
+            {
+                auto samples = samples_by_pc.find(std::stoi(pc_offset, nullptr, 16));
+                if (samples != samples_by_pc.end())
+                {
+                    overhead_samples += get_sample_count(samples->second);
+                    branch_samples += get_sample_count(samples->second, "branch_resolving");
+                    if (pc_offset == index_sass.pcOffset)
+                    {
+                        branch_stalls = &samples->second;
+                    }
+                }
+            }
+            double sample_share = kernel_samples > 0 ? (double)overhead_samples / kernel_samples : 0;
+            bool hot = sample_share >= predication_sample_share_threshold;
+
+            int overhead_instructions = index_sass.overhead_pc_offsets.size();
+            std::cout << (hot ? "WARNING   ::  " : "INFO  ::  ") << "The conditional branch at line number " << index_sass.line_number << " (pcOffset " << index_sass.pcOffset << ", "
+                      << index_sass.sass_instruction << ") skips only " << index_sass.then_instructions << " instructions";
+            if (index_sass.else_instructions > 0)
+            {
+                std::cout << " (else part: " << index_sass.else_instructions << " instructions)";
+            }
+            std::cout << " until the threads reconverge at pcOffset " << index_sass.reconvergence_pcOffset << " (line number " << index_sass.reconvergence_line_number << ")";
+            if (index_sass.loop_depth > 0)
+            {
+                std::cout << ", inside a loop";
+            }
+            std::cout << std::endl;
+            std::cout << "Predicating the region instead of branching (e.g. with a conditional assignment c ? a : b, or by computing both values and selecting one) saves "
+                      << overhead_instructions << " issue slots of branch overhead (" << (index_sass.uses_bssy ? "BSSY, BSYNC and " : "") << "BRA) per execution of a divergent warp. "
+                      << "A warp whose threads all take the same side then issues up to " << region_instructions << " more instructions" << std::endl;
+            if (overhead_samples > 0)
+            {
+                std::cout << "The branch overhead has " << overhead_samples << " samples (" << 100 * sample_share << " % of the kernel), " << branch_samples
+                          << " of them in branch resolving stalls, which predication removes" << std::endl;
+            }
+            if (branch_stalls != nullptr)
+            {
+                print_stalls_percentage(*branch_stalls);
+            }
+
+            kernel_result["occurrences"].push_back({
+                {"severity", hot ? "WARNING" : "INFO"},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.pcOffset},
+                {"target_branch", index_sass.target_branch},
+                {"reconvergence_pc_offset", index_sass.reconvergence_pcOffset},
+                {"reconvergence_line_number", index_sass.reconvergence_line_number},
+                {"then_instructions", index_sass.then_instructions},
+                {"else_instructions", index_sass.else_instructions},
+                {"uses_bssy", index_sass.uses_bssy},
+                {"overhead_instructions", overhead_instructions},
+                {"loop_depth", index_sass.loop_depth},
+                {"samples", overhead_samples},
+                {"stalled_branch_samples", branch_samples},
+                {"sample_share", sample_share}
+            });
+        }
+
+        std::cout << "INFO  ::  " << v_sass.size() << " forward conditional branches: " << candidate_count << " short divergent regions, " << uniform_count
+                  << " short regions with a condition that is the same for all threads of a warp (branching is cheaper there), " << large_count
+                  << " regions with more than " << predication_max_instructions << " instructions or other control flow" << std::endl;
+
+        // Map kernel with metrics collected
+        if (metric_map.count(k_sass) && metric_map[k_sass].metrics_list.sm__sass_branch_targets > 0)
+        {
+            const cuda_metrics &m = metric_map[k_sass].metrics_list;
+            double branch_divergence_percent = 100.0 * m.sm__sass_branch_targets_threads_divergent / m.sm__sass_branch_targets;
+            std::cout << "INFO  ::  Branch targets with divergent threads: " << branch_divergence_percent << " %" << std::endl;
+            kernel_result["metrics"] = {
+                {"branch_divergence_perc", branch_divergence_percent}
+            };
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    std::unordered_map<std::string, std::vector<conditional_region>> region_map = profile_stage("predication_analysis", [&] { return predication_analysis(filename_hpctoolkit_sass); });
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::PREDICATION); });
+    std::unordered_map<std::string, std::unordered_map<std::string, int>> kernel_stalls = profile_stage("get_kernel_stalls", [&] { return get_kernel_stalls(filename_sampling); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_predication", [&] { return merge_analysis_predication(region_map, pc_stall_map, kernel_stalls, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/predication.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
@@ -0,0 +1,229 @@
+/**
+ * Merge analysis for redundant global loads
+ * SASS analysis - loop-invariant and duplicate loads (instruction LDG) -> loop, earlier load of the same address, stores which may alias, barriers
+ * PC Sampling analysis - pc stalls (the load, the innermost loop and the first use of the loaded value) -> samples of the load, long scoreboard samples of the use, share of the kernel samples in the loop
+ * Metric analysis - get metrics for entire kernel -> long scoreboard stalls, global load sectors
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_redundant_loads.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Share of the kernel samples on the load and its use from which a redundant load is reported as WARNING
+const double redundant_load_sample_share_threshold = 0.01;
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for redundant global loads
+/// @param load_map Loop-invariant and duplicate global loads of every kernel
+/// @param loop_map pcOffsets of the instructions of the loops with redundant loads, to sum the samples of the loops
+/// @param pc_stall_map CUPTI warp stalls
+/// @param metric_map Metric analysis
+json merge_analysis_redundant_loads(std::unordered_map<std::string, std::vector<redundant_load>> load_map, std::unordered_map<std::string, std::unordered_map<std::string, std::vector<std::string>>> loop_map,
+                                    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map, std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+
+    for (auto [k_sass, v_sass] : load_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Redundant global load analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        if (v_sass.empty())
+        {
+            std::cout << "INFO  ::  No loop-invariant or duplicate global loads" << std::endl;
+            result[k_sass] = kernel_result;
+            continue;
+        }
+
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        int kernel_samples = 0;
+        for (const auto &j : pc_stall_map[k_sass])
+        {
+            kernel_samples += get_sample_count(j);
+        }
+
+        // Samples of every loop, as the weight of the iterations
+        std::unordered_map<std::string, int> loop_samples;
+        for (const auto &[loop_pc_offset, pc_offsets] : loop_map[k_sass])
+        {
+            int &samples = loop_samples[loop_pc_offset];
+            for (const auto &pc_offset : pc_offsets)
+            {
+                auto pc_samples = samples_by_pc.find(std::stoi(pc_offset, nullptr, 16));
+                samples += pc_samples != samples_by_pc.end() ? get_sample_count(pc_samples->second) : 0;
+            }
+        }
+
+        int invariant_count = 0, duplicate_count = 0;
+        for (const auto &index_sass : v_sass)
+        {
+            bool invariant = index_sass.kind == "loop_invariant";
+            invariant_count += invariant;
+            duplicate_count += !invariant;
+
+            auto load_samples = samples_by_pc.find(std::stoi(index_sass.pcOffset, nullptr, 16));
+            int sample_count = load_samples != samples_by_pc.end() ? get_sample_count(load_samples->second) : 0;
+            int use_samples = 0, long_scoreboard_samples = 0;
+            if (!index_sass.use_pcOffset.empty())
+            {
+                auto samples = samples_by_pc.find(std::stoi(index_sass.use_pcOffset, nullptr, 16));
+                use_samples = samples != samples_by_pc.end() ? get_sample_count(samples->second) : 0;
+                long_scoreboard_samples = samples != samples_by_pc.end() ? get_sample_count(samples->second, "long_scoreboard") : 0;
+            }
+            int loop_sample_count = index_sass.loop_pcOffset.empty() ? 0 : loop_samples[index_sass.loop_pcOffset];
+            double sample_share = kernel_samples > 0 ? (double)(sample_count + long_scoreboard_samples) / kernel_samples : 0;
+            double loop_share = kernel_samples > 0 ? (double)loop_sample_count / kernel_samples : 0;
+            bool important = !index_sass.synchronized && (kernel_samples == 0 || sample_share >= redundant_load_sample_share_threshold);
+
+            std::cout << (important ? "WARNING   ::  " : "INFO  ::  ") << (invariant ? "Loop-invariant" : "Duplicate") << " global load at line number " << index_sass.line_number << " (pcOffset "
+                      << index_sass.pcOffset << ", " << index_sass.sass_instruction << ")";
+            if (invariant)
+            {
+                std::cout << ": the address does not change in the loop starting at line number " << index_sass.loop_line_number << " (pcOffset " << index_sass.loop_pcOffset << ", loop depth "
+                          << index_sass.loop_depth << "), so the same value is loaded in every iteration" << std::endl;
+            }
+            else
+            {
+                std::cout << ": the same address is already loaded at line number " << index_sass.first_load_line_number << " (pcOffset " << index_sass.first_load_pcOffset << ")" << std::endl;
+            }
+
+            if (index_sass.synchronized)
+            {
+                std::cout << "A barrier or memory fence " << (invariant ? "in the loop" : "between the loads") << " requires the reload if other threads write to the address, "
+                          << "only reuse the value if the data does not change during the kernel" << std::endl;
+            }
+            if (!index_sass.aliasing_store_pc_offsets.empty())
+            {
+                std::cout << index_sass.aliasing_store_pc_offsets.size() << " stores, atomics or calls " << (invariant ? "in the loop" : "between the loads") << " (first at pcOffset "
+                          << index_sass.aliasing_store_pc_offsets.front() << ") may write to the address, so the compiler has to reload it. "
+                          << "If the pointers do not alias, declare them __restrict__ (and const for read-only data), or keep the value in a local variable";
+            }
+            else
+            {
+                std::cout << "Keep the value in a local variable";
+            }
+            std::cout << (invariant ? " loaded once before the loop (hoisting)" : " and reuse it (common subexpression elimination)") << std::endl;
+            if (index_sass.read_only)
+            {
+                std::cout << "The load already uses the read-only cache (LDG.CONSTANT), but every reload still costs an L1 access" << std::endl;
+            }
+
+            if (sample_count + use_samples > 0)
+            {
+                std::cout << "The load has " << sample_count << " samples and its first use (pcOffset " << index_sass.use_pcOffset << ") " << long_scoreboard_samples
+                          << " long scoreboard samples (" << 100 * sample_share << " % of the kernel)";
+                if (invariant)
+                {
+                    std::cout << ", the loop has " << 100 * loop_share << " % of the kernel samples";
+                }
+                std::cout << std::endl;
+                if (load_samples != samples_by_pc.end())
+                {
+                    print_stalls_percentage(load_samples->second);
+                }
+            }
+
+            kernel_result["occurrences"].push_back({
+                {"severity", important ? "WARNING" : "INFO"},
+                {"kind", index_sass.kind},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.pcOffset},
+                {"loop_depth", index_sass.loop_depth},
+                {"loop_pc_offset", index_sass.loop_pcOffset},
+                {"first_load_pc_offset", index_sass.first_load_pcOffset},
+                {"first_load_line_number", index_sass.first_load_line_number},
+                {"aliasing_store_pc_offsets", index_sass.aliasing_store_pc_offsets},
+                {"synchronized", index_sass.synchronized},
+                {"read_only", index_sass.read_only},
+                {"use_pc_offset", index_sass.use_pcOffset},
+                {"samples", sample_count},
+                {"long_scoreboard_samples", long_scoreboard_samples},
+                {"sample_share", sample_share},
+                {"loop_sample_share", loop_share}
+            });
+        }
+
+        std::cout << "INFO  ::  " << invariant_count << " loop-invariant and " << duplicate_count << " duplicate global loads" << std::endl;
+
+        // Map kernel with metrics collected
+        if (metric_map.count(k_sass))
+        {
+            const cuda_metrics &m = metric_map[k_sass].metrics_list;
+            std::cout << "INFO  ::  Long scoreboard stalls: " << m.smsp__warp_issue_stalled_long_scoreboard_per_warp_active << " % per warp active, global load sectors: "
+                      << m.l1tex__t_sectors_pipe_lsu_mem_global_op_ld << " (L1 hit rate " << m.l1tex__t_sector_pipe_lsu_mem_global_op_ld_hit_rate << " %)" << std::endl;
+            kernel_result["metrics"] = {
+                {"long_scoreboard_perc", m.smsp__warp_issue_stalled_long_scoreboard_per_warp_active},
+                {"global_load_sectors", m.l1tex__t_sectors_pipe_lsu_mem_global_op_ld},
+                {"global_load_l1_hit_rate", m.l1tex__t_sector_pipe_lsu_mem_global_op_ld_hit_rate}
+            };
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    auto redundant_load_tuple = profile_stage("redundant_load_analysis", [&] { return redundant_load_analysis(filename_hpctoolkit_sass); });
+    std::unordered_map<std::string, std::vector<redundant_load>> load_map = std::get<0>(redundant_load_tuple);
+    std::unordered_map<std::string, std::unordered_map<std::string, std::vector<std::string>>> loop_map = std::get<1>(redundant_load_tuple);
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::ALL); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_redundant_loads", [&] { return merge_analysis_redundant_loads(load_map, loop_map, pc_stall_map, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/redundant_loads.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
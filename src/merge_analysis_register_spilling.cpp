@@ -1,6 +1,7 @@
 /**
  * Merge analysis for register spilling
- * SASS analysis - register spilling (instruction LDL/STL) -> output code line number and register pressure
+ * SASS analysis - register spilling (instruction LDL/STL) -> output code line number and register pressure, spill, thread-private array or ABI stack
+ * PTX analysis - local memory declarations (__local_depot) -> size of the thread-private arrays in the stack frame
  * PC Sampling analysis - pc stalls (instruction LDL/STL) -> output stall reasons and percentage of stall
  * Metric analysis - get metrics for entire kernel -> long scoreboard stall and % of memory traffic due to LMEM in L1-L2
  *
@@ -8,10 +9,12 @@
  */
 
 #include "parser_sass_register_spilling.hpp"
+#include "parser_ptx_local_memory.hpp"
 #include "parser_pcsampling.hpp"
 #include "parser_metrics.hpp"
 #include "parser_liveregisters.hpp"
 #include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
 #include <ostream>
 #include <string>
 
@@ -38,6 +41,15 @@ void print_stalls_percentage(const pc_issue_samples &index)
     }
 }
 
+/// @brief Local memory accesses of one kind (spill, local_array, abi_stack) in a kernel
+struct local_memory_cost
+{
+    int loads = 0;
+    int stores = 0;
+    int load_samples = 0;
+    int store_samples = 0;
+};
+
 /// @brief Merge analysis (SASS, CUPTI, Metrics) for register spilling to local memory
 /// @param spilling_analysis_map Includes register load/store to local memory data
 /// @param track_register_map Includes previous arithmetic SASS instruction of the register
@@ -61,17 +73,56 @@ json merge_analysis_register_spill(std::unordered_map<std::string, std::vector<l
 
         std::cout << "--------------------- Register spilling analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
         bool spilled_detected_flag = false;
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        std::map<std::string, local_memory_cost> kind_costs;
         for (auto index_sass : v_sass)
         {
-            // Find the register spill info from the SASS analysis
-            std::cout << "WARNING   ::  Spill detected in line number " << index_sass.line_number << " of your code. Base register number " << index_sass.register_number << " spilled in " << lmem_operation_type_string[index_sass.op_type] << " operation" << std::endl;
+            auto samples = samples_by_pc.find(std::stoul(index_sass.pcOffset, nullptr, 16));
+            local_memory_cost &cost = kind_costs[index_sass.kind];
+            (index_sass.op_type == LOAD ? cost.loads : cost.stores)++;
+            (index_sass.op_type == LOAD ? cost.load_samples : cost.store_samples) += samples != samples_by_pc.end() ? get_sample_count(samples->second) : 0;
+
             json line_result = {
-                {"severity", "WARNING"},
+                {"severity", index_sass.kind == "abi_stack" ? "INFO" : "WARNING"},
                 {"line_number", index_sass.line_number},
                 {"register", index_sass.register_number},
                 {"pc_offset", index_sass.pcOffset},
-                {"operation", lmem_operation_type_string[index_sass.op_type]}
+                {"operation", lmem_operation_type_string[index_sass.op_type]},
+                {"kind", index_sass.kind},
+                {"access_bytes", index_sass.access_bytes},
+                {"stack_offset", index_sass.stack_offset}
             };
+            if (index_sass.kind == "local_array")
+            {
+                // Thread-private arrays are not spills, the register pressure does not explain them
+                std::cout << "WARNING   ::  Local memory " << lmem_operation_type_string[index_sass.op_type] << " of a thread-private array in line number " << index_sass.line_number << " of your code (pcOffset "
+                          << index_sass.pcOffset << (index_sass.stack_offset < 0 ? ", dynamically indexed" : ", stack offset " + std::to_string(index_sass.stack_offset)) << ")" << std::endl;
+                std::cout << "Arrays are only kept in registers if every index is known at compile time. Use constant indices, e.g. fully unroll the loops over the array (#pragma unroll), "
+                          << "replace the array by scalar variables, or move it to shared memory if it has to be indexed dynamically";
+                if (index_sass.thread_dependent_index)
+                {
+                    std::cout << ". The index differs between the threads of a warp, so the access is not coalesced";
+                }
+                std::cout << std::endl;
+                line_result["thread_dependent_index"] = index_sass.thread_dependent_index;
+                if (samples != samples_by_pc.end())
+                {
+                    print_stalls_percentage(samples->second);
+                }
+                kernel_result["occurrences"].push_back(line_result);
+                continue;
+            }
+            if (index_sass.kind == "abi_stack")
+            {
+                std::cout << "INFO  ::  ABI stack " << lmem_operation_type_string[index_sass.op_type] << " in line number " << index_sass.line_number
+                          << " of your code (pcOffset " << index_sass.pcOffset << ", stack offset " << index_sass.stack_offset << "): the register of the caller is saved and restored around a call of a device function. "
+                          << "Inlining the function (__forceinline__) removes it, see the device function call analysis for the cost of the call" << std::endl;
+                kernel_result["occurrences"].push_back(line_result);
+                continue;
+            }
+
+            // Find the register spill info from the SASS analysis
+            std::cout << "WARNING   ::  Spill detected in line number " << index_sass.line_number << " of your code. Base register number " << index_sass.register_number << " spilled in " << lmem_operation_type_string[index_sass.op_type] << " operation" << std::endl;
             for (auto last_reg : track_register_map[k_sass])
             {
                 if (index_sass.register_number == last_reg.register_number)
@@ -129,6 +180,40 @@ json merge_analysis_register_spill(std::unordered_map<std::string, std::vector<l
             std::cout << "INFO  ::  No register spilling detected in your kernel: " << k_sass << std::endl;
         }
 
+        // Local memory traffic of every kind, the measured sectors are split by the PC samples of the accesses (by their number without samples)
+        const cuda_metrics *m = metric_map.count(k_sass) ? &metric_map[k_sass].metrics_list : nullptr;
+        int total_loads = 0, total_stores = 0, total_load_samples = 0, total_store_samples = 0;
+        for (const auto &[kind, cost] : kind_costs)
+        {
+            total_loads += cost.loads;
+            total_stores += cost.stores;
+            total_load_samples += cost.load_samples;
+            total_store_samples += cost.store_samples;
+        }
+        for (const auto &[kind, cost] : kind_costs)
+        {
+            double load_share = total_load_samples > 0 ? (double)cost.load_samples / total_load_samples : (total_loads > 0 ? (double)cost.loads / total_loads : 0);
+            double store_share = total_store_samples > 0 ? (double)cost.store_samples / total_store_samples : (total_stores > 0 ? (double)cost.stores / total_stores : 0);
+            json kind_result = {
+                {"loads", cost.loads},
+                {"stores", cost.stores},
+                {"samples", cost.load_samples + cost.store_samples}
+            };
+            std::cout << "INFO  ::  " << (kind == "spill" ? "Register spills" : (kind == "local_array" ? "Thread-private arrays" : "ABI stack")) << ": " << cost.loads << " loads and " << cost.stores
+                      << " stores with " << cost.load_samples + cost.store_samples << " samples";
+            if (m != nullptr)
+            {
+                double l1_load_sectors = load_share * m->l1tex__t_sectors_pipe_lsu_mem_local_op_ld;
+                double l1_store_sectors = store_share * m->l1tex__t_sectors_pipe_lsu_mem_local_op_st;
+                double l2_sectors = l1_load_sectors * (1 - m->l1tex__t_sector_pipe_lsu_mem_local_op_ld_hit_rate / 100) + l1_store_sectors * (1 - m->l1tex__t_sector_pipe_lsu_mem_local_op_st_hit_rate / 100);
+                std::cout << ", estimated " << l1_load_sectors + l1_store_sectors << " L1 sectors and " << l2_sectors << " L2 sectors (L1 misses)";
+                kind_result["estimated_l1_sectors"] = l1_load_sectors + l1_store_sectors;
+                kind_result["estimated_l2_sectors"] = l2_sectors;
+            }
+            std::cout << std::endl;
+            kernel_result["local_memory_kinds"][kind] = kind_result;
+        }
+
         // Map kernel with metrics collected
         for (auto [k_metric, v_metric] : metric_map)
         {
@@ -160,24 +245,33 @@ int main(int argc, char **argv)
 {
     // std::string filename_hpctoolkit_sass = argv[1];
     std::string filename_executable_sass = argv[2];
-    auto sass_spilling_tuple = register_spilling_analysis(filename_executable_sass);
+    auto sass_spilling_tuple = profile_stage("register_spilling_analysis", [&] { return register_spilling_analysis(filename_executable_sass); });
     std::unordered_map<std::string, std::vector<local_memory_counter>> spilling_analysis_map = std::get<0>(sass_spilling_tuple);
     std::unordered_map<std::string, std::vector<track_register_instruction>> track_register_map = std::get<1>(sass_spilling_tuple);
 
+    std::string filename_ptx = argv[3];
+    std::unordered_map<std::string, ptx_local_memory> ptx_local_memory_map = profile_stage("ptx_local_memory_analysis", [&] { return ptx_local_memory_analysis(filename_ptx); });
+    std::unordered_map<std::string, int> depot_bytes;
+    for (const auto &[function_name, local_memory_obj] : ptx_local_memory_map)
+    {
+        depot_bytes[function_name] = local_memory_obj.depot_bytes;
+    }
+    profile_stage("local_memory_classification", [&] { local_memory_classification(filename_executable_sass, depot_bytes, spilling_analysis_map); });
+
     std::string filename_sampling = argv[4];
-    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = get_warp_stalls(filename_sampling, filename_executable_sass, analysis_kind::REGISTER_SPILLING);
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_executable_sass, analysis_kind::REGISTER_SPILLING); });
 
     std::string filename_metrics = argv[5];
-    std::unordered_map<std::string, kernel_metrics> metric_map = create_metrics(filename_metrics);
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
 
     std::string filename_registers = argv[6];
-    std::unordered_map<std::string, std::vector<live_registers>> live_register_map = live_registers_analysis(filename_registers);
+    std::unordered_map<std::string, std::vector<live_registers>> live_register_map = profile_stage("live_registers_analysis", [&] { return live_registers_analysis(filename_registers); });
 
     int save_as_json = std::strcmp(argv[7], "true") == 0;
     std::string json_output_dir = argv[8];
     int sm_count = std::stoi(argv[9]);
 
-    json result = merge_analysis_register_spill(spilling_analysis_map, track_register_map, pc_stall_map, metric_map, live_register_map, sm_count);
+    json result = profile_stage("merge_analysis_register_spill", [&] { return merge_analysis_register_spill(spilling_analysis_map, track_register_map, pc_stall_map, metric_map, live_register_map, sm_count); });
 
     if (save_as_json)
     {
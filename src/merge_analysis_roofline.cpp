@@ -0,0 +1,142 @@
+/**
+ * Merge analysis for the roofline and the speed-of-light classification of every kernel
+ * SASS analysis - N/A
+ * PC Sampling analysis - N/A
+ * Metric analysis - floating point operations, DRAM bytes and elapsed time -> arithmetic intensity, achieved vs. peak bandwidth and FLOP/s
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+#include <map>
+
+using json = nlohmann::json;
+
+/// @brief Print the roofline of every kernel and classify it as memory-, compute- or latency-bound
+/// @param metric_map Metrics of every kernel
+/// @return Roofline data points, ceilings and classification of every kernel
+json merge_analysis_roofline(const std::unordered_map<std::string, kernel_metrics> &metric_map)
+{
+    json result;
+
+    // Sorted by kernel name for a stable output
+    std::map<std::string, kernel_metrics> kernels(metric_map.begin(), metric_map.end());
+    for (const auto &[k_metric, v_metric] : kernels)
+    {
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_metric == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Roofline analysis for kernel: " << k_metric << "   --------------------- " << std::endl;
+        kernel_roofline roofline = get_roofline(v_metric);
+
+        if (roofline.elapsed_seconds == 0)
+        {
+            std::cout << "INFO  ::  No elapsed time was measured for this kernel (gpu__time_duration, sm__cycles_elapsed), the roofline cannot be computed" << std::endl;
+            continue;
+        }
+
+        std::cout << "INFO  ::  Elapsed time " << roofline.elapsed_seconds * 1e6 << " us (" << roofline.elapsed_cycles << " cycles), DRAM traffic "
+                  << roofline.dram_bytes / 1e6 << " MB at " << roofline.achieved_bandwidth / 1e9 << " GB/s";
+        if (roofline.peak_bandwidth > 0)
+        {
+            std::cout << " (" << 100 * roofline.achieved_bandwidth / roofline.peak_bandwidth << " % of the peak " << roofline.peak_bandwidth / 1e9 << " GB/s)";
+        }
+        std::cout << std::endl;
+
+        json points = json::array();
+        json ceilings = {{"dram_bandwidth", roofline.peak_bandwidth}};
+        for (const auto &point : roofline.points)
+        {
+            ceilings[point.precision] = point.peak_flops_per_second;
+            if (point.flops == 0)
+            {
+                continue;
+            }
+            std::cout << "INFO  ::  " << point.precision << ": " << point.achieved_flops_per_second / 1e9 << " GFLOP/s";
+            if (point.peak_flops_per_second > 0)
+            {
+                std::cout << " (" << 100 * point.achieved_flops_per_second / point.peak_flops_per_second << " % of the peak " << point.peak_flops_per_second / 1e9 << " GFLOP/s)";
+            }
+            std::cout << ", arithmetic intensity " << point.arithmetic_intensity << " FLOP/byte" << std::endl;
+            points.push_back({
+                {"precision", point.precision},
+                {"flops", point.flops},
+                {"arithmetic_intensity", point.arithmetic_intensity},
+                {"performance", point.achieved_flops_per_second}
+            });
+        }
+        if (roofline.tensor_instructions > 0)
+        {
+            std::cout << "INFO  ::  " << roofline.tensor_instructions << " tensor core instructions, their operations are not part of the roofline" << std::endl;
+        }
+
+        std::cout << "INFO  ::  Speed of light: SM " << roofline.compute_throughput_perc << " %, memory " << roofline.memory_throughput_perc << " %" << std::endl;
+        if (roofline.bound == "memory")
+        {
+            std::cout << "WARNING   ::  The kernel is memory-bound. Reduce the bytes moved, e.g. by reusing data in shared memory or registers, "
+                      << "coalescing and vectorizing the accesses" << std::endl;
+        }
+        else if (roofline.bound == "compute")
+        {
+            std::cout << "WARNING   ::  The kernel is compute-bound. Reduce or cheapen the executed instructions, e.g. with lower precision or tensor cores" << std::endl;
+        }
+        else
+        {
+            std::cout << "WARNING   ::  The kernel is latency-bound, it uses less than " << speed_of_light_bound_perc << " % of both the compute and the memory throughput. "
+                      << "Increase the parallelism (occupancy, independent instructions) and look at the warp stalls" << std::endl;
+        }
+        if (!roofline.dominant_precision.empty())
+        {
+            std::cout << "INFO  ::  In the " << roofline.dominant_precision << " roofline, the kernel is on the " << roofline.roofline_side << " side of the ridge point" << std::endl;
+        }
+
+        result[k_metric] = {
+            {"metrics", {
+                {"bound", roofline.bound},
+                {"compute_throughput_perc", roofline.compute_throughput_perc},
+                {"memory_throughput_perc", roofline.memory_throughput_perc},
+                {"dominant_precision", roofline.dominant_precision},
+                {"roofline_side", roofline.roofline_side},
+                {"elapsed_seconds", roofline.elapsed_seconds},
+                {"elapsed_cycles", roofline.elapsed_cycles},
+                {"dram_bytes", roofline.dram_bytes},
+                {"achieved_bandwidth", roofline.achieved_bandwidth},
+                {"tensor_instructions", roofline.tensor_instructions}
+            }},
+            {"roofline", {
+                {"points", points},
+                {"ceilings", ceilings}
+            }}
+        };
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_roofline", [&] { return merge_analysis_roofline(metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/roofline.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
@@ -0,0 +1,260 @@
+/**
+ * Merge analysis for loops which could use tensor cores
+ * SASS analysis - innermost loops (instruction FFMA, HFMA2, DFMA, HMMA, ...) -> share of FMAs in the loop, operands loaded from shared or global memory, no tensor core instructions
+ * PC Sampling analysis - pc stalls (all instructions of the loop) -> share of the kernel samples in the loop
+ * Metric analysis - get metrics for entire kernel -> executed tensor pipe instructions
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_tensor_cores.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Share of FMAs among the instructions of a loop, from which the loop counts as FMA-dominated
+const double tensor_core_min_fma_share = 0.3;
+// Share of the FMAs whose operands are loaded from memory (tiles of the matrices)
+const double tensor_core_min_loaded_share = 0.5;
+// Share of the kernel samples in the loop below which a candidate is only reported as INFO
+const double tensor_core_sample_share_threshold = 0.05;
+// Estimated speedup of the loop below which the tensor cores are not recommended
+const double tensor_core_min_speedup = 1.5;
+
+/// @brief Dense throughput of an SM per clock cycle in FLOP, of the FMA pipes and the tensor cores
+struct tensor_core_throughput
+{
+    double ffma;
+    double hfma2;
+    double dfma;
+    double hmma; // fp16/bf16 with fp32 accumulation
+    double tf32; // 0 if the architecture has no tf32 tensor cores
+    double dmma; // 0 if the architecture has no fp64 tensor cores
+};
+
+/// @brief Throughput of the architecture, from the NVIDIA architecture whitepapers (V100, T4, A100, A10, L40S, H100)
+tensor_core_throughput get_tensor_core_throughput(int sm_version)
+{
+    std::map<int, tensor_core_throughput> architectures = {
+        {70, {128, 256, 64, 1024, 0, 0}}, {75, {128, 256, 4, 1024, 0, 0}}, {80, {128, 512, 64, 2048, 1024, 128}},
+        {86, {256, 256, 4, 1024, 512, 0}}, {89, {256, 256, 4, 1024, 512, 0}}, {90, {256, 512, 128, 4096, 2048, 256}}};
+
+    // Unknown (newer) architectures use the throughput of the closest older one
+    auto architecture_it = architectures.upper_bound(sm_version);
+    if (architecture_it == architectures.begin())
+    {
+        return {0, 0, 0, 0, 0, 0}; // no tensor cores before Volta
+    }
+    return std::prev(architecture_it)->second;
+}
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for loops which could use tensor cores
+/// @param loop_map Innermost loops of every kernel
+/// @param kernel_mma_map Tensor core instructions of every kernel
+/// @param sm_version SM version of the SASS
+/// @param pc_stall_map CUPTI warp stalls
+/// @param metric_map Metric analysis
+json merge_analysis_tensor_cores(std::unordered_map<std::string, std::vector<fma_loop>> loop_map, std::unordered_map<std::string, int> kernel_mma_map, int sm_version,
+                                 std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map, std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+    tensor_core_throughput throughput = get_tensor_core_throughput(sm_version);
+
+    for (auto [k_sass, v_sass] : loop_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Tensor core opportunity analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        if (throughput.hmma == 0)
+        {
+            std::cout << "INFO  ::  The architecture (sm_" << sm_version << ") has no tensor cores" << std::endl;
+            result[k_sass] = kernel_result;
+            continue;
+        }
+        if (kernel_mma_map[k_sass] > 0)
+        {
+            std::cout << "INFO  ::  The kernel already uses " << kernel_mma_map[k_sass] << " tensor core instructions" << std::endl;
+        }
+
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        int kernel_samples = 0;
+        for (const auto &j : pc_stall_map[k_sass])
+        {
+            kernel_samples += get_sample_count(j);
+        }
+
+        int candidate_count = 0;
+        for (const auto &index_sass : v_sass)
+        {
+            int fma_instructions = 0;
+            for (const auto &[opcode, count] : index_sass.fma_count)
+            {
+                fma_instructions += count;
+            }
+            double fma_share = (double)fma_instructions / index_sass.instructions;
+            double loaded_share = fma_instructions > 0 ? (double)(index_sass.fma_from_shared + index_sass.fma_from_global) / fma_instructions : 0;
+            if (index_sass.mma_count > 0 || fma_instructions < 4 || fma_share < tensor_core_min_fma_share || loaded_share < tensor_core_min_loaded_share)
+            {
+                continue;
+            }
+
+            // Time of the loop relative to now, if every FMA type moves to its tensor cores (Amdahl's law on the issued instructions)
+            double relative_time = 1 - fma_share;
+            std::map<std::string, double> speedups;
+            auto add_fma_type = [&](const std::string &opcode, double fma_throughput, double mma_throughput)
+            {
+                if (index_sass.fma_count.count(opcode) == 0)
+                {
+                    return;
+                }
+                double share = (double)index_sass.fma_count.at(opcode) / index_sass.instructions;
+                double speedup = mma_throughput > 0 ? mma_throughput / fma_throughput : 1;
+                speedups[opcode] = speedup;
+                relative_time += share / speedup;
+            };
+            add_fma_type("FFMA", throughput.ffma, throughput.tf32 > 0 ? throughput.tf32 : throughput.hmma);
+            add_fma_type("HFMA2", throughput.hfma2, throughput.hmma);
+            add_fma_type("DFMA", throughput.dfma, throughput.dmma);
+            double loop_speedup = 1 / relative_time;
+            if (loop_speedup < tensor_core_min_speedup)
+            {
+                continue; // e.g. DFMA without fp64 tensor cores
+            }
+            candidate_count++;
+
+            int loop_samples = 0;
+            for (const auto &pc_offset : index_sass.pc_offsets)
+            {
+                auto samples = samples_by_pc.find(std::stoi(pc_offset, nullptr, 16));
+                loop_samples += samples != samples_by_pc.end() ? get_sample_count(samples->second) : 0;
+            }
+            double sample_share = kernel_samples > 0 ? (double)loop_samples / kernel_samples : 0;
+            bool important = kernel_samples == 0 || sample_share >= tensor_core_sample_share_threshold;
+
+            std::cout << (important ? "WARNING   ::  " : "INFO  ::  ") << "The loop starting at line number " << index_sass.line_number << " (pcOffset " << index_sass.start_pcOffset << " to "
+                      << index_sass.end_pcOffset << ") consists of " << 100 * fma_share << " % FMAs (";
+            for (auto it = index_sass.fma_count.begin(); it != index_sass.fma_count.end(); it++)
+            {
+                std::cout << (it == index_sass.fma_count.begin() ? "" : ", ") << it->second << " " << it->first;
+            }
+            std::cout << " of " << index_sass.instructions << " instructions) and uses no tensor cores. " << index_sass.fma_from_shared << " FMAs multiply values loaded from shared memory and "
+                      << index_sass.fma_from_global << " from global memory" << std::endl;
+            for (const auto &[opcode, speedup] : speedups)
+            {
+                std::cout << "The tensor cores of sm_" << sm_version << " execute " << speedup << "x the FLOPs of " << opcode << " per cycle"
+                          << (opcode == "FFMA" ? (throughput.tf32 > 0 ? " (as TF32, or 2x more with FP16/BF16 inputs)" : " (with FP16 inputs)") : "") << std::endl;
+            }
+            std::cout << "Estimated speedup of the loop with tensor cores: " << loop_speedup << "x (the other instructions of the loop remain)" << std::endl;
+            std::cout << "If the loop computes a matrix product, use a library call (cuBLAS, e.g. cublasGemmEx, or CUTLASS), or the warp-level matrix operations "
+                      << "(nvcuda::wmma fragments or the mma.sync PTX instruction) on the tiles in shared memory";
+            if (index_sass.fma_from_shared == 0)
+            {
+                std::cout << ", after staging the tiles through shared memory";
+            }
+            std::cout << std::endl;
+            if (loop_samples > 0)
+            {
+                std::cout << "The loop has " << loop_samples << " samples (" << 100 * sample_share << " % of the kernel)" << std::endl;
+            }
+
+            json line_result = {
+                {"severity", important ? "WARNING" : "INFO"},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.start_pcOffset},
+                {"end_pc_offset", index_sass.end_pcOffset},
+                {"instructions", index_sass.instructions},
+                {"fma_count", index_sass.fma_count},
+                {"fma_share", fma_share},
+                {"fma_from_shared", index_sass.fma_from_shared},
+                {"fma_from_global", index_sass.fma_from_global},
+                {"mma_throughput_ratio", speedups},
+                {"estimated_speedup", loop_speedup},
+                {"samples", loop_samples},
+                {"sample_share", sample_share}
+            };
+            kernel_result["occurrences"].push_back(line_result);
+        }
+
+        if (candidate_count == 0)
+        {
+            std::cout << "INFO  ::  No FMA-dominated loops without tensor core instructions found" << std::endl;
+        }
+
+        // Map kernel with metrics collected
+        if (metric_map.count(k_sass))
+        {
+            double tensor_instructions = metric_map[k_sass].metrics_list.sm__inst_executed_pipe_tensor;
+            std::cout << "INFO  ::  Executed tensor pipe instructions: " << tensor_instructions << std::endl;
+            kernel_result["metrics"] = {
+                {"tensor_instructions", tensor_instructions}
+            };
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    auto tensor_core_tuple = profile_stage("tensor_core_analysis", [&] { return tensor_core_analysis(filename_hpctoolkit_sass); });
+    std::unordered_map<std::string, std::vector<fma_loop>> loop_map = std::get<0>(tensor_core_tuple);
+    std::unordered_map<std::string, int> kernel_mma_map = std::get<1>(tensor_core_tuple);
+    int sm_version = std::get<2>(tensor_core_tuple);
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::ALL); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_tensor_cores", [&] { return merge_analysis_tensor_cores(loop_map, kernel_mma_map, sm_version, pc_stall_map, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/tensor_cores.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
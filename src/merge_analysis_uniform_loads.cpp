@@ -0,0 +1,203 @@
+/**
+ * Merge analysis for global loads with a warp-uniform address, which are candidates for constant memory
+ * SASS analysis - uniform loads (instruction LDG) -> address depends only on kernel parameters, blockIdx and loop counters, read-only or written in the kernel
+ * PC Sampling analysis - pc stalls (instruction LDG) -> long scoreboard and IMC miss samples of the loads
+ * Metric analysis - get metrics for entire kernel -> IMC miss stalls, i.e. the pressure on the constant cache
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_uniform_loads.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Share of the kernel samples below which a uniform load is only reported as INFO
+const double uniform_load_sample_share_threshold = 0.01;
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for global loads with a warp-uniform address
+/// @param load_map Uniform loads of every kernel
+/// @param pc_stall_map CUPTI warp stalls
+/// @param kernel_stalls Samples of the whole kernels
+/// @param metric_map Metric analysis
+json merge_analysis_uniform_loads(std::unordered_map<std::string, std::vector<uniform_load>> load_map, std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map,
+                                  std::unordered_map<std::string, std::unordered_map<std::string, int>> kernel_stalls, std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+
+    for (auto [k_sass, v_sass] : load_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Uniform load (constant memory) analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        if (v_sass.empty())
+        {
+            std::cout << "INFO  ::  No global loads with an address which is the same for all threads of a warp" << std::endl;
+            result[k_sass] = kernel_result;
+            continue;
+        }
+
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        int kernel_samples = 0;
+        for (const auto &[stall_name, count] : kernel_stalls[k_sass])
+        {
+            kernel_samples += count;
+        }
+
+        for (const auto &index_sass : v_sass)
+        {
+            auto samples = samples_by_pc.find(std::stoi(index_sass.pcOffset, nullptr, 16));
+            int sample_count = samples != samples_by_pc.end() ? get_sample_count(samples->second) : 0;
+            int long_scoreboard_samples = samples != samples_by_pc.end() ? get_sample_count(samples->second, "long_scoreboard") : 0;
+            int imc_miss_samples = samples != samples_by_pc.end() ? get_sample_count(samples->second, "imc_miss") : 0;
+            double sample_share = kernel_samples > 0 ? (double)sample_count / kernel_samples : 0;
+            bool important = !index_sass.written_in_kernel && !index_sass.selected && (kernel_samples == 0 || sample_share >= uniform_load_sample_share_threshold);
+
+            std::cout << (important ? "WARNING   ::  " : "INFO  ::  ") << "All threads of a warp load the same address at line number " << index_sass.line_number << " (pcOffset "
+                      << index_sass.pcOffset << ", " << index_sass.sass_instruction << ")";
+            if (index_sass.scope == "grid")
+                std::cout << ", the address only depends on kernel parameters, so the whole grid reads the same value";
+            else if (index_sass.scope == "block")
+                std::cout << ", the address only depends on kernel parameters and blockIdx";
+            else if (index_sass.scope == "loop")
+                std::cout << ", the address only changes with the loop counter";
+            if (index_sass.loop_depth > 0)
+            {
+                std::cout << ", inside a loop";
+            }
+            std::cout << std::endl;
+
+            if (index_sass.written_in_kernel)
+            {
+                std::cout << "The kernel also writes through the same pointer, so the data is not read-only and cannot move to constant memory" << std::endl;
+            }
+            else if (index_sass.selected)
+            {
+                std::cout << "The address is chosen at runtime (SEL or a predicated instruction), e.g. between different arrays, so a single __constant__ array cannot replace it";
+                if (!index_sass.read_only_path)
+                {
+                    std::cout << ". Mark the pointers as const __restrict__ (or use __ldg) to load them through the read-only data cache";
+                }
+                std::cout << std::endl;
+            }
+            else
+            {
+                std::cout << "Every warp issues a global load and waits for its latency. If the data is read-only and at most 64 KB, declare it as __constant__ memory: "
+                          << "the constant cache broadcasts a warp-uniform address to all threads, and the compiler can load it with the uniform datapath (ULDC)";
+                if (index_sass.scope == "grid")
+                {
+                    std::cout << ". A single value can also be passed as kernel argument by value";
+                }
+                std::cout << std::endl;
+                if (!index_sass.read_only_path)
+                {
+                    std::cout << "Otherwise, mark the pointer as const __restrict__ (or use __ldg) to load it through the read-only data cache" << std::endl;
+                }
+            }
+            if (sample_count > 0)
+            {
+                std::cout << "This instruction has " << sample_count << " samples (" << 100 * sample_share << " % of the kernel), " << long_scoreboard_samples << " in long scoreboard and "
+                          << imc_miss_samples << " in IMC miss stalls" << std::endl;
+                print_stalls_percentage(samples->second);
+            }
+
+            kernel_result["occurrences"].push_back({
+                {"severity", important ? "WARNING" : "INFO"},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.pcOffset},
+                {"access_bytes", index_sass.access_bytes},
+                {"loop_depth", index_sass.loop_depth},
+                {"scope", index_sass.scope},
+                {"parameters", index_sass.parameters},
+                {"read_only_path", index_sass.read_only_path},
+                {"written_in_kernel", index_sass.written_in_kernel},
+                {"selected", index_sass.selected},
+                {"samples", sample_count},
+                {"long_scoreboard_samples", long_scoreboard_samples},
+                {"imc_miss_samples", imc_miss_samples},
+                {"sample_share", sample_share}
+            });
+        }
+
+        // Map kernel with metrics collected
+        if (metric_map.count(k_sass))
+        {
+            const cuda_metrics &m = metric_map[k_sass].metrics_list;
+            std::cout << "INFO  ::  IMC miss stalls (constant cache misses): " << m.smsp__warp_issue_stalled_imc_miss_per_warp_active << " % per warp active, long scoreboard stalls: "
+                      << m.smsp__warp_issue_stalled_long_scoreboard_per_warp_active << " % per warp active" << std::endl;
+            if (m.smsp__warp_issue_stalled_imc_miss_per_warp_active > m.smsp__warp_issue_stalled_long_scoreboard_per_warp_active)
+            {
+                std::cout << "The constant cache already misses often, moving more data to constant memory can increase the IMC miss stalls" << std::endl;
+            }
+            kernel_result["metrics"] = {
+                {"imc_miss_perc", m.smsp__warp_issue_stalled_imc_miss_per_warp_active},
+                {"long_scoreboard_perc", m.smsp__warp_issue_stalled_long_scoreboard_per_warp_active}
+            };
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    std::unordered_map<std::string, std::vector<uniform_load>> load_map = profile_stage("uniform_load_analysis", [&] { return uniform_load_analysis(filename_hpctoolkit_sass); });
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::GLOBAL_MEMORY_ACCESS); });
+    std::unordered_map<std::string, std::unordered_map<std::string, int>> kernel_stalls = profile_stage("get_kernel_stalls", [&] { return get_kernel_stalls(filename_sampling); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_uniform_loads", [&] { return merge_analysis_uniform_loads(load_map, pc_stall_map, kernel_stalls, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/uniform_loads.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
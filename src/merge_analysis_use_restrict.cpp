@@ -12,6 +12,7 @@
 #include "parser_metrics.hpp"
 #include "parser_liveregisters.hpp"
 #include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
 #include <cstddef>
 
 using json = nlohmann::json;
@@ -161,21 +162,21 @@ json merge_analysis_restrict(std::unordered_map<std::string, std::vector<registe
 int main(int argc, char **argv)
 {
     std::string filename_hpctoolkit_sass = argv[1];
-    std::unordered_map<std::string, std::vector<register_used>> restrict_analysis_map = restrict_analysis(filename_hpctoolkit_sass);
+    std::unordered_map<std::string, std::vector<register_used>> restrict_analysis_map = profile_stage("restrict_analysis", [&] { return restrict_analysis(filename_hpctoolkit_sass); });
 
     std::string filename_sampling = argv[4];
-    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::RESTRICT_USE);
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::RESTRICT_USE); });
 
     std::string filename_metrics = argv[5];
-    std::unordered_map<std::string, kernel_metrics> metric_map = create_metrics(filename_metrics);
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
 
     std::string filename_registers = argv[6];
-    std::unordered_map<std::string, std::vector<live_registers>> live_register_map = live_registers_analysis(filename_registers);
+    std::unordered_map<std::string, std::vector<live_registers>> live_register_map = profile_stage("live_registers_analysis", [&] { return live_registers_analysis(filename_registers); });
 
     int save_as_json = std::strcmp(argv[7], "true") == 0;
     std::string json_output_dir = argv[8];
 
-    json result = merge_analysis_restrict(restrict_analysis_map, pc_stall_map, metric_map, live_register_map);
+    json result = profile_stage("merge_analysis_restrict", [&] { return merge_analysis_restrict(restrict_analysis_map, pc_stall_map, metric_map, live_register_map); });
 
     if (save_as_json)
     {
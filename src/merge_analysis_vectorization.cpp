@@ -1,7 +1,7 @@
 /**
- * Merge analysis for using vectorized load
- * SASS analysis - vectorized load (instruction LDG ) -> output code line number, no of unrolls of a register and register pressure
- * PC Sampling analysis - pc stalls (instruction LDG ) -> output stall reasons and percentage of stall
+ * Merge analysis for using vectorized loads and stores
+ * SASS analysis - vectorized load and store (instruction LDG, STG, LDS, STS, LDL, STL) -> adjacent accesses of a base register, vector width, instructions saved and register pressure
+ * PC Sampling analysis - pc stalls (instruction LDG, STG, LDS, STS, LDL, STL) -> output stall reasons, samples of the accesses which a vectorized access saves
  * Metric analysis - get metrics for entire kernel -> Long scoreboard, occupancy achieved
  *
  * @author Soumya Sen
@@ -12,6 +12,7 @@
 #include "parser_metrics.hpp"
 #include "parser_liveregisters.hpp"
 #include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
 
 using json = nlohmann::json;
 
@@ -36,9 +37,9 @@ void print_stalls_percentage(const pc_issue_samples &index)
     }
 }
 
-/// @brief Merge analysis (SASS, CUPTI, Metrics) for using vectorized load
-/// @param vectorize_analysis_map Total global load count
-/// @param register_map Includes base register and unrolled values data
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for using vectorized loads and stores
+/// @param vectorize_analysis_map Load and store counts of the kernel
+/// @param register_map Scalar accesses which can be combined into vectorized accesses
 /// @param pc_stall_map CUPTI warp stalls
 /// @param metric_map Metric analysis
 /// @param live_register_map Currently used (or live) register count denoting register pressure
@@ -56,105 +57,149 @@ json merge_analysis_vectorize(std::unordered_map<std::string, load_counter> vect
         // Fix for blank kernel name appearing in the analysis_map
         if (k_sass == "")
         {
-            break;
+            continue;
         }
 
-        std::cout << "--------------------- Vectorized load analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        std::cout << "--------------------- Vectorized load and store analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
         std::cout << "WARNING   ::  Total number of non-vectorized global load SASS instructions for this kernel: " << v_sass.global_load_count << std::endl;
+        std::cout << "INFO  ::  " << v_sass.vectorized_access_count << " of " << v_sass.access_count << " global, shared and local loads and stores already use 64- or 128-bit width" << std::endl;
 
-        for (auto [k_reg, v_reg] : register_map)
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        int memory_samples = 0;
+        for (const auto &j : pc_stall_map[k_sass])
         {
-            if (k_reg == k_sass) // analysis for the same kernel
+            memory_samples += get_sample_count(j);
+        }
+
+        // Candidates with the most samples first, the samples weight the instructions a vectorized access saves
+        std::vector<std::pair<int, register_data>> candidates;
+        for (const auto &index_sass : register_map[k_sass])
+        {
+            int sample_count = 0;
+            for (const auto &pc_offset : index_sass.unroll_pc_offsets)
+            {
+                auto samples = samples_by_pc.find(std::stoi(pc_offset, nullptr, 16));
+                sample_count += samples != samples_by_pc.end() ? get_sample_count(samples->second) : 0;
+            }
+            candidates.push_back({sample_count, index_sass});
+        }
+        std::stable_sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+
+        int total_saved = 0;
+        double total_samples_saved = 0;
+        int conditional_count = std::count_if(candidates.begin(), candidates.end(), [](const auto &candidate) { return !candidate.second.alignment_known; });
+        for (const auto &[sample_count, index_sass] : candidates)
+        {
+            int accesses = index_sass.unrolls.size();
+            double samples_saved = (double)sample_count * index_sass.instructions_saved / accesses;
+            // Candidates whose alignment is unknown are conditional, they are not counted in the savings
+            if (index_sass.alignment_known)
+            {
+                total_saved += index_sass.instructions_saved;
+                total_samples_saved += samples_saved;
+            }
+
+            std::cout << (index_sass.alignment_known ? "WARNING  ::  Use a " : "INFO  ::  If the address is aligned to " + std::to_string(index_sass.vector_bytes) + " bytes, use a ") << 8 * index_sass.vector_bytes << "-bit vectorized " << index_sass.memory_space << " " << index_sass.access_kind << " for register " << index_sass.base
+                      << ", in line number " << index_sass.line_number << " of your code" << std::endl;
+            std::cout << "Register " << index_sass.base << " in line number " << index_sass.line_number << " of your code has " << accesses << " adjacent " << 8 * index_sass.access_bytes << "-bit "
+                      << index_sass.access_kind << "s (pcOffsets";
+            for (const auto &pc_offset : index_sass.unroll_pc_offsets)
+            {
+                std::cout << " " << pc_offset;
+            }
+            std::cout << "), one " << 8 * index_sass.vector_bytes << "-bit " << index_sass.access_kind << " saves " << index_sass.instructions_saved << " instructions";
+            if (index_sass.loop_depth > 0)
+            {
+                std::cout << " in every iteration of the loop";
+            }
+            std::cout << ", e.g. by accessing the data through a " << (index_sass.vector_bytes == 16 ? "float4/int4" : "float2/int2") << " pointer" << std::endl;
+            if (!index_sass.alignment_known)
             {
-                for (auto index_sass : v_reg)
+                std::cout << "The alignment of the address could not be derived from the SASS. The vectorized access is only possible if the address is aligned to " << index_sass.vector_bytes
+                          << " bytes, e.g. if the array is allocated with cudaMalloc and indexed in multiples of " << index_sass.vector_bytes / index_sass.access_bytes << " elements" << std::endl;
+            }
+            if (index_sass.store_in_between)
+            {
+                std::cout << "A " << index_sass.memory_space << " store is executed between these loads, the compiler could not rule out that it overlaps with them. "
+                          << "Use __restrict__ pointers or load the values into a vector type before the store" << std::endl;
+            }
+            if (sample_count > 0)
+            {
+                std::cout << "These instructions have " << sample_count << " samples (" << 100.0 * sample_count / memory_samples << " % of the samples of the memory instructions), "
+                          << "the vectorized access would remove about " << samples_saved << " of them" << std::endl;
+            }
+
+            json line_result = {
+                {"severity", index_sass.alignment_known ? "WARNING" : "INFO"},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.pcOffset},
+                {"register", index_sass.base},
+                {"unroll_pc_offsets", index_sass.unroll_pc_offsets},
+                {"adjacent_memory_accesses", accesses},
+                {"memory_space", index_sass.memory_space},
+                {"access", index_sass.access_kind},
+                {"access_bytes", index_sass.access_bytes},
+                {"vector_bytes", index_sass.vector_bytes},
+                {"instructions_saved", index_sass.instructions_saved},
+                {"alignment_known", index_sass.alignment_known},
+                {"store_in_between", index_sass.store_in_between},
+                {"loop_depth", index_sass.loop_depth},
+                {"samples", sample_count},
+                {"weighted_samples_saved", samples_saved}
+            };
+
+            // Print the number of current number of active registers, a vectorized access needs consecutive registers
+            int pcOffset_to_search = std::stoi(index_sass.pcOffset, nullptr, 16);
+            std::vector<live_registers>::iterator reg_search_it = std::find_if(live_register_map[k_sass].begin(), live_register_map[k_sass].end(), [&](const live_registers &register_index)
+                                                                               { return pcOffset_to_search == std::stoi(register_index.pcOffset, nullptr, 16); });
+            if (reg_search_it != live_register_map[k_sass].end())
+            {
+                std::cout << "INFO  ::  Total current registers for the SASS instruction: " << reg_search_it->gen_reg + reg_search_it->pred_reg + reg_search_it->u_gen_reg << std::endl;
+                line_result["used_register_count"] = reg_search_it->gen_reg + reg_search_it->pred_reg + reg_search_it->u_gen_reg;
+                if (reg_search_it->change_reg_from_last > 0)
+                {
+                    std::cout << "Increased register pressure with " << std::abs(reg_search_it->change_reg_from_last) << " more registers compared to last SASS instruction" << std::endl;
+                    line_result["register_pressure_increase"] = std::abs(reg_search_it->change_reg_from_last);
+                }
+            }
+
+            // Stall reasons of the access with the most samples
+            const pc_issue_samples *most_samples = nullptr;
+            for (const auto &pc_offset : index_sass.unroll_pc_offsets)
+            {
+                auto samples = samples_by_pc.find(std::stoi(pc_offset, nullptr, 16));
+                if (samples != samples_by_pc.end() && (most_samples == nullptr || get_sample_count(samples->second) > get_sample_count(*most_samples)))
                 {
-                    json line_result;
-                    // Base registers with no unrolling will show 0, hence need to ignore those counts
-                    if (((index_sass.unrolls.size() - std::count(index_sass.unrolls.begin(), index_sass.unrolls.end(), 0)) > 0) && (index_sass.reg_load_type == VEC_32))
-                    {
-                        std::cout << "WARNING  ::  Use vectorized load for register " << index_sass.base << ", in line number " << index_sass.line_number << " of your code" << std::endl;
-                        std::cout << "Register " << index_sass.base << " in line number " << index_sass.line_number << " of your code has " << index_sass.unrolls.size() - std::count(index_sass.unrolls.begin(), index_sass.unrolls.end(), 0) << " adjacent memory accesses" << std::endl;
-                        line_result = {
-                            {"severity", "WARNING"},
-                            {"line_number", index_sass.line_number},
-                            {"pc_offset", index_sass.pcOffset},
-                            {"register", index_sass.base},
-                            {"unroll_pc_offsets", index_sass.unroll_pc_offsets},
-                            {"adjacent_memory_accesses", index_sass.unrolls.size() - std::count(index_sass.unrolls.begin(), index_sass.unrolls.end(), 0)}
-                        };
-                    }
-                    else
-                    {
-                        if (index_sass.reg_load_type == VEC_64)
-                        {
-                            std::cout << "INFO  ::  Register " << index_sass.base << ", in line number " << index_sass.line_number << " of your code, is already using 64-bit width vectorized load" << std::endl;
-                        }
-                        if (index_sass.reg_load_type == VEC_128)
-                        {
-                            std::cout << "INFO  ::  Register " << index_sass.base << ", in line number " << index_sass.line_number << " of your code, is already using 128-bit width vectorized load" << std::endl;
-                        }
-                        else
-                        {
-                            std::cout << "INFO  ::  Using vectorized load for register " << index_sass.base << ", in line number " << index_sass.line_number << " of your code, might not boost performance" << std::endl;
-                        }
-                        line_result = {
-                            {"severity", "INFO"},
-                            {"line_number", index_sass.line_number},
-                            {"pc_offset", index_sass.pcOffset},
-                            {"register", index_sass.base},
-                            {"register_load_type", index_sass.reg_load_type}
-                        };
-                    }
-
-                    // Map kernel with the PC Stall map
-                    for (auto [k_pc, v_pc] : pc_stall_map)
-                    {
-                        if ((k_pc == k_sass)) // analyze for the same kernel (sass analysis and pc sampling analysis)
-                        {
-                            for (const auto &j : v_pc)
-                            {
-                                if ((index_sass.line_number == j.line_number) && (index_sass.base == read_register_pair(j.sass_instruction).first)) // analyze for the same line numbers in the code and same registers in SASS
-                                {
-                                    /*
-                                    Example: Register R12 in line number 28 in your code (for example) has 1 unrolls done by the compiler
-                                    This line has a SASS instruction:    (06f0) LDG.E.SYS R15, [R12+-0x4] ;
-                                    This SASSS instruction has no corresponding PC sampling stalls
-                                    */
-
-                                    // Print the number of current number of active registers
-                                    if ((index_sass.reg_load_type == VEC_64) || (index_sass.reg_load_type == VEC_128) || (index_sass.reg_load_type == VEC_32))
-                                    {
-                                        int pcOffset_to_search = j.pc_offset;
-                                        std::vector<live_registers>::iterator reg_search_it = std::find_if(live_register_map[k_sass].begin(), live_register_map[k_sass].end(), [&](const live_registers &register_index)
-                                                                                                           { return pcOffset_to_search == std::stoul(register_index.pcOffset, nullptr, 16); });
-                                        if (reg_search_it != live_register_map[k_sass].end())
-                                        {
-                                            // std::cout << reg_search_it->gen_reg << ", " << reg_search_it->pred_reg << " ," << reg_search_it->u_gen_reg << std::endl;
-                                            std::cout << "INFO  ::  Total current registers for the SASS instruction: " << reg_search_it->gen_reg + reg_search_it->pred_reg + reg_search_it->u_gen_reg << std::endl;
-                                            line_result["used_register_count"] = reg_search_it->gen_reg + reg_search_it->pred_reg + reg_search_it->u_gen_reg;
-                                            if (reg_search_it->change_reg_from_last > 0)
-                                            {
-                                                std::cout << "Increased register pressure with " << std::abs(reg_search_it->change_reg_from_last) << " more registers compared to last SASS instruction" << std::endl;
-                                                line_result["register_pressure_increase"] = std::abs(reg_search_it->change_reg_from_last);
-                                            }
-                                        }
-                                    }
-
-                                    // Note: Only printing PC stalls if there are unrolls present in the SASS for the register
-                                    if (((index_sass.unrolls.size() - std::count(index_sass.unrolls.begin(), index_sass.unrolls.end(), 0)) > 0) && (index_sass.reg_load_type == VEC_32))
-                                    {
-                                        print_stalls_percentage(j);
-                                    }
-                                    break; // once register matched/found, get out of the loop
-                                }
-                            }
-                        }
-                    }
-
-                    if (!line_result.is_null())
-                        kernel_result["occurrences"].push_back(line_result);
+                    most_samples = &samples->second;
                 }
             }
+            if (most_samples != nullptr)
+            {
+                print_stalls_percentage(*most_samples);
+            }
+
+            kernel_result["occurrences"].push_back(line_result);
+        }
+        kernel_result["total"] = candidates.size();
+
+        if (candidates.empty())
+        {
+            std::cout << "INFO  ::  No adjacent scalar loads or stores found which can be combined into a vectorized access" << std::endl;
+        }
+        else
+        {
+            std::cout << "INFO  ::  Vectorizing the " << candidates.size() << " candidates saves " << total_saved << " load and store instructions";
+            if (conditional_count > 0)
+            {
+                std::cout << " (without the " << conditional_count << " candidates which require an unknown alignment)";
+            }
+            if (memory_samples > 0)
+            {
+                std::cout << " and about " << 100.0 * total_samples_saved / memory_samples << " % of the samples of the memory instructions";
+            }
+            std::cout << std::endl;
+            kernel_result["instructions_saved"] = total_saved;
+            kernel_result["weighted_samples_saved"] = total_samples_saved;
         }
 
         // Map kernel with metrics collected
@@ -176,23 +221,23 @@ json merge_analysis_vectorize(std::unordered_map<std::string, load_counter> vect
 int main(int argc, char **argv)
 {
     std::string filename_hpctoolkit_sass = argv[1];
-    auto sass_vectorize_tuple = vectorized_analysis(filename_hpctoolkit_sass);
+    auto sass_vectorize_tuple = profile_stage("vectorized_analysis", [&] { return vectorized_analysis(filename_hpctoolkit_sass); });
     std::unordered_map<std::string, load_counter> vectorize_analysis_map = std::get<0>(sass_vectorize_tuple);
     std::unordered_map<std::string, std::vector<register_data>> register_map = std::get<1>(sass_vectorize_tuple);
 
     std::string filename_sampling = argv[4];
-    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::VECTORIZED_LOAD);
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::VECTORIZED_LOAD); });
 
     std::string filename_metrics = argv[5];
-    std::unordered_map<std::string, kernel_metrics> metric_map = create_metrics(filename_metrics);
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
 
     std::string filename_registers = argv[6];
-    std::unordered_map<std::string, std::vector<live_registers>> live_register_map = live_registers_analysis(filename_registers);
+    std::unordered_map<std::string, std::vector<live_registers>> live_register_map = profile_stage("live_registers_analysis", [&] { return live_registers_analysis(filename_registers); });
 
     int save_as_json = std::strcmp(argv[7], "true") == 0;
     std::string json_output_dir = argv[8];
 
-    json result = merge_analysis_vectorize(vectorize_analysis_map, register_map, pc_stall_map, metric_map, live_register_map);
+    json result = profile_stage("merge_analysis_vectorize", [&] { return merge_analysis_vectorize(vectorize_analysis_map, register_map, pc_stall_map, metric_map, live_register_map); });
 
     if (save_as_json)
     {
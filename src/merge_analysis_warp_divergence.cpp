@@ -11,6 +11,7 @@
 #include "parser_pcsampling.hpp"
 #include "parser_metrics.hpp"
 #include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
 
 using json = nlohmann::json;
 
@@ -121,20 +122,20 @@ json merge_analysis_divergence(std::unordered_map<std::string, std::vector<branc
 int main(int argc, char **argv)
 {
     std::string filename_hpctoolkit_sass = argv[1];
-    auto divergence_tuple = branches_detection(filename_hpctoolkit_sass);
+    auto divergence_tuple = profile_stage("branches_detection", [&] { return branches_detection(filename_hpctoolkit_sass); });
     std::unordered_map<std::string, std::vector<branch_counter>> divergence_analysis_map = std::get<0>(divergence_tuple);
     std::unordered_map<std::string, int> branch_target_map = std::get<1>(divergence_tuple);
 
     std::string filename_sampling = argv[4];
-    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::WARP_DIVERGENCE);
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::WARP_DIVERGENCE); });
 
     std::string filename_metrics = argv[5];
-    std::unordered_map<std::string, kernel_metrics> metric_map = create_metrics(filename_metrics);
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
 
     int save_as_json = std::strcmp(argv[6], "true") == 0;
     std::string json_output_dir = argv[7];
 
-    json result = merge_analysis_divergence(divergence_analysis_map, branch_target_map, pc_stall_map, metric_map);
+    json result = profile_stage("merge_analysis_divergence", [&] { return merge_analysis_divergence(divergence_analysis_map, branch_target_map, pc_stall_map, metric_map); });
 
     if (save_as_json)
     {
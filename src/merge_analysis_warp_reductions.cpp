@@ -0,0 +1,271 @@
+/**
+ * Merge analysis for reductions within a warp
+ * SASS analysis - shared memory tree reductions (LDS -> add -> STS steps separated by BAR) and atomics (ATOMG, RED, ATOMS) to a warp-uniform or data dependent address without warp aggregation
+ * PC Sampling analysis - pc stalls (all instructions of the tree reduction, the atomic) -> samples and barrier samples of the tree reduction, samples of the atomic
+ * Metric analysis - get metrics for entire kernel -> L2 sectors of global atomics and reductions, executed shared atomics
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_sass_warp_reductions.hpp"
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+// Share of the kernel samples on the reduction from which it is reported as WARNING
+const double warp_reduction_sample_share_threshold = 0.01;
+// Steps of a tree reduction with a stride below the warp size (16, 8, 4, 2, 1), which a warp can do with shuffles alone
+const int warp_reduction_steps = 5;
+
+void print_stalls_percentage(const pc_issue_samples &index)
+{
+    // Printing the stall with percentage of samples
+    auto total_samples = 0;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        total_samples += j.second;
+    }
+    std::unordered_map<std::string, int> map_stall_name_count;
+    for (const auto &j : index.stall_name_count_pair)
+    {
+        map_stall_name_count[mapping_stall_reasons_to_names(j.first)] += j.second;
+    }
+    std::cout << "Stalls are detected with % of occurence for the SASS instruction" << std::endl;
+    for (const auto &[k, v] : map_stall_name_count)
+    {
+        std::cout << k << " (" << (100.0 * v) / total_samples << " %)" << std::endl;
+    }
+}
+
+/// @brief Warp reduction intrinsic for the operation and data type, __reduce_*_sync needs 32 bit integers and sm_80
+std::string get_warp_reduction_intrinsic(const std::string &operation, const std::string &data_type, int sm_version)
+{
+    bool integer = data_type == "S32" || data_type == "U32";
+    if (integer && sm_version >= 80 && (operation == "ADD" || operation == "MIN" || operation == "MAX"))
+    {
+        return "__reduce_" + std::string(operation == "ADD" ? "add" : operation == "MIN" ? "min" : "max") + "_sync";
+    }
+    if (integer && sm_version >= 80 && (operation == "AND" || operation == "OR" || operation == "XOR"))
+    {
+        return "__reduce_" + std::string(operation == "AND" ? "and" : operation == "OR" ? "or" : "xor") + "_sync";
+    }
+    return "__shfl_down_sync";
+}
+
+/// @brief Merge analysis (SASS, CUPTI, Metrics) for reductions within a warp
+/// @param reduction_map Tree reductions and atomics without warp aggregation of every kernel
+/// @param atomic_map pcOffsets of all global atomics of every kernel
+/// @param sm_version SM version of the SASS
+/// @param pc_stall_map CUPTI warp stalls
+/// @param metric_map Metric analysis
+json merge_analysis_warp_reductions(std::unordered_map<std::string, std::vector<warp_reduction>> reduction_map, std::unordered_map<std::string, std::vector<std::string>> atomic_map, int sm_version,
+                                    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map, std::unordered_map<std::string, kernel_metrics> metric_map)
+{
+    json result;
+
+    for (auto [k_sass, v_sass] : reduction_map)
+    {
+        json kernel_result = {
+            {"occurrences", json::array()}
+        };
+
+        // Fix for blank kernel name appearing in the analysis_map
+        if (k_sass == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Warp reduction analysis for kernel: " << k_sass << "   --------------------- " << std::endl;
+        if (v_sass.empty())
+        {
+            std::cout << "INFO  ::  No shared memory tree reductions or atomics without warp aggregation" << std::endl;
+            result[k_sass] = kernel_result;
+            continue;
+        }
+
+        std::unordered_map<int, pc_issue_samples> samples_by_pc = get_samples_by_pc(pc_stall_map[k_sass]);
+        int kernel_samples = 0;
+        for (const auto &j : pc_stall_map[k_sass])
+        {
+            kernel_samples += get_sample_count(j);
+        }
+
+        // Samples of all global atomics, to weight the aggregatable ones (the instruction count if there are no samples)
+        int atomic_samples = 0, aggregatable_samples = 0, aggregatable_atomics = 0;
+        for (const auto &pc_offset : atomic_map[k_sass])
+        {
+            auto samples = samples_by_pc.find(std::stoi(pc_offset, nullptr, 16));
+            atomic_samples += samples != samples_by_pc.end() ? get_sample_count(samples->second) : 0;
+        }
+
+        for (const auto &index_sass : v_sass)
+        {
+            bool tree = index_sass.kind == "tree_loop" || index_sass.kind == "tree_unrolled";
+            int region_samples = 0, barrier_samples = 0;
+            const pc_issue_samples *hottest = nullptr;
+            for (const auto &pc_offset : index_sass.pc_offsets)
+            {
+                auto samples = samples_by_pc.find(std::stoi(pc_offset, nullptr, 16));
+                if (samples != samples_by_pc.end())
+                {
+                    region_samples += get_sample_count(samples->second);
+                    barrier_samples += get_sample_count(samples->second, "barrier");
+                    hottest = hottest == nullptr || get_sample_count(samples->second) > get_sample_count(*hottest) ? &samples->second : hottest;
+                }
+            }
+            double sample_share = kernel_samples > 0 ? (double)region_samples / kernel_samples : 0;
+            bool hot = kernel_samples == 0 || sample_share >= warp_reduction_sample_share_threshold;
+            bool important = hot && index_sass.kind != "atomic_data_dependent";
+            std::string intrinsic = get_warp_reduction_intrinsic(index_sass.operation, index_sass.data_type, sm_version);
+            if (index_sass.kind == "atomic_uniform" && index_sass.global)
+            {
+                aggregatable_atomics++;
+                aggregatable_samples += region_samples;
+            }
+
+            std::cout << (important ? "WARNING   ::  " : "INFO  ::  ");
+            if (tree)
+            {
+                std::cout << "Shared memory tree reduction (" << index_sass.operation << ", " << index_sass.data_type << ") at line number " << index_sass.line_number << " (pcOffset "
+                          << index_sass.pcOffset << " to " << index_sass.end_pcOffset << ", " << index_sass.sass_instruction << ")";
+                if (index_sass.kind == "tree_loop")
+                {
+                    std::cout << ": a loop with " << index_sass.steps << " LDS -> " << index_sass.operation << " -> STS steps and " << index_sass.barriers << " barriers per iteration"
+                              << (index_sass.halving ? ", halving the stride" : "") << std::endl;
+                    std::cout << "The last " << warp_reduction_steps << " iterations (stride below 32) synchronize the whole block for the work of a single warp";
+                }
+                else
+                {
+                    std::cout << ": " << index_sass.steps << " unrolled LDS -> " << index_sass.operation << " -> STS steps with " << index_sass.barriers << " barriers" << std::endl;
+                    if (index_sass.warp_synchronous_steps > 0)
+                    {
+                        std::cout << index_sass.warp_synchronous_steps << " steps rely on the threads of a warp running in lockstep without a barrier, which is not guaranteed since Volta "
+                                  << "(independent thread scheduling) unless __syncwarp() separates them" << std::endl;
+                    }
+                    std::cout << "The steps with a stride below 32 synchronize the whole block for the work of a single warp";
+                }
+                std::cout << ". Reduce within each warp with " << intrinsic << " first, write one value per warp to shared memory and reduce these with one more warp reduction: "
+                          << "one barrier instead of one per step (cooperative_groups::reduce does the same)" << std::endl;
+                if (region_samples > 0)
+                {
+                    std::cout << "The reduction has " << region_samples << " samples (" << 100 * sample_share << " % of the kernel), " << barrier_samples << " of them waiting at a barrier" << std::endl;
+                }
+            }
+            else
+            {
+                std::cout << (index_sass.global ? "Global" : "Shared") << " atomic " << index_sass.operation << " (" << index_sass.data_type << ") at line number " << index_sass.line_number
+                          << " (pcOffset " << index_sass.pcOffset << ", " << index_sass.sass_instruction << ")";
+                if (index_sass.kind == "atomic_uniform")
+                {
+                    std::cout << ": every thread of a warp updates the same address, the " << (index_sass.global ? "L2 cache" : "shared memory") << " serializes up to 32 updates per warp instruction"
+                              << std::endl;
+                    if (index_sass.constant_value)
+                    {
+                        std::cout << "All threads add the same value: let one thread of the warp add it times __popc(__activemask()) (warp-aggregated atomic)";
+                    }
+                    else
+                    {
+                        std::cout << "Reduce the values within the warp with " << intrinsic << " and let one thread (lane 0) do the atomic (warp-aggregated atomic)";
+                    }
+                    std::cout << ", which reduces the atomic traffic up to 32x" << std::endl;
+                }
+                else
+                {
+                    std::cout << ": the address is only known at runtime, threads of a warp which update the same address (e.g. a histogram bin) are serialized" << std::endl;
+                    std::cout << "If the threads of a warp often hit the same address, group them with __match_any_sync, reduce within each group and let its leader do the atomic" << std::endl;
+                }
+                if (region_samples > 0)
+                {
+                    std::cout << "The atomic has " << region_samples << " samples (" << 100 * sample_share << " % of the kernel)" << std::endl;
+                }
+            }
+            if (hottest != nullptr)
+            {
+                print_stalls_percentage(*hottest);
+            }
+
+            kernel_result["occurrences"].push_back({
+                {"severity", important ? "WARNING" : "INFO"},
+                {"kind", index_sass.kind},
+                {"line_number", index_sass.line_number},
+                {"pc_offset", index_sass.pcOffset},
+                {"end_pc_offset", index_sass.end_pcOffset},
+                {"loop_depth", index_sass.loop_depth},
+                {"operation", index_sass.operation},
+                {"data_type", index_sass.data_type},
+                {"steps", index_sass.steps},
+                {"barriers", index_sass.barriers},
+                {"warp_synchronous_steps", index_sass.warp_synchronous_steps},
+                {"halving", index_sass.halving},
+                {"global", index_sass.global},
+                {"constant_value", index_sass.constant_value},
+                {"intrinsic", intrinsic},
+                {"samples", region_samples},
+                {"barrier_samples", barrier_samples},
+                {"sample_share", sample_share}
+            });
+        }
+
+        // Map kernel with metrics collected
+        if (metric_map.count(k_sass))
+        {
+            const cuda_metrics &m = metric_map[k_sass].metrics_list;
+            double atomic_sectors = m.lts__t_sectors_op_atom + m.lts__t_sectors_op_red;
+            // Share of the global atomic traffic on atomics to a warp-uniform address, which warp aggregation reduces up to 32x
+            double aggregatable_share = atomic_samples > 0 ? (double)aggregatable_samples / atomic_samples
+                                        : !atomic_map[k_sass].empty() ? (double)aggregatable_atomics / atomic_map[k_sass].size() : 0;
+            double saved_sectors = atomic_sectors * aggregatable_share * (1 - 1.0 / 32);
+            std::cout << "INFO  ::  L2 sectors of global atomics and reductions: " << atomic_sectors << ", shared atomic instructions: " << m.sm__sass_inst_executed_op_shared_atom << std::endl;
+            if (saved_sectors > 0)
+            {
+                std::cout << "INFO  ::  Warp aggregation of the atomics to warp-uniform addresses saves up to " << saved_sectors << " L2 atomic sectors (" << 100 * aggregatable_share
+                          << " % of the global atomics, with full warps)" << std::endl;
+            }
+            kernel_result["metrics"] = {
+                {"atomic_sectors", atomic_sectors},
+                {"shared_atomics", m.sm__sass_inst_executed_op_shared_atom},
+                {"aggregatable_share", aggregatable_share},
+                {"estimated_saved_atomic_sectors", saved_sectors}
+            };
+        }
+
+        result[k_sass] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_hpctoolkit_sass = argv[1];
+    auto warp_reduction_tuple = profile_stage("warp_reduction_analysis", [&] { return warp_reduction_analysis(filename_hpctoolkit_sass); });
+    std::unordered_map<std::string, std::vector<warp_reduction>> reduction_map = std::get<0>(warp_reduction_tuple);
+    std::unordered_map<std::string, std::vector<std::string>> atomic_map = std::get<1>(warp_reduction_tuple);
+    int sm_version = std::get<2>(warp_reduction_tuple);
+
+    std::string filename_sampling = argv[4];
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> pc_stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(filename_sampling, filename_hpctoolkit_sass, analysis_kind::ALL); });
+
+    std::string filename_metrics = argv[5];
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(filename_metrics); });
+
+    int save_as_json = std::strcmp(argv[6], "true") == 0;
+    std::string json_output_dir = argv[7];
+
+    json result = profile_stage("merge_analysis_warp_reductions", [&] { return merge_analysis_warp_reductions(reduction_map, atomic_map, sm_version, pc_stall_map, metric_map); });
+
+    if (save_as_json)
+    {
+        std::ofstream json_file;
+        json_file.open(json_output_dir + "/warp_reductions.json");
+        json_file << result.dump(4);
+        json_file.close();
+    }
+
+    return 0;
+}
@@ -0,0 +1,322 @@
+/**
+ * Combines the results of the ranks of a multi-process (MPI) run
+ * PC Sampling analysis - pc stalls of every rank -> samples and stall profile of every kernel across the ranks
+ * Metric analysis - metrics of every rank -> spread of every metric of every kernel across the ranks
+ *
+ * @author Soumya Sen
+ */
+
+#include "parser_pcsampling.hpp"
+#include "parser_metrics.hpp"
+#include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
+#include <fstream>
+#include <cmath>
+#include <map>
+
+using json = nlohmann::json;
+
+// Ranks with a modified z-score above this are reported as outliers (Iglewicz and Hoaglin)
+const double outlier_z_score_threshold = 3.5;
+
+/// @brief Results of one rank
+struct rank_result
+{
+    std::string rank;
+    std::unordered_map<std::string, std::unordered_map<std::string, int>> kernel_stalls; // kernel -> stall name -> samples
+    std::unordered_map<std::string, kernel_metrics> metric_map;
+};
+
+/// @brief Spread of one value across the ranks
+struct rank_statistics
+{
+    double median;
+    double min;
+    double max;
+    std::string min_rank;
+    std::string max_rank;
+    std::vector<std::string> outlier_ranks;
+};
+
+/// @brief Get the ranks and their result files, as listed by GPUscout --merge_ranks
+/// @param filename_ranks List of ranks, one line per rank
+/// @return Rank and the sampling and metrics file of the rank
+std::vector<std::tuple<std::string, std::string, std::string>> get_rank_files(const std::string &filename_ranks)
+{
+    // Log file content looks like:
+    // rank: 3, samplingFile: /path/tmp-gpuscout/rank3/pcsampling_app_rank3.txt, metricsFile: /path/tmp-gpuscout/rank3/app_rank3_metrics_list
+    std::vector<std::tuple<std::string, std::string, std::string>> rank_files;
+
+    std::fstream file_ranks(filename_ranks, std::ios::in);
+    if (file_ranks.is_open())
+    {
+        std::string line, word;
+        while (std::getline(file_ranks, line))
+        {
+            std::vector<std::string> row;
+            std::stringstream str(line);
+            while (std::getline(str, word, ','))
+            {
+                row.push_back(word);
+            }
+            if (row.size() < 3)
+            {
+                continue;
+            }
+            rank_files.push_back(std::make_tuple(get_value_from_field(row[0]), get_value_from_field(row[1]), get_value_from_field(row[2])));
+        }
+    }
+    else
+        std::cout << "Could not open the file: " << filename_ranks << std::endl;
+
+    return rank_files;
+}
+
+double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return (n % 2) ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+/// @brief Median, extremes and outlier ranks of a value, using the median absolute deviation (MAD) as robust spread
+/// @param ranks Rank of every value
+/// @param values Value of every rank
+rank_statistics get_rank_statistics(const std::vector<std::string> &ranks, const std::vector<double> &values)
+{
+    rank_statistics statistics = {median(values), values.front(), values.front(), ranks.front(), ranks.front(), {}};
+
+    std::vector<double> deviations;
+    double mean_deviation = 0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (values[i] < statistics.min)
+        {
+            statistics.min = values[i];
+            statistics.min_rank = ranks[i];
+        }
+        if (values[i] > statistics.max)
+        {
+            statistics.max = values[i];
+            statistics.max_rank = ranks[i];
+        }
+        deviations.push_back(std::abs(values[i] - statistics.median));
+        mean_deviation += deviations.back() / values.size();
+    }
+
+    // Modified z-score 0.6745 * deviation / MAD. With more than half of the ranks at the median the MAD is 0,
+    // then the mean absolute deviation is used instead (deviation / (1.2533 * mean absolute deviation)).
+    double mad = median(deviations);
+    double scale = (mad > 0) ? mad / 0.6745 : 1.2533 * mean_deviation;
+    if (scale > 0)
+    {
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            if (deviations[i] / scale > outlier_z_score_threshold)
+            {
+                statistics.outlier_ranks.push_back(ranks[i]);
+            }
+        }
+    }
+
+    return statistics;
+}
+
+json statistics_to_json(const rank_statistics &statistics)
+{
+    return {
+        {"median", statistics.median},
+        {"min", statistics.min},
+        {"min_rank", statistics.min_rank},
+        {"max", statistics.max},
+        {"max_rank", statistics.max_rank},
+        {"outlier_ranks", statistics.outlier_ranks}
+    };
+}
+
+std::string join_ranks(const std::vector<std::string> &ranks)
+{
+    std::string joined;
+    for (const auto &rank : ranks)
+    {
+        joined += (joined.empty() ? "" : ", ") + rank;
+    }
+    return joined;
+}
+
+/// @brief Combine the stall samples and metrics of every kernel over all ranks
+/// @param ranks Results of every rank
+json merge_rank_results(const std::vector<rank_result> &ranks)
+{
+    json result;
+
+    std::map<std::string, bool> kernels;
+    for (const auto &rank : ranks)
+    {
+        for (const auto &[kernel, stalls] : rank.kernel_stalls)
+        {
+            kernels[kernel] = true;
+        }
+        for (const auto &[kernel, metrics] : rank.metric_map)
+        {
+            kernels[kernel] = true;
+        }
+    }
+
+    std::vector<std::string> rank_names;
+    for (const auto &rank : ranks)
+    {
+        rank_names.push_back(rank.rank);
+    }
+
+    for (const auto &[kernel, v] : kernels)
+    {
+        // Fix for blank kernel name appearing in the analysis_map
+        if (kernel == "")
+        {
+            continue;
+        }
+
+        std::cout << "--------------------- Cross-rank analysis for kernel: " << kernel << "   --------------------- " << std::endl;
+        json kernel_result;
+
+        // Samples and stall profile, a rank on which the kernel was not sampled counts with 0 samples
+        std::vector<double> samples;
+        std::map<std::string, std::vector<double>> stall_fractions;
+        std::map<std::string, int> combined_stalls;
+        std::map<std::string, int> per_rank_samples;
+        for (const auto &rank : ranks)
+        {
+            int total = 0;
+            auto it = rank.kernel_stalls.find(kernel);
+            if (it != rank.kernel_stalls.end())
+            {
+                for (const auto &[stall, count] : it->second)
+                {
+                    total += count;
+                    combined_stalls[stall] += count;
+                }
+            }
+            samples.push_back(total);
+            per_rank_samples[rank.rank] = total;
+        }
+        // The stall profile is only compared between the ranks which sampled the kernel
+        std::vector<std::string> sampled_ranks;
+        for (const auto &rank : ranks)
+        {
+            if (per_rank_samples[rank.rank] == 0)
+            {
+                continue;
+            }
+            sampled_ranks.push_back(rank.rank);
+            const auto &stalls = rank.kernel_stalls.at(kernel);
+            for (const auto &[stall, count] : combined_stalls)
+            {
+                auto it = stalls.find(stall);
+                stall_fractions[stall].push_back(it != stalls.end() ? (1.0 * it->second) / per_rank_samples[rank.rank] : 0);
+            }
+        }
+
+        rank_statistics sample_statistics = get_rank_statistics(rank_names, samples);
+        std::cout << "INFO  ::  Samples per rank: median " << sample_statistics.median << " (min " << sample_statistics.min << " on rank " << sample_statistics.min_rank
+                  << ", max " << sample_statistics.max << " on rank " << sample_statistics.max_rank << ")" << std::endl;
+        if (!sample_statistics.outlier_ranks.empty())
+        {
+            std::cout << "WARNING   ::  The time spent in this kernel differs on ranks: " << join_ranks(sample_statistics.outlier_ranks) << std::endl;
+        }
+        kernel_result["samples"] = statistics_to_json(sample_statistics);
+        kernel_result["samples"]["per_rank"] = per_rank_samples;
+        kernel_result["stall_samples"] = combined_stalls;
+
+        json stalls = json::object();
+        for (const auto &[stall, fractions] : stall_fractions)
+        {
+            rank_statistics stall_statistics = get_rank_statistics(sampled_ranks, fractions);
+            if (!stall_statistics.outlier_ranks.empty())
+            {
+                std::cout << "WARNING   ::  " << stall << " (median " << 100.0 * stall_statistics.median << " % of the samples) is unusual on ranks: "
+                          << join_ranks(stall_statistics.outlier_ranks) << " (" << 100.0 * stall_statistics.min << " % - " << 100.0 * stall_statistics.max << " %)" << std::endl;
+            }
+            stalls[stall] = statistics_to_json(stall_statistics);
+        }
+        kernel_result["stalls"] = stalls;
+
+        // Metrics of the ranks which ran the kernel under Nsight Compute
+        std::vector<std::string> metric_ranks;
+        std::map<std::string, std::vector<double>> metric_values;
+        for (const auto &rank : ranks)
+        {
+            auto it = rank.metric_map.find(kernel);
+            if (it == rank.metric_map.end())
+            {
+                continue;
+            }
+            metric_ranks.push_back(rank.rank);
+            json metrics = it->second.metrics_list;
+            for (const auto &[metric, value] : metrics.items())
+            {
+                if (value.is_number())
+                {
+                    metric_values[metric].push_back(value.get<double>());
+                }
+            }
+        }
+
+        json metrics = json::object();
+        for (const auto &[metric, values] : metric_values)
+        {
+            rank_statistics metric_statistics = get_rank_statistics(metric_ranks, values);
+            if (!metric_statistics.outlier_ranks.empty())
+            {
+                std::cout << "WARNING   ::  " << metric << " (median " << metric_statistics.median << ") is unusual on ranks: "
+                          << join_ranks(metric_statistics.outlier_ranks) << " (" << metric_statistics.min << " - " << metric_statistics.max << ")" << std::endl;
+            }
+            metrics[metric] = statistics_to_json(metric_statistics);
+        }
+        kernel_result["metrics"] = metrics;
+        kernel_result["rank_count"] = ranks.size();
+        kernel_result["sampled_rank_count"] = sampled_ranks.size();
+        kernel_result["metric_rank_count"] = metric_ranks.size();
+
+        result[kernel] = kernel_result;
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename_ranks = argv[1];
+    std::string filename_output = argv[2];
+
+    std::vector<rank_result> ranks;
+    for (const auto &[rank, filename_sampling, filename_metrics] : get_rank_files(filename_ranks))
+    {
+        rank_result rank_obj;
+        rank_obj.rank = rank;
+        if (!filename_sampling.empty())
+        {
+            rank_obj.kernel_stalls = profile_stage("get_kernel_stalls (rank " + rank + ")", [&] { return get_kernel_stalls(filename_sampling); });
+        }
+        if (!filename_metrics.empty())
+        {
+            rank_obj.metric_map = profile_stage("create_metrics (rank " + rank + ")", [&] { return create_metrics(filename_metrics); });
+        }
+        ranks.push_back(rank_obj);
+    }
+
+    if (ranks.empty())
+    {
+        std::cout << "No rank results found in: " << filename_ranks << std::endl;
+        return 1;
+    }
+
+    json result = profile_stage("merge_rank_results", [&] { return merge_rank_results(ranks); });
+
+    std::ofstream json_file;
+    json_file.open(filename_output);
+    json_file << result.dump(4);
+    json_file.close();
+
+    return 0;
+}
@@ -27,6 +27,14 @@ struct live_registers
     int pred_reg;
     int u_gen_reg;
     int change_reg_from_last; // change in number of registers compared to the last SASS instruction
+    int line_number;          // source line of the instruction
+};
+
+/// @brief Resources of a kernel fixed at compile time, which limit its occupancy
+struct kernel_resources
+{
+    int registers;     // allocated registers per thread
+    int static_shared; // bytes of static shared memory per block
 };
 
 std::string get_pcOffset_sass_registers(std::string line)
@@ -84,7 +92,7 @@ std::unordered_map<std::string, std::vector<live_registers>> live_registers_anal
     std::unordered_map<std::string, std::vector<live_registers>> counter_map;
     std::vector<live_registers> live_registers_vec;
     std::string kernel_name;
-    int code_line_number, last_inst_register_count;
+    int code_line_number = 0, last_inst_register_count;
 
     if (file.is_open())
     {
@@ -120,6 +128,7 @@ std::unordered_map<std::string, std::vector<live_registers>> live_registers_anal
                 counter_obj.gen_reg = get_all_registers(line)[0];
                 counter_obj.pred_reg = get_all_registers(line)[1];
                 counter_obj.u_gen_reg = get_all_registers(line)[2];
+                counter_obj.line_number = code_line_number;
 
                 counter_obj.change_reg_from_last = ((counter_obj.gen_reg) + (counter_obj.pred_reg) + (counter_obj.u_gen_reg)) - last_inst_register_count;
                 // update the current sum of registers to the last instruction registers count
@@ -145,3 +154,58 @@ std::unordered_map<std::string, std::vector<live_registers>> live_registers_anal
 
     return counter_map;
 }
+
+/// @brief Get the allocated registers and the static shared memory of every kernel from the SASS
+/// @param filename of the sass
+/// @return mapping of each kernel with its resources
+std::unordered_map<std::string, kernel_resources> get_kernel_resources(const std::string &filename)
+{
+    // Section headers look like:
+    //	.section	.text._Z6kernelPfS_,"ax",@progbits
+    //	.sectioninfo	@"SHI_REGISTERS=32"
+    //	.section	.nv.shared._Z6kernelPfS_,"aw",@nobits
+    //	.zero		4096
+    std::unordered_map<std::string, kernel_resources> resource_map;
+    std::string line, kernel_name, shared_kernel_name;
+
+    std::fstream file(filename, std::ios::in);
+    if (file.is_open())
+    {
+        while (std::getline(file, line))
+        {
+            if (line.find(".section\t.text.") != std::string::npos)
+            {
+                kernel_name = line.substr(line.find(".text.") + 6);
+                kernel_name = kernel_name.substr(0, kernel_name.find(','));
+                shared_kernel_name = "";
+                resource_map.emplace(kernel_name, kernel_resources{0, 0});
+            }
+            else if (line.find(".section\t.nv.shared.") != std::string::npos)
+            {
+                shared_kernel_name = line.substr(line.find(".nv.shared.") + 11);
+                shared_kernel_name = shared_kernel_name.substr(0, shared_kernel_name.find(','));
+                // .nv.shared.reserved.* is the shared memory reserved by the system, not by the kernel
+                if (shared_kernel_name.find("reserved.") == 0)
+                {
+                    shared_kernel_name = "";
+                }
+            }
+            else if (line.find("SHI_REGISTERS=") != std::string::npos && kernel_name != "")
+            {
+                resource_map[kernel_name].registers = std::stoi(line.substr(line.find("SHI_REGISTERS=") + 14));
+            }
+            else if (shared_kernel_name != "" && (line.find(".zero") != std::string::npos || line.find(".skip") != std::string::npos))
+            {
+                std::istringstream ss(line);
+                std::string directive;
+                int bytes = 0;
+                ss >> directive >> bytes;
+                resource_map[shared_kernel_name].static_shared += bytes;
+            }
+        }
+    }
+    else
+        std::cout << "Could not open the file: " << filename << std::endl;
+
+    return resource_map;
+}
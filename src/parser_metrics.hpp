@@ -92,6 +92,40 @@ struct cuda_metrics
     double memory_l2_theoretical_sectors_global_ideal;
     double memory_l1_wavefronts_shared;
     double memory_l1_wavefronts_shared_ideal;
+    // Roofline: floating point operations, DRAM traffic, elapsed time and the peaks of the device
+    double smsp__sass_thread_inst_executed_op_fadd_pred_on;
+    double smsp__sass_thread_inst_executed_op_fmul_pred_on;
+    double smsp__sass_thread_inst_executed_op_ffma_pred_on;
+    double smsp__sass_thread_inst_executed_op_dadd_pred_on;
+    double smsp__sass_thread_inst_executed_op_dmul_pred_on;
+    double smsp__sass_thread_inst_executed_op_dfma_pred_on;
+    double smsp__sass_thread_inst_executed_op_hadd_pred_on;
+    double smsp__sass_thread_inst_executed_op_hmul_pred_on;
+    double smsp__sass_thread_inst_executed_op_hfma_pred_on;
+    double sm__inst_executed_pipe_tensor;
+    double sm__sass_thread_inst_executed_op_ffma_pred_on_peak_sustained;
+    double sm__sass_thread_inst_executed_op_dfma_pred_on_peak_sustained;
+    double sm__sass_thread_inst_executed_op_hfma_pred_on_peak_sustained;
+    double dram__bytes_read;
+    double dram__bytes_write;
+    double dram__bytes_peak_sustained;
+    double dram__cycles_elapsed_per_second;
+    double sm__cycles_elapsed;
+    double sm__cycles_elapsed_per_second;
+    double gpu__time_duration;
+    double sm__throughput;
+    double gpu__compute_memory_throughput;
+    // Occupancy: launch configuration and limits of the device
+    double launch__block_size;
+    double launch__grid_size;
+    double launch__registers_per_thread;
+    double launch__shared_mem_per_block_static;
+    double launch__shared_mem_per_block_dynamic;
+    double launch__shared_mem_config_size;
+    double device__attribute_max_warps_per_multiprocessor;
+    double device__attribute_max_blocks_per_multiprocessor;
+    double device__attribute_max_registers_per_multiprocessor;
+    double device__attribute_max_shared_memory_per_multiprocessor;
 };
 
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(cuda_metrics, 
@@ -180,7 +214,7 @@ std::unordered_map<std::string, kernel_metrics> create_metrics(const std::string
     // Log file content header looks like:
     // "ID","Process ID","Process Name","Host Name","Kernel Name","Kernel Time","Context","Stream","Section Name","Metric Name","Metric Unit","Metric Value"
 
-    cuda_metrics metric_obj;
+    cuda_metrics metric_obj = {}; // metrics missing in the file (e.g. of older GPUscout versions) are 0
     std::unordered_map<std::string, kernel_metrics> metric_map; // create a map with the kernel id as the key and the metrics metadata as the value
 
     // Note: Clean the metrics_list file: remove from begining till the headers (including)
@@ -452,6 +486,134 @@ std::unordered_map<std::string, kernel_metrics> create_metrics(const std::string
         {
             metric_obj.smsp__inst_executed_op_ldgsts = std::stod(i[metric_value_index]);
         }
+        if (i[metric_name_index] == "smsp__sass_thread_inst_executed_op_fadd_pred_on.sum")
+        {
+            metric_obj.smsp__sass_thread_inst_executed_op_fadd_pred_on = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "smsp__sass_thread_inst_executed_op_fmul_pred_on.sum")
+        {
+            metric_obj.smsp__sass_thread_inst_executed_op_fmul_pred_on = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "smsp__sass_thread_inst_executed_op_ffma_pred_on.sum")
+        {
+            metric_obj.smsp__sass_thread_inst_executed_op_ffma_pred_on = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "smsp__sass_thread_inst_executed_op_dadd_pred_on.sum")
+        {
+            metric_obj.smsp__sass_thread_inst_executed_op_dadd_pred_on = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "smsp__sass_thread_inst_executed_op_dmul_pred_on.sum")
+        {
+            metric_obj.smsp__sass_thread_inst_executed_op_dmul_pred_on = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "smsp__sass_thread_inst_executed_op_dfma_pred_on.sum")
+        {
+            metric_obj.smsp__sass_thread_inst_executed_op_dfma_pred_on = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "smsp__sass_thread_inst_executed_op_hadd_pred_on.sum")
+        {
+            metric_obj.smsp__sass_thread_inst_executed_op_hadd_pred_on = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "smsp__sass_thread_inst_executed_op_hmul_pred_on.sum")
+        {
+            metric_obj.smsp__sass_thread_inst_executed_op_hmul_pred_on = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "smsp__sass_thread_inst_executed_op_hfma_pred_on.sum")
+        {
+            metric_obj.smsp__sass_thread_inst_executed_op_hfma_pred_on = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "sm__inst_executed_pipe_tensor.sum")
+        {
+            metric_obj.sm__inst_executed_pipe_tensor = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "sm__sass_thread_inst_executed_op_ffma_pred_on.sum.peak_sustained")
+        {
+            metric_obj.sm__sass_thread_inst_executed_op_ffma_pred_on_peak_sustained = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "sm__sass_thread_inst_executed_op_dfma_pred_on.sum.peak_sustained")
+        {
+            metric_obj.sm__sass_thread_inst_executed_op_dfma_pred_on_peak_sustained = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "sm__sass_thread_inst_executed_op_hfma_pred_on.sum.peak_sustained")
+        {
+            metric_obj.sm__sass_thread_inst_executed_op_hfma_pred_on_peak_sustained = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "dram__bytes_read.sum")
+        {
+            metric_obj.dram__bytes_read = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "dram__bytes_write.sum")
+        {
+            metric_obj.dram__bytes_write = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "dram__bytes.sum.peak_sustained")
+        {
+            metric_obj.dram__bytes_peak_sustained = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "dram__cycles_elapsed.avg.per_second")
+        {
+            metric_obj.dram__cycles_elapsed_per_second = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "sm__cycles_elapsed.avg")
+        {
+            metric_obj.sm__cycles_elapsed = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "sm__cycles_elapsed.avg.per_second")
+        {
+            metric_obj.sm__cycles_elapsed_per_second = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "gpu__time_duration.sum")
+        {
+            metric_obj.gpu__time_duration = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "sm__throughput.avg.pct_of_peak_sustained_elapsed")
+        {
+            metric_obj.sm__throughput = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "gpu__compute_memory_throughput.avg.pct_of_peak_sustained_elapsed")
+        {
+            metric_obj.gpu__compute_memory_throughput = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "launch__block_size")
+        {
+            metric_obj.launch__block_size = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "launch__grid_size")
+        {
+            metric_obj.launch__grid_size = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "launch__registers_per_thread")
+        {
+            metric_obj.launch__registers_per_thread = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "launch__shared_mem_per_block_static")
+        {
+            metric_obj.launch__shared_mem_per_block_static = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "launch__shared_mem_per_block_dynamic")
+        {
+            metric_obj.launch__shared_mem_per_block_dynamic = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "launch__shared_mem_config_size")
+        {
+            metric_obj.launch__shared_mem_config_size = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "device__attribute_max_warps_per_multiprocessor")
+        {
+            metric_obj.device__attribute_max_warps_per_multiprocessor = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "device__attribute_max_blocks_per_multiprocessor")
+        {
+            metric_obj.device__attribute_max_blocks_per_multiprocessor = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "device__attribute_max_registers_per_multiprocessor")
+        {
+            metric_obj.device__attribute_max_registers_per_multiprocessor = std::stod(i[metric_value_index]);
+        }
+        if (i[metric_name_index] == "device__attribute_max_shared_memory_per_multiprocessor")
+        {
+            metric_obj.device__attribute_max_shared_memory_per_multiprocessor = std::stod(i[metric_value_index]);
+        }
 
         if (i.size() > 9) {
             std::string id_name = i[9]; // key of the map is the name of the kernel
@@ -559,6 +721,98 @@ json total_memory_flow(const kernel_metrics &all_metrics, int total_SM)
     };
 }
 
+// A kernel reaching this percentage of the peak throughput of the SMs or of the memory is bound by it, below both it is latency-bound
+const double speed_of_light_bound_perc = 60;
+
+/// @brief Roofline data of a kernel for one floating point precision
+struct roofline_point
+{
+    std::string precision; // fp16, fp32 or fp64
+    double flops;
+    double arithmetic_intensity; // FLOP per DRAM byte
+    double achieved_flops_per_second;
+    double peak_flops_per_second;
+};
+
+/// @brief Roofline and speed-of-light classification of a kernel
+struct kernel_roofline
+{
+    std::vector<roofline_point> points;
+    double dram_bytes;
+    double elapsed_seconds;
+    double elapsed_cycles;
+    double tensor_instructions;
+    double achieved_bandwidth; // DRAM bytes per second
+    double peak_bandwidth;
+    double compute_throughput_perc; // speed of light of the SMs
+    double memory_throughput_perc;  // speed of light of the memory
+    std::string dominant_precision;
+    std::string roofline_side; // memory or compute, side of the ridge point of the dominant precision
+    std::string bound;         // memory, compute or latency
+};
+
+/// @brief Relate the floating point operations of a kernel to its DRAM traffic and to the peaks of the device
+/// @param all_metrics Metrics of the kernel
+kernel_roofline get_roofline(const kernel_metrics &all_metrics)
+{
+    const cuda_metrics &m = all_metrics.metrics_list;
+    kernel_roofline roofline = {};
+
+    roofline.dram_bytes = m.dram__bytes_read + m.dram__bytes_write;
+    roofline.elapsed_cycles = m.sm__cycles_elapsed;
+    roofline.tensor_instructions = m.sm__inst_executed_pipe_tensor;
+    // gpu__time_duration is in ns, without it the time is derived from the elapsed cycles
+    roofline.elapsed_seconds = m.gpu__time_duration > 0 ? m.gpu__time_duration * 1e-9
+                             : (m.sm__cycles_elapsed_per_second > 0 ? m.sm__cycles_elapsed / m.sm__cycles_elapsed_per_second : 0);
+
+    roofline.achieved_bandwidth = roofline.elapsed_seconds > 0 ? roofline.dram_bytes / roofline.elapsed_seconds : 0;
+    roofline.peak_bandwidth = m.dram__bytes_peak_sustained * m.dram__cycles_elapsed_per_second;
+
+    // A fused multiply-add counts as two operations, the peaks are given in FMA per cycle
+    std::vector<std::tuple<std::string, double, double>> precisions = {
+        {"fp16", m.smsp__sass_thread_inst_executed_op_hadd_pred_on + m.smsp__sass_thread_inst_executed_op_hmul_pred_on + 2 * m.smsp__sass_thread_inst_executed_op_hfma_pred_on,
+         2 * m.sm__sass_thread_inst_executed_op_hfma_pred_on_peak_sustained * m.sm__cycles_elapsed_per_second},
+        {"fp32", m.smsp__sass_thread_inst_executed_op_fadd_pred_on + m.smsp__sass_thread_inst_executed_op_fmul_pred_on + 2 * m.smsp__sass_thread_inst_executed_op_ffma_pred_on,
+         2 * m.sm__sass_thread_inst_executed_op_ffma_pred_on_peak_sustained * m.sm__cycles_elapsed_per_second},
+        {"fp64", m.smsp__sass_thread_inst_executed_op_dadd_pred_on + m.smsp__sass_thread_inst_executed_op_dmul_pred_on + 2 * m.smsp__sass_thread_inst_executed_op_dfma_pred_on,
+         2 * m.sm__sass_thread_inst_executed_op_dfma_pred_on_peak_sustained * m.sm__cycles_elapsed_per_second},
+    };
+
+    // The precision with the highest share of its peak decides on which side of the roofline the kernel is
+    double dominant_fraction = -1;
+    double compute_perc = 0;
+    for (const auto &[precision, flops, peak] : precisions)
+    {
+        roofline_point point = {precision, flops, roofline.dram_bytes > 0 ? flops / roofline.dram_bytes : 0,
+                                roofline.elapsed_seconds > 0 ? flops / roofline.elapsed_seconds : 0, peak};
+        roofline.points.push_back(point);
+
+        double fraction = point.peak_flops_per_second > 0 ? point.achieved_flops_per_second / point.peak_flops_per_second : 0;
+        if (flops > 0 && fraction > dominant_fraction)
+        {
+            dominant_fraction = fraction;
+            roofline.dominant_precision = precision;
+            double ridge_point = roofline.peak_bandwidth > 0 ? peak / roofline.peak_bandwidth : 0;
+            roofline.roofline_side = (ridge_point > 0 && point.arithmetic_intensity >= ridge_point) ? "compute" : "memory";
+        }
+        compute_perc = std::max(compute_perc, 100 * fraction);
+    }
+
+    // sm__throughput and gpu__compute_memory_throughput also cover the other pipelines and the caches
+    double memory_perc = roofline.peak_bandwidth > 0 ? 100 * roofline.achieved_bandwidth / roofline.peak_bandwidth : 0;
+    roofline.compute_throughput_perc = std::max(compute_perc, m.sm__throughput);
+    roofline.memory_throughput_perc = std::max(memory_perc, m.gpu__compute_memory_throughput);
+
+    if (std::max(roofline.compute_throughput_perc, roofline.memory_throughput_perc) < speed_of_light_bound_perc)
+        roofline.bound = "latency";
+    else if (roofline.memory_throughput_perc >= roofline.compute_throughput_perc)
+        roofline.bound = "memory";
+    else
+        roofline.bound = "compute";
+
+    return roofline;
+}
+
 void load_data_memory_flow(const kernel_metrics &all_metrics)
 {
     // std::cout << "For kernel name: " << all_metrics.kernel_name << std::endl;
@@ -11,6 +11,7 @@
 #include <iostream>
 #include <iomanip>
 #include <unordered_map>
+#include <map>
 #include <string>
 #include <vector>
 #include <tuple>
@@ -19,6 +20,7 @@
 #include <utility>
 #include <algorithm>
 #include <memory>
+#include <cmath>
 
 /// @brief Kind of bottleneck analysis performed
 enum analysis_kind
@@ -32,6 +34,9 @@ enum analysis_kind
     TEXTURE_USE,
     SHARED_USE,
     DATATYPE_CONVERSION,
+    SHARED_MEMORY_ACCESS,
+    GLOBAL_MEMORY_ACCESS,
+    PREDICATION,
 };
 
 /// @brief Based on the type of bottleneck detection analysis, the relevant SASS instructions are returned
@@ -46,7 +51,7 @@ bool sampling_type(analysis_kind analysis_kind, std::string line)
     }
     if (analysis_kind == REGISTER_SPILLING)
     {
-        return (line.find("STL ") != std::string::npos) || (line.find("LDL ") != std::string::npos);
+        return (line.find(" STL") != std::string::npos) || (line.find(" LDL") != std::string::npos);
     }
     if (analysis_kind == RESTRICT_USE)
     {
@@ -55,7 +60,8 @@ bool sampling_type(analysis_kind analysis_kind, std::string line)
     if (analysis_kind == VECTORIZED_LOAD)
     {
         // return (line.find("LDG.E ") != std::string::npos) || (line.find("LDG.E.CI ") != std::string::npos) || (line.find("LDG.E.U ") != std::string::npos) || (line.find("LDG.E.CONSTANT.SYS ") != std::string::npos) || (line.find("LDG.E.SYS ") != std::string::npos);
-        return line.find("LDG.") != std::string::npos;
+        return (line.find("LDG.") != std::string::npos) || (line.find(" STG") != std::string::npos) || (line.find(" LDS") != std::string::npos) || (line.find(" STS") != std::string::npos) ||
+               (line.find(" LDL") != std::string::npos) || (line.find(" STL") != std::string::npos);
     }
     if (analysis_kind == ATOMICS_GLOBAL)
     {
@@ -77,6 +83,18 @@ bool sampling_type(analysis_kind analysis_kind, std::string line)
     {
         return (line.find("F2F") != std::string::npos) || (line.find("I2F") != std::string::npos) || (line.find("F2I") != std::string::npos);
     }
+    if (analysis_kind == SHARED_MEMORY_ACCESS)
+    {
+        return (line.find(" LDS") != std::string::npos) || (line.find(" STS") != std::string::npos) || (line.find(" ATOMS") != std::string::npos);
+    }
+    if (analysis_kind == GLOBAL_MEMORY_ACCESS)
+    {
+        return (line.find(" LDG.") != std::string::npos) || (line.find(" LDG ") != std::string::npos) || (line.find(" STG") != std::string::npos);
+    }
+    if (analysis_kind == PREDICATION)
+    {
+        return (line.find(" BRA ") != std::string::npos) || (line.find(" BSSY ") != std::string::npos) || (line.find(" BSYNC ") != std::string::npos);
+    }
 
     return false;
 }
@@ -172,6 +190,32 @@ struct pc_issue_samples
     std::vector<std::pair<std::string, int>> stall_name_count_pair;
 };
 
+/// @brief Number of samples of an instruction
+/// @param stall_reason Only count the samples of stall reasons containing this text (e.g. mio_throttle), all samples if empty
+int get_sample_count(const pc_issue_samples &samples, const std::string &stall_reason = "")
+{
+    int count = 0;
+    for (const auto &[stall_name, stall_count] : samples.stall_name_count_pair)
+    {
+        if (stall_reason.empty() || stall_name.find(stall_reason) != std::string::npos)
+        {
+            count += stall_count;
+        }
+    }
+    return count;
+}
+
+/// @brief Index the samples of the instructions of a kernel by their pcOffset
+std::unordered_map<int, pc_issue_samples> get_samples_by_pc(const std::vector<pc_issue_samples> &kernel_samples)
+{
+    std::unordered_map<int, pc_issue_samples> samples_by_pc;
+    for (const auto &samples : kernel_samples)
+    {
+        samples_by_pc[samples.pc_offset] = samples;
+    }
+    return samples_by_pc;
+}
+
 std::string get_pcoffset_from_sass(std::string line)
 {
     //         /*00a0*/                   ISETP.GE.AND P1, PT, R2, c[0x0][0x168], PT ;         -> extract 00a0
@@ -244,8 +288,9 @@ std::pair<std::string, int> get_stall_reason_from_sampling(std::string line)
 std::unordered_map<std::string, std::vector<pc_issue_samples>> get_warp_stalls(const std::string &filename_sampling, const std::string &filename_sass, analysis_kind analysis_input)
 {
 
-    // Get the pc sampling stall data from the file first
-    std::vector<std::vector<std::string>> data;
+    // Get the pc sampling stall data from the file first, indexed by kernel and pcoffset.
+    // The same pc appears once per buffer (and once per context if the files of several contexts are merged), the samples are summed up.
+    std::unordered_map<std::string, std::unordered_map<unsigned long, std::vector<std::pair<std::string, int>>>> data;
 
     std::fstream file_sampling(filename_sampling, std::ios::in);
     if (file_sampling.is_open())
@@ -253,14 +298,14 @@ std::unordered_map<std::string, std::vector<pc_issue_samples>> get_warp_stalls(c
         std::vector<std::string> row;
         std::string line, word;
 
-        // This will skip the first two lines
-        // https://stackoverflow.com/questions/33250380/c-skip-first-line-of-csv-file
-        std::getline(file_sampling, line);
-        std::getline(file_sampling, line);
-
-        // Read from the next lines (contains the data)
         while (std::getline(file_sampling, line))
         {
+            // Only the pc records contain the data, skip the buffer information
+            if (line.rfind("functionName: ", 0) != 0)
+            {
+                continue;
+            }
+
             row.clear();
 
             std::stringstream str(line);
@@ -269,7 +314,25 @@ std::unordered_map<std::string, std::vector<pc_issue_samples>> get_warp_stalls(c
             {
                 row.push_back(word);
             }
-            data.push_back(row);
+            if (row.size() < 7)
+            {
+                continue;
+            }
+
+            auto &stalls = data[get_kernelname_from_sampling(row[0])][std::stoul(get_pcoffset_from_sampling(row[2]))];
+            for (auto j = 0; j < get_stallcount_from_sampling(row[6]) && 7 + j < (int)row.size(); j++)
+            {
+                std::pair<std::string, int> stall_count_pair = get_stall_reason_from_sampling(row[7 + j]);
+                auto existing = std::find_if(stalls.begin(), stalls.end(), [&stall_count_pair](const auto &stall) { return stall.first == stall_count_pair.first; });
+                if (existing != stalls.end())
+                {
+                    existing->second += stall_count_pair.second;
+                }
+                else
+                {
+                    stalls.push_back(stall_count_pair);
+                }
+            }
         }
     }
     else
@@ -285,7 +348,7 @@ std::unordered_map<std::string, std::vector<pc_issue_samples>> get_warp_stalls(c
     std::unordered_map<std::string, std::vector<pc_issue_samples>> counter_map;
     std::string kernel_name;
     int code_line_number;
-    std::vector<pc_issue_samples> pc_samp_vec;
+    std::vector<pc_issue_samples> *pc_samp_vec = &counter_map[kernel_name]; // samples of the current kernel, filled in place
     std::vector<std::pair<std::string, int>> stalls_vec;
 
     if (file_sass.is_open())
@@ -298,12 +361,13 @@ std::unordered_map<std::string, std::vector<pc_issue_samples>> get_warp_stalls(c
                 pc_obj.pc_offset = 0;
                 pc_obj.sass_instruction = "";
                 pc_obj.stall_name_count_pair.clear();
-                pc_samp_vec.clear();
 
                 // https://cplusplus.com/reference/string/string/erase/     - erase part of a string
                 line.erase(line.begin(), line.begin() + 16); // erase the first 16 character of the name of the kernel
                 line.erase(line.end() - 15, line.end());     // erase the last 15 character of the name of the kernel
                 kernel_name = line;
+                pc_samp_vec = &counter_map[kernel_name];
+                pc_samp_vec->clear();
                 // std::cout << kernel_name << std::endl;
             }
 
@@ -319,27 +383,22 @@ std::unordered_map<std::string, std::vector<pc_issue_samples>> get_warp_stalls(c
                 std::string pcoffset_sass_hex = get_pcoffset_from_sass(line);
                 unsigned long pcoffset_sass_dec = std::stoul(pcoffset_sass_hex, nullptr, 16); // hex to dec conversion using std::stoul
 
-                // Traverse through the pc sampling file to match the pcoffset
-                for (auto i : data)
+                // Look up the pcoffset in the pc sampling data of the kernel (the sampling file contains data for all the kernels together)
+                auto kernel_data = data.find(kernel_name);
+                if (kernel_data != data.end())
                 {
-                    auto pcoffset_sampling = get_pcoffset_from_sampling(i[2]);
-                    if ((kernel_name == get_kernelname_from_sampling(i[0])) && (pcoffset_sass_dec == std::stoul(pcoffset_sampling))) // Note: sampling file contains data for both the kernels together
+                    auto pc_data = kernel_data->second.find(pcoffset_sass_dec);
+                    if (pc_data != kernel_data->second.end())
                     {
                         pc_obj.line_number = code_line_number;
                         pc_obj.pc_offset = pcoffset_sass_dec;
                         pc_obj.sass_instruction = line; // note change this entire line to only give the command
-                        for (auto j = 0; j < get_stallcount_from_sampling(i[6]); j++)
-                        {
-                            std::pair<std::string, int> stall_count_pair = get_stall_reason_from_sampling(i[7 + j]);
-                            stalls_vec.push_back(stall_count_pair);
-                        }
+                        stalls_vec = pc_data->second;
                         pc_obj.stall_name_count_pair = stalls_vec;
-                        pc_samp_vec.push_back(pc_obj);
+                        pc_samp_vec->push_back(pc_obj);
                     }
                 }
             }
-
-            counter_map[kernel_name] = pc_samp_vec;
         }
     }
     else
@@ -375,4 +434,201 @@ std::unordered_map<std::string, std::vector<pc_issue_samples>> get_warp_stalls(c
     return counter_map;
 }
 
+/// @brief Get the warp stalls of every kernel, summed over all pcs
+/// @param filename_sampling PC sampling data file
+/// @return Stall samples per kernel and stall reason
+std::unordered_map<std::string, std::unordered_map<std::string, int>> get_kernel_stalls(const std::string &filename_sampling)
+{
+    std::unordered_map<std::string, std::unordered_map<std::string, int>> kernel_stalls; // kernel -> stall name -> samples
+
+    std::fstream file_sampling(filename_sampling, std::ios::in);
+    if (file_sampling.is_open())
+    {
+        std::string line, word;
+        while (std::getline(file_sampling, line))
+        {
+            if (line.rfind("functionName: ", 0) != 0)
+            {
+                continue;
+            }
+
+            std::vector<std::string> row;
+            std::stringstream str(line);
+            while (std::getline(str, word, ','))
+            {
+                row.push_back(word);
+            }
+            if (row.size() < 7)
+            {
+                continue;
+            }
+
+            std::string kernel_name = get_kernelname_from_sampling(row[0]);
+            int stall_count = get_stallcount_from_sampling(row[6]);
+            for (int j = 0; j < stall_count && 7 + j < (int)row.size(); j++)
+            {
+                std::pair<std::string, int> stall_count_pair = get_stall_reason_from_sampling(row[7 + j]);
+                kernel_stalls[kernel_name][mapping_stall_reasons_to_names(stall_count_pair.first)] += stall_count_pair.second;
+            }
+        }
+    }
+    else
+        std::cout << "Could not open the file: " << filename_sampling << std::endl;
+
+    return kernel_stalls;
+}
+
+/// @brief Warp stall samples of one launch bucket, i.e. a range of consecutive kernel launches
+struct launch_bucket_stalls
+{
+    std::string context_id; // launch ids are counted per context, empty if the file has one context
+    int bucket;
+    long first_launch_id;
+    long last_launch_id;
+    std::unordered_map<std::string, std::unordered_map<std::string, int>> kernel_stalls; // kernel -> stall name -> samples
+};
+
+/// @brief Get the value of a "key: value" field
+/// @param field Field of a comma separated line, e.g. " First Launch Id: 10"
+/// @return The value, e.g. "10"
+std::string get_value_from_field(const std::string &field)
+{
+    std::string::size_type i = field.find(": ");
+    return (i != std::string::npos) ? field.substr(i + 2) : "";
+}
+
+/// @brief Get the warp stalls of every kernel per launch bucket, as printed by pc_sampling_utility --launch-file
+/// @param filename_sampling Per launch bucket PC sampling data file
+/// @return Stall samples per kernel and stall reason for every launch bucket, ordered by the launches
+std::vector<launch_bucket_stalls> get_launch_bucket_stalls(const std::string &filename_sampling)
+{
+    // Log file content looks like:
+    // Launch Bucket: 3, First Launch Id: 3, Last Launch Id: 3, First Correlation Id: 41, Last Correlation Id: 41, Buffers: 2, Context Id: 1
+    // ...
+    // functionName: _Z6HistSMPiiPfi, functionIndex: 11, pcOffset: 320, lineNumber:0, fileName: ERROR_NO_CUBIN, dirName: , stallReasonCount: 2, smsp__pcsamp_warps_issue_stalled_mio_throttle: 1, smsp__pcsamp_warps_issue_stalled_wait: 1
+    std::vector<launch_bucket_stalls> buckets;
+
+    std::fstream file_sampling(filename_sampling, std::ios::in);
+    if (file_sampling.is_open())
+    {
+        std::string line, word;
+        while (std::getline(file_sampling, line))
+        {
+            std::vector<std::string> row;
+            std::stringstream str(line);
+            while (std::getline(str, word, ','))
+            {
+                row.push_back(word);
+            }
+
+            if (line.rfind("Launch Bucket: ", 0) == 0 && row.size() >= 3)
+            {
+                launch_bucket_stalls bucket_obj;
+                bucket_obj.bucket = std::stoi(get_value_from_field(row[0]));
+                bucket_obj.first_launch_id = std::stol(get_value_from_field(row[1]));
+                bucket_obj.last_launch_id = std::stol(get_value_from_field(row[2]));
+                bucket_obj.context_id = row.size() >= 7 ? get_value_from_field(row[6]) : "";
+                buckets.push_back(bucket_obj);
+            }
+            else if (line.rfind("functionName: ", 0) == 0 && row.size() >= 7 && !buckets.empty())
+            {
+                std::string kernel_name = get_kernelname_from_sampling(row[0]);
+                int stall_count = get_stallcount_from_sampling(row[6]);
+                for (int j = 0; j < stall_count && 7 + j < (int)row.size(); j++)
+                {
+                    std::pair<std::string, int> stall_count_pair = get_stall_reason_from_sampling(row[7 + j]);
+                    buckets.back().kernel_stalls[kernel_name][mapping_stall_reasons_to_names(stall_count_pair.first)] += stall_count_pair.second;
+                }
+            }
+        }
+    }
+    else
+        std::cout << "Could not open the file: " << filename_sampling << std::endl;
+
+    return buckets;
+}
+
+/// @brief Total variation distance between two stall profiles (0 - identical, 1 - disjoint)
+double profile_distance(const std::map<std::string, double> &a, const std::map<std::string, double> &b)
+{
+    std::map<std::string, double> difference = a;
+    for (const auto &[k, v] : b)
+    {
+        difference[k] -= v;
+    }
+    double distance = 0;
+    for (const auto &[k, v] : difference)
+    {
+        distance += std::abs(v);
+    }
+    return distance / 2;
+}
+
+/// @brief A CUDA context whose samples were collected, and the device it ran on
+struct sampling_context
+{
+    std::string context_id;
+    std::string device_id;
+    std::string device_name;
+    std::string compute_capability;
+    std::string sampling_file;
+    bool sass_matched; // the device architecture is the one of the analyzed cubin
+};
+
+/// @brief Get the sampled contexts, as listed by generate_sampling_stalls.sh
+/// @param filename_devices List of contexts, one "key: value" field per line and an empty line after every context
+/// @return The sampled contexts, the sampling files are relative to the directory of filename_devices
+std::vector<sampling_context> get_sampling_contexts(const std::string &filename_devices)
+{
+    // Log file content looks like:
+    // contextUid: 1
+    // deviceId: 0
+    // deviceName: NVIDIA A100-SXM4-40GB
+    // computeCapability: 80
+    // samplingFile: pcsampling_stencil_ctx1.txt
+    // sassMatched: true
+    //
+    std::vector<sampling_context> contexts;
+
+    std::string directory = filename_devices.find('/') != std::string::npos ? filename_devices.substr(0, filename_devices.find_last_of('/') + 1) : "";
+
+    std::fstream file_devices(filename_devices, std::ios::in);
+    if (file_devices.is_open())
+    {
+        // Fields of the current context, the device name is taken as is (it may contain commas)
+        std::unordered_map<std::string, std::string> fields;
+        std::string line;
+        while (true)
+        {
+            bool has_line = static_cast<bool>(std::getline(file_devices, line));
+            std::string::size_type i = has_line ? line.find(": ") : std::string::npos;
+            if (i != std::string::npos)
+            {
+                fields[line.substr(0, i)] = line.substr(i + 2);
+                continue;
+            }
+            if (fields.count("contextUid") && fields.count("samplingFile"))
+            {
+                sampling_context context_obj;
+                context_obj.context_id = fields["contextUid"];
+                context_obj.device_id = fields["deviceId"];
+                context_obj.device_name = fields["deviceName"];
+                context_obj.compute_capability = fields["computeCapability"];
+                context_obj.sampling_file = directory + fields["samplingFile"];
+                context_obj.sass_matched = fields["sassMatched"] == "true";
+                contexts.push_back(context_obj);
+            }
+            fields.clear();
+            if (!has_line)
+            {
+                break;
+            }
+        }
+    }
+    else
+        std::cout << "Could not open the file: " << filename_devices << std::endl;
+
+    return contexts;
+}
+
 #endif // PARSER_PCSAMPLING_HPP
@@ -0,0 +1,98 @@
+/**
+ * PTX code analysis to detect the asynchronous copies (cp.async), their commits and wait groups as written in the source
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_PTX_ASYNC_COPY_HPP
+#define PARSER_PTX_ASYNC_COPY_HPP
+
+#include <iostream>
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+/// @brief Asynchronous copy instructions of a kernel in the PTX
+struct ptx_async_copy_counter
+{
+    int copy_count;                             // cp.async.ca/cg.shared.global
+    int bulk_copy_count;                        // cp.async.bulk (TMA, Hopper)
+    int commit_count;                           // cp.async.commit_group
+    int mbarrier_arrive_count;                  // cp.async.mbarrier.arrive
+    std::vector<std::pair<int, int>> waits;     // code line number and N of cp.async.wait_group N, -1 for cp.async.wait_all
+};
+
+/// @brief Detects the asynchronous copies by parsing the PTX file
+/// @param filename Decoded PTX file
+/// @return mapping of each kernel with its asynchronous copy instructions
+std::unordered_map<std::string, ptx_async_copy_counter> ptx_async_copy_analysis(const std::string &filename)
+{
+    std::string line;
+    std::fstream file(filename, std::ios::in);
+    std::unordered_map<std::string, ptx_async_copy_counter> counter_map;
+    ptx_async_copy_counter *counter_obj = nullptr;
+    int code_line_number = 0;
+
+    if (file.is_open())
+    {
+        while (std::getline(file, line))
+        {
+            if (line.find(".entry ") != std::string::npos) // denotes start of the kernel, e.g. .visible .entry _Z6kernelPf(
+            {
+                std::string kernel_name = line.substr(line.find(".entry ") + 7);
+                kernel_name = kernel_name.substr(0, kernel_name.find('('));
+                counter_obj = &counter_map[kernel_name];
+                *counter_obj = {};
+                code_line_number = 0;
+                continue;
+            }
+            if (counter_obj == nullptr)
+            {
+                continue;
+            }
+
+            if (line.find(".loc") != std::string::npos)
+            {
+                // .loc	1 39 34      -> extract 39
+                std::istringstream ss(line.substr(line.find(".loc") + 4));
+                int file_index;
+                ss >> file_index >> code_line_number;
+            }
+            else if (line.find("cp.async.bulk") != std::string::npos)
+            {
+                // The bulk copies have their own commit and wait groups
+                bool bulk_group = line.find("commit_group") != std::string::npos || line.find("wait_group") != std::string::npos;
+                counter_obj->bulk_copy_count += !bulk_group;
+            }
+            else if (line.find("cp.async.commit_group") != std::string::npos)
+            {
+                counter_obj->commit_count++;
+            }
+            else if (line.find("cp.async.wait_group") != std::string::npos)
+            {
+                counter_obj->waits.push_back({code_line_number, std::stoi(line.substr(line.find("cp.async.wait_group") + 19))});
+            }
+            else if (line.find("cp.async.wait_all") != std::string::npos)
+            {
+                counter_obj->waits.push_back({code_line_number, -1});
+            }
+            else if (line.find("cp.async.mbarrier.arrive") != std::string::npos)
+            {
+                counter_obj->mbarrier_arrive_count++;
+            }
+            else if (line.find("cp.async.") != std::string::npos)
+            {
+                counter_obj->copy_count++;
+            }
+        }
+    }
+    else
+        std::cout << "Could not open the file: " << filename << std::endl;
+
+    return counter_map;
+}
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * PTX code analysis to find the thread-private arrays which the PTX keeps in local memory (.local __local_depot)
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_PTX_LOCAL_MEMORY_HPP
+#define PARSER_PTX_LOCAL_MEMORY_HPP
+
+#include <iostream>
+#include <unordered_map>
+#include <string>
+#include <fstream>
+#include <cstdlib>
+
+/// @brief Local memory declared by a kernel or device function in the PTX
+struct ptx_local_memory
+{
+    int depot_bytes;   // size of the __local_depot, i.e. the arrays and structs which are not promoted to registers
+    int local_loads;   // ld.local
+    int local_stores;  // st.local
+};
+
+/// @brief Detects the local memory declarations by parsing the PTX file
+/// @param filename Decoded PTX file
+/// @return mapping of each kernel and device function with its local memory
+std::unordered_map<std::string, ptx_local_memory> ptx_local_memory_analysis(const std::string &filename)
+{
+    std::string line;
+    std::fstream file(filename, std::ios::in);
+    std::unordered_map<std::string, ptx_local_memory> local_memory_map;
+    ptx_local_memory *local_memory_obj = nullptr;
+
+    if (file.is_open())
+    {
+        while (std::getline(file, line))
+        {
+            // Start of a kernel or device function, e.g. .visible .entry _Z6kernelPf( or .func  (.param .b32 func_retval0) _Z3fooi(
+            if ((line.find(".entry ") != std::string::npos || line.find(".func ") != std::string::npos) && line.find('(') != std::string::npos)
+            {
+                std::string function_name = line.substr(0, line.rfind('('));
+                function_name = function_name.substr(function_name.find_last_of(" \t") + 1);
+                local_memory_obj = &local_memory_map[function_name];
+                *local_memory_obj = {};
+                continue;
+            }
+            if (local_memory_obj == nullptr)
+            {
+                continue;
+            }
+
+            if (line.find("__local_depot") != std::string::npos && line.find('[') != std::string::npos)
+            {
+                // .local .align 8 .b8 	__local_depot0[40];      -> extract 40
+                local_memory_obj->depot_bytes += std::atoi(line.substr(line.find('[') + 1).c_str());
+            }
+            else if (line.find("ld.local") != std::string::npos)
+            {
+                local_memory_obj->local_loads++;
+            }
+            else if (line.find("st.local") != std::string::npos)
+            {
+                local_memory_obj->local_stores++;
+            }
+        }
+    }
+    else
+        std::cout << "Could not open the file: " << filename << std::endl;
+
+    return local_memory_map;
+}
+
+#endif
@@ -0,0 +1,184 @@
+/**
+ * SASS code analysis of the asynchronous global to shared memory copies (instruction LDGSTS, cp.async) of Ampere and newer GPUs
+ * For every loop which issues copies, the commits (LDGDEPBAR), the waits (DEPBAR.LE SB0, N) and the barriers (BAR.SYNC) give the number of pipeline stages
+ * and the instructions which overlap a copy before it is waited for
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_ASYNC_COPY_HPP
+#define PARSER_SASS_ASYNC_COPY_HPP
+
+#include "parser_sass_ir.hpp"
+#include <tuple>
+
+/// @brief Pipeline structure of a loop with asynchronous copies
+struct async_copy_loop
+{
+    int line_number;            // source line of the first instruction of the loop
+    std::string start_pcOffset;
+    std::string end_pcOffset;   // of the backward branch
+    std::vector<std::string> pc_offsets; // of all instructions of the loop
+    int instructions;
+    int copy_count;             // LDGSTS per iteration
+    int copy_bytes;             // bytes copied per thread and iteration
+    int commit_count;           // LDGDEPBAR per iteration
+    int prologue_commits;       // LDGDEPBAR before the loop, i.e. stages loaded ahead
+    bool has_wait;              // DEPBAR on the LDGSTS scoreboard inside the loop
+    int wait_pending;           // N of DEPBAR.LE SB0, N: copy groups which may still be in flight after the wait
+    int wait_line_number;
+    std::string wait_pcOffset;
+    std::vector<std::string> wait_pc_offsets;
+    int prefetch_distance;      // iterations between the commit of a copy and the wait for it
+    int stages;                 // shared memory buffers in use, prefetch_distance + 1
+    int overlap_instructions;   // instructions issued between the commit of a copy and the wait for it
+    std::vector<std::string> barrier_pc_offsets; // BAR.SYNC of the loop
+    bool barrier_after_wait;    // a barrier separates the wait from the shared loads of the copied data
+    bool uses_mbarrier;         // copies complete on an mbarrier (ARRIVES.LDGSTSBAR, cuda::pipeline with barriers)
+};
+
+/// @brief Asynchronous copy instructions of a kernel
+struct async_copy_counter
+{
+    int copy_count;             // LDGSTS
+    int commit_count;           // LDGDEPBAR
+    int wait_count;             // DEPBAR on the LDGSTS scoreboard
+    int copies_outside_loops;   // LDGSTS which are not part of a loop, e.g. the prologue of a pipeline
+};
+
+/// @brief Whether the instruction waits for asynchronous copies, e.g. DEPBAR.LE SB0, 0x1 (cp.async.wait_group 1)
+bool is_async_copy_wait(const sass_instruction &instruction_obj)
+{
+    return instruction_obj.opcode == "DEPBAR" && !instruction_obj.operands.empty() && instruction_obj.operands[0] == "SB0";
+}
+
+/// @brief Copy groups which may still be in flight after the wait, e.g. 1 for DEPBAR.LE SB0, 0x1
+int get_async_copy_wait_pending(const sass_instruction &instruction_obj)
+{
+    if (instruction_obj.operands.size() < 2)
+    {
+        return 0;
+    }
+    return (int)std::strtol(instruction_obj.operands[1].c_str(), nullptr, 0);
+}
+
+/// @brief SASS analysis of the asynchronous copy pipelines
+/// @param filename Disassembled SASS file
+/// @return Tuple of the innermost loops with copies of every kernel and the copy instructions of every kernel
+std::tuple<std::unordered_map<std::string, std::vector<async_copy_loop>>, std::unordered_map<std::string, async_copy_counter>> async_copy_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<async_copy_loop>> loop_map;
+    std::unordered_map<std::string, async_copy_counter> counter_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        std::vector<async_copy_loop> &loop_vec = loop_map[k_kernel];
+        async_copy_counter &counter_obj = counter_map[k_kernel];
+        counter_obj = {};
+        for (const auto &instruction_obj : v_kernel.instructions)
+        {
+            counter_obj.copy_count += instruction_obj.opcode == "LDGSTS";
+            counter_obj.commit_count += instruction_obj.opcode == "LDGDEPBAR";
+            counter_obj.wait_count += is_async_copy_wait(instruction_obj);
+            counter_obj.copies_outside_loops += instruction_obj.opcode == "LDGSTS" && instruction_obj.loop_depth == 0;
+        }
+        if (counter_obj.copy_count == 0)
+        {
+            continue;
+        }
+
+        for (const auto &loop : v_kernel.loops)
+        {
+            // Only innermost loops, the copies of an outer loop are part of its inner loops
+            if (!is_innermost_loop(v_kernel, loop))
+            {
+                continue;
+            }
+
+            async_copy_loop loop_obj = {};
+            loop_obj.line_number = loop.line_number;
+            loop_obj.start_pcOffset = v_kernel.instructions[loop.start_index].pcOffset;
+            loop_obj.end_pcOffset = v_kernel.instructions[loop.end_index].pcOffset;
+            int commit_index = -1, last_copy_index = -1, wait_index = -1;
+            for (int i = loop.start_index; i <= loop.end_index; i++)
+            {
+                const sass_instruction &instruction_obj = v_kernel.instructions[i];
+                loop_obj.instructions++;
+                loop_obj.pc_offsets.push_back(instruction_obj.pcOffset);
+                if (instruction_obj.opcode == "LDGSTS")
+                {
+                    loop_obj.copy_count++;
+                    loop_obj.copy_bytes += get_access_bytes(instruction_obj);
+                    last_copy_index = i;
+                }
+                else if (instruction_obj.opcode == "LDGDEPBAR")
+                {
+                    loop_obj.commit_count++;
+                    commit_index = i;
+                }
+                else if (is_async_copy_wait(instruction_obj))
+                {
+                    loop_obj.wait_pc_offsets.push_back(instruction_obj.pcOffset);
+                    // The first wait of the iteration decides how long the copies overlap
+                    if (wait_index < 0)
+                    {
+                        wait_index = i;
+                        loop_obj.wait_pending = get_async_copy_wait_pending(instruction_obj);
+                        loop_obj.wait_line_number = instruction_obj.line_number;
+                        loop_obj.wait_pcOffset = instruction_obj.pcOffset;
+                    }
+                }
+                else if (instruction_obj.opcode == "BAR" && !has_modifier(instruction_obj, "ARV"))
+                {
+                    loop_obj.barrier_pc_offsets.push_back(instruction_obj.pcOffset);
+                }
+                else if (instruction_obj.opcode == "ARRIVES" && has_modifier(instruction_obj, "LDGSTSBAR"))
+                {
+                    loop_obj.uses_mbarrier = true;
+                }
+            }
+            if (loop_obj.copy_count == 0)
+            {
+                continue;
+            }
+            for (int i = 0; i < loop.start_index; i++)
+            {
+                loop_obj.prologue_commits += v_kernel.instructions[i].opcode == "LDGDEPBAR";
+            }
+
+            // A copy committed in iteration i is waited for in iteration i + N if the wait follows the commit in the loop body (DEPBAR.LE SB0, N),
+            // otherwise one iteration later, as the wait at the top of the loop only sees the groups of the previous iterations
+            loop_obj.has_wait = wait_index >= 0;
+            int issue_index = commit_index >= 0 ? commit_index : last_copy_index;
+            if (loop_obj.has_wait)
+            {
+                loop_obj.prefetch_distance = wait_index > issue_index ? loop_obj.wait_pending : loop_obj.wait_pending + 1;
+                loop_obj.stages = loop_obj.prefetch_distance + 1;
+                loop_obj.overlap_instructions = loop_obj.prefetch_distance * loop_obj.instructions + wait_index - issue_index;
+
+                // The copies of the other threads are only visible after a barrier, which has to come before the first shared load of the stage
+                int first_load = -1;
+                for (int j = 1; j <= loop_obj.instructions && first_load < 0; j++)
+                {
+                    int i = loop.start_index + (wait_index - loop.start_index + j) % loop_obj.instructions;
+                    if (v_kernel.instructions[i].opcode == "LDS" || v_kernel.instructions[i].opcode == "LDSM")
+                    {
+                        first_load = j;
+                    }
+                }
+                for (int j = 1; j < first_load; j++)
+                {
+                    const sass_instruction &instruction_obj = v_kernel.instructions[loop.start_index + (wait_index - loop.start_index + j) % loop_obj.instructions];
+                    loop_obj.barrier_after_wait = loop_obj.barrier_after_wait || (instruction_obj.opcode == "BAR" && !has_modifier(instruction_obj, "ARV"));
+                }
+                loop_obj.barrier_after_wait = loop_obj.barrier_after_wait || first_load < 0;
+            }
+            loop_vec.push_back(loop_obj);
+        }
+    }
+
+    return std::make_tuple(loop_map, counter_map);
+}
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * SASS code analysis to predict the shared memory bank conflicts of every LDS, STS and ATOMS instruction
+ * The address is traced back to the thread index, the stride between the lanes of a warp gives the banks accessed
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_BANK_CONFLICTS_HPP
+#define PARSER_SASS_BANK_CONFLICTS_HPP
+
+#include "parser_sass_ir.hpp"
+
+const int shared_memory_banks = 32;
+const int shared_memory_bank_width = 4; // bytes
+
+/// @brief Predicted bank conflicts of a shared memory instruction
+struct shared_memory_access
+{
+    int line_number;
+    std::string pcOffset;
+    std::string sass_instruction;
+    std::string access_kind; // load, store or atomic
+    int access_bytes;        // bytes per thread
+    int loop_depth;
+    bool stride_known;       // false if the address could not be traced to the thread index
+    long long stride;        // bytes between the addresses of neighbouring lanes
+    int wavefronts;          // predicted wavefronts of a warp
+    int ideal_wavefronts;    // wavefronts without bank conflicts
+    int padding_bytes;       // padding of the stride which removes the conflicts, 0 if none was found
+};
+
+/// @brief Number of wavefronts (shared memory passes) needed for a warp whose lanes access the given stride
+/// Accesses wider than 4 bytes are split into phases of 128 bytes (half warps for 8 bytes, quarter warps for 16 bytes),
+/// in every phase, all distinct 4 byte words mapping to the same bank are serialized, the same word is broadcast (but not for atomics)
+int get_shared_memory_wavefronts(long long stride, int access_bytes, bool atomic = false)
+{
+    int lanes_per_phase = std::min(32, std::max(1, shared_memory_banks * shared_memory_bank_width / access_bytes));
+    int words_per_lane = std::max(1, access_bytes / shared_memory_bank_width);
+    int wavefronts = 0;
+    for (int phase_start = 0; phase_start < 32; phase_start += lanes_per_phase)
+    {
+        std::vector<std::multiset<long long>> bank_words(shared_memory_banks);
+        for (int lane = phase_start; lane < phase_start + lanes_per_phase; lane++)
+        {
+            for (int word = 0; word < words_per_lane; word++)
+            {
+                long long address = stride * lane + word * shared_memory_bank_width;
+                long long word_address = address >= 0 ? address / shared_memory_bank_width : -((-address + shared_memory_bank_width - 1) / shared_memory_bank_width);
+                auto &words = bank_words[((word_address % shared_memory_banks) + shared_memory_banks) % shared_memory_banks];
+                if (atomic || words.count(word_address) == 0)
+                {
+                    words.insert(word_address);
+                }
+            }
+        }
+        size_t ways = 1;
+        for (const auto &words : bank_words)
+        {
+            ways = std::max(ways, words.size());
+        }
+        wavefronts += ways;
+    }
+    return wavefronts;
+}
+
+/// @brief Smallest padding of the stride (in multiples of the access size) which removes the bank conflicts
+/// @return 0 if no padding up to 32 words helps
+int get_padding_bytes(long long stride, int access_bytes, bool atomic)
+{
+    int ideal_wavefronts = get_shared_memory_wavefronts(access_bytes, access_bytes);
+    for (int padding = access_bytes; padding <= shared_memory_banks * shared_memory_bank_width; padding += access_bytes)
+    {
+        if (get_shared_memory_wavefronts(stride + padding, access_bytes, atomic) <= ideal_wavefronts)
+        {
+            return padding;
+        }
+    }
+    return 0;
+}
+
+/// @brief SASS analysis of the bank conflicts of the shared memory accesses
+/// @param filename Disassembled SASS file
+/// @return mapping of each kernel with its shared memory accesses
+std::unordered_map<std::string, std::vector<shared_memory_access>> bank_conflict_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<shared_memory_access>> access_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        std::vector<shared_memory_access> &access_vec = access_map[k_kernel];
+        std::unordered_map<std::string, sass_value> cache;
+
+        for (int i = 0; i < (int)v_kernel.instructions.size(); i++)
+        {
+            const sass_instruction &instruction_obj = v_kernel.instructions[i];
+            shared_memory_access access_obj = {};
+            if (instruction_obj.opcode == "LDS")
+                access_obj.access_kind = "load";
+            else if (instruction_obj.opcode == "STS")
+                access_obj.access_kind = "store";
+            else if (instruction_obj.opcode == "ATOMS")
+                access_obj.access_kind = "atomic";
+            else
+                continue;
+
+            access_obj.line_number = instruction_obj.line_number;
+            access_obj.pcOffset = instruction_obj.pcOffset;
+            access_obj.sass_instruction = instruction_obj.sass_instruction;
+            access_obj.access_bytes = get_access_bytes(instruction_obj);
+            access_obj.loop_depth = instruction_obj.loop_depth;
+            access_obj.ideal_wavefronts = get_shared_memory_wavefronts(access_obj.access_bytes, access_obj.access_bytes);
+
+            sass_value address = get_address_value(v_kernel, i, cache);
+            access_obj.stride_known = get_lane_stride(address, access_obj.stride);
+            if (access_obj.stride_known)
+            {
+                bool atomic = access_obj.access_kind == "atomic";
+                access_obj.wavefronts = get_shared_memory_wavefronts(access_obj.stride, access_obj.access_bytes, atomic);
+                // Padding only helps if the lanes access different rows, i.e. the stride is larger than the element
+                if (access_obj.wavefronts > access_obj.ideal_wavefronts && std::abs(access_obj.stride) > access_obj.access_bytes)
+                {
+                    access_obj.padding_bytes = get_padding_bytes(std::abs(access_obj.stride), access_obj.access_bytes, atomic);
+                }
+            }
+            access_vec.push_back(access_obj);
+        }
+    }
+
+    return access_map;
+}
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * SASS code analysis of the barriers (instruction BAR, WARPSYNC, MEMBAR), their position in the loops and the work between consecutive barriers
+ * Barriers without memory accesses since the previous barrier are redundant, barriers after divergent code make the threads which skipped it wait
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_BARRIERS_HPP
+#define PARSER_SASS_BARRIERS_HPP
+
+#include "parser_sass_ir.hpp"
+
+/// @brief A barrier or memory fence
+struct barrier_instruction
+{
+    int line_number;
+    std::string pcOffset;
+    std::string sass_instruction;
+    std::string kind;                   // block (BAR.SYNC, BAR.RED), arrive (BAR.ARV), warp (WARPSYNC) or fence (MEMBAR)
+    int loop_depth;
+    std::string loop_pcOffset;          // first instruction of the innermost loop, empty outside of loops
+    int loop_line_number;
+    std::string previous_pcOffset;      // previous block barrier, of the previous iteration for the first barrier of a loop, empty if there is none
+    int instructions_since_previous;    // instructions since the previous block barrier (or the start of the kernel)
+    int memory_instructions_since_previous; // shared and global memory accesses since the previous block barrier
+    bool redundant;                     // a block barrier without memory accesses since the previous one
+    std::string divergent_branch_pcOffset; // divergent branch around the barrier, empty if the barrier is reached by all threads
+    int divergent_instructions;         // instructions skipped by a part of the threads since the previous block barrier
+};
+
+/// @brief Whether the instruction accesses memory which a barrier orders, e.g. shared or global loads and stores, atomics and waits for asynchronous copies
+bool is_barrier_ordered_access(const sass_instruction &instruction_obj)
+{
+    static const std::set<std::string> accesses = {"LDS", "STS", "LDSM", "STSM", "ATOMS", "LDG", "STG", "LD", "ST", "ATOM", "ATOMG", "RED", "REDG", "LDGSTS", "DEPBAR",
+                                                   "SULD", "SUST", "SURED", "SUATOM", "CALL", "UBLKCP", "UTMALDG", "UTMASTG", "SYNCS"};
+    return accesses.count(instruction_obj.opcode) > 0;
+}
+
+/// @brief Kind of the barrier, empty if the instruction is no barrier
+std::string get_barrier_kind(const sass_instruction &instruction_obj)
+{
+    if (instruction_obj.opcode == "BAR")
+        return has_modifier(instruction_obj, "ARV") ? "arrive" : "block";
+    if (instruction_obj.opcode == "WARPSYNC")
+        return "warp";
+    if (instruction_obj.opcode == "MEMBAR")
+        return "fence";
+    return "";
+}
+
+/// @brief SASS analysis of the barriers
+/// @param filename Disassembled SASS file
+/// @return mapping of each kernel with its barriers
+std::unordered_map<std::string, std::vector<barrier_instruction>> barrier_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<barrier_instruction>> barrier_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        std::vector<barrier_instruction> &barrier_vec = barrier_map[k_kernel];
+        std::unordered_map<std::string, sass_value> cache;
+        const std::vector<sass_instruction> &instructions = v_kernel.instructions;
+        int instruction_count = instructions.size();
+
+        // Regions of the forward branches which only a part of the threads of a warp takes, early exits (e.g. if (i >= n) return;) excluded
+        std::vector<std::pair<int, int>> divergent_regions;
+        for (int i = 0; i < instruction_count; i++)
+        {
+            if (instructions[i].opcode != "BRA" || instructions[i].predicate.empty())
+            {
+                continue;
+            }
+            auto target = v_kernel.label_index.find(get_branch_target(instructions[i]));
+            if (target == v_kernel.label_index.end() || target->second <= i || (target->second < instruction_count && instructions[target->second].opcode == "EXIT"))
+            {
+                continue;
+            }
+            if (is_divergent_predicate(v_kernel, i, cache))
+            {
+                divergent_regions.push_back({i, target->second});
+            }
+        }
+
+        for (int i = 0; i < instruction_count; i++)
+        {
+            const sass_instruction &instruction_obj = instructions[i];
+            std::string kind = get_barrier_kind(instruction_obj);
+            if (kind.empty())
+            {
+                continue;
+            }
+
+            barrier_instruction barrier_obj = {};
+            barrier_obj.line_number = instruction_obj.line_number;
+            barrier_obj.pcOffset = instruction_obj.pcOffset;
+            barrier_obj.sass_instruction = instruction_obj.sass_instruction;
+            barrier_obj.kind = kind;
+            barrier_obj.loop_depth = instruction_obj.loop_depth;
+            const sass_loop *loop = get_innermost_loop(v_kernel, i);
+            if (loop != nullptr)
+            {
+                barrier_obj.loop_pcOffset = instructions[loop->start_index].pcOffset;
+                barrier_obj.loop_line_number = loop->line_number;
+            }
+
+            // Previous block barrier: the last one before in the same loop, otherwise the last one of the previous iteration (outside of loops the last one before in the kernel)
+            std::vector<int> path; // instructions between the previous block barrier and this one
+            int previous = -1;
+            for (int j = i - 1; j >= (loop != nullptr ? loop->start_index : 0) && previous < 0; j--)
+            {
+                if (get_barrier_kind(instructions[j]) == "block")
+                    previous = j;
+                else
+                    path.push_back(j);
+            }
+            if (previous < 0 && loop != nullptr)
+            {
+                for (int j = loop->end_index; j > i && previous < 0; j--)
+                {
+                    if (get_barrier_kind(instructions[j]) == "block")
+                        previous = j;
+                    else
+                        path.push_back(j);
+                }
+            }
+            if (previous < 0 && loop != nullptr && kind == "block")
+            {
+                previous = i; // the only block barrier of the loop, the previous one is itself in the previous iteration
+            }
+            barrier_obj.previous_pcOffset = previous >= 0 ? instructions[previous].pcOffset : "";
+            barrier_obj.instructions_since_previous = path.size();
+            std::vector<bool> in_path(instruction_count, false);
+            for (int j : path)
+            {
+                barrier_obj.memory_instructions_since_previous += is_barrier_ordered_access(instructions[j]);
+                in_path[j] = true;
+            }
+            barrier_obj.redundant = kind == "block" && previous >= 0 && previous != i && barrier_obj.memory_instructions_since_previous == 0;
+
+            // Divergent branches around the barrier, or skipping a part of the work since the previous barrier
+            for (const auto &[branch, target] : divergent_regions)
+            {
+                if (branch < i && target > i)
+                {
+                    barrier_obj.divergent_branch_pcOffset = instructions[branch].pcOffset;
+                }
+                else if (in_path[branch] && target <= i)
+                {
+                    barrier_obj.divergent_instructions += target - branch - 1;
+                }
+            }
+            barrier_vec.push_back(barrier_obj);
+        }
+    }
+
+    return barrier_map;
+}
+
+#endif
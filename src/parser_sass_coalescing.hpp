@@ -0,0 +1,109 @@
+/**
+ * SASS code analysis to predict the coalescing of every global memory load and store (instruction LDG, STG)
+ * The address is traced back to the thread and block index, the stride between the lanes of a warp gives the sectors accessed per request
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_COALESCING_HPP
+#define PARSER_SASS_COALESCING_HPP
+
+#include "parser_sass_ir.hpp"
+
+const int global_memory_sector_bytes = 32;
+
+/// @brief Predicted coalescing of a global memory instruction
+struct global_memory_access
+{
+    int line_number;
+    std::string pcOffset;
+    std::string sass_instruction;
+    std::string access_kind;   // load or store
+    std::string pattern;       // coalesced, uniform (all lanes access the same address), strided or gather/scatter
+    int access_bytes;          // bytes per thread
+    int loop_depth;
+    bool stride_known;         // false if the address could not be traced to the thread index (e.g. loaded from memory)
+    long long stride;          // bytes between the addresses of neighbouring lanes
+    long long sector_offset;   // byte offset of the address of lane 0 within its sector, from the constant part of the address
+    int sectors;               // predicted 32 byte sectors per request of a warp
+    int ideal_sectors;         // sectors of a fully coalesced and aligned access
+};
+
+/// @brief Number of 32 byte sectors touched by a warp whose lanes access the given stride, starting at the offset within a sector
+int get_global_memory_sectors(long long offset, long long stride, int access_bytes)
+{
+    // Round down to the sector, also for negative strides
+    auto sector = [](long long address) { return address >= 0 ? address / global_memory_sector_bytes : -((-address + global_memory_sector_bytes - 1) / global_memory_sector_bytes); };
+    std::set<long long> sectors;
+    for (int lane = 0; lane < 32; lane++)
+    {
+        long long first = offset + stride * lane;
+        long long last = first + access_bytes - 1;
+        for (long long s = sector(first); s <= sector(last); s++)
+        {
+            sectors.insert(s);
+        }
+    }
+    return sectors.size();
+}
+
+/// @brief SASS analysis of the coalescing of the global memory accesses
+/// Parts of the address which are the same for all threads (pointers, blockIdx.x * blockDim.x) are assumed to be sector aligned
+/// @param filename Disassembled SASS file
+/// @return mapping of each kernel with its global memory accesses
+std::unordered_map<std::string, std::vector<global_memory_access>> coalescing_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<global_memory_access>> access_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        std::vector<global_memory_access> &access_vec = access_map[k_kernel];
+        std::unordered_map<std::string, sass_value> cache;
+
+        for (int i = 0; i < (int)v_kernel.instructions.size(); i++)
+        {
+            const sass_instruction &instruction_obj = v_kernel.instructions[i];
+            global_memory_access access_obj = {};
+            if (instruction_obj.opcode == "LDG")
+                access_obj.access_kind = "load";
+            else if (instruction_obj.opcode == "STG")
+                access_obj.access_kind = "store";
+            else
+                continue;
+
+            access_obj.line_number = instruction_obj.line_number;
+            access_obj.pcOffset = instruction_obj.pcOffset;
+            access_obj.sass_instruction = instruction_obj.sass_instruction;
+            access_obj.access_bytes = get_access_bytes(instruction_obj);
+            access_obj.loop_depth = instruction_obj.loop_depth;
+            access_obj.ideal_sectors = get_global_memory_sectors(0, access_obj.access_bytes, access_obj.access_bytes);
+
+            // The low register of the 64 bit address holds the thread dependent part, the carry into the high register is ignored
+            sass_value address = get_address_value(v_kernel, i, cache);
+            access_obj.stride_known = get_lane_stride(address, access_obj.stride);
+            if (!access_obj.stride_known)
+            {
+                access_obj.pattern = "gather/scatter";
+                // Worst case, every lane accesses its own sector
+                access_obj.sectors = 32 * ((access_obj.access_bytes + global_memory_sector_bytes - 1) / global_memory_sector_bytes);
+                access_vec.push_back(access_obj);
+                continue;
+            }
+
+            access_obj.sector_offset = ((address.constant % global_memory_sector_bytes) + global_memory_sector_bytes) % global_memory_sector_bytes;
+            access_obj.sectors = get_global_memory_sectors(access_obj.sector_offset, access_obj.stride, access_obj.access_bytes);
+            if (access_obj.stride == 0)
+                access_obj.pattern = "uniform";
+            else if (std::abs(access_obj.stride) == access_obj.access_bytes)
+                access_obj.pattern = "coalesced";
+            else
+                access_obj.pattern = "strided";
+            access_vec.push_back(access_obj);
+        }
+    }
+
+    return access_map;
+}
+
+#endif
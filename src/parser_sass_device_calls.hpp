@@ -0,0 +1,167 @@
+/**
+ * SASS code analysis of the calls of non-inlined device functions (instruction CALL) and their ABI overhead
+ * Call site - argument and return value moves around the CALL; callee - stack pointer adjustment, saves and restores of the caller's registers (STL/LDL) and RET
+ * Indirect calls (function pointers, virtual functions) call a register, calls of functions without SASS (e.g. vprintf, malloc) are external
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_DEVICE_CALLS_HPP
+#define PARSER_SASS_DEVICE_CALLS_HPP
+
+#include "parser_sass_ir.hpp"
+#include <tuple>
+
+// Instructions before and after a CALL searched for the moves of the arguments and the return value
+const int device_call_move_window = 16;
+
+/// @brief A call of a device function
+struct device_call
+{
+    int line_number;
+    std::string pcOffset;
+    std::string sass_instruction;
+    std::string callee;             // empty for indirect calls
+    std::string kind;               // direct, indirect or external
+    int loop_depth;
+    std::string loop_pcOffset;      // first instruction of the innermost loop, empty outside of loops
+    int argument_moves;             // register moves of the arguments and the return address before the CALL
+    int result_moves;               // register moves of the return value after the CALL
+    std::vector<std::string> pc_offsets; // the CALL and the moves
+};
+
+/// @brief A device function which is called, with the instructions of its ABI overhead
+struct device_function
+{
+    std::string name;
+    int instructions;
+    int call_sites;                 // calls of the function in all kernels and functions
+    int saved_registers;            // STL of registers of the caller before the function writes them
+    int restored_registers;         // LDL of the saved registers
+    int stack_adjustments;          // instructions which move the stack pointer (R1)
+    int returns;                    // RET
+    int other_local_accesses;       // remaining STL/LDL, spills and thread-private arrays of the function
+    std::vector<std::string> overhead_pc_offsets; // saves, restores, stack adjustments and returns
+    std::vector<std::string> pc_offsets;          // all instructions of the function
+};
+
+/// @brief Whether the instruction only copies a value into a register
+bool is_register_move(const sass_instruction &instruction_obj)
+{
+    return instruction_obj.opcode == "MOV" || instruction_obj.opcode == "MOV32I" || instruction_obj.opcode == "UMOV" ||
+           (instruction_obj.opcode == "IMAD" && has_modifier(instruction_obj, "MOV"));
+}
+
+/// @brief Detects the calls of device functions and the ABI overhead of the called functions by parsing the SASS file
+/// @param filename Disassembled SASS file
+/// @return Tuple of the calls of every kernel (and device function) and the called device functions by name
+std::tuple<std::unordered_map<std::string, std::vector<device_call>>, std::unordered_map<std::string, device_function>> device_call_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<device_call>> call_map;
+    std::unordered_map<std::string, device_function> function_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        std::vector<device_call> &call_vec = call_map[k_kernel];
+        const std::vector<sass_instruction> &instructions = v_kernel.instructions;
+        int instruction_count = instructions.size();
+
+        for (int i = 0; i < instruction_count; i++)
+        {
+            const sass_instruction &instruction_obj = instructions[i];
+            if (instruction_obj.opcode != "CALL")
+            {
+                continue;
+            }
+            std::string target = get_branch_target(instruction_obj);
+            if (!target.empty() && v_kernel.label_index.count(target))
+            {
+                continue; // internal subroutine of the compiler, e.g. the 64 bit division
+            }
+
+            device_call call_obj = {};
+            call_obj.line_number = instruction_obj.line_number;
+            call_obj.pcOffset = instruction_obj.pcOffset;
+            call_obj.sass_instruction = instruction_obj.sass_instruction;
+            call_obj.callee = target;
+            call_obj.kind = target.empty() ? "indirect" : kernel_map.count(target) ? "direct" : "external";
+            call_obj.loop_depth = instruction_obj.loop_depth;
+            const sass_loop *loop = get_innermost_loop(v_kernel, i);
+            call_obj.loop_pcOffset = loop != nullptr ? instructions[loop->start_index].pcOffset : "";
+            call_obj.pc_offsets.push_back(instruction_obj.pcOffset);
+            for (int j = i - 1; j >= 0 && j >= i - device_call_move_window && is_register_move(instructions[j]); j--)
+            {
+                call_obj.argument_moves++;
+                call_obj.pc_offsets.push_back(instructions[j].pcOffset);
+            }
+            for (int j = i + 1; j < instruction_count && j <= i + device_call_move_window && is_register_move(instructions[j]); j++)
+            {
+                call_obj.result_moves++;
+                call_obj.pc_offsets.push_back(instructions[j].pcOffset);
+            }
+            call_vec.push_back(call_obj);
+
+            if (call_obj.kind == "direct")
+            {
+                function_map[target].name = target;
+                function_map[target].call_sites++;
+            }
+        }
+    }
+
+    // ABI overhead of the called functions
+    for (auto &[k_function, v_function] : function_map)
+    {
+        const sass_kernel &function_obj = kernel_map[k_function];
+        const std::vector<sass_instruction> &instructions = function_obj.instructions;
+        v_function.instructions = instructions.size();
+        std::unordered_map<std::string, sass_value> cache;
+
+        // Stack offsets at which registers of the caller are saved, i.e. registers stored before the function writes them
+        std::set<long long> saved_offsets;
+        for (int i = 0; i < (int)instructions.size(); i++)
+        {
+            const sass_instruction &instruction_obj = instructions[i];
+            v_function.pc_offsets.push_back(instruction_obj.pcOffset);
+            long long stack_offset = 0;
+            bool stack_access = (instruction_obj.opcode == "STL" || instruction_obj.opcode == "LDL") && get_stack_offset(function_obj, i, cache, stack_offset);
+            const std::vector<std::string> &destinations = get_destination_registers(instruction_obj);
+
+            bool overhead = false;
+            if (stack_access && is_abi_register_save(function_obj, i))
+            {
+                v_function.saved_registers++;
+                saved_offsets.insert(stack_offset);
+                overhead = true;
+            }
+            else if (instruction_obj.opcode == "LDL" && stack_access && saved_offsets.count(stack_offset))
+            {
+                v_function.restored_registers++;
+                overhead = true;
+            }
+            else if (instruction_obj.opcode == "STL" || instruction_obj.opcode == "LDL")
+            {
+                v_function.other_local_accesses++;
+            }
+            else if (std::find(destinations.begin(), destinations.end(), "R1") != destinations.end())
+            {
+                v_function.stack_adjustments++;
+                overhead = true;
+            }
+            else if (instruction_obj.opcode == "RET")
+            {
+                v_function.returns++;
+                overhead = true;
+            }
+            if (overhead)
+            {
+                v_function.overhead_pc_offsets.push_back(instruction_obj.pcOffset);
+            }
+        }
+    }
+
+    return std::make_tuple(call_map, function_map);
+}
+
+#endif
@@ -0,0 +1,162 @@
+/**
+ * SASS code analysis of the double precision instructions (DADD, DMUL, DFMA, DSETP, DMNMX, MUFU.RCP64H, F2F.F64, ...) of every innermost loop and of the code outside of loops
+ * Operations on floats promoted to double (F2F.F64.F32) and double literals point to unintended double precision
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_FP64_HPP
+#define PARSER_SASS_FP64_HPP
+
+#include "parser_sass_ir.hpp"
+#include <tuple>
+#include <cctype>
+
+/// @brief Double precision instructions of an innermost loop, or of the code outside of loops
+struct fp64_region
+{
+    int line_number;            // source line of the first instruction of the loop, or of the first double precision instruction outside of loops
+    std::string start_pcOffset; // empty for the code outside of loops
+    std::string end_pcOffset;   // of the backward branch
+    int loop_depth;
+    int instructions;
+    std::map<std::string, int> fp64_count; // DADD, DMUL, DFMA, ... -> instructions
+    int fp64_instructions;      // double precision arithmetic, comparisons and MUFU.*64H
+    int conversions;            // conversions from or to double (F2F, I2F, F2I with F64)
+    int promotions;             // F2F.F64.F32, float to double
+    int demotions;              // F2F.F32.F64, double to float
+    int promoted_operations;    // double precision instructions with an operand promoted from float
+    int literal_operations;     // double precision instructions with an immediate operand (double literal)
+    std::vector<std::string> pc_offsets;      // of all instructions of the region
+    std::vector<std::string> fp64_pc_offsets; // of the double precision instructions and conversions
+};
+
+/// @brief Whether the instruction is a double precision arithmetic, comparison or MUFU.*64H instruction
+bool is_fp64_instruction(const sass_instruction &instruction_obj)
+{
+    static const std::set<std::string> fp64 = {"DADD", "DMUL", "DFMA", "DSETP", "DSET", "DMNMX"};
+    if (fp64.count(instruction_obj.opcode))
+        return true;
+    return instruction_obj.opcode == "MUFU" && (has_modifier(instruction_obj, "RCP64H") || has_modifier(instruction_obj, "RSQ64H"));
+}
+
+/// @brief Whether the instruction converts from or to double precision
+bool is_fp64_conversion(const sass_instruction &instruction_obj)
+{
+    return (instruction_obj.opcode == "F2F" || instruction_obj.opcode == "I2F" || instruction_obj.opcode == "F2I" || instruction_obj.opcode == "FRND") && has_modifier(instruction_obj, "F64");
+}
+
+/// @brief Whether the conversion promotes a float to a double (F2F.F64.F32)
+bool is_fp64_promotion(const sass_instruction &instruction_obj)
+{
+    return instruction_obj.opcode == "F2F" && instruction_obj.modifiers.size() >= 2 && instruction_obj.modifiers[0] == "F64" && instruction_obj.modifiers[1] == "F32";
+}
+
+/// @brief Whether the operand is an immediate floating point value, e.g. 2.5 or -0.5
+bool is_float_immediate(const std::string &operand)
+{
+    size_t start = !operand.empty() && operand[0] == '-' ? 1 : 0;
+    return start < operand.size() && std::isdigit(operand[start]) && operand.compare(start, 2, "0x") != 0;
+}
+
+/// @brief Adds a double precision instruction to the region
+void add_fp64_instruction(const sass_kernel &kernel, int index, fp64_region &region_obj)
+{
+    const sass_instruction &instruction_obj = kernel.instructions[index];
+    if (is_fp64_conversion(instruction_obj))
+    {
+        region_obj.conversions++;
+        region_obj.promotions += is_fp64_promotion(instruction_obj);
+        region_obj.demotions += instruction_obj.opcode == "F2F" && !instruction_obj.modifiers.empty() && instruction_obj.modifiers[0] == "F32";
+        region_obj.fp64_pc_offsets.push_back(instruction_obj.pcOffset);
+        return;
+    }
+    if (!is_fp64_instruction(instruction_obj))
+    {
+        return;
+    }
+    region_obj.fp64_instructions++;
+    region_obj.fp64_count[instruction_obj.opcode]++;
+    region_obj.fp64_pc_offsets.push_back(instruction_obj.pcOffset);
+
+    bool promoted = false, literal = false;
+    for (const auto &source : get_source_operands(instruction_obj))
+    {
+        literal = literal || is_float_immediate(source);
+        std::string register_name = get_sass_register_name(source);
+        if (register_name.empty() || register_name[0] != 'R' || register_name == "RZ")
+        {
+            continue;
+        }
+        int definition = find_register_definition(kernel, index, register_name);
+        promoted = promoted || (definition >= 0 && is_fp64_promotion(kernel.instructions[definition]));
+    }
+    region_obj.promoted_operations += promoted;
+    region_obj.literal_operations += literal;
+}
+
+/// @brief SASS analysis of the double precision instructions
+/// @param filename Disassembled SASS file
+/// @return Tuple of the innermost loops (and the code outside of loops) with double precision instructions of every kernel and the SM version of the SASS
+std::tuple<std::unordered_map<std::string, std::vector<fp64_region>>, int> fp64_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<fp64_region>> region_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+    int sm_version = 0;
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        sm_version = std::max(sm_version, v_kernel.sm_version);
+        std::vector<fp64_region> &region_vec = region_map[k_kernel];
+
+        for (const auto &loop : v_kernel.loops)
+        {
+            // Only innermost loops, the instructions of an outer loop are counted in its inner loops
+            if (!is_innermost_loop(v_kernel, loop))
+            {
+                continue;
+            }
+
+            fp64_region region_obj = {};
+            region_obj.line_number = loop.line_number;
+            region_obj.start_pcOffset = v_kernel.instructions[loop.start_index].pcOffset;
+            region_obj.end_pcOffset = v_kernel.instructions[loop.end_index].pcOffset;
+            region_obj.loop_depth = v_kernel.instructions[loop.start_index].loop_depth;
+            for (int i = loop.start_index; i <= loop.end_index; i++)
+            {
+                region_obj.instructions++;
+                region_obj.pc_offsets.push_back(v_kernel.instructions[i].pcOffset);
+                add_fp64_instruction(v_kernel, i, region_obj);
+            }
+            if (!region_obj.fp64_pc_offsets.empty())
+            {
+                region_vec.push_back(region_obj);
+            }
+        }
+
+        // The code outside of loops
+        fp64_region region_obj = {};
+        for (int i = 0; i < (int)v_kernel.instructions.size(); i++)
+        {
+            if (v_kernel.instructions[i].loop_depth > 0)
+            {
+                continue;
+            }
+            region_obj.instructions++;
+            region_obj.pc_offsets.push_back(v_kernel.instructions[i].pcOffset);
+            add_fp64_instruction(v_kernel, i, region_obj);
+            if (region_obj.fp64_pc_offsets.size() == 1 && region_obj.fp64_pc_offsets[0] == v_kernel.instructions[i].pcOffset)
+            {
+                region_obj.line_number = v_kernel.instructions[i].line_number;
+            }
+        }
+        if (!region_obj.fp64_pc_offsets.empty())
+        {
+            region_vec.push_back(region_obj);
+        }
+    }
+
+    return std::make_tuple(region_map, sm_version);
+}
+
+#endif
@@ -0,0 +1,220 @@
+/**
+ * SASS code analysis of the generic memory accesses (instruction LD, ST, ATOM), whose address space is resolved at runtime
+ * The base pointer is traced through its definitions to its origin: the shared or local window (SR_SWINHI, SR_LWINHI, cvta from shared or local), a kernel parameter (global)
+ * or a value loaded from memory; arguments of non-inlined device functions are traced into the call sites
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_GENERIC_MEMORY_HPP
+#define PARSER_SASS_GENERIC_MEMORY_HPP
+
+#include "parser_sass_ir.hpp"
+
+// Definitions traced back to find the origin of a pointer
+const int generic_pointer_max_depth = 16;
+
+/// @brief Offset of the first kernel parameter in constant bank 0: c[0x0][0x160] up to sm_89, c[0x0][0x210] from sm_90
+long long get_kernel_parameter_offset(int sm_version)
+{
+    return sm_version >= 90 ? 0x210 : 0x160;
+}
+
+/// @brief A generic memory access
+struct generic_access
+{
+    int line_number;
+    std::string pcOffset;
+    std::string sass_instruction;
+    std::string opcode;             // LD, ST or ATOM
+    std::string origin;             // shared, local, global, loaded (pointer loaded from memory), argument (of a function which is not called in the SASS), mixed or unknown
+    std::string origin_pcOffset;    // instruction the pointer comes from, e.g. the S2R of SR_SWINHI, empty if unknown
+    std::string origin_function;    // function of the origin instruction, differs from the kernel if the pointer is passed to a device function
+    int loop_depth;
+    int access_bytes;
+};
+
+/// @brief Origin of a pointer and the instruction it comes from
+struct pointer_origin
+{
+    std::string space; // see generic_access::origin
+    std::string pcOffset;
+    std::string function;
+};
+
+/// @brief Origin of a pointer from the origins of two values combined into it, e.g. of a SEL or a 64 bit add
+/// The windows are more certain than kernel parameters (which may also be sizes or indices), these more than loaded values and arguments; two origins of the same certainty are mixed
+pointer_origin combine_pointer_origins(const pointer_origin &a, const pointer_origin &b)
+{
+    std::map<std::string, int> certainty = {{"", 0}, {"argument", 1}, {"loaded", 1}, {"global", 2}, {"shared", 3}, {"local", 3}, {"mixed", 4}};
+    if (a.space == b.space || certainty[a.space] > certainty[b.space])
+        return a;
+    if (certainty[b.space] > certainty[a.space])
+        return b;
+    return {"mixed", "", ""};
+}
+
+/// @brief Origin of the pointer in the register when the instruction at the index is executed
+/// The high register of a 64 bit pointer decides the address space: the shared and local windows only differ there, global pointers come from the kernel parameters
+/// @param call_sites Calls (caller and index of the CALL) of every device function, to follow its arguments into the callers
+/// @param parameter_offset Offset of the first kernel parameter in constant bank 0, see get_kernel_parameter_offset
+/// @param cache Origins of the definitions already traced
+pointer_origin get_pointer_origin(const std::unordered_map<std::string, std::vector<std::pair<const sass_kernel *, int>>> &call_sites, long long parameter_offset, const sass_kernel &kernel,
+                                  int index, const std::string &register_name, std::unordered_map<std::string, pointer_origin> &cache, int depth = 0)
+{
+    if (register_name.empty() || register_name == "RZ" || register_name == "URZ" || depth > generic_pointer_max_depth)
+    {
+        return {};
+    }
+    int definition = find_register_definition(kernel, index, register_name);
+    std::string key = kernel.kernel_name + ":" + std::to_string(definition) + ":" + register_name;
+    auto cached = cache.find(key);
+    if (cached != cache.end())
+    {
+        return cached->second;
+    }
+    pointer_origin &origin = cache[key];
+
+    if (definition < 0)
+    {
+        // Argument of a device function: the register at its call sites
+        auto calls = call_sites.find(kernel.kernel_name);
+        if (calls == call_sites.end())
+        {
+            origin = {"argument", "", kernel.kernel_name};
+            return origin;
+        }
+        for (const auto &[caller, call_index] : calls->second)
+        {
+            origin = combine_pointer_origins(origin, get_pointer_origin(call_sites, parameter_offset, *caller, call_index, register_name, cache, depth + 1));
+        }
+        return origin;
+    }
+
+    const sass_instruction &definition_obj = kernel.instructions[definition];
+    pointer_origin here = {"", definition_obj.pcOffset, kernel.kernel_name};
+    const std::string &opcode = definition_obj.opcode;
+    std::vector<std::string> sources = get_source_operands(definition_obj);
+
+    if (opcode == "S2R" || opcode == "S2UR" || opcode == "CS2R")
+    {
+        for (const auto &source : sources)
+        {
+            if (source.find("SWIN") != std::string::npos)
+                here.space = "shared";
+            else if (source.find("LWIN") != std::string::npos)
+                here.space = "local";
+        }
+        origin = here.space.empty() ? pointer_origin() : here; // thread index, clock, ... are no pointers
+        return origin;
+    }
+    if (opcode.compare(0, 2, "LD") == 0 && opcode != "LDC")
+    {
+        here.space = "loaded";
+        origin = here;
+        return origin;
+    }
+
+    for (const auto &source : sources)
+    {
+        if (source.compare(0, 3, "c[0") == 0)
+        {
+            // Kernel parameters are global pointers (cvta.to.global does not change them), the constants before them (block size, stack, ...) are no pointers
+            long long offset = std::strtoll(source.c_str() + source.find("][") + 2, nullptr, 0);
+            if (offset >= parameter_offset)
+            {
+                here.space = "global";
+                origin = combine_pointer_origins(origin, here);
+            }
+            continue;
+        }
+        std::string source_register = get_sass_register_name(source);
+        if (source_register.empty() || source_register == "RZ" || source_register == "URZ" || source_register[0] == 'P' || source_register.compare(0, 2, "UP") == 0)
+        {
+            continue;
+        }
+        // Only the high parts of a 64 bit add (IADD3.X, IMAD.X, LEA.HI.X) carry the address space, the high register of the pointer added by IMAD.WIDE
+        if ((opcode == "IADD3" || opcode == "IMAD" || opcode == "LEA") && !has_modifier(definition_obj, "X") && !has_modifier(definition_obj, "WIDE"))
+        {
+            continue;
+        }
+        if (has_modifier(definition_obj, "WIDE"))
+        {
+            if (&source != &sources.back())
+            {
+                continue;
+            }
+            source_register = get_next_register(source_register, 1);
+        }
+        origin = combine_pointer_origins(origin, get_pointer_origin(call_sites, parameter_offset, kernel, definition, source_register, cache, depth + 1));
+    }
+    return origin;
+}
+
+/// @brief Detects generic memory accesses and the origin of their pointers by parsing the SASS file
+/// @param filename Disassembled SASS file
+/// @return mapping of each kernel (and device function) with its generic memory accesses
+std::unordered_map<std::string, std::vector<generic_access>> generic_memory_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<generic_access>> access_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+    std::unordered_map<std::string, pointer_origin> cache;
+
+    std::unordered_map<std::string, std::vector<std::pair<const sass_kernel *, int>>> call_sites;
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        for (int i = 0; i < (int)v_kernel.instructions.size(); i++)
+        {
+            if (v_kernel.instructions[i].opcode == "CALL" && kernel_map.count(get_branch_target(v_kernel.instructions[i])))
+            {
+                call_sites[get_branch_target(v_kernel.instructions[i])].push_back({&v_kernel, i});
+            }
+        }
+    }
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        std::vector<generic_access> &access_vec = access_map[k_kernel];
+        const std::vector<sass_instruction> &instructions = v_kernel.instructions;
+        long long parameter_offset = get_kernel_parameter_offset(v_kernel.sm_version);
+
+        for (int i = 0; i < (int)instructions.size(); i++)
+        {
+            const sass_instruction &instruction_obj = instructions[i];
+            if (instruction_obj.opcode != "LD" && instruction_obj.opcode != "ST" && instruction_obj.opcode != "ATOM")
+            {
+                continue;
+            }
+            int operand_index = get_memory_operand_index(instruction_obj);
+            if (operand_index < 0)
+            {
+                continue;
+            }
+            sass_memory_operand address = parse_memory_operand(instruction_obj.operands[operand_index]);
+
+            generic_access access_obj = {};
+            access_obj.line_number = instruction_obj.line_number;
+            access_obj.pcOffset = instruction_obj.pcOffset;
+            access_obj.sass_instruction = instruction_obj.sass_instruction;
+            access_obj.opcode = instruction_obj.opcode;
+            access_obj.loop_depth = instruction_obj.loop_depth;
+            access_obj.access_bytes = get_access_bytes(instruction_obj);
+
+            // The high register of the 64 bit address, of the uniform register if a zero extended 32 bit offset is added to it, e.g. [R2.U32+UR4]
+            std::string high_register = address.wide ? get_next_register(address.base_register, 1) : address.base_register;
+            if (address.zero_extended && !address.uniform_register.empty())
+            {
+                high_register = get_next_register(address.uniform_register, 1);
+            }
+            pointer_origin origin = get_pointer_origin(call_sites, parameter_offset, v_kernel, i, high_register, cache);
+            access_obj.origin = origin.space.empty() ? "unknown" : origin.space;
+            access_obj.origin_pcOffset = origin.pcOffset;
+            access_obj.origin_function = origin.function;
+            access_vec.push_back(access_obj);
+        }
+    }
+
+    return access_map;
+}
+
+#endif
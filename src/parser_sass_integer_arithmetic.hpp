@@ -0,0 +1,238 @@
+/**
+ * SASS code analysis to detect expensive integer arithmetic
+ * Integer division and modulo by a variable (I2F.RP, MUFU.RCP, IMAD.HI sequences or calls of the internal 64 bit division subroutines)
+ * and 64 bit index arithmetic (64 bit comparisons, shifts, scaled additions and multiplications)
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_INTEGER_ARITHMETIC_HPP
+#define PARSER_SASS_INTEGER_ARITHMETIC_HPP
+
+#include "parser_sass_ir.hpp"
+#include <tuple>
+
+// Instructions after the I2F.RP which are searched for the rest of the division sequence
+const int integer_division_window = 40;
+
+/// @brief An integer division or modulo by a variable
+struct integer_division
+{
+    int line_number;
+    std::string pcOffset;                 // I2F.RP of the inline sequence, or the CALL of the subroutine
+    std::string sass_instruction;
+    std::string kind;                     // 32 bit unsigned, 32 bit signed, or the name of the subroutine, e.g. __cuda_sm20_div_u64
+    int loop_depth;
+    std::string divisor;                  // register of the divisor, empty for the subroutines
+    bool divisor_uniform;                 // the divisor is the same for all threads of a warp
+    bool divisor_loop_invariant;          // the divisor is not written in the innermost loop (true outside of loops)
+    std::vector<std::string> pc_offsets;  // instructions of the sequence, or the CALL and the instructions of the subroutine
+};
+
+/// @brief 64 bit integer instructions of one source line in one loop
+struct wide_index_arithmetic
+{
+    int line_number;
+    std::string pcOffset;                 // first 64 bit instruction of the line
+    int loop_depth;
+    std::string loop_pcOffset;            // first instruction of the innermost loop, empty outside of loops
+    int comparisons;                      // 64 bit comparisons (ISETP.EX), e.g. i < n with size_t i
+    int index_instructions;               // other instructions which need a 64 bit index: 64 bit shifts, LEA.HI.X of a 64 bit index, 64 bit multiplications
+    int carry_instructions;               // additions of the upper 32 bits (IADD3.X, IMAD.X, LEA.HI.X.SX32)
+    std::vector<std::string> pc_offsets;
+};
+
+/// @brief Name of the internal integer division or modulo subroutine called by the instruction, e.g. __cuda_sm20_rem_s64, empty if there is none
+std::string get_integer_division_subroutine(const sass_instruction &instruction_obj)
+{
+    if (instruction_obj.opcode != "CALL")
+    {
+        return "";
+    }
+    std::string target = get_branch_target(instruction_obj);
+    for (const std::string operation : {"div_u", "div_s", "rem_u", "rem_s"})
+    {
+        size_t position = target.find("__cuda_sm");
+        if (position != std::string::npos && target.find(operation, position) != std::string::npos)
+        {
+            return target.substr(position);
+        }
+    }
+    return "";
+}
+
+/// @brief Whether the instruction at the index multiplies two variables, i.e. two registers which are no constants (not e.g. R3 of MOV R3, 0x4)
+bool has_register_factors(const sass_kernel &kernel, int index, std::unordered_map<std::string, sass_value> &cache)
+{
+    std::vector<std::string> sources = get_source_operands(kernel.instructions[index]);
+    if (sources.size() < 2)
+    {
+        return false;
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        std::string register_name = get_sass_register_name(sources[i]);
+        if (register_name.empty() || register_name == "RZ" || register_name[0] != 'R' || is_constant_sass_value(get_operand_value(kernel, index, sources[i], cache)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Classifies the 64 bit integer instruction at the index
+/// @return comparison, index, carry, or empty if the instruction is no 64 bit integer instruction
+std::string get_wide_integer_kind(const sass_kernel &kernel, int index, std::unordered_map<std::string, sass_value> &cache)
+{
+    const sass_instruction &instruction_obj = kernel.instructions[index];
+    if (instruction_obj.opcode == "ISETP" && has_modifier(instruction_obj, "EX"))
+        return "comparison";
+    if (instruction_obj.opcode == "SHF" && (has_modifier(instruction_obj, "U64") || has_modifier(instruction_obj, "S64")))
+        return "index";
+    if (instruction_obj.opcode == "LEA" && has_modifier(instruction_obj, "HI") && has_modifier(instruction_obj, "X"))
+        return has_modifier(instruction_obj, "SX32") ? "carry" : "index";
+    if (instruction_obj.opcode == "IMAD" && has_modifier(instruction_obj, "WIDE") && has_modifier(instruction_obj, "U32") && has_register_factors(kernel, index, cache))
+        return "index";
+    if ((instruction_obj.opcode == "IADD3" || instruction_obj.opcode == "IMAD") && has_modifier(instruction_obj, "X"))
+        return "carry";
+    return "";
+}
+
+/// @brief Detects the integer divisions and the 64 bit index arithmetic by parsing the SASS file
+/// @param filename Disassembled SASS file
+/// @return mapping of each kernel with its integer divisions and 64 bit index arithmetic
+std::tuple<std::unordered_map<std::string, std::vector<integer_division>>, std::unordered_map<std::string, std::vector<wide_index_arithmetic>>> integer_arithmetic_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<integer_division>> division_map;
+    std::unordered_map<std::string, std::vector<wide_index_arithmetic>> wide_index_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+    static const std::set<std::string> control_flow = {"BRA", "BRX", "JMP", "JMX", "EXIT", "RET", "CALL", "BSSY", "BSYNC", "WARPSYNC", "BAR"};
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        std::vector<integer_division> &division_vec = division_map[k_kernel];
+        std::vector<wide_index_arithmetic> &wide_index_vec = wide_index_map[k_kernel];
+        std::unordered_map<std::string, sass_value> cache;
+        const std::vector<sass_instruction> &instructions = v_kernel.instructions;
+        int instruction_count = instructions.size();
+        std::vector<bool> in_division(instruction_count, false);
+
+        for (int i = 0; i < instruction_count; i++)
+        {
+            const sass_instruction &instruction_obj = instructions[i];
+            integer_division division_obj = {};
+            division_obj.line_number = instruction_obj.line_number;
+            division_obj.pcOffset = instruction_obj.pcOffset;
+            division_obj.sass_instruction = instruction_obj.sass_instruction;
+            division_obj.loop_depth = instruction_obj.loop_depth;
+            division_obj.divisor_loop_invariant = true;
+
+            std::string subroutine = get_integer_division_subroutine(instruction_obj);
+            if (!subroutine.empty())
+            {
+                // The CALL and the subroutine up to its return, whose samples are shared by all calls
+                division_obj.kind = subroutine;
+                division_obj.pc_offsets.push_back(instruction_obj.pcOffset);
+                auto target = v_kernel.label_index.find(get_branch_target(instruction_obj));
+                for (int j = target != v_kernel.label_index.end() ? target->second : instruction_count; j < instruction_count; j++)
+                {
+                    division_obj.pc_offsets.push_back(instructions[j].pcOffset);
+                    in_division[j] = true;
+                    if (instructions[j].opcode == "RET")
+                        break;
+                }
+                division_vec.push_back(division_obj);
+                continue;
+            }
+
+            // Inline division: I2F.U32.RP (unsigned) or IABS and I2F.RP (signed) of the divisor, followed by MUFU.RCP and IMAD.HI
+            if (instruction_obj.opcode != "I2F" || !has_modifier(instruction_obj, "RP") || in_division[i])
+            {
+                continue;
+            }
+            std::vector<std::string> sources = get_source_operands(instruction_obj);
+            if (sources.empty())
+            {
+                continue;
+            }
+            division_obj.kind = has_modifier(instruction_obj, "U32") ? "32 bit unsigned" : "32 bit signed";
+            division_obj.divisor = get_sass_register_name(sources[0]);
+            int definition = find_register_definition(v_kernel, i, division_obj.divisor);
+            int divisor_index = i;
+            if (definition >= 0 && instructions[definition].opcode == "IABS" && !get_source_operands(instructions[definition]).empty())
+            {
+                // The signed division divides the absolute values
+                divisor_index = definition;
+                division_obj.divisor = get_sass_register_name(get_source_operands(instructions[definition])[0]);
+            }
+            division_obj.divisor_uniform = !get_register_value(v_kernel, divisor_index, division_obj.divisor, cache).thread_dependent;
+            const sass_loop *loop = get_innermost_loop(v_kernel, i);
+            if (loop != nullptr)
+            {
+                division_obj.divisor_loop_invariant = !is_register_written(v_kernel, loop->start_index, loop->end_index + 1, division_obj.divisor);
+            }
+
+            // The sequence: the instructions of the same source line up to the next control flow, including the IABS before the I2F.RP
+            bool has_reciprocal = false;
+            for (int j = std::max(0, i - 4); j < i; j++)
+            {
+                if (instructions[j].opcode == "IABS" && instructions[j].line_number == instruction_obj.line_number)
+                {
+                    division_obj.pc_offsets.push_back(instructions[j].pcOffset);
+                    in_division[j] = true;
+                }
+            }
+            for (int j = i; j < instruction_count && j < i + integer_division_window && !control_flow.count(instructions[j].opcode); j++)
+            {
+                if (instructions[j].line_number != instruction_obj.line_number)
+                {
+                    continue;
+                }
+                has_reciprocal |= instructions[j].opcode == "MUFU" && has_modifier(instructions[j], "RCP");
+                division_obj.pc_offsets.push_back(instructions[j].pcOffset);
+                in_division[j] = true;
+            }
+            if (has_reciprocal)
+            {
+                division_vec.push_back(division_obj);
+            }
+        }
+
+        // 64 bit integer instructions outside of the divisions, grouped by source line and innermost loop
+        std::map<std::pair<int, int>, wide_index_arithmetic> wide_index_lines;
+        for (int i = 0; i < instruction_count; i++)
+        {
+            std::string kind = get_wide_integer_kind(v_kernel, i, cache);
+            if (kind.empty() || in_division[i])
+            {
+                continue;
+            }
+            const sass_loop *loop = get_innermost_loop(v_kernel, i);
+            auto [line, inserted] = wide_index_lines.insert({{instructions[i].line_number, loop != nullptr ? loop->start_index : -1}, {}});
+            wide_index_arithmetic &wide_index_obj = line->second;
+            if (inserted)
+            {
+                wide_index_obj.line_number = instructions[i].line_number;
+                wide_index_obj.pcOffset = instructions[i].pcOffset;
+                wide_index_obj.loop_depth = instructions[i].loop_depth;
+                wide_index_obj.loop_pcOffset = loop != nullptr ? instructions[loop->start_index].pcOffset : "";
+            }
+            wide_index_obj.comparisons += kind == "comparison";
+            wide_index_obj.index_instructions += kind == "index";
+            wide_index_obj.carry_instructions += kind == "carry";
+            wide_index_obj.pc_offsets.push_back(instructions[i].pcOffset);
+        }
+        // Only lines with evidence of a 64 bit index, the carries of 64 bit pointers with a 32 bit index are the normal address arithmetic
+        for (const auto &[k_line, v_line] : wide_index_lines)
+        {
+            if (v_line.comparisons + v_line.index_instructions > 0)
+            {
+                wide_index_vec.push_back(v_line);
+            }
+        }
+    }
+
+    return std::make_tuple(division_map, wide_index_map);
+}
+
+#endif
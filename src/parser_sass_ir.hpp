@@ -0,0 +1,998 @@
+/**
+ * Intermediate representation of the SASS code for the analyses which need more than a single line
+ * Every instruction is split into predicate, opcode, modifiers and operands, loops are detected from the backward branches
+ * Register values are traced through the definitions (def-use chain) into affine expressions of the thread index
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_IR_HPP
+#define PARSER_SASS_IR_HPP
+
+#include <iostream>
+#include <iomanip>
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <algorithm>
+#include <cstdlib>
+
+/// @brief One SASS instruction
+struct sass_instruction
+{
+    std::string pcOffset; // in hex, as in the SASS, e.g. 0080
+    int line_number;
+    std::string predicate;              // e.g. @!P0, empty if the instruction is not predicated
+    std::string opcode;                 // e.g. LDS
+    std::vector<std::string> modifiers; // e.g. U, 128 for LDS.U.128
+    std::vector<std::string> operands;  // e.g. R4, [R2.X4+0x10]
+    std::string sass_instruction;       // the instruction as in the SASS, without the pcOffset
+    std::vector<std::string> destinations; // registers written, e.g. R4, R5 for LDS.64 R4, [R2]
+    size_t first_source;                // index of the first operand which is read
+    int loop_depth;                     // number of loops the instruction is part of
+};
+
+/// @brief A loop, formed by a backward branch to a label
+struct sass_loop
+{
+    int start_index; // index of the first instruction of the loop (the branch target)
+    int end_index;   // index of the backward branch
+    int line_number; // source line of the first instruction of the loop
+};
+
+/// @brief The instructions and loops of a kernel
+struct sass_kernel
+{
+    std::string kernel_name;
+    int sm_version; // e.g. 80 for EF_CUDA_SM80, 0 if unknown
+    std::vector<sass_instruction> instructions;
+    std::vector<sass_loop> loops;
+    std::unordered_map<std::string, int> label_index; // label -> index of the first instruction after it
+};
+
+/// @brief Value of a register as affine expression of the thread index
+/// value = sum(thread_terms[t] * t) + sum(uniform values) + constant, e.g. threadIdx.x * 4 + c[0x0][0x160] + 0x10
+struct sass_value
+{
+    bool affine = true;                              // false if the value depends on the thread index in a way which is not affine (or unknown)
+    bool thread_dependent = false;                   // true if the value can differ between the threads of a warp
+    std::map<std::string, long long> thread_terms;   // tid.x, tid.y, tid.z, laneid -> factor
+    std::set<std::string> uniform_terms;             // values equal for all threads of a warp, e.g. c[0x0][0x160], ctaid.x, UR4
+    long long constant = 0;
+};
+
+/// @brief A memory operand, e.g. [R2.X4+UR4+0x10] or desc[UR6][R2.64+0x10] (CUDA 12)
+struct sass_memory_operand
+{
+    std::string descriptor_register; // UR register of the memory descriptor, e.g. UR6 for desc[UR6][R2.64], empty if none
+    std::string base_register;    // RZ if there is no register
+    int scale = 1;                // from .X4, .X8, .X16
+    bool wide = false;            // 64 bit address in a register pair (.64)
+    bool zero_extended = false;   // 32 bit register zero extended to 64 bit (.U32), e.g. an offset added to a 64 bit uniform register
+    std::string uniform_register; // UR register added to the address, empty if none
+    long long offset = 0;
+};
+
+/// @brief Whether the operand is a memory address, e.g. [R2+0x10] or desc[UR4][R2.64], but not a constant c[0x0][0x160]
+bool is_memory_operand(const std::string &operand)
+{
+    return !operand.empty() && (operand[0] == '[' || operand.compare(0, 5, "desc[") == 0);
+}
+
+std::string trim_sass(const std::string &text)
+{
+    size_t start = text.find_first_not_of(" \t");
+    if (start == std::string::npos)
+    {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(start, end - start + 1);
+}
+
+void set_destination_registers(sass_instruction &instruction_obj);
+
+/// @brief Parse one SASS line into an instruction
+/// @param line SASS line, e.g.         /*0090*/              @!P0 LDS.U.128 R4, [R2.X4+0x10] ;   // | 12 | 1 | |
+/// @param instruction_obj Parsed instruction
+/// @return false if the line does not contain an instruction
+bool parse_sass_instruction(const std::string &line, sass_instruction &instruction_obj)
+{
+    size_t pc_start = line.find("/*");
+    size_t pc_end = line.find("*/");
+    if (pc_start == std::string::npos || pc_end == std::string::npos || pc_end < pc_start)
+    {
+        return false;
+    }
+    instruction_obj.pcOffset = line.substr(pc_start + 2, pc_end - pc_start - 2);
+
+    // The instruction ends at the semicolon, e.g. the live registers follow after it
+    std::string text = line.substr(pc_end + 2);
+    text = trim_sass(text.substr(0, text.find(';')));
+    if (text.empty())
+    {
+        return false;
+    }
+    instruction_obj.sass_instruction = text;
+
+    std::istringstream ss(text);
+    std::string token;
+    ss >> token;
+    instruction_obj.predicate = "";
+    if (token[0] == '@')
+    {
+        instruction_obj.predicate = token;
+        ss >> token;
+    }
+
+    std::istringstream ss_opcode(token);
+    std::string part;
+    std::getline(ss_opcode, instruction_obj.opcode, '.');
+    instruction_obj.modifiers.clear();
+    while (std::getline(ss_opcode, part, '.'))
+    {
+        instruction_obj.modifiers.push_back(part);
+    }
+
+    instruction_obj.operands.clear();
+    std::string operands;
+    std::getline(ss, operands);
+    std::istringstream ss_operands(operands);
+    while (std::getline(ss_operands, part, ','))
+    {
+        part = trim_sass(part);
+        if (!part.empty())
+        {
+            instruction_obj.operands.push_back(part);
+        }
+    }
+    set_destination_registers(instruction_obj);
+    return true;
+}
+
+bool has_modifier(const sass_instruction &instruction_obj, const std::string &modifier)
+{
+    return std::find(instruction_obj.modifiers.begin(), instruction_obj.modifiers.end(), modifier) != instruction_obj.modifiers.end();
+}
+
+/// @brief Branch target of a BRA or CALL, e.g. .L_x_1 for @!P0 BRA `(.L_x_1) ;
+std::string get_branch_target(const sass_instruction &instruction_obj)
+{
+    for (const auto &operand : instruction_obj.operands)
+    {
+        size_t start = operand.find("`(");
+        if (start != std::string::npos)
+        {
+            return operand.substr(start + 2, operand.find(')', start) - start - 2);
+        }
+    }
+    return "";
+}
+
+/// @brief Find the loops (backward branches) of the kernel and the loop depth of every instruction
+void find_sass_loops(sass_kernel &kernel)
+{
+    kernel.loops.clear();
+    for (int i = 0; i < (int)kernel.instructions.size(); i++)
+    {
+        const sass_instruction &instruction_obj = kernel.instructions[i];
+        if (instruction_obj.opcode != "BRA")
+        {
+            continue;
+        }
+        auto target = kernel.label_index.find(get_branch_target(instruction_obj));
+        if (target == kernel.label_index.end() || target->second > i)
+        {
+            continue;
+        }
+        // Several backward branches to the same label (e.g. continue) form one loop
+        auto loop = std::find_if(kernel.loops.begin(), kernel.loops.end(), [&](const sass_loop &l) { return l.start_index == target->second; });
+        if (loop != kernel.loops.end())
+        {
+            loop->end_index = std::max(loop->end_index, i);
+        }
+        else
+        {
+            kernel.loops.push_back({target->second, i, kernel.instructions[target->second].line_number});
+        }
+    }
+
+    for (auto &instruction_obj : kernel.instructions)
+    {
+        instruction_obj.loop_depth = 0;
+    }
+    for (const auto &loop : kernel.loops)
+    {
+        for (int i = loop.start_index; i <= loop.end_index; i++)
+        {
+            kernel.instructions[i].loop_depth++;
+        }
+    }
+}
+
+/// @brief Parse the SASS into instructions and loops of every kernel
+/// @param filename Disassembled SASS file
+/// @return mapping of each kernel with its instructions
+std::unordered_map<std::string, sass_kernel> parse_sass_ir(const std::string &filename)
+{
+    std::string line;
+    std::fstream file(filename, std::ios::in);
+
+    std::unordered_map<std::string, sass_kernel> kernel_map;
+    sass_kernel *kernel = nullptr;
+    int sm_version = 0, code_line_number = 0;
+
+    if (file.is_open())
+    {
+        while (std::getline(file, line))
+        {
+            if (line.find(".section	.text.") != std::string::npos) // denotes start of the kernel
+            {
+                // https://cplusplus.com/reference/string/string/erase/     - erase part of a string
+                line.erase(line.begin(), line.begin() + 16); // erase the first 16 character of the name of the kernel
+                line.erase(line.end() - 15, line.end());     // erase the last 15 character of the name of the kernel
+                kernel = &kernel_map[line];
+                kernel->kernel_name = line;
+                kernel->sm_version = sm_version;
+                code_line_number = 0;
+                continue;
+            }
+
+            if (sm_version == 0 && line.find("EF_CUDA_SM") != std::string::npos)
+            {
+                sm_version = std::atoi(line.c_str() + line.find("EF_CUDA_SM") + 10);
+            }
+
+            if (kernel == nullptr)
+            {
+                continue;
+            }
+
+            if (line.find(" line ") != std::string::npos)
+            {
+                code_line_number = std::stoi(line.substr(line.find("line ") + 5)); // saving the current line number
+                continue;
+            }
+
+            // Labels, e.g. .L_x_1: or $__internal_0_$__cuda_sm20_div_u64: for the internal subroutines called by the kernel
+            std::string label = trim_sass(line);
+            if (label.size() > 1 && (label[0] == '.' || label[0] == '$') && label.back() == ':')
+            {
+                kernel->label_index[label.substr(0, label.size() - 1)] = kernel->instructions.size();
+                continue;
+            }
+
+            sass_instruction instruction_obj;
+            if (parse_sass_instruction(line, instruction_obj))
+            {
+                instruction_obj.line_number = code_line_number;
+                instruction_obj.loop_depth = 0;
+                kernel->instructions.push_back(instruction_obj);
+            }
+        }
+    }
+    else
+        std::cout << "Could not open the file: " << filename << std::endl;
+
+    for (auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        find_sass_loops(v_kernel);
+    }
+
+    return kernel_map;
+}
+
+/// @brief Register of an operand without its modifiers, e.g. R2 for -R2.reuse or [R2.X4+0x10], empty if there is none
+std::string get_sass_register_name(const std::string &operand)
+{
+    size_t start = operand.find_first_of("RPU");
+    while (start != std::string::npos)
+    {
+        // The register has to start at a word boundary (not e.g. the U of .U32)
+        bool boundary = start == 0 || std::string("@[-!|~ +").find(operand[start - 1]) != std::string::npos;
+        size_t end = start;
+        if (operand.compare(start, 2, "UR") == 0 || operand.compare(start, 2, "UP") == 0)
+        {
+            end += 2;
+        }
+        else if (operand[start] == 'R' || operand[start] == 'P')
+        {
+            end += 1;
+        }
+        if (boundary && end > start)
+        {
+            if (operand.compare(end, 1, "Z") == 0 || operand.compare(end, 1, "T") == 0)
+            {
+                return operand.substr(start, end - start + 1);
+            }
+            size_t digits = end;
+            while (digits < operand.size() && std::isdigit(operand[digits]))
+            {
+                digits++;
+            }
+            if (digits > end)
+            {
+                return operand.substr(start, digits - start);
+            }
+        }
+        start = operand.find_first_of("RPU", start + 1);
+    }
+    return "";
+}
+
+/// @brief Next register of a register pair or quadruple, e.g. R5 for R4
+std::string get_next_register(const std::string &register_name, int distance)
+{
+    size_t digits = register_name.find_first_of("0123456789");
+    if (digits == std::string::npos)
+    {
+        return register_name;
+    }
+    return register_name.substr(0, digits) + std::to_string(std::stoi(register_name.substr(digits)) + distance);
+}
+
+/// @brief Number of 32 bit registers written or read by a memory access or a 64 bit operation
+int get_register_width(const sass_instruction &instruction_obj)
+{
+    if (has_modifier(instruction_obj, "128"))
+        return 4;
+    static const std::set<std::string> double_precision = {"DADD", "DMUL", "DFMA", "DMNMX", "DSETP"};
+    if (has_modifier(instruction_obj, "64") || has_modifier(instruction_obj, "WIDE") || double_precision.count(instruction_obj.opcode) ||
+        ((instruction_obj.opcode == "F2F" || instruction_obj.opcode == "I2F") && !instruction_obj.modifiers.empty() && instruction_obj.modifiers[0] == "F64"))
+        return 2;
+    return 1;
+}
+
+/// @brief Bytes accessed per thread by a memory instruction
+int get_access_bytes(const sass_instruction &instruction_obj)
+{
+    if (has_modifier(instruction_obj, "U8") || has_modifier(instruction_obj, "S8"))
+        return 1;
+    if (has_modifier(instruction_obj, "U16") || has_modifier(instruction_obj, "S16"))
+        return 2;
+    if (has_modifier(instruction_obj, "64"))
+        return 8;
+    if (has_modifier(instruction_obj, "128"))
+        return 16;
+    return 4;
+}
+
+/// @brief Whether the instruction writes to its first operand
+bool has_destination(const sass_instruction &instruction_obj)
+{
+    static const std::set<std::string> no_destination = {
+        "ST", "STG", "STS", "STL", "RED", "REDG", "BAR", "BRA", "BRX", "JMP", "JMX", "EXIT", "RET", "CALL", "BSYNC", "BREAK", "WARPSYNC", "NOP", "MEMBAR",
+        "DEPBAR", "LDGSTS", "LDGDEPBAR", "ERRBAR", "YIELD", "CCTL", "CCTLL", "BPT", "KILL", "SYNCS", "ARRIVES", "UBLKCP", "UTMALDG", "UTMASTG"};
+    return !instruction_obj.operands.empty() && no_destination.count(instruction_obj.opcode) == 0;
+}
+
+/// @brief Find the registers written by the instruction, e.g. R4, R5 and P0 for IMAD.WIDE R4, P0, ...
+void set_destination_registers(sass_instruction &instruction_obj)
+{
+    instruction_obj.destinations.clear();
+    instruction_obj.first_source = 0;
+    if (!has_destination(instruction_obj) || is_memory_operand(instruction_obj.operands[0]))
+    {
+        return;
+    }
+
+    // Predicates written next to the result, e.g. the carry of IADD3 R4, P0, R2, R3, RZ or both predicates of ISETP,
+    // SHFL and ATOM write a predicate before the result, e.g. SHFL.BFLY PT, R5, R2, 0x10, 0x1f
+    static const std::set<std::string> predicate_first = {"SHFL", "ATOM", "ATOMG", "ATOMS", "ATOMX"};
+    size_t i = 0;
+    for (; i < instruction_obj.operands.size(); i++)
+    {
+        const std::string &operand = instruction_obj.operands[i];
+        std::string register_name = get_sass_register_name(operand);
+        if (register_name.empty() || register_name != operand)
+        {
+            break;
+        }
+        bool predicate = register_name[0] == 'P' || register_name.compare(0, 2, "UP") == 0;
+        if (i > 0 && !predicate && !(i == 1 && predicate_first.count(instruction_obj.opcode)))
+        {
+            break;
+        }
+        instruction_obj.destinations.push_back(register_name);
+        if (!predicate && register_name != "RZ" && register_name != "URZ")
+        {
+            for (int j = 1; j < get_register_width(instruction_obj); j++)
+            {
+                instruction_obj.destinations.push_back(get_next_register(register_name, j));
+            }
+        }
+        if (i > 0 && !predicate)
+        {
+            i++;
+            break;
+        }
+    }
+    instruction_obj.first_source = std::max<size_t>(i, 1);
+}
+
+/// @brief Registers written by the instruction
+const std::vector<std::string> &get_destination_registers(const sass_instruction &instruction_obj)
+{
+    return instruction_obj.destinations;
+}
+
+/// @brief Operands read by the instruction
+std::vector<std::string> get_source_operands(const sass_instruction &instruction_obj)
+{
+    size_t first_source = std::min(instruction_obj.first_source, instruction_obj.operands.size());
+    if (instruction_obj.destinations.empty())
+    {
+        first_source = 0;
+    }
+    return std::vector<std::string>(instruction_obj.operands.begin() + first_source, instruction_obj.operands.end());
+}
+
+/// @brief Index of the last instruction before the given index which writes the register, in the order of the SASS
+/// @return -1 if the register is not written before
+int find_register_definition(const sass_kernel &kernel, int index, const std::string &register_name)
+{
+    for (int i = index - 1; i >= 0; i--)
+    {
+        for (const auto &destination : get_destination_registers(kernel.instructions[i]))
+        {
+            if (destination == register_name)
+            {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+/// @brief Whether the register is written between the two indices (start included, end excluded)
+bool is_register_written(const sass_kernel &kernel, int start_index, int end_index, const std::string &register_name)
+{
+    for (int i = std::max(0, start_index); i < end_index && i < (int)kernel.instructions.size(); i++)
+    {
+        for (const auto &destination : get_destination_registers(kernel.instructions[i]))
+        {
+            if (destination == register_name)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/// @brief Innermost loop containing the instruction, nullptr if it is not in a loop
+const sass_loop *get_innermost_loop(const sass_kernel &kernel, int index)
+{
+    const sass_loop *innermost = nullptr;
+    for (const auto &loop : kernel.loops)
+    {
+        if (loop.start_index <= index && index <= loop.end_index && (innermost == nullptr || loop.end_index - loop.start_index < innermost->end_index - innermost->start_index))
+        {
+            innermost = &loop;
+        }
+    }
+    return innermost;
+}
+
+/// @brief Whether the loop of the kernel contains no other loop
+bool is_innermost_loop(const sass_kernel &kernel, const sass_loop &loop)
+{
+    return std::none_of(kernel.loops.begin(), kernel.loops.end(), [&](const sass_loop &other)
+                        { return &other != &loop && other.start_index >= loop.start_index && other.end_index <= loop.end_index; });
+}
+
+sass_value unknown_sass_value(bool thread_dependent)
+{
+    sass_value value;
+    value.affine = !thread_dependent;
+    value.thread_dependent = thread_dependent;
+    if (!thread_dependent)
+    {
+        value.uniform_terms.insert("?");
+    }
+    return value;
+}
+
+sass_value add_sass_values(const sass_value &a, const sass_value &b)
+{
+    sass_value value = a;
+    value.affine = a.affine && b.affine;
+    value.thread_dependent = a.thread_dependent || b.thread_dependent;
+    for (const auto &[term, factor] : b.thread_terms)
+    {
+        value.thread_terms[term] += factor;
+        if (value.thread_terms[term] == 0)
+        {
+            value.thread_terms.erase(term);
+        }
+    }
+    value.uniform_terms.insert(b.uniform_terms.begin(), b.uniform_terms.end());
+    value.constant += b.constant;
+    return value;
+}
+
+sass_value multiply_sass_value(const sass_value &a, long long factor)
+{
+    sass_value value = a;
+    for (auto &[term, term_factor] : value.thread_terms)
+    {
+        term_factor *= factor;
+    }
+    if (factor == 0)
+    {
+        value.thread_terms.clear();
+        value.uniform_terms.clear();
+        value.thread_dependent = false;
+        value.affine = true;
+    }
+    else if (factor != 1 && !value.uniform_terms.empty())
+    {
+        std::set<std::string> scaled;
+        for (const auto &term : value.uniform_terms)
+        {
+            scaled.insert(term + "*" + std::to_string(factor));
+        }
+        value.uniform_terms = scaled;
+    }
+    value.constant *= factor;
+    return value;
+}
+
+bool is_constant_sass_value(const sass_value &value)
+{
+    return value.affine && !value.thread_dependent && value.uniform_terms.empty();
+}
+
+sass_value multiply_sass_values(const sass_value &a, const sass_value &b)
+{
+    if (is_constant_sass_value(a))
+        return multiply_sass_value(b, a.constant);
+    if (is_constant_sass_value(b))
+        return multiply_sass_value(a, b.constant);
+    // Product of a thread dependent value with a value unknown at compile time, e.g. threadIdx.x * pitch
+    return unknown_sass_value(a.thread_dependent || b.thread_dependent);
+}
+
+sass_value get_register_value(const sass_kernel &kernel, int index, const std::string &register_name, std::unordered_map<std::string, sass_value> &cache, int depth = 0);
+sass_memory_operand parse_memory_operand(const std::string &operand);
+
+/// @brief Value of an operand of the instruction at the index
+sass_value get_operand_value(const sass_kernel &kernel, int index, const std::string &operand, std::unordered_map<std::string, sass_value> &cache, int depth = 0)
+{
+    sass_value value;
+    std::string text = operand;
+    bool negate = false;
+    if (!text.empty() && text[0] == '-')
+    {
+        negate = true;
+        text = text.substr(1);
+    }
+    if (text.empty())
+    {
+        return unknown_sass_value(true);
+    }
+    if (text[0] == '|' || text[0] == '~' || text[0] == '!')
+    {
+        // Absolute value, bitwise or logical negation: not traced, but the same for all threads of a warp if the operand is
+        sass_value operand_value = get_operand_value(kernel, index, text.substr(1), cache, depth);
+        return unknown_sass_value(operand_value.thread_dependent || !operand_value.thread_terms.empty());
+    }
+
+    if (text.compare(0, 2, "0x") == 0 || std::isdigit(text[0]))
+    {
+        if (text.compare(0, 2, "0x") != 0 && (text.find('.') != std::string::npos || text.find('e') != std::string::npos))
+        {
+            return unknown_sass_value(false); // floating point immediate
+        }
+        value.constant = std::strtoll(text.c_str(), nullptr, 0);
+    }
+    else if (text.compare(0, 2, "c[") == 0)
+    {
+        value.uniform_terms.insert(text); // kernel parameter or constant
+    }
+    else if (text == "SRZ")
+    {
+        return value;
+    }
+    else if (text.compare(0, 3, "SR_") == 0)
+    {
+        std::map<std::string, std::string> thread_registers = {{"SR_TID.X", "tid.x"}, {"SR_TID.Y", "tid.y"}, {"SR_TID.Z", "tid.z"}, {"SR_LANEID", "laneid"}};
+        if (thread_registers.count(text))
+        {
+            value.thread_terms[thread_registers[text]] = 1;
+            value.thread_dependent = true;
+        }
+        else if (text.compare(0, 8, "SR_CTAID") == 0 || text.compare(0, 9, "SR_NCTAID") == 0)
+        {
+            value.uniform_terms.insert(text == "SR_CTAID.X" ? "ctaid.x" : text == "SR_CTAID.Y" ? "ctaid.y" : text == "SR_CTAID.Z" ? "ctaid.z" : text);
+        }
+        else
+        {
+            return unknown_sass_value(true); // clock, warp id, ...
+        }
+    }
+    else
+    {
+        std::string register_name = get_sass_register_name(text);
+        if (register_name == "RZ" || register_name == "URZ" || register_name == "PT" || register_name == "UPT")
+        {
+            return value;
+        }
+        if (register_name.empty())
+        {
+            return unknown_sass_value(true);
+        }
+        if (register_name.compare(0, 2, "UP") == 0)
+        {
+            return unknown_sass_value(false);
+        }
+        value = get_register_value(kernel, index, register_name, cache, depth + 1);
+        // A predicate is only true or false, it matters whether it is the same for all threads of a warp, e.g. ISETP of the thread index
+        if (register_name[0] == 'P')
+        {
+            return unknown_sass_value(value.thread_dependent || !value.thread_terms.empty());
+        }
+        // Uniform registers hold the same value for all threads of a warp, even if it could not be traced
+        if (register_name.compare(0, 2, "UR") == 0 && (value.thread_dependent || !value.affine))
+        {
+            value = unknown_sass_value(false);
+        }
+    }
+    return negate ? multiply_sass_value(value, -1) : value;
+}
+
+/// @brief Value written by an instruction to its first destination register
+sass_value get_definition_value(const sass_kernel &kernel, int index, std::unordered_map<std::string, sass_value> &cache, int depth)
+{
+    const sass_instruction &instruction_obj = kernel.instructions[index];
+    std::vector<std::string> sources = get_source_operands(instruction_obj);
+    auto source = [&](size_t i) { return i < sources.size() ? get_operand_value(kernel, index, sources[i], cache, depth) : sass_value(); };
+    const std::string &opcode = instruction_obj.opcode;
+    bool high = has_modifier(instruction_obj, "HI") || has_modifier(instruction_obj, "X");
+
+    if (!high)
+    {
+        if ((opcode == "MOV" || opcode == "MOV32I" || opcode == "UMOV" || opcode == "ULDC" || opcode == "S2R" || opcode == "S2UR" || opcode == "CS2R") && !sources.empty())
+        {
+            return source(0);
+        }
+        if ((opcode == "IMAD" || opcode == "UIMAD") && sources.size() >= 3)
+        {
+            return add_sass_values(multiply_sass_values(source(0), source(1)), source(2));
+        }
+        if (opcode == "IADD3" || opcode == "UIADD3" || opcode == "IADD" || opcode == "IADD32I")
+        {
+            sass_value value;
+            for (size_t i = 0; i < sources.size(); i++)
+            {
+                value = add_sass_values(value, source(i));
+            }
+            return value;
+        }
+        if ((opcode == "IMUL" || opcode == "IMUL32I") && sources.size() >= 2)
+        {
+            return multiply_sass_values(source(0), source(1));
+        }
+        if ((opcode == "SHL" || (opcode == "SHF" && has_modifier(instruction_obj, "L")) || opcode == "USHF") && sources.size() >= 2 && !has_modifier(instruction_obj, "R"))
+        {
+            sass_value shift = source(1);
+            if (is_constant_sass_value(shift) && shift.constant >= 0 && shift.constant < 32 && (sources.size() < 3 || get_sass_register_name(sources[2]) == "RZ"))
+            {
+                return multiply_sass_value(source(0), 1LL << shift.constant);
+            }
+        }
+        if ((opcode == "LEA" || opcode == "ULEA" || opcode == "ISCADD") && sources.size() >= 3)
+        {
+            sass_value shift = source(2);
+            if (is_constant_sass_value(shift) && shift.constant >= 0 && shift.constant < 32)
+            {
+                return add_sass_values(multiply_sass_value(source(0), 1LL << shift.constant), source(1));
+            }
+        }
+    }
+
+    // Anything else is not traced, it is the same for all threads of a warp if all its inputs are
+    bool thread_dependent = false;
+    for (size_t i = 0; i < sources.size() && !thread_dependent; i++)
+    {
+        if (is_memory_operand(sources[i]))
+        {
+            sass_value address_value = get_operand_value(kernel, index, parse_memory_operand(sources[i]).base_register, cache, depth);
+            thread_dependent = address_value.thread_dependent || !address_value.thread_terms.empty();
+            continue;
+        }
+        sass_value value = source(i);
+        thread_dependent = value.thread_dependent || !value.thread_terms.empty();
+    }
+    return unknown_sass_value(thread_dependent);
+}
+
+/// @brief Value of the register when the instruction at the index is executed, traced through its definitions
+/// @param cache Values of the definitions already traced, shared between the calls for one kernel
+sass_value get_register_value(const sass_kernel &kernel, int index, const std::string &register_name, std::unordered_map<std::string, sass_value> &cache, int depth)
+{
+    // Registers without a definition are e.g. set by the ABI, the depth limit protects against long chains
+    int definition = find_register_definition(kernel, index, register_name);
+    if (definition < 0 || depth > 24)
+    {
+        return unknown_sass_value(true);
+    }
+
+    // While a definition is traced, it stands for the value of the register in the previous loop iteration
+    sass_value previous_iteration = unknown_sass_value(false);
+    previous_iteration.uniform_terms = {"previous iteration of " + register_name};
+
+    std::string key = std::to_string(definition) + ":" + register_name;
+    auto cached = cache.find(key);
+    sass_value value;
+    if (cached != cache.end())
+    {
+        value = cached->second;
+    }
+    else
+    {
+        cache[key] = previous_iteration;
+        const sass_instruction &definition_obj = kernel.instructions[definition];
+        const std::vector<std::string> &destinations = get_destination_registers(definition_obj);
+        value = get_definition_value(kernel, definition, cache, depth);
+        // Only the low register of a 64 bit result is traced, the high register and the predicates written next to it (e.g. a carry) are the same for all threads if the result is
+        if (destinations.empty() || destinations[0] != register_name)
+        {
+            value = unknown_sass_value(value.thread_dependent || !value.thread_terms.empty());
+        }
+        // A predicated definition keeps the previous value of the register in the threads where the predicate is false, e.g. @P0 MOV R2, R4
+        if (!definition_obj.predicate.empty())
+        {
+            sass_value predicate_value = get_operand_value(kernel, definition, definition_obj.predicate.substr(1), cache, depth);
+            sass_value previous_value = get_register_value(kernel, definition, register_name, cache, depth + 1);
+            bool same = value.affine && previous_value.affine && value.thread_terms == previous_value.thread_terms && value.uniform_terms == previous_value.uniform_terms &&
+                        value.constant == previous_value.constant;
+            if (!same)
+            {
+                value = unknown_sass_value(value.thread_dependent || previous_value.thread_dependent || !value.thread_terms.empty() || !previous_value.thread_terms.empty() ||
+                                           predicate_value.thread_dependent);
+            }
+        }
+        cache[key] = value;
+    }
+
+    // A register written later in the same loop carries its value over the iterations, e.g. a loop counter or a pointer incremented in the loop.
+    // Its thread index terms stay the same if every iteration adds a value which is the same for all threads, i.e. the update minus the value has no thread terms
+    const sass_loop *loop = get_innermost_loop(kernel, index);
+    if (loop != nullptr && is_register_written(kernel, index, loop->end_index + 1, register_name))
+    {
+        // While the update itself is traced, the increment is checked by the caller which traces it
+        int update = find_register_definition(kernel, loop->end_index + 1, register_name);
+        auto traced = cache.find(std::to_string(update) + ":" + register_name);
+        if (traced == cache.end() || traced->second.uniform_terms != previous_iteration.uniform_terms)
+        {
+            sass_value update_value = get_register_value(kernel, update + 1, register_name, cache, depth + 1);
+            sass_value increment = add_sass_values(update_value, multiply_sass_value(value, -1));
+            if (!increment.affine || !increment.thread_terms.empty())
+            {
+                return unknown_sass_value(value.thread_dependent || update_value.thread_dependent || !value.thread_terms.empty() || !update_value.thread_terms.empty());
+            }
+        }
+        value.uniform_terms.insert("iteration of loop at " + kernel.instructions[loop->start_index].pcOffset);
+    }
+    return value;
+}
+
+/// @brief Whether the predicate of the instruction, e.g. the condition of a branch, can differ between the threads of a warp, from the values compared to set it
+bool is_divergent_predicate(const sass_kernel &kernel, int index, std::unordered_map<std::string, sass_value> &cache)
+{
+    // The guard without its @, e.g. !P0 of @!P0, the negation does not change whether it diverges
+    const std::string &guard = kernel.instructions[index].predicate;
+    std::string predicate = guard.empty() ? "PT" : get_sass_register_name(guard.substr(1));
+    if (predicate.compare(0, 2, "UP") == 0 || predicate == "PT")
+    {
+        return false;
+    }
+    int definition = find_register_definition(kernel, index, predicate);
+    if (definition < 0)
+    {
+        return true;
+    }
+    const sass_instruction &definition_obj = kernel.instructions[definition];
+    static const std::set<std::string> compares = {"ISETP", "FSETP", "DSETP", "HSETP2", "PLOP3", "PSETP"};
+    if (compares.count(definition_obj.opcode) == 0)
+    {
+        return true;
+    }
+    for (const auto &source : get_source_operands(definition_obj))
+    {
+        std::string register_name = get_sass_register_name(source);
+        if (register_name == "PT" || register_name.compare(0, 2, "UP") == 0)
+        {
+            continue;
+        }
+        if (!register_name.empty() && register_name[0] == 'P')
+        {
+            return true; // combined with another predicate, not traced further
+        }
+        sass_value value = get_operand_value(kernel, definition, source, cache);
+        if (value.thread_dependent || !value.thread_terms.empty())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Parse a memory operand, e.g. [R2.X4+UR4+0x10] or desc[UR6][R2.64+0x10]
+sass_memory_operand parse_memory_operand(const std::string &operand)
+{
+    sass_memory_operand address;
+    address.base_register = "RZ";
+    std::string text = operand;
+    if (text.compare(0, 5, "desc[") == 0)
+    {
+        address.descriptor_register = get_sass_register_name(text.substr(0, text.find(']')));
+        text = text.substr(text.find(']') + 1);
+    }
+    text = text.substr(text.find('[') + 1);
+    text = text.substr(0, text.find(']'));
+
+    std::string part;
+    std::istringstream ss(text);
+    while (std::getline(ss, part, '+'))
+    {
+        part = trim_sass(part);
+        if (part.compare(0, 2, "UR") == 0)
+        {
+            address.uniform_register = get_sass_register_name(part);
+        }
+        else if (part[0] == 'R')
+        {
+            address.base_register = get_sass_register_name(part);
+            address.wide = part.find(".64") != std::string::npos;
+            address.zero_extended = part.find(".U32") != std::string::npos;
+            if (part.find(".X16") != std::string::npos)
+                address.scale = 16;
+            else if (part.find(".X8") != std::string::npos)
+                address.scale = 8;
+            else if (part.find(".X4") != std::string::npos)
+                address.scale = 4;
+        }
+        else if (!part.empty())
+        {
+            bool negative = part[0] == '-';
+            long long offset = std::strtoll(part.c_str() + (negative ? 1 : 0), nullptr, 0);
+            address.offset += negative ? -offset : offset;
+        }
+    }
+    return address;
+}
+
+/// @brief Whether the address is a constant offset from the stack pointer R1, e.g. [R1+0x8] of the spills and the ABI stack of device functions
+bool is_stack_address(const sass_memory_operand &address)
+{
+    return address.base_register == "R1" && address.uniform_register.empty();
+}
+
+/// @brief Index of the memory operand of the instruction, -1 if there is none
+int get_memory_operand_index(const sass_instruction &instruction_obj)
+{
+    for (size_t i = 0; i < instruction_obj.operands.size(); i++)
+    {
+        if (is_memory_operand(instruction_obj.operands[i]))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// @brief Address accessed by the memory instruction at the index
+sass_value get_address_value(const sass_kernel &kernel, int index, std::unordered_map<std::string, sass_value> &cache)
+{
+    const sass_instruction &instruction_obj = kernel.instructions[index];
+    int operand_index = get_memory_operand_index(instruction_obj);
+    if (operand_index < 0)
+    {
+        return unknown_sass_value(true);
+    }
+    sass_memory_operand address = parse_memory_operand(instruction_obj.operands[operand_index]);
+
+    sass_value value = multiply_sass_value(get_operand_value(kernel, index, address.base_register, cache), address.scale);
+    if (!address.uniform_register.empty())
+    {
+        value = add_sass_values(value, get_operand_value(kernel, index, address.uniform_register, cache));
+    }
+    value.constant += address.offset;
+    return value;
+}
+
+/// @brief Offset from the stack pointer R1 of the local memory access (LDL, STL) at the index, directly [R1+0x8] or through a copy of R1 with a constant offset
+/// @return false if the address is no constant offset from the stack pointer, e.g. an index into a local array
+bool get_stack_offset(const sass_kernel &kernel, int index, std::unordered_map<std::string, sass_value> &cache, long long &offset)
+{
+    const sass_instruction &instruction_obj = kernel.instructions[index];
+    int operand_index = get_memory_operand_index(instruction_obj);
+    if (operand_index < 0)
+    {
+        return false;
+    }
+    sass_memory_operand address = parse_memory_operand(instruction_obj.operands[operand_index]);
+    if (is_stack_address(address))
+    {
+        offset = address.offset;
+        return true;
+    }
+    sass_value stack_pointer = get_register_value(kernel, index, "R1", cache);
+    sass_value value = get_address_value(kernel, index, cache);
+    if (!stack_pointer.affine || stack_pointer.thread_dependent || !value.affine || value.thread_dependent || !value.thread_terms.empty() ||
+        stack_pointer.uniform_terms.count("?") || value.uniform_terms != stack_pointer.uniform_terms)
+    {
+        return false;
+    }
+    offset = value.constant - stack_pointer.constant;
+    return true;
+}
+
+/// @brief Whether the STL at the index saves a register of the caller to the stack, as the ABI of device functions does: the stored register is not written before in the function
+bool is_abi_register_save(const sass_kernel &kernel, int index)
+{
+    const sass_instruction &instruction_obj = kernel.instructions[index];
+    std::vector<std::string> sources = get_source_operands(instruction_obj);
+    std::string stored_register = instruction_obj.opcode == "STL" && sources.size() > 1 ? get_sass_register_name(sources.back()) : "";
+    return !stored_register.empty() && stored_register != "RZ" && find_register_definition(kernel, index, stored_register) < 0;
+}
+
+/// @brief Byte stride between the addresses of neighbouring lanes of a warp, assuming blockDim.x is a multiple of 32
+/// @return false if the stride is unknown
+bool get_lane_stride(const sass_value &address, long long &stride)
+{
+    if (!address.affine)
+    {
+        return false;
+    }
+    stride = 0;
+    for (const auto &[term, factor] : address.thread_terms)
+    {
+        if (term == "tid.x" || term == "laneid")
+        {
+            stride += factor;
+        }
+    }
+    return true;
+}
+
+/// @brief Largest power of two (up to the limit) which divides the value for every thread
+/// Kernel parameters (pointers) are assumed to be aligned, uniform values scaled by a constant (e.g. ?*4) are multiples of the factor
+/// @param known false if a part of the value has no alignment evidence, then the alignment of the other parts is returned
+/// @return the alignment in bytes, 1 if the value is not affine
+long long get_sass_value_alignment(const sass_value &value, long long limit, bool &known)
+{
+    known = value.affine;
+    if (!value.affine)
+    {
+        return 1;
+    }
+    auto alignment_of = [&](long long factor) { return factor == 0 ? limit : std::min(limit, factor & -factor); };
+    long long alignment = alignment_of(std::abs(value.constant));
+    for (const auto &[term, factor] : value.thread_terms)
+    {
+        alignment = std::min(alignment, alignment_of(std::abs(factor)));
+    }
+    for (const auto &term : value.uniform_terms)
+    {
+        size_t factor_start = term.rfind('*');
+        if (factor_start != std::string::npos)
+        {
+            alignment = std::min(alignment, alignment_of(std::abs(std::atoll(term.c_str() + factor_start + 1))));
+        }
+        else if (term.compare(0, 2, "c[") != 0)
+        {
+            known = false;
+        }
+    }
+    return alignment;
+}
+
+#endif
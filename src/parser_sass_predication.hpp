@@ -0,0 +1,142 @@
+/**
+ * SASS code analysis to find short conditional regions which can be predicated instead of branched
+ * The region of every forward conditional branch (instruction BRA) is measured up to its reconvergence point (BSSY target, else branch or branch target)
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_PREDICATION_HPP
+#define PARSER_SASS_PREDICATION_HPP
+
+#include "parser_sass_ir.hpp"
+
+/// @brief Region skipped by a forward conditional branch
+struct conditional_region
+{
+    int line_number;
+    std::string pcOffset;         // of the branch
+    std::string sass_instruction; // the branch, as in the SASS
+    std::string target_branch;    // label of the branch target
+    int reconvergence_line_number;
+    std::string reconvergence_pcOffset;
+    int then_instructions;        // instructions skipped if the branch is taken
+    int else_instructions;        // instructions of the else part, 0 if there is none
+    bool uses_bssy;               // the reconvergence is managed by BSSY/BSYNC
+    std::vector<std::string> overhead_pc_offsets; // BRA, BSSY, BSYNC and the branch around the else part, which predication removes
+    bool divergent;               // false if the condition is the same for all threads of a warp
+    bool predicable;              // false if the region contains other branches, barriers, calls or exits
+    int loop_depth;
+};
+
+/// @brief SASS analysis of the regions of the forward conditional branches
+/// @param filename Disassembled SASS file
+/// @return mapping of each kernel with its conditional regions
+std::unordered_map<std::string, std::vector<conditional_region>> predication_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<conditional_region>> region_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        std::vector<conditional_region> &region_vec = region_map[k_kernel];
+        std::unordered_map<std::string, sass_value> cache;
+        const std::vector<sass_instruction> &instructions = v_kernel.instructions;
+
+        for (int i = 0; i < (int)instructions.size(); i++)
+        {
+            const sass_instruction &instruction_obj = instructions[i];
+            if (instruction_obj.opcode != "BRA" || instruction_obj.predicate.empty())
+            {
+                continue;
+            }
+            auto target = v_kernel.label_index.find(get_branch_target(instruction_obj));
+            if (target == v_kernel.label_index.end() || target->second <= i)
+            {
+                continue; // loops are not predicated
+            }
+
+            conditional_region region_obj = {};
+            region_obj.line_number = instruction_obj.line_number;
+            region_obj.pcOffset = instruction_obj.pcOffset;
+            region_obj.sass_instruction = instruction_obj.sass_instruction;
+            region_obj.target_branch = target->first;
+            region_obj.loop_depth = instruction_obj.loop_depth;
+            region_obj.overhead_pc_offsets.push_back(instruction_obj.pcOffset);
+            int then_end = target->second;
+            int reconvergence = target->second;
+
+            // An unconditional branch at the end of the then part jumps around the else part
+            if (then_end - 1 > i && instructions[then_end - 1].opcode == "BRA" && instructions[then_end - 1].predicate.empty())
+            {
+                auto join = v_kernel.label_index.find(get_branch_target(instructions[then_end - 1]));
+                if (join != v_kernel.label_index.end() && join->second > then_end)
+                {
+                    reconvergence = join->second;
+                    region_obj.overhead_pc_offsets.push_back(instructions[then_end - 1].pcOffset);
+                    then_end--;
+                }
+            }
+
+            // BSSY right before the branch sets the reconvergence point, where BSYNC waits for all threads of the warp
+            for (int j = i - 1; j >= 0 && j >= i - 4; j--)
+            {
+                if (instructions[j].opcode == "BSSY")
+                {
+                    // The BSSY target follows the BSYNC, e.g. .L_x_2: BSYNC B0 ; .L_x_1:
+                    auto bssy_target = v_kernel.label_index.find(get_branch_target(instructions[j]));
+                    if (bssy_target == v_kernel.label_index.end())
+                    {
+                        break;
+                    }
+                    int sync = bssy_target->second;
+                    if (sync > 0 && instructions[sync - 1].opcode == "BSYNC")
+                    {
+                        sync--;
+                    }
+                    if (sync >= reconvergence && sync < (int)instructions.size() && instructions[sync].opcode == "BSYNC")
+                    {
+                        region_obj.uses_bssy = true;
+                        region_obj.overhead_pc_offsets.push_back(instructions[j].pcOffset);
+                        region_obj.overhead_pc_offsets.push_back(instructions[sync].pcOffset);
+                        reconvergence = sync;
+                    }
+                    break;
+                }
+                if (instructions[j].opcode == "BRA" || instructions[j].opcode == "BSYNC")
+                {
+                    break;
+                }
+            }
+
+            region_obj.then_instructions = then_end - i - 1;
+            region_obj.else_instructions = reconvergence > target->second ? reconvergence - target->second : 0;
+            if (reconvergence < (int)instructions.size())
+            {
+                region_obj.reconvergence_line_number = instructions[reconvergence].line_number;
+                region_obj.reconvergence_pcOffset = instructions[reconvergence].pcOffset;
+            }
+
+            // Only straight-line code without other control flow can be predicated
+            static const std::set<std::string> control_flow = {"BRA", "BRX", "JMP", "JMX", "CALL", "RET", "EXIT", "BAR", "BSSY", "BSYNC", "BREAK", "WARPSYNC", "KILL"};
+            region_obj.predicable = true;
+            for (int j = i + 1; j < reconvergence && j < (int)instructions.size(); j++)
+            {
+                if (j == then_end)
+                {
+                    continue; // the branch around the else part
+                }
+                if (control_flow.count(instructions[j].opcode))
+                {
+                    region_obj.predicable = false;
+                    break;
+                }
+            }
+            region_obj.divergent = is_divergent_predicate(v_kernel, i, cache);
+            region_vec.push_back(region_obj);
+        }
+    }
+
+    return region_map;
+}
+
+#endif
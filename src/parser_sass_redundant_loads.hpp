@@ -0,0 +1,260 @@
+/**
+ * SASS code analysis to find redundant global loads (instruction LDG)
+ * Loads in a loop whose address does not change in the loop (loop-invariant), and loads of the same address as an earlier load of the same region (duplicates)
+ * Stores, atomics and calls in between may alias the address and keep the compiler from reusing the value, which __restrict__ allows
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_REDUNDANT_LOADS_HPP
+#define PARSER_SASS_REDUNDANT_LOADS_HPP
+
+#include "parser_sass_ir.hpp"
+#include <tuple>
+
+// Definitions traced back to decide whether a register is loop-invariant
+const int redundant_load_max_depth = 4;
+
+/// @brief A global load which reads a value that was already loaded, or could be loaded once before its loop
+struct redundant_load
+{
+    int line_number;
+    std::string pcOffset;
+    std::string sass_instruction;
+    std::string kind;                   // loop_invariant or duplicate
+    int loop_depth;
+    std::string loop_pcOffset;          // first instruction of the innermost loop, empty outside of loops
+    int loop_line_number;
+    std::string first_load_pcOffset;    // earlier load of the same address, for duplicates
+    int first_load_line_number;
+    std::vector<std::string> aliasing_store_pc_offsets; // stores, atomics and calls which may write to the address (in the loop, or between the loads)
+    bool synchronized;                  // a barrier or memory fence in the loop or between the loads, other threads may have changed the value
+    bool read_only;                     // loaded through the read-only cache (LDG.CONSTANT), e.g. with const __restrict__
+    std::string use_pcOffset;           // first instruction which reads the loaded value, empty if not found; it waits for the load (long scoreboard)
+};
+
+/// @brief Whether the instruction may write to global memory
+bool is_global_memory_write(const sass_instruction &instruction_obj)
+{
+    static const std::set<std::string> writes = {"STG", "ST", "ATOM", "ATOMG", "RED", "REDG", "CALL", "SUST", "SURED", "SUATOM", "UTMASTG"};
+    return writes.count(instruction_obj.opcode) > 0;
+}
+
+/// @brief Whether the instruction orders memory accesses between threads (barrier or memory fence)
+bool is_memory_synchronization(const sass_instruction &instruction_obj)
+{
+    return instruction_obj.opcode == "BAR" || instruction_obj.opcode == "MEMBAR" || instruction_obj.opcode == "ERRBAR";
+}
+
+/// @brief Whether the register has the same value in every iteration of the loop
+/// It is not written in the loop, or written once (unpredicated) from loop-invariant registers, e.g. an address recomputed in every iteration
+bool is_loop_invariant_register(const sass_kernel &kernel, const sass_loop &loop, const std::string &register_name, int depth = 0)
+{
+    if (register_name.empty() || register_name == "RZ" || register_name == "URZ" || register_name == "PT")
+    {
+        return true;
+    }
+    int definition = -1;
+    for (int i = loop.start_index; i <= loop.end_index; i++)
+    {
+        const std::vector<std::string> &destinations = get_destination_registers(kernel.instructions[i]);
+        if (std::find(destinations.begin(), destinations.end(), register_name) == destinations.end())
+        {
+            continue;
+        }
+        if (definition >= 0)
+        {
+            return false; // written more than once
+        }
+        definition = i;
+    }
+    if (definition < 0)
+    {
+        return true;
+    }
+
+    const sass_instruction &definition_obj = kernel.instructions[definition];
+    if (depth >= redundant_load_max_depth || !definition_obj.predicate.empty() || (definition_obj.opcode.compare(0, 2, "LD") == 0 && definition_obj.opcode != "LDC") ||
+        definition_obj.opcode.find("ATOM") != std::string::npos || definition_obj.opcode == "CS2R")
+    {
+        return false;
+    }
+    for (const auto &source : get_source_operands(definition_obj))
+    {
+        if (definition_obj.opcode == "S2R" || definition_obj.opcode == "S2UR")
+        {
+            // Thread and block indices do not change, the clock and other special registers do
+            return source.find("TID") != std::string::npos || source.find("CTAID") != std::string::npos || source.find("LANEID") != std::string::npos;
+        }
+        std::string source_register = get_sass_register_name(source);
+        if (source_register == register_name || !is_loop_invariant_register(kernel, loop, source_register, depth + 1))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Registers which form the address of the memory operand, e.g. R2, R3 and UR4 for [R2.64+UR4]
+std::vector<std::string> get_address_registers(const sass_instruction &instruction_obj)
+{
+    std::vector<std::string> registers;
+    int operand_index = get_memory_operand_index(instruction_obj);
+    if (operand_index < 0)
+    {
+        return registers;
+    }
+    sass_memory_operand address = parse_memory_operand(instruction_obj.operands[operand_index]);
+    if (address.base_register != "RZ")
+    {
+        registers.push_back(address.base_register);
+        if (address.wide)
+        {
+            registers.push_back(get_next_register(address.base_register, 1));
+        }
+    }
+    if (!address.uniform_register.empty())
+    {
+        registers.push_back(address.uniform_register);
+        // A zero extended 32 bit offset is added to a 64 bit uniform pointer, e.g. [R2.U32+UR4]
+        if (address.zero_extended)
+        {
+            registers.push_back(get_next_register(address.uniform_register, 1));
+        }
+    }
+    return registers;
+}
+
+/// @brief First instruction after the load which reads the loaded register, -1 if it is overwritten before or not found up to the end of the loop or kernel
+int find_register_use(const sass_kernel &kernel, int index, int end_index)
+{
+    const std::vector<std::string> &destinations = get_destination_registers(kernel.instructions[index]);
+    if (destinations.empty())
+    {
+        return -1;
+    }
+    for (int i = index + 1; i <= end_index && i < (int)kernel.instructions.size(); i++)
+    {
+        for (const auto &source : get_source_operands(kernel.instructions[i]))
+        {
+            std::string register_name = get_sass_register_name(source);
+            if (std::find(destinations.begin(), destinations.end(), register_name) != destinations.end())
+            {
+                return i;
+            }
+        }
+        if (is_register_written(kernel, i, i + 1, destinations[0]))
+        {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+/// @brief Detects loop-invariant and duplicate global loads by parsing the SASS file
+/// @param filename Disassembled SASS file
+/// @return Tuple of the redundant global loads of every kernel and the pcOffsets of the instructions of the loops which contain them (by the pcOffset of the first instruction)
+std::tuple<std::unordered_map<std::string, std::vector<redundant_load>>, std::unordered_map<std::string, std::unordered_map<std::string, std::vector<std::string>>>> redundant_load_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<redundant_load>> load_map;
+    std::unordered_map<std::string, std::unordered_map<std::string, std::vector<std::string>>> loop_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        std::vector<redundant_load> &load_vec = load_map[k_kernel];
+        const std::vector<sass_instruction> &instructions = v_kernel.instructions;
+        int instruction_count = instructions.size();
+
+        // Instructions which start a basic block reached from elsewhere (branch targets), the end of a region for duplicates
+        std::vector<bool> join(instruction_count + 1, false);
+        for (const auto &[label, index] : v_kernel.label_index)
+        {
+            join[index] = true;
+        }
+
+        for (int i = 0; i < instruction_count; i++)
+        {
+            const sass_instruction &instruction_obj = instructions[i];
+            if (instruction_obj.opcode != "LDG" || has_modifier(instruction_obj, "STRONG") || has_modifier(instruction_obj, "MMIO"))
+            {
+                continue; // volatile and atomic-like loads have to be repeated
+            }
+            std::vector<std::string> address_registers = get_address_registers(instruction_obj);
+            const sass_loop *loop = get_innermost_loop(v_kernel, i);
+            int end_index = loop != nullptr ? loop->end_index : instruction_count - 1;
+
+            redundant_load load_obj = {};
+            load_obj.line_number = instruction_obj.line_number;
+            load_obj.pcOffset = instruction_obj.pcOffset;
+            load_obj.sass_instruction = instruction_obj.sass_instruction;
+            load_obj.loop_depth = instruction_obj.loop_depth;
+            load_obj.read_only = has_modifier(instruction_obj, "CONSTANT") || has_modifier(instruction_obj, "CI");
+            if (loop != nullptr)
+            {
+                load_obj.loop_pcOffset = instructions[loop->start_index].pcOffset;
+                load_obj.loop_line_number = loop->line_number;
+            }
+
+            // Duplicate of an earlier load of the same region: the same address operand and width, executed whenever this load is, the address registers not written in between
+            bool duplicate = false;
+            for (int j = i - 1; j >= 0 && !join[j + 1] && !duplicate; j--)
+            {
+                if (std::any_of(address_registers.begin(), address_registers.end(), [&](const std::string &r) { return is_register_written(v_kernel, j, j + 1, r); }))
+                {
+                    break;
+                }
+                load_obj.synchronized = load_obj.synchronized || is_memory_synchronization(instructions[j]);
+                if (is_global_memory_write(instructions[j]))
+                {
+                    load_obj.aliasing_store_pc_offsets.insert(load_obj.aliasing_store_pc_offsets.begin(), instructions[j].pcOffset);
+                }
+                if (instructions[j].opcode == "LDG" && (instructions[j].predicate.empty() || instructions[j].predicate == instruction_obj.predicate) &&
+                    instructions[j].operands.back() == instruction_obj.operands.back() && get_access_bytes(instructions[j]) == get_access_bytes(instruction_obj))
+                {
+                    duplicate = true;
+                    load_obj.kind = "duplicate";
+                    load_obj.first_load_pcOffset = instructions[j].pcOffset;
+                    load_obj.first_load_line_number = instructions[j].line_number;
+                }
+            }
+
+            if (!duplicate)
+            {
+                // Loop-invariant: every address register has the same value in all iterations
+                if (loop == nullptr || !std::all_of(address_registers.begin(), address_registers.end(), [&](const std::string &r) { return is_loop_invariant_register(v_kernel, *loop, r); }))
+                {
+                    continue;
+                }
+                load_obj.kind = "loop_invariant";
+                load_obj.synchronized = false;
+                load_obj.aliasing_store_pc_offsets.clear();
+                for (int j = loop->start_index; j <= loop->end_index; j++)
+                {
+                    load_obj.synchronized = load_obj.synchronized || is_memory_synchronization(instructions[j]);
+                    if (is_global_memory_write(instructions[j]))
+                    {
+                        load_obj.aliasing_store_pc_offsets.push_back(instructions[j].pcOffset);
+                    }
+                }
+            }
+
+            int use = find_register_use(v_kernel, i, end_index);
+            load_obj.use_pcOffset = use >= 0 ? instructions[use].pcOffset : "";
+            load_vec.push_back(load_obj);
+
+            if (loop != nullptr && !loop_map[k_kernel].count(load_obj.loop_pcOffset))
+            {
+                std::vector<std::string> &loop_pc_offsets = loop_map[k_kernel][load_obj.loop_pcOffset];
+                for (int j = loop->start_index; j <= loop->end_index; j++)
+                {
+                    loop_pc_offsets.push_back(instructions[j].pcOffset);
+                }
+            }
+        }
+    }
+
+    return std::make_tuple(load_map, loop_map);
+}
+
+#endif
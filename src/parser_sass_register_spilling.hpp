@@ -1,5 +1,6 @@
 /**
  * SASS code analysis to detect register spilling to local memory
+ * Every local memory access is classified as register spill, access to a thread-private array (PTX .local depot) or ABI stack of a device function
  *
  * @author Soumya Sen
  */
@@ -7,6 +8,7 @@
 #ifndef PARSER_SASS_REGISTER_SPILLING_HPP
 #define PARSER_SASS_REGISTER_SPILLING_HPP
 
+#include "parser_sass_ir.hpp"
 #include <iostream>
 #include <iomanip>
 #include <unordered_map>
@@ -38,6 +40,10 @@ struct local_memory_counter
     int line_number;
     lmem_operation_type op_type;
     std::string pcOffset;
+    std::string kind = "spill";  // spill, local_array (thread-private array) or abi_stack (saved registers of a device function)
+    int access_bytes = 4;
+    long long stack_offset = -1; // offset in the stack frame, -1 if the address is computed (dynamically indexed array)
+    bool thread_dependent_index = false; // the index differs between the threads of a warp
 };
 
 /// @brief Track last SASS instruction of the spilled register
@@ -183,9 +189,9 @@ std::tuple<std::unordered_map<std::string, std::vector<local_memory_counter>>, s
                 code_line_number = std::stoi(line.substr(line.find("line ") + 5)); // saving the current line number
             }
 
-            if ((line.find("STL ") != std::string::npos) || (line.find("LDL ") != std::string::npos))
+            if ((line.find(" STL") != std::string::npos) || (line.find(" LDL") != std::string::npos)) // also the 64 and 128 bit accesses, e.g. LDL.64
             {
-                counter_obj.op_type = ((line.find("STL ") != std::string::npos)) ? STORE : LOAD;
+                counter_obj.op_type = ((line.find(" STL") != std::string::npos)) ? STORE : LOAD;
                 counter_obj.line_number = code_line_number;
                 counter_obj.register_number = ((line.find("+0x") != std::string::npos) || (line.find("+-0x") != std::string::npos)) ? get_lmem_base_register(line) : lmem_register(line);
                 counter_obj.pcOffset = get_pcoffset_sass(line);
@@ -250,4 +256,79 @@ std::tuple<std::unordered_map<std::string, std::vector<local_memory_counter>>, s
     return std::make_tuple(counter_map, track_register_map);
 }
 
+/// @brief Classify the local memory accesses found by register_spilling_analysis
+/// The stack frame is assumed to start with the arrays of the PTX __local_depot, followed by the spill slots of ptxas
+/// @param filename Disassembled SASS file, the same as for register_spilling_analysis
+/// @param depot_bytes Size of the PTX local depot of every kernel and device function
+/// @param counter_map Local memory accesses of every kernel, their kind is set
+void local_memory_classification(const std::string &filename, const std::unordered_map<std::string, int> &depot_bytes, std::unordered_map<std::string, std::vector<local_memory_counter>> &counter_map)
+{
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+
+    for (auto &[k_kernel, v_kernel] : counter_map)
+    {
+        auto kernel = kernel_map.find(k_kernel);
+        if (kernel == kernel_map.end())
+        {
+            continue;
+        }
+        const std::vector<sass_instruction> &instructions = kernel->second.instructions;
+        auto depot = depot_bytes.find(k_kernel);
+        int local_depot_bytes = depot != depot_bytes.end() ? depot->second : 0;
+        std::unordered_map<std::string, sass_value> cache;
+
+        std::unordered_map<std::string, int> index_by_pc;
+        for (int i = 0; i < (int)instructions.size(); i++)
+        {
+            index_by_pc[instructions[i].pcOffset] = i;
+        }
+
+        // Frame offsets at which registers of the caller are saved, i.e. registers stored before the function writes them
+        std::set<long long> saved_register_offsets;
+        std::unordered_map<int, long long> frame_offsets;
+        for (int i = 0; i < (int)instructions.size(); i++)
+        {
+            // Accesses relative to the stack pointer R1, directly or through a copy with a constant offset
+            long long offset = 0;
+            if ((instructions[i].opcode != "LDL" && instructions[i].opcode != "STL") || !get_stack_offset(kernel->second, i, cache, offset))
+            {
+                continue;
+            }
+            frame_offsets[i] = offset;
+
+            if (offset >= local_depot_bytes && is_abi_register_save(kernel->second, i))
+            {
+                saved_register_offsets.insert(offset);
+            }
+        }
+
+        for (auto &counter_obj : v_kernel)
+        {
+            auto index = index_by_pc.find(counter_obj.pcOffset);
+            if (index == index_by_pc.end())
+            {
+                continue;
+            }
+            const sass_instruction &instruction_obj = instructions[index->second];
+            counter_obj.access_bytes = get_access_bytes(instruction_obj);
+
+            auto frame_offset = frame_offsets.find(index->second);
+            if (frame_offset == frame_offsets.end())
+            {
+                // A computed address indexes a thread-private array
+                counter_obj.kind = "local_array";
+                counter_obj.thread_dependent_index = get_address_value(kernel->second, index->second, cache).thread_dependent;
+                continue;
+            }
+            counter_obj.stack_offset = frame_offset->second;
+            if (frame_offset->second < local_depot_bytes)
+                counter_obj.kind = "local_array";
+            else if (saved_register_offsets.count(frame_offset->second))
+                counter_obj.kind = "abi_stack";
+            else
+                counter_obj.kind = "spill";
+        }
+    }
+}
+
 #endif // PARSER_SASS_REGISTER_SPILLING_HPP
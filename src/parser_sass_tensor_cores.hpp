@@ -0,0 +1,106 @@
+/**
+ * SASS code analysis to find loops dominated by fused multiply-adds (instruction FFMA, HFMA2, DFMA) without tensor core instructions (HMMA, IMMA, HGMMA, ...)
+ * The instruction mix of every innermost loop and the memory space its FMA operands are loaded from are counted
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_TENSOR_CORES_HPP
+#define PARSER_SASS_TENSOR_CORES_HPP
+
+#include "parser_sass_ir.hpp"
+#include <tuple>
+
+/// @brief Instruction mix of an innermost loop
+struct fma_loop
+{
+    int line_number;            // source line of the first instruction of the loop
+    std::string start_pcOffset;
+    std::string end_pcOffset;   // of the backward branch
+    std::vector<std::string> pc_offsets; // of all instructions of the loop
+    int instructions;
+    std::map<std::string, int> fma_count; // FFMA, HFMA2, DFMA -> instructions
+    int fma_from_shared;        // FMAs with an operand loaded from shared memory (LDS)
+    int fma_from_global;        // FMAs with an operand loaded from global memory (LDG)
+    int mma_count;              // tensor core instructions in the loop
+};
+
+/// @brief Whether the opcode is a tensor core instruction
+bool is_mma_opcode(const std::string &opcode)
+{
+    static const std::set<std::string> mma = {"HMMA", "IMMA", "DMMA", "BMMA", "HGMMA", "IGMMA", "QGMMA", "BGMMA", "OMMA", "QMMA", "UTCHMMA", "UTCQMMA", "UTCIMMA", "UTCOMMA"};
+    return mma.count(opcode) > 0;
+}
+
+/// @brief SASS analysis of the instruction mix of the innermost loops
+/// @param filename Disassembled SASS file
+/// @return Tuple of the innermost loops of every kernel, the number of tensor core instructions of every kernel and the SM version of the SASS
+std::tuple<std::unordered_map<std::string, std::vector<fma_loop>>, std::unordered_map<std::string, int>, int> tensor_core_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<fma_loop>> loop_map;
+    std::unordered_map<std::string, int> kernel_mma_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+    int sm_version = 0;
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        sm_version = std::max(sm_version, v_kernel.sm_version);
+        std::vector<fma_loop> &loop_vec = loop_map[k_kernel];
+        int &kernel_mma = kernel_mma_map[k_kernel];
+        for (const auto &instruction_obj : v_kernel.instructions)
+        {
+            kernel_mma += is_mma_opcode(instruction_obj.opcode);
+        }
+
+        for (const auto &loop : v_kernel.loops)
+        {
+            // Only innermost loops, the FMAs of an outer loop are counted in its inner loops
+            if (!is_innermost_loop(v_kernel, loop))
+            {
+                continue;
+            }
+
+            fma_loop loop_obj = {};
+            loop_obj.line_number = loop.line_number;
+            loop_obj.start_pcOffset = v_kernel.instructions[loop.start_index].pcOffset;
+            loop_obj.end_pcOffset = v_kernel.instructions[loop.end_index].pcOffset;
+            for (int i = loop.start_index; i <= loop.end_index; i++)
+            {
+                const sass_instruction &instruction_obj = v_kernel.instructions[i];
+                loop_obj.instructions++;
+                loop_obj.pc_offsets.push_back(instruction_obj.pcOffset);
+                loop_obj.mma_count += is_mma_opcode(instruction_obj.opcode);
+                if (instruction_obj.opcode != "FFMA" && instruction_obj.opcode != "HFMA2" && instruction_obj.opcode != "DFMA")
+                {
+                    continue;
+                }
+                loop_obj.fma_count[instruction_obj.opcode]++;
+
+                // Multiplied operands loaded from memory, e.g. the tiles of a matrix multiplication
+                bool from_shared = false, from_global = false;
+                std::vector<std::string> sources = get_source_operands(instruction_obj);
+                for (size_t j = 0; j < sources.size() && j < 2; j++)
+                {
+                    std::string register_name = get_sass_register_name(sources[j]);
+                    if (register_name.empty() || register_name[0] != 'R' || register_name == "RZ")
+                    {
+                        continue;
+                    }
+                    int definition = find_register_definition(v_kernel, i, register_name);
+                    if (definition >= 0)
+                    {
+                        from_shared = from_shared || v_kernel.instructions[definition].opcode == "LDS";
+                        from_global = from_global || v_kernel.instructions[definition].opcode == "LDG";
+                    }
+                }
+                loop_obj.fma_from_shared += from_shared;
+                loop_obj.fma_from_global += from_global && !from_shared;
+            }
+            loop_vec.push_back(loop_obj);
+        }
+    }
+
+    return std::make_tuple(loop_map, kernel_mma_map, sm_version);
+}
+
+#endif
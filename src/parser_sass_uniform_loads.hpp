@@ -0,0 +1,146 @@
+/**
+ * SASS code analysis to find global loads (instruction LDG) whose address is the same for all threads of a warp
+ * Such loads read kernel parameter arrays, block-wise or loop-wise tables, which the constant cache (__constant__, ULDC) serves with one broadcast
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_UNIFORM_LOADS_HPP
+#define PARSER_SASS_UNIFORM_LOADS_HPP
+
+#include "parser_sass_ir.hpp"
+
+/// @brief A global load with a warp-uniform address
+struct uniform_load
+{
+    int line_number;
+    std::string pcOffset;
+    std::string sass_instruction;
+    int access_bytes;
+    int loop_depth;
+    std::string scope;                 // grid (only kernel parameters and constants), block (blockIdx), loop (loop counter) or warp (other uniform values)
+    std::set<std::string> parameters;  // kernel parameters (c[0x0][...]) of the address
+    bool read_only_path;               // the load already uses the read-only data path (LDG.CONSTANT, __ldg, const __restrict__)
+    bool written_in_kernel;            // a store or atomic of the kernel uses the same kernel parameter as address
+    bool selected;                     // the address is chosen at runtime by a SEL or a predicated instruction, e.g. between two arrays
+};
+
+/// @brief Kernel parameter of a uniform term, e.g. c[0x0][0x160] for c[0x0][0x160]*4, empty for other terms
+std::string get_parameter_term(const std::string &term)
+{
+    return term.compare(0, 2, "c[") == 0 ? term.substr(0, term.find('*')) : "";
+}
+
+/// @brief Whether the register depends on a predicated definition or a SEL/FSEL, i.e. its value is chosen at runtime between different ones
+bool has_selected_definition(const sass_kernel &kernel, int index, const std::string &register_name, int depth = 0)
+{
+    int definition = find_register_definition(kernel, index, register_name);
+    if (definition < 0 || depth > 8)
+    {
+        return false;
+    }
+    const sass_instruction &definition_obj = kernel.instructions[definition];
+    if (!definition_obj.predicate.empty() || definition_obj.opcode == "SEL" || definition_obj.opcode == "FSEL" || definition_obj.opcode == "USEL")
+    {
+        return true;
+    }
+    for (const auto &source : get_source_operands(definition_obj))
+    {
+        // The address of a load does not choose the loaded value
+        std::string source_register = get_sass_register_name(source);
+        if (is_memory_operand(source) || source_register.empty() || source_register == "RZ" || source_register == "URZ" || source_register[0] == 'P' ||
+            source_register.compare(0, 2, "UP") == 0)
+        {
+            continue;
+        }
+        if (has_selected_definition(kernel, definition, source_register, depth + 1))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief SASS analysis of the global loads with warp-uniform addresses
+/// @param filename Disassembled SASS file
+/// @return mapping of each kernel with its uniform loads
+std::unordered_map<std::string, std::vector<uniform_load>> uniform_load_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<uniform_load>> load_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        std::vector<uniform_load> &load_vec = load_map[k_kernel];
+        std::unordered_map<std::string, sass_value> cache;
+
+        // Kernel parameters used as address of a store or atomic, their data is not read-only
+        std::set<std::string> written_parameters;
+        static const std::set<std::string> global_writes = {"STG", "ATOMG", "ATOM", "RED", "REDG", "ST"};
+        for (int i = 0; i < (int)v_kernel.instructions.size(); i++)
+        {
+            if (global_writes.count(v_kernel.instructions[i].opcode))
+            {
+                for (const auto &term : get_address_value(v_kernel, i, cache).uniform_terms)
+                {
+                    if (!get_parameter_term(term).empty())
+                    {
+                        written_parameters.insert(get_parameter_term(term));
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < (int)v_kernel.instructions.size(); i++)
+        {
+            const sass_instruction &instruction_obj = v_kernel.instructions[i];
+            if (instruction_obj.opcode != "LDG")
+            {
+                continue;
+            }
+            sass_value address = get_address_value(v_kernel, i, cache);
+            if (!address.affine || address.thread_dependent || !address.thread_terms.empty())
+            {
+                continue;
+            }
+
+            uniform_load load_obj = {};
+            load_obj.line_number = instruction_obj.line_number;
+            load_obj.pcOffset = instruction_obj.pcOffset;
+            load_obj.sass_instruction = instruction_obj.sass_instruction;
+            load_obj.access_bytes = get_access_bytes(instruction_obj);
+            load_obj.loop_depth = instruction_obj.loop_depth;
+            load_obj.read_only_path = has_modifier(instruction_obj, "CONSTANT") || has_modifier(instruction_obj, "CI");
+            load_obj.scope = "grid";
+            sass_memory_operand operand = parse_memory_operand(instruction_obj.operands[get_memory_operand_index(instruction_obj)]);
+            load_obj.selected = has_selected_definition(v_kernel, i, operand.base_register) ||
+                                (!operand.uniform_register.empty() && has_selected_definition(v_kernel, i, operand.uniform_register));
+            for (const auto &term : address.uniform_terms)
+            {
+                std::string parameter = get_parameter_term(term);
+                if (!parameter.empty())
+                {
+                    load_obj.parameters.insert(parameter);
+                    load_obj.written_in_kernel = load_obj.written_in_kernel || written_parameters.count(parameter);
+                }
+                else if (term.find("iteration of loop") != std::string::npos)
+                {
+                    load_obj.scope = "loop";
+                }
+                else if (term.compare(0, 5, "ctaid") == 0 && load_obj.scope == "grid")
+                {
+                    load_obj.scope = "block";
+                }
+                else if (load_obj.scope == "grid")
+                {
+                    load_obj.scope = "warp";
+                }
+            }
+            load_vec.push_back(load_obj);
+        }
+    }
+
+    return load_map;
+}
+
+#endif
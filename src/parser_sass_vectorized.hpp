@@ -1,5 +1,8 @@
 /**
- * SASS code analysis to detect use of vectorized load
+ * SASS code analysis to detect use of vectorized load and store
+ * Scalar accesses of the same memory space which share a base register and have consecutive offsets, e.g. [R2.64], [R2.64+0x4], [R2.64+0x8], [R2.64+0xc],
+ * can be replaced by one 64- or 128-bit access, if the alignment of the address allows it
+ * Local accesses relative to the stack pointer are spills or the ABI stack of device functions, which the source code cannot vectorize
  *
  * @author Soumya Sen
 */
@@ -7,17 +10,8 @@
 #ifndef PARSER_SASS_VECTORIZED_HPP
 #define PARSER_SASS_VECTORIZED_HPP
 
-#include <iostream>
-#include <iomanip>
-#include <unordered_map>
-#include <string>
-#include <vector>
+#include "parser_sass_ir.hpp"
 #include <tuple>
-#include <set>
-#include <fstream>
-#include <sstream>
-#include <utility>
-#include <algorithm>
 #include <memory>
 
 /// @brief Load types can be 32- 64- or 128-bit width
@@ -28,198 +22,223 @@ enum load_type
     VEC_128,
 };
 
-/// @brief Counts total number of global load instructions
+const int max_vector_bytes = 16;
+
+/// @brief Counts the loads and stores of a kernel
 struct load_counter
 {
-    int global_load_count;
+    int global_load_count;       // non-vectorized global loads
+    int access_count;            // global, shared and local loads and stores
+    int vectorized_access_count; // loads and stores which already use 64- or 128-bit width
 };
 
+/// @brief Scalar accesses which can be combined into one vectorized access
 struct register_data
 {
     int line_number;
-    std::string pcOffset;
-    std::string base;
-    std::vector<unsigned long> unrolls;
-    std::vector<std::string> unroll_pc_offsets;
-    load_type reg_load_type;
+    std::string pcOffset;          // of the first access
+    std::string base;              // base register of the address
+    std::vector<long long> unrolls;               // offsets of the accesses from the base register
+    std::vector<std::string> unroll_pc_offsets;   // pcOffsets of the accesses
+    std::vector<int> line_numbers;                // source lines of the accesses
+    load_type reg_load_type;       // width of the vectorized access
+    std::string sass_instruction;  // the first access, as in the SASS
+    std::string memory_space;      // global, shared or local
+    std::string access_kind;       // load or store
+    int access_bytes;              // bytes per thread of every scalar access
+    int vector_bytes;              // bytes per thread of the vectorized access
+    int instructions_saved;
+    bool alignment_known;          // false if the alignment of the base address is unknown, the candidate then requires the address to be aligned to vector_bytes
+    bool store_in_between;         // loads only: a store to the same memory space is executed between the accesses
+    int loop_depth;
 };
 
-/// @brief Reads the global load address and splits into the base register and unrolled value, where [R2+0x10] denotes R2 as base register and 10 as the unrolled value
-/// @param line SASS instruction line
-/// @return Pair with the base register and unrolled values. For no unrolled values, returns 0 for the second pair element
-std::pair<std::string, unsigned long> read_register_pair(const std::string &line)
+/// @brief Memory space and kind of a load or store which could be vectorized
+/// @return false for other instructions
+bool get_vectorizable_access(const sass_instruction &instruction_obj, std::string &memory_space, std::string &access_kind)
 {
-    std::string substr, last_string, last_string_clean;
-
-    std::istringstream ss(line);
-    while (std::getline(ss, substr, ','))
-    {
-        last_string = substr;
-    }
-
-    std::istringstream ss2(last_string);
-    std::getline(ss2, substr, ' ');
-    std::getline(ss2, substr, ' ');
-
-    std::string remove_chars = "[]-";
-    substr.erase(std::remove_if(substr.begin(), substr.end(), [&remove_chars](const char &c)
-                                { return remove_chars.find(c) != std::string::npos; }),
-                 substr.end());
-
-    std::string register_base, register_unroll;
-    std::istringstream ss3(substr);
-    std::getline(ss3, register_base, '+');
-    std::getline(ss3, register_unroll, 'x');
-    std::getline(ss3, register_unroll, 'x');
-
-    /*
-    Need to put in try-catch block since the register unroll might not always be numbers
-    For example:    (18a0*) LDG.E.SYS R34, [R2.64+UR4] ;
-    */
-    try
-    {
-        std::stoul(register_unroll, nullptr, 16);
-    }
-    catch (const std::invalid_argument &e)
+    static const std::map<std::string, std::pair<std::string, std::string>> accesses = {
+        {"LDG", {"global", "load"}}, {"STG", {"global", "store"}}, {"LDS", {"shared", "load"}}, {"STS", {"shared", "store"}}, {"LDL", {"local", "load"}}, {"STL", {"local", "store"}}};
+    auto access = accesses.find(instruction_obj.opcode);
+    if (access == accesses.end() || get_memory_operand_index(instruction_obj) < 0)
     {
-        register_unroll = "";
-        // std::cerr << e.what() << std::endl;
+        return false;
     }
-
-    std::pair<std::string, unsigned long> register_pair = (register_unroll != "") ? std::make_pair(register_base, std::stoul(register_unroll, nullptr, 16)) : std::make_pair(register_base, (ulong)0);
-    return register_pair;
+    memory_space = access->second.first;
+    access_kind = access->second.second;
+    return true;
 }
 
-std::string get_pcoffset_sass(std::string line)
+/// @brief One scalar access of a group with the same base address
+struct vectorizable_access
 {
-    //         /*00a0*/                   ISETP.GE.AND P1, PT, R2, c[0x0][0x168], PT ;         -> extract 00a0
-    std::string substr;
-
-    std::istringstream ss(line);
-    std::getline(ss, substr, '*');
-    std::getline(ss, substr, '*');
-
-    return substr;
-}
+    int index;
+    long long offset;
+};
 
-/// @brief SASS analysis if vectorized load can be used
+/// @brief SASS analysis if vectorized loads and stores can be used
+/// The accesses of a basic block are grouped by the instruction (opcode and width), the value of the base register and the predicate,
+/// consecutive offsets of a group are then split into the widest aligned vectors
 /// @param filename Disassembled SASS file
-/// @return Tuple of two maps - first map includes total global load counts for the kernel, second includes register data for global loads
+/// @return Tuple of two maps - first map includes the access counts for the kernel, second includes the accesses which can be vectorized
 std::tuple<std::unordered_map<std::string, load_counter>, std::unordered_map<std::string, std::vector<register_data>>> vectorized_analysis(const std::string &filename)
 {
-    std::string line;
-    std::fstream file(filename, std::ios::in);
-
-    load_counter counter_obj;
     std::unordered_map<std::string, load_counter> counter_map;
-    std::vector<register_data> register_vec;
     std::unordered_map<std::string, std::vector<register_data>> register_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
 
-    std::string kernel_name;
-
-    int code_line_number;
-    // register_data register_obj;
-
-    if (file.is_open())
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
     {
-        while (std::getline(file, line))
+        load_counter counter_obj = {};
+        std::vector<register_data> &register_vec = register_map[k_kernel];
+        std::unordered_map<std::string, sass_value> cache;
+
+        // Groups in the order of their first access, the key identifies the instruction, base address and basic block
+        std::vector<std::vector<vectorizable_access>> groups;
+        std::unordered_map<std::string, int> group_index;
+        std::vector<std::pair<int, std::string>> stores; // index and memory space, for the stores between the accesses of a load group
+        int basic_block = 0;
+        std::set<int> labels;
+        for (const auto &[label, index] : v_kernel.label_index)
         {
-            if (line.find(".section	.text.") != std::string::npos) // denotes start of the kernel
+            labels.insert(index);
+        }
+
+        for (int i = 0; i < (int)v_kernel.instructions.size(); i++)
+        {
+            const sass_instruction &instruction_obj = v_kernel.instructions[i];
+            if (labels.count(i))
             {
-                counter_obj.global_load_count = 0;
-                register_vec.clear();
-
-                // https://cplusplus.com/reference/string/string/erase/     - erase part of a string
-                line.erase(line.begin(), line.begin() + 16); // erase the first 16 character of the name of the kernel
-                line.erase(line.end() - 15, line.end());     // erase the last 15 character of the name of the kernel
-                kernel_name = line;
-                // std::cout << kernel_name << std::endl;
+                basic_block++;
             }
-
-            if (line.find(" line ") != std::string::npos)
+            static const std::set<std::string> block_end = {"BRA", "BRX", "JMP", "JMX", "CALL", "RET", "EXIT", "BAR", "MEMBAR", "WARPSYNC", "BSYNC"};
+            if (block_end.count(instruction_obj.opcode))
             {
-                code_line_number = std::stoi(line.substr(line.find("line ") + 5)); // saving the current line number
+                basic_block++;
+                continue;
             }
 
-            // looking for not vectorized global load
-            // if ((line.find("LDG.E ") != std::string::npos) ||
-            //     (line.find("LDG.E.CI ") != std::string::npos) ||
-            //     (line.find("LDG.E.U ") != std::string::npos) ||
-            //     (line.find("LDG.E.CONSTANT.SYS ") != std::string::npos) ||
-            //     (line.find("LDG.E.SYS ") != std::string::npos) )
-            if (line.find("LDG.") != std::string::npos)
+            std::string memory_space, access_kind;
+            if (!get_vectorizable_access(instruction_obj, memory_space, access_kind))
+            {
+                continue;
+            }
+            counter_obj.access_count++;
+            int access_bytes = get_access_bytes(instruction_obj);
+            if (access_bytes >= 8)
+            {
+                counter_obj.vectorized_access_count++;
+            }
+            else if (memory_space == "global" && access_kind == "load")
             {
                 counter_obj.global_load_count++;
+            }
+            if (access_kind == "store")
+            {
+                stores.push_back({i, memory_space});
+            }
+            if (access_bytes >= max_vector_bytes)
+            {
+                continue;
+            }
 
-                std::pair<std::string, unsigned long> register_pair = read_register_pair(line);
+            // The same register with another definition holds another address
+            sass_memory_operand address = parse_memory_operand(instruction_obj.operands[get_memory_operand_index(instruction_obj)]);
+            if (memory_space == "local" && is_stack_address(address))
+            {
+                continue;
+            }
+            std::string key = instruction_obj.predicate + " " + instruction_obj.opcode;
+            for (const auto &modifier : instruction_obj.modifiers)
+            {
+                key += "." + modifier;
+            }
+            key += " " + address.base_register + ":" + std::to_string(find_register_definition(v_kernel, i, address.base_register)) + " " + std::to_string(address.scale) + " " +
+                   address.uniform_register + ":" + std::to_string(address.uniform_register.empty() ? -1 : find_register_definition(v_kernel, i, address.uniform_register)) + " " +
+                   std::to_string(basic_block);
+            auto group = group_index.find(key);
+            if (group == group_index.end())
+            {
+                group = group_index.emplace(key, groups.size()).first;
+                groups.emplace_back();
+            }
+            groups[group->second].push_back({i, address.offset});
+        }
 
-                // Check if the line is already present (i.e. did LDG already)
-                std::vector<register_data>::iterator line_match = std::find_if(register_vec.begin(), register_vec.end(), [&](const register_data &i)
-                                                                               { return code_line_number == i.line_number; });
-                std::vector<register_data>::iterator base_match = std::find_if(register_vec.begin(), register_vec.end(), [&](const register_data &i)
-                                                                               { return (register_pair.first == i.base) && (code_line_number == i.line_number); });
-                if (line_match == register_vec.end()) // line not present
+        for (auto &group : groups)
+        {
+            if (group.size() < 2)
+            {
+                continue;
+            }
+            // The same offset accessed twice is not a candidate, only its first access is kept
+            std::stable_sort(group.begin(), group.end(), [](const vectorizable_access &a, const vectorizable_access &b) { return a.offset < b.offset; });
+            group.erase(std::unique(group.begin(), group.end(), [](const vectorizable_access &a, const vectorizable_access &b) { return a.offset == b.offset; }), group.end());
+
+            const sass_instruction &first_obj = v_kernel.instructions[group[0].index];
+            std::string memory_space, access_kind;
+            get_vectorizable_access(first_obj, memory_space, access_kind);
+            int access_bytes = get_access_bytes(first_obj);
+
+            // Alignment of the base address, without the offsets of the accesses
+            sass_value base_value = get_address_value(v_kernel, group[0].index, cache);
+            base_value.constant -= group[0].offset;
+            // If the alignment is unknown, the vectors only follow the offsets and the candidates are conditional on the alignment of the address
+            bool alignment_known;
+            long long base_alignment = get_sass_value_alignment(base_value, max_vector_bytes, alignment_known);
+
+            size_t start = 0;
+            while (start < group.size())
+            {
+                // Widest vector which starts here, covers consecutive offsets and is aligned
+                int vector_elements = 1;
+                for (int vector_bytes = max_vector_bytes; vector_bytes > access_bytes && vector_elements == 1; vector_bytes /= 2)
                 {
-                    register_data register_obj;
-
-                    register_obj.reg_load_type = VEC_32;
-                    if (line.find(".64") != std::string::npos)
-                    {
-                        register_obj.reg_load_type = VEC_64;
-                    }
-                    if (line.find(".128") != std::string::npos)
+                    int elements = vector_bytes / access_bytes;
+                    if (start + elements > group.size() || group[start].offset % vector_bytes != 0 || (alignment_known && base_alignment % vector_bytes != 0) ||
+                        group[start + elements - 1].offset - group[start].offset != (long long)(elements - 1) * access_bytes)
                     {
-                        register_obj.reg_load_type = VEC_128;
+                        continue;
                     }
-                    register_obj.line_number = code_line_number;
-                    register_obj.pcOffset = get_pcoffset_sass(line);
-                    register_obj.base = register_pair.first;
-                    register_obj.unrolls.push_back(register_pair.second);
-                    register_obj.unroll_pc_offsets.push_back(get_pcoffset_sass(line));
-                    register_vec.push_back(register_obj);
+                    vector_elements = elements;
                 }
-                else // line present
+                if (vector_elements == 1)
                 {
-                    // Check if the base (register) is present
-                    if (base_match == register_vec.end()) // base not present
-                    {
-                        register_data register_obj;
-
-                        register_obj.reg_load_type = VEC_32;
-                        if (line.find(".64") != std::string::npos)
-                        {
-                            register_obj.reg_load_type = VEC_64;
-                        }
-                        if (line.find(".128") != std::string::npos)
-                        {
-                            register_obj.reg_load_type = VEC_128;
-                        }
-                        register_obj.line_number = code_line_number;
-                        register_obj.pcOffset = get_pcoffset_sass(line);
-                        register_obj.base = register_pair.first;
-                        register_obj.unrolls.push_back(register_pair.second);
-                        register_obj.unroll_pc_offsets.push_back(get_pcoffset_sass(line));
-                        register_vec.push_back(register_obj);
-                    }
-                    else // line and base present
-                    {
-                        // Add the unroll part
-                        base_match->unrolls.push_back(register_pair.second);
-                        base_match->unroll_pc_offsets.push_back(get_pcoffset_sass(line));
-                    }
+                    start++;
+                    continue;
                 }
-            }
 
-            counter_map[kernel_name] = counter_obj;
-            register_map[kernel_name] = register_vec;
+                register_data register_obj;
+                register_obj.base = parse_memory_operand(first_obj.operands[get_memory_operand_index(first_obj)]).base_register;
+                register_obj.memory_space = memory_space;
+                register_obj.access_kind = access_kind;
+                register_obj.access_bytes = access_bytes;
+                register_obj.vector_bytes = vector_elements * access_bytes;
+                register_obj.reg_load_type = register_obj.vector_bytes == 16 ? VEC_128 : VEC_64;
+                register_obj.instructions_saved = vector_elements - 1;
+                register_obj.alignment_known = alignment_known;
+                register_obj.loop_depth = first_obj.loop_depth;
+                int first_index = v_kernel.instructions.size(), last_index = 0;
+                for (size_t j = start; j < start + vector_elements; j++)
+                {
+                    const sass_instruction &instruction_obj = v_kernel.instructions[group[j].index];
+                    register_obj.unrolls.push_back(group[j].offset);
+                    register_obj.unroll_pc_offsets.push_back(instruction_obj.pcOffset);
+                    register_obj.line_numbers.push_back(instruction_obj.line_number);
+                    first_index = std::min(first_index, group[j].index);
+                    last_index = std::max(last_index, group[j].index);
+                }
+                register_obj.line_number = v_kernel.instructions[first_index].line_number;
+                register_obj.pcOffset = v_kernel.instructions[first_index].pcOffset;
+                register_obj.sass_instruction = v_kernel.instructions[first_index].sass_instruction;
+                register_obj.store_in_between = access_kind == "load" && std::any_of(stores.begin(), stores.end(), [&](const std::pair<int, std::string> &store)
+                                                                                      { return store.first > first_index && store.first < last_index && store.second == memory_space; });
+                register_vec.push_back(register_obj);
+                start += vector_elements;
+            }
         }
+        counter_map[k_kernel] = counter_obj;
     }
-    else
-        std::cout << "Could not open the file: " << filename << std::endl;
-
-    // // To suggest vectorization: https://stackoverflow.com/questions/69464386/is-there-a-way-to-load-128-bits-from-memory-directly-to-registers
-    // // If there are, say, 4 seperate LDG.E (for a single line), like LDG.E.SYS R13, [UR4]; , LDG.E.SYS R17, [UR4+0x18] ; , LDG.E.SYS R21, [UR4+0x30] ; , LDG.E.SYS R21, [UR4+0x48] ;
-    // // then suggest to use 1 LDG.E.128 vectorized load for that line (it then becomes LDG.E.128.SYS R20, [UR6] ;)
 
     return std::make_tuple(counter_map, register_map);
 }
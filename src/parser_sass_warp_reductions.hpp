@@ -0,0 +1,332 @@
+/**
+ * SASS code analysis to find reductions which could be done within a warp with shuffles
+ * Shared memory tree reductions (LDS -> add -> STS steps separated by BAR) in loops or unrolled, and atomics (ATOMG, RED, ATOMS) which every thread of a warp applies to the same address
+ * Warp reductions (SHFL, REDUX) or a vote (VOTE, MATCH) before an atomic mean that it is already aggregated
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef PARSER_SASS_WARP_REDUCTIONS_HPP
+#define PARSER_SASS_WARP_REDUCTIONS_HPP
+
+#include "parser_sass_ir.hpp"
+#include <tuple>
+
+// Instructions before an atomic searched for an existing warp aggregation
+const int warp_aggregation_window = 16;
+// Instructions between the steps of an unrolled tree reduction
+const int tree_reduction_max_step_distance = 64;
+
+/// @brief A shared memory tree reduction, or an atomic which could be aggregated within the warp first
+struct warp_reduction
+{
+    int line_number;
+    std::string pcOffset;               // first instruction of the tree reduction, or the atomic
+    std::string end_pcOffset;           // last instruction of the tree reduction
+    std::string sass_instruction;       // the atomic, or the combining instruction of the first step
+    std::string kind;                   // tree_loop, tree_unrolled, atomic_uniform or atomic_data_dependent
+    int loop_depth;
+    std::string operation;              // ADD, MIN, MAX, AND, OR, XOR, ...
+    std::string data_type;              // e.g. F32, S32, U32, F64
+    int steps;                          // LDS -> combine -> STS steps of the tree reduction
+    int barriers;                       // block barriers of the tree reduction
+    int warp_synchronous_steps;         // steps without a barrier since the previous step, only safe with __syncwarp since Volta
+    bool halving;                       // the loop shifts its stride to the right (s >>= 1)
+    bool global;                        // global atomic (ATOMG, RED), otherwise shared (ATOMS)
+    bool constant_value;                // the atomic adds the same value in all threads, e.g. a counter increment
+    std::vector<std::string> pc_offsets; // of the instructions of the tree reduction, or the atomic
+};
+
+/// @brief Whether the instruction combines two values of a reduction
+bool is_reduction_combine(const sass_instruction &instruction_obj)
+{
+    static const std::set<std::string> combines = {"FADD", "DADD", "HADD2", "IADD3", "IADD", "FMNMX", "IMNMX", "VIMNMX", "DMNMX", "LOP3"};
+    return combines.count(instruction_obj.opcode) > 0;
+}
+
+/// @brief Whether the instruction reduces or votes within a warp (shuffles, REDUX, VOTE, MATCH, find leader)
+bool is_warp_collective(const sass_instruction &instruction_obj)
+{
+    static const std::set<std::string> collectives = {"SHFL", "REDUX", "CREDUX", "VOTE", "VOTEU", "MATCH", "FLO", "UFLO"};
+    return collectives.count(instruction_obj.opcode) > 0;
+}
+
+/// @brief Operation of a reduction atomic, e.g. ADD for RED.E.ADD.F32.FTZ.RN.STRONG.GPU, empty for exchanges and compare and swap
+std::string get_atomic_operation(const sass_instruction &instruction_obj)
+{
+    static const std::set<std::string> operations = {"ADD", "INC", "DEC", "MIN", "MAX", "AND", "OR", "XOR"};
+    for (const auto &modifier : instruction_obj.modifiers)
+    {
+        if (operations.count(modifier))
+        {
+            return modifier;
+        }
+    }
+    // ATOMS.POPC.INC and ATOMS without an operation default to an integer add
+    return instruction_obj.opcode == "ATOMS" && !has_modifier(instruction_obj, "EXCH") && !has_modifier(instruction_obj, "CAS") && !has_modifier(instruction_obj, "CAST") ? "ADD" : "";
+}
+
+/// @brief Data type of an atomic or combining instruction, e.g. F32 or S32
+std::string get_reduction_data_type(const sass_instruction &instruction_obj)
+{
+    static const std::set<std::string> types = {"F32", "F64", "F16x2", "BF16x2", "S32", "U32", "64", "S64", "U64"};
+    for (const auto &modifier : instruction_obj.modifiers)
+    {
+        if (types.count(modifier))
+        {
+            return modifier == "64" ? "U64" : modifier;
+        }
+    }
+    if (instruction_obj.opcode[0] == 'F')
+        return "F32";
+    if (instruction_obj.opcode[0] == 'D')
+        return "F64";
+    if (instruction_obj.opcode[0] == 'H')
+        return "F16x2";
+    return instruction_obj.opcode == "ATOMG" || instruction_obj.opcode == "RED" || instruction_obj.opcode == "ATOM" || instruction_obj.opcode == "ATOMS" ? "U32" : "S32";
+}
+
+/// @brief Operation of a combining instruction, e.g. MIN for FMNMX R4, R4, R5, PT
+std::string get_combine_operation(const sass_instruction &instruction_obj)
+{
+    if (instruction_obj.opcode.find("MNMX") != std::string::npos)
+        return instruction_obj.operands.back() == "PT" ? "MIN" : instruction_obj.operands.back() == "!PT" ? "MAX" : "MIN/MAX";
+    if (instruction_obj.opcode == "LOP3")
+        return "AND/OR/XOR";
+    return "ADD";
+}
+
+/// @brief Combining instruction of a reduction step which ends with the store at the index: the stored value combines a value loaded from shared memory
+/// @return index of the combining instruction, -1 if the store is no reduction step
+int find_reduction_step(const sass_kernel &kernel, int store_index)
+{
+    const sass_instruction &store_obj = kernel.instructions[store_index];
+    if (store_obj.opcode != "STS" || store_obj.operands.size() < 2)
+    {
+        return -1;
+    }
+    int combine = find_register_definition(kernel, store_index, get_sass_register_name(store_obj.operands.back()));
+    if (combine < 0 || !is_reduction_combine(kernel.instructions[combine]))
+    {
+        return -1;
+    }
+    for (const auto &source : get_source_operands(kernel.instructions[combine]))
+    {
+        std::string register_name = get_sass_register_name(source);
+        if (register_name.empty() || register_name[0] != 'R' || register_name == "RZ")
+        {
+            continue;
+        }
+        int load = find_register_definition(kernel, combine, register_name);
+        if (load >= 0 && kernel.instructions[load].opcode == "LDS")
+        {
+            return combine;
+        }
+    }
+    return -1;
+}
+
+/// @brief Whether the instruction is a barrier of the thread block
+bool is_block_barrier(const sass_instruction &instruction_obj)
+{
+    return instruction_obj.opcode == "BAR" && !has_modifier(instruction_obj, "ARV");
+}
+
+/// @brief Detects shared memory tree reductions and atomics which could be aggregated within a warp by parsing the SASS file
+/// @param filename Disassembled SASS file
+/// @return Tuple of the reductions of every kernel, the pcOffsets of all global atomics of every kernel (for the share of the aggregatable atomic traffic) and the SM version of the SASS
+std::tuple<std::unordered_map<std::string, std::vector<warp_reduction>>, std::unordered_map<std::string, std::vector<std::string>>, int> warp_reduction_analysis(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<warp_reduction>> reduction_map;
+    std::unordered_map<std::string, std::vector<std::string>> atomic_map;
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+    int sm_version = 0;
+
+    for (const auto &[k_kernel, v_kernel] : kernel_map)
+    {
+        sm_version = std::max(sm_version, v_kernel.sm_version);
+        std::vector<warp_reduction> &reduction_vec = reduction_map[k_kernel];
+        std::vector<std::string> &atomic_vec = atomic_map[k_kernel];
+        std::unordered_map<std::string, sass_value> cache;
+        const std::vector<sass_instruction> &instructions = v_kernel.instructions;
+        int instruction_count = instructions.size();
+
+        // Tree reductions: reduction steps in a loop with a block barrier, the remaining steps of the kernel in unrolled ladders
+        std::vector<std::pair<int, int>> steps; // (store, combine)
+        for (int i = 0; i < instruction_count; i++)
+        {
+            int combine = find_reduction_step(v_kernel, i);
+            if (combine >= 0)
+            {
+                steps.push_back({i, combine});
+            }
+        }
+        std::vector<bool> in_tree_loop(instruction_count, false);
+        for (const auto &loop : v_kernel.loops)
+        {
+            int loop_steps = 0, loop_barriers = 0;
+            int first_combine = -1;
+            for (const auto &[store, combine] : steps)
+            {
+                if (store >= loop.start_index && store <= loop.end_index && get_innermost_loop(v_kernel, store) == &loop)
+                {
+                    loop_steps++;
+                    first_combine = first_combine < 0 ? combine : first_combine;
+                }
+            }
+            bool halving = false;
+            for (int i = loop.start_index; i <= loop.end_index; i++)
+            {
+                loop_barriers += is_block_barrier(instructions[i]);
+                halving = halving || ((instructions[i].opcode == "SHF" || instructions[i].opcode == "USHF") && has_modifier(instructions[i], "R")) ||
+                          instructions[i].opcode == "SHR" || instructions[i].opcode == "USHR";
+            }
+            if (loop_steps == 0 || loop_barriers == 0)
+            {
+                continue;
+            }
+
+            warp_reduction reduction_obj = {};
+            reduction_obj.line_number = loop.line_number;
+            reduction_obj.pcOffset = instructions[loop.start_index].pcOffset;
+            reduction_obj.end_pcOffset = instructions[loop.end_index].pcOffset;
+            reduction_obj.sass_instruction = instructions[first_combine].sass_instruction;
+            reduction_obj.kind = "tree_loop";
+            reduction_obj.loop_depth = instructions[loop.start_index].loop_depth;
+            reduction_obj.operation = get_combine_operation(instructions[first_combine]);
+            reduction_obj.data_type = get_reduction_data_type(instructions[first_combine]);
+            reduction_obj.steps = loop_steps;
+            reduction_obj.barriers = loop_barriers;
+            reduction_obj.halving = halving;
+            for (int i = loop.start_index; i <= loop.end_index; i++)
+            {
+                reduction_obj.pc_offsets.push_back(instructions[i].pcOffset);
+                in_tree_loop[i] = true;
+            }
+            reduction_vec.push_back(reduction_obj);
+        }
+
+        // Unrolled ladders: at least two steps close to each other, with a block barrier before the second one
+        for (size_t s = 0; s < steps.size();)
+        {
+            size_t end = s;
+            while (end + 1 < steps.size() && !in_tree_loop[steps[end + 1].first] && steps[end + 1].first - steps[end].first <= tree_reduction_max_step_distance)
+            {
+                end++;
+            }
+            if (in_tree_loop[steps[s].first])
+            {
+                s++;
+                continue;
+            }
+
+            int start = steps[s].second;
+            int last = steps[end].first;
+            // The loads of the first step belong to the ladder
+            for (int j = start; j >= 0 && j > start - tree_reduction_max_step_distance && instructions[j].opcode != "STS" && !is_block_barrier(instructions[j]); j--)
+            {
+                start = instructions[j].opcode == "LDS" ? j : start;
+            }
+            warp_reduction reduction_obj = {};
+            for (size_t step = s + 1; step <= end; step++)
+            {
+                bool barrier = false;
+                for (int j = steps[step - 1].first + 1; j < steps[step].first; j++)
+                {
+                    barrier = barrier || is_block_barrier(instructions[j]);
+                }
+                reduction_obj.barriers += barrier;
+                reduction_obj.warp_synchronous_steps += !barrier;
+            }
+            if (end > s && reduction_obj.barriers > 0)
+            {
+                reduction_obj.line_number = instructions[start].line_number;
+                reduction_obj.pcOffset = instructions[start].pcOffset;
+                reduction_obj.end_pcOffset = instructions[last].pcOffset;
+                reduction_obj.sass_instruction = instructions[steps[s].second].sass_instruction;
+                reduction_obj.kind = "tree_unrolled";
+                reduction_obj.loop_depth = instructions[start].loop_depth;
+                reduction_obj.operation = get_combine_operation(instructions[steps[s].second]);
+                reduction_obj.data_type = get_reduction_data_type(instructions[steps[s].second]);
+                reduction_obj.steps = end - s + 1;
+                for (int j = start; j <= last; j++)
+                {
+                    reduction_obj.pc_offsets.push_back(instructions[j].pcOffset);
+                }
+                reduction_vec.push_back(reduction_obj);
+            }
+            s = end + 1;
+        }
+
+        // Atomics which all threads of a warp apply to the same address (warp-uniform address), or to addresses only known at runtime (e.g. histograms)
+        for (int i = 0; i < instruction_count; i++)
+        {
+            const sass_instruction &instruction_obj = instructions[i];
+            bool global = instruction_obj.opcode == "ATOMG" || instruction_obj.opcode == "RED" || instruction_obj.opcode == "ATOM";
+            if (!global && instruction_obj.opcode != "ATOMS")
+            {
+                continue;
+            }
+            if (global)
+            {
+                atomic_vec.push_back(instruction_obj.pcOffset);
+            }
+            std::string operation = get_atomic_operation(instruction_obj);
+            if (operation.empty())
+            {
+                continue;
+            }
+
+            // Already aggregated: a warp reduction or vote shortly before, e.g. the aggregation nvcc inserts for atomicAdd(counter, 1),
+            // or the value is the result of a block reduction in shared memory (if (threadIdx.x == 0) atomicAdd(sum, sdata[0]);)
+            const std::string &value_operand = instruction_obj.operands.back();
+            int value_definition = find_register_definition(v_kernel, i, get_sass_register_name(value_operand));
+            bool aggregated = value_definition >= 0 && instructions[value_definition].opcode == "LDS";
+            for (int j = i - 1; j >= 0 && j >= i - warp_aggregation_window && !aggregated; j--)
+            {
+                aggregated = is_warp_collective(instructions[j]);
+            }
+            if (aggregated)
+            {
+                continue;
+            }
+
+            sass_value address = get_address_value(v_kernel, i, cache);
+            long long stride = 0;
+            std::string kind;
+            if (!address.thread_dependent)
+            {
+                kind = "atomic_uniform";
+            }
+            else if (!get_lane_stride(address, stride))
+            {
+                kind = "atomic_data_dependent"; // lanes may collide on the same address
+            }
+            else if (stride == 0)
+            {
+                kind = "atomic_uniform"; // only depends on threadIdx.y or z, the same for all lanes of a warp
+            }
+            else
+            {
+                continue; // a different address for every lane, nothing to aggregate
+            }
+
+            warp_reduction reduction_obj = {};
+            reduction_obj.line_number = instruction_obj.line_number;
+            reduction_obj.pcOffset = instruction_obj.pcOffset;
+            reduction_obj.sass_instruction = instruction_obj.sass_instruction;
+            reduction_obj.kind = kind;
+            reduction_obj.loop_depth = instruction_obj.loop_depth;
+            reduction_obj.operation = operation;
+            reduction_obj.data_type = get_reduction_data_type(instruction_obj);
+            reduction_obj.global = global;
+            reduction_obj.constant_value = value_operand[0] != '[' && is_constant_sass_value(get_operand_value(v_kernel, i, value_operand, cache));
+            reduction_obj.pc_offsets.push_back(instruction_obj.pcOffset);
+            reduction_vec.push_back(reduction_obj);
+        }
+    }
+
+    return std::make_tuple(reduction_map, atomic_map, sm_version);
+}
+
+#endif
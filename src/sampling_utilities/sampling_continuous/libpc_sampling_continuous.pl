@@ -25,6 +25,11 @@ my $circularBufferCount;
 my $fileName;
 my $disableFileDump;
 
+my $kernelRegex;
+my $launchRange;
+my $stallReasons;
+my $flushEveryLaunch;
+
 # Command line arguments
 GetOptions( 'help'                             => \$help
           , 'app=s'                            => \$applicationName
@@ -37,6 +42,10 @@ GetOptions( 'help'                             => \$help
           , 'circular-buf-count=i'             => \$circularBufferCount
           , 'disable-file-dump'                => \$disableFileDump
           , 'file-name=s'                      => \$fileName
+          , 'kernel-regex=s'                   => \$kernelRegex
+          , 'launch-range=s'                   => \$launchRange
+          , 'stall-reasons=s'                  => \$stallReasons
+          , 'flush-every-launch'               => \$flushEveryLaunch
           , 'verbose'                          => \$verbose
           ) or printUsage();
 
@@ -101,6 +110,32 @@ GetOptions( 'help'                             => \$help
     if ($verbose) {
         $cmdLineOptions .= " --verbose ";
     }
+
+    if ($kernelRegex) {
+        if ($kernelRegex =~ /\s/)
+        {
+            print "ERROR : --kernel-regex must not contain white space.\n";
+            printUsage();
+        }
+        $cmdLineOptions .= " --kernel-regex ".$kernelRegex;
+    }
+
+    if ($launchRange) {
+        if (!($launchRange =~ /^\d+(:\d+)?(,\d+(:\d+)?)*$/))
+        {
+            print "ERROR : Wrong argument to --launch-range.\n";
+            printUsage();
+        }
+        $cmdLineOptions .= " --launch-range ".$launchRange;
+    }
+
+    if ($stallReasons) {
+        $cmdLineOptions .= " --stall-reasons ".$stallReasons;
+    }
+
+    if ($flushEveryLaunch) {
+        $cmdLineOptions .= " --flush-every-launch ";
+    }
 }
 
 init();
@@ -141,6 +176,18 @@ sub printUsage {
                                     DEFAULT : file dump is enabled\n";
     print STDERR "  --file-name                     : File name to store PC sampling data.
                                     DEFAULT : pcsampling.dat\n";
+    print STDERR "  --kernel-regex                  : Only sample launches of kernels whose (mangled) name matches the regex.
+                                    DEFAULT : all kernels\n";
+    print STDERR "  --launch-range                  : Only sample the given launch indices of each kernel, counted from 0.
+                                    Comma separated list of windows first:last, e.g. 0:9,100:109
+                                    DEFAULT : all launches\n";
+    print STDERR "  --stall-reasons                 : Comma separated list of stall reasons to sample, e.g. long_scoreboard,barrier
+                                    DEFAULT : all stall reasons\n";
+    print STDERR "  --flush-every-launch            : Synchronize the context and flush the collected records before every launch
+                                    in the continuous mode, so that every stored buffer covers the launches it is tagged with.
+                                    This serializes the kernels of the context.
+                                    The launches of every buffer are stored in <file name>.launches
+                                    DEFAULT : flush when a circular buffer can be filled\n";
     print STDERR "  --verbose                       : Verbose output\n";
 
     print STDERR "\nExample : ./libpc_sampling_continuous.pl --collection-mode 1 --sampling-period 7 --file-name pcsampling.dat --app \"a.out --args\" \n";
@@ -20,11 +20,20 @@
  *            Only for first context creation, allocate memory for circular buffers which will hold flushed data from cupti.
  *
  *        Launch callbacks:
+ *           If a kernel name regex or launch index windows are given then on API entry start PC sampling for
+ *           matching launches and stop it for the others using cuptiPCSamplingStart()/cuptiPCSamplingStop().
+ *           Before sampling is stopped, the context is synchronized, so that a selected kernel which is still running is sampled to its end.
  *           If serialized mode is enabled then every time if cupti has PC records then flush all records using
  *           cuptiPCSamplingGetData() and push buffer in queue with context info to store it in file.
  *           If continuous mode is enabled then if cupti has more records than size of single circular buffer
  *           then flush records in one circular buffer using cuptiPCSamplingGetData() and push it in queue with
- *           context info to store it in file.
+ *           context info to store it in file. With --flush-every-launch all records are flushed on API entry of every launch.
+ *           In continuous mode the flush happens on API entry, before the new launch is recorded, and every pushed buffer is
+ *           tagged with the launches (launch id, correlation id) issued since the previous flush and not with the new one.
+ *           Kernels run asynchronously after their API exit, so with --flush-every-launch the context is synchronized
+ *           (cuCtxSynchronize) before the flush: all records of the previous launches are collected by then, and the next buffers
+ *           only hold records of the new launch. This serializes the kernels of the context, like the serialized collection mode,
+ *           and adds the launch latency to every launch.
  *
  *        Module load:
  *           This callback covers case when module get unloaded and new module get loaded then cupti flush
@@ -47,6 +56,8 @@
  *        Worker thread read front of queue take buffer and from context info read context id to store data into
  *        the file <context_id>_<file name>. Also it read configuration info and stall reason info from context info
  *        and store it in file using CuptiUtilPutPcSampData() CUPTI PC sampling Util API.
+ *        The launch tags of the buffer are appended to <context_id>_<file name>.launches, one line per launch:
+ *        <buffer number>,<launch id>,<launch index of the kernel>,<correlation id>,<kernel name>
  *        Worker thread stores all buffers till the queue gets empty and then goes to sleep.
  *        It got joined to the main thread in AtExitHandler.
  */
@@ -64,6 +75,9 @@
 #include <queue>
 #include <thread>
 #include <mutex>
+#include <regex>
+#include <sstream>
+#include <fstream>
 
 #ifndef EXIT_WAIVED
 #define EXIT_WAIVED 2
@@ -100,6 +114,18 @@ using namespace CUPTI::PcSamplingUtil;
     }                                                                       \
 }
 
+#define DRIVER_API_CALL(apiFuncCall)                                            \
+do {                                                                            \
+    CUresult _status = apiFuncCall;                                             \
+    if (_status != CUDA_SUCCESS) {                                              \
+        const char* errstr;                                                     \
+        cuGetErrorString(_status, &errstr);                                     \
+        fprintf(stderr, "%s:%d: error: function %s failed with error %s.\n",    \
+                __FILE__, __LINE__, #apiFuncCall, errstr);                      \
+        exit(EXIT_FAILURE);                                                     \
+    }                                                                           \
+} while (0)
+
 #define MEMORY_ALLOCATION_CALL(var)                                             \
 do {                                                                            \
     if (var == NULL) {                                                          \
@@ -110,6 +136,8 @@ do {
 } while (0)
 
 #define THREAD_SLEEP_TIME 100 // in ms
+#define LAUNCH_TAG_FILE_SUFFIX ".launches"
+#define DEVICE_INFO_FILE_SUFFIX ".device"
 
 typedef struct contextInfo
 {
@@ -117,8 +145,25 @@ typedef struct contextInfo
     CUpti_PCSamplingData pcSamplingData;
     std::vector<CUpti_PCSamplingConfigurationInfo> pcSamplingConfigurationInfo;
     PcSamplingStallReasons pcSamplingStallReasons;
+    uint32_t *pSelectedStallReasonIndex;
+    bool samplingStarted;
 } ContextInfo;
 
+typedef struct launchInfo
+{
+    uint64_t launchId;          // launch number within the context
+    uint64_t kernelLaunchIndex; // launch number of this kernel
+    uint32_t correlationId;
+    std::string kernelName;
+} LaunchInfo;
+
+typedef struct pcSampDataQueueEntry
+{
+    CUpti_PCSamplingData *pcSamplingData;
+    ContextInfo *contextInfo;
+    std::vector<LaunchInfo> launches;
+} PcSampDataQueueEntry;
+
 // For multi-gpu we are preallocating buffers only for first context creation,
 // so preallocated buffer stall reason size will be equal to max stall reason for first context GPU
 size_t stallReasonsCount = 0;
@@ -144,7 +189,7 @@ std::vector<ContextInfo*> g_contextInfoToFreeInEndVector;
 // Variables related to thread which store data in file.
 std::string g_fileName = "pcsampling.dat";
 std::thread g_storeDataInFileThreadHandle;
-std::queue<std::pair<CUpti_PCSamplingData*, ContextInfo*>> g_pcSampDataQueue;
+std::queue<PcSampDataQueueEntry> g_pcSampDataQueue;
 bool g_waitAtJoin = false;
 std::mutex g_pcSampDataQueueMutex;
 bool g_createdWorkerThread = false;
@@ -165,6 +210,23 @@ size_t g_circularbufSize = 500;
 bool g_disableFileDump = false;
 bool g_verbose = false;
 
+// Variables related to selective sampling, set through script.
+std::string g_kernelRegexString;
+std::regex g_kernelRegex;
+std::vector<std::pair<uint64_t, uint64_t>> g_launchRanges; // inclusive launch index windows per kernel
+std::vector<std::string> g_stallReasonAllowList;
+bool g_selectiveSampling = false;
+std::map<std::string, uint64_t> g_kernelLaunchCount;
+std::mutex g_kernelLaunchCountMutex;
+
+// Variables related to tagging the flushed buffers with the launches they cover.
+bool g_flushEveryLaunch = false;
+std::map<ContextInfo*, uint64_t> g_launchIdCounter;
+std::map<ContextInfo*, std::vector<LaunchInfo>> g_pendingLaunches;       // launches issued since the last flush
+std::map<ContextInfo*, std::vector<LaunchInfo>> g_lastFlushedLaunches;
+std::mutex g_launchTagMutex;
+std::map<uint32_t, size_t> g_storedBufferCount; // per context id, only used by the worker thread
+
 bool g_running = false;
 
 static void ReadInputParams()
@@ -231,12 +293,167 @@ static void ReadInputParams()
         {
             g_verbose = true;
         }
+        else if(!strcmp(token, "--kernel-regex"))
+        {
+            token = strtok(NULL," ");
+            if (token == NULL)
+            {
+                std::cout << "ERROR : Pass a regex to --kernel-regex, the launches are not selected by kernel name." << std::endl;
+                break;
+            }
+            // An invalid pattern must not abort the profiled application, it is sampled without the kernel name selection
+            try
+            {
+                g_kernelRegex = std::regex(token);
+                g_kernelRegexString = token;
+                g_selectiveSampling = true;
+            }
+            catch (const std::regex_error& error)
+            {
+                std::cout << "ERROR : Invalid --kernel-regex " << token << " (" << error.what() << "), the launches are not selected by kernel name." << std::endl;
+            }
+        }
+        else if(!strcmp(token, "--launch-range"))
+        {
+            // Comma separated list of windows "first:last" (or a single index), e.g. 0:9,100:109
+            token = strtok(NULL," ");
+            if (token == NULL)
+            {
+                std::cout << "ERROR : Pass launch index windows to --launch-range, all launches are sampled." << std::endl;
+                break;
+            }
+            std::stringstream ranges(token);
+            std::string range;
+            while (std::getline(ranges, range, ','))
+            {
+                size_t separator = range.find(':');
+                uint64_t first = strtoull(range.substr(0, separator).c_str(), NULL, 10);
+                uint64_t last = (separator == std::string::npos) ? first : strtoull(range.substr(separator + 1).c_str(), NULL, 10);
+                g_launchRanges.push_back(std::make_pair(first, last));
+            }
+            g_selectiveSampling = true;
+        }
+        else if(!strcmp(token, "--flush-every-launch"))
+        {
+            g_flushEveryLaunch = true;
+        }
+        else if(!strcmp(token, "--stall-reasons"))
+        {
+            token = strtok(NULL," ");
+            if (token == NULL)
+            {
+                std::cout << "ERROR : Pass stall reasons to --stall-reasons, all stall reasons are sampled." << std::endl;
+                break;
+            }
+            std::stringstream reasons(token);
+            std::string reason;
+            while (std::getline(reasons, reason, ','))
+            {
+                g_stallReasonAllowList.push_back(reason);
+            }
+        }
         token = strtok(NULL," ");
     }
     g_circularBuffer.resize(g_circularbufCount);
     g_bufferEmptyTrackerArray.resize(g_circularbufCount, false);
 }
 
+// Check if the stall reason name reported by cupti (e.g. smsp__pcsamp_warps_issue_stalled_long_scoreboard_not_issued)
+// is covered by the allowlist entry (e.g. long_scoreboard)
+static bool IsStallReasonSelected(const char *stallReasonName)
+{
+    std::string name(stallReasonName);
+    for (auto& allowed: g_stallReasonAllowList)
+    {
+        if (name == allowed || name == "smsp__pcsamp_warps_issue_stalled_" + allowed ||
+            name == "smsp__pcsamp_warps_issue_stalled_" + allowed + "_not_issued")
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Count one launch of the given kernel and return its launch index. Must be called exactly once per launch.
+static uint64_t CountKernelLaunch(const std::string& kernelName)
+{
+    g_kernelLaunchCountMutex.lock();
+    uint64_t launchIndex = g_kernelLaunchCount[kernelName]++;
+    g_kernelLaunchCountMutex.unlock();
+    return launchIndex;
+}
+
+// Decide whether the given launch of the kernel should be sampled.
+static bool IsLaunchSelected(const std::string& kernelName, uint64_t launchIndex)
+{
+    if (!g_kernelRegexString.empty() && !std::regex_search(kernelName, g_kernelRegex))
+    {
+        return false;
+    }
+
+    if (g_launchRanges.empty())
+    {
+        return true;
+    }
+    for (auto& range: g_launchRanges)
+    {
+        if (launchIndex >= range.first && launchIndex <= range.second)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void StartPcSampling(CUcontext cuCtx, ContextInfo *contextInfo)
+{
+    CUpti_PCSamplingStartParams pcSamplingStartParams = {};
+    pcSamplingStartParams.size = CUpti_PCSamplingStartParamsSize;
+    pcSamplingStartParams.ctx = cuCtx;
+    CUPTI_CALL(cuptiPCSamplingStart(&pcSamplingStartParams));
+    contextInfo->samplingStarted = true;
+}
+
+static void StopPcSampling(CUcontext cuCtx, ContextInfo *contextInfo)
+{
+    CUpti_PCSamplingStopParams pcSamplingStopParams = {};
+    pcSamplingStopParams.size = CUpti_PCSamplingStopParamsSize;
+    pcSamplingStopParams.ctx = cuCtx;
+    CUPTI_CALL(cuptiPCSamplingStop(&pcSamplingStopParams));
+    contextInfo->samplingStarted = false;
+}
+
+static void RecordLaunch(ContextInfo *contextInfo, uint64_t kernelLaunchIndex, uint32_t correlationId, const std::string& kernelName)
+{
+    g_launchTagMutex.lock();
+    LaunchInfo launch = {g_launchIdCounter[contextInfo]++, kernelLaunchIndex, correlationId, kernelName};
+    g_pendingLaunches[contextInfo].push_back(launch);
+    g_launchTagMutex.unlock();
+}
+
+// Push the buffer in the queue, tagged with the launches issued since the previous flush.
+// Buffers flushed without new launches in between belong to the same launches as the previous buffer.
+static void PushPcSampDataToQueue(CUpti_PCSamplingData *pcSamplingData, ContextInfo *contextInfo)
+{
+    PcSampDataQueueEntry entry;
+    entry.pcSamplingData = pcSamplingData;
+    entry.contextInfo = contextInfo;
+
+    g_launchTagMutex.lock();
+    std::vector<LaunchInfo> &pendingLaunches = g_pendingLaunches[contextInfo];
+    if (!pendingLaunches.empty())
+    {
+        g_lastFlushedLaunches[contextInfo] = pendingLaunches;
+        pendingLaunches.clear();
+    }
+    entry.launches = g_lastFlushedLaunches[contextInfo];
+    g_launchTagMutex.unlock();
+
+    g_pcSampDataQueueMutex.lock();
+    g_pcSampDataQueue.push(entry);
+    g_pcSampDataQueueMutex.unlock();
+}
+
 static void GetPcSamplingDataFromCupti(CUpti_PCSamplingGetDataParams &pcSamplingGetDataParams, ContextInfo *contextInfo)
 {
     CUpti_PCSamplingData *pPcSamplingData = NULL;
@@ -261,9 +478,37 @@ static void GetPcSamplingDataFromCupti(CUpti_PCSamplingGetDataParams &pcSampling
 
     if (!g_disableFileDump)
     {
-        g_pcSampDataQueueMutex.lock();
-        g_pcSampDataQueue.push(std::make_pair(pPcSamplingData, contextInfo));
-        g_pcSampDataQueueMutex.unlock();
+        PushPcSampDataToQueue(pPcSamplingData, contextInfo);
+    }
+}
+
+// Records on which device the context lives, so that every <context id>_<file> can be correlated with the SASS
+// of its own architecture and the results of several GPUs can be told apart.
+static void StoreDeviceInfoInFile(CUcontext cuCtx, uint32_t contextUid)
+{
+    uint32_t deviceId = 0;
+    CUPTI_CALL(cuptiGetDeviceId(cuCtx, &deviceId));
+
+    CUdevice device;
+    char deviceName[256] = {0};
+    int major = 0, minor = 0;
+    DRIVER_API_CALL(cuDeviceGet(&device, (int)deviceId));
+    DRIVER_API_CALL(cuDeviceGetName(deviceName, sizeof(deviceName) - 1, device));
+    DRIVER_API_CALL(cuDeviceGetAttribute(&major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, device));
+    DRIVER_API_CALL(cuDeviceGetAttribute(&minor, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR, device));
+
+    std::string file = std::to_string((long int)contextUid) + "_" + g_fileName + DEVICE_INFO_FILE_SUFFIX;
+    std::ofstream deviceFile(file, std::ios::trunc);
+    // One "key: value" field per line, the device name may contain commas
+    deviceFile << "contextUid: " << contextUid << "\n"
+               << "deviceId: " << deviceId << "\n"
+               << "deviceName: " << deviceName << "\n"
+               << "computeCapability: " << major << minor << "\n";
+
+    if (g_verbose)
+    {
+        std::cout << "Injection - Context " << contextUid << " runs on device " << deviceId << " (" << deviceName
+                  << ", sm_" << major << minor << ")" << std::endl;
     }
 }
 
@@ -272,10 +517,12 @@ static void StorePcSampDataInFile()
     CUptiUtilResult utilResult;
     ContextInfo *contextInfo;
     CUpti_PCSamplingData *pcSamplingData;
+    std::vector<LaunchInfo> launches;
 
     g_pcSampDataQueueMutex.lock();
-    pcSamplingData = g_pcSampDataQueue.front().first;
-    contextInfo = g_pcSampDataQueue.front().second;
+    pcSamplingData = g_pcSampDataQueue.front().pcSamplingData;
+    contextInfo = g_pcSampDataQueue.front().contextInfo;
+    launches.swap(g_pcSampDataQueue.front().launches);
     g_pcSampDataQueue.pop();
     g_pcSampDataQueueMutex.unlock();
 
@@ -296,6 +543,14 @@ static void StorePcSampDataInFile()
         std::cout << "error in StorePcSampDataInFile(), failed with error : " << utilResult << std::endl;
         exit (EXIT_FAILURE);
     }
+
+    size_t bufferNumber = g_storedBufferCount[contextInfo->contextUid]++;
+    std::ofstream launchFile(file + LAUNCH_TAG_FILE_SUFFIX, bufferNumber ? std::ios::app : std::ios::trunc);
+    for (auto& launch: launches)
+    {
+        launchFile << bufferNumber << "," << launch.launchId << "," << launch.kernelLaunchIndex << ","
+                   << launch.correlationId << "," << launch.kernelName << "\n";
+    }
     for (size_t i = 0; i < pcSamplingData->totalNumPcs; i++)
     {
         functions.insert(pcSamplingData->pPcData[i].functionName);
@@ -370,6 +625,7 @@ static void FreePreallocatedMemory()
         }
         free(itr.second->pcSamplingStallReasons.stallReasons);
         free(itr.second->pcSamplingStallReasons.stallReasonIndex);
+        free(itr.second->pSelectedStallReasonIndex);
 
         free(itr.second);
     }
@@ -389,6 +645,7 @@ static void FreePreallocatedMemory()
         }
         free(itr->pcSamplingStallReasons.stallReasons);
         free(itr->pcSamplingStallReasons.stallReasonIndex);
+        free(itr->pSelectedStallReasonIndex);
 
         free(itr);
     }
@@ -424,16 +681,8 @@ void ConfigureActivity(CUcontext cuCtx)
     numStallReasonsParams.ctx = cuCtx;
     numStallReasonsParams.numStallReasons = &numStallReasons;
 
-    g_stallReasonsCountMutex.lock();
     CUPTI_CALL(cuptiPCSamplingGetNumStallReasons(&numStallReasonsParams));
 
-    if (!g_collectedStallReasonsCount)
-    {
-        stallReasonsCount = numStallReasons;
-        g_collectedStallReasonsCount = true;
-    }
-    g_stallReasonsCountMutex.unlock();
-
     char **pStallReasons = (char **)malloc(numStallReasons * sizeof(char*));
     MEMORY_ALLOCATION_CALL(pStallReasons);
     for (size_t i = 0; i < numStallReasons; i++)
@@ -452,6 +701,41 @@ void ConfigureActivity(CUcontext cuCtx)
     stallReasonsParams.stallReasons = pStallReasons;
     CUPTI_CALL(cuptiPCSamplingGetStallReasons(&stallReasonsParams));
 
+    // Restrict the sampled stall reasons to the allowlist; the names of all stall reasons are still stored in the file
+    // as the records refer to them by index.
+    size_t numSelectedStallReasons = numStallReasons;
+    uint32_t *pSelectedStallReasonIndex = pStallReasonIndex;
+    if (!g_stallReasonAllowList.empty())
+    {
+        contextStateMapItr->second->pSelectedStallReasonIndex = (uint32_t *)malloc(numStallReasons * sizeof(uint32_t));
+        MEMORY_ALLOCATION_CALL(contextStateMapItr->second->pSelectedStallReasonIndex);
+        numSelectedStallReasons = 0;
+        for (size_t i = 0; i < numStallReasons; i++)
+        {
+            if (IsStallReasonSelected(pStallReasons[i]))
+            {
+                contextStateMapItr->second->pSelectedStallReasonIndex[numSelectedStallReasons++] = pStallReasonIndex[i];
+            }
+        }
+        if (numSelectedStallReasons == 0)
+        {
+            std::cout << "WARNING : None of the stall reasons given with --stall-reasons is supported, sampling all stall reasons." << std::endl;
+            numSelectedStallReasons = numStallReasons;
+        }
+        else
+        {
+            pSelectedStallReasonIndex = contextStateMapItr->second->pSelectedStallReasonIndex;
+        }
+    }
+
+    g_stallReasonsCountMutex.lock();
+    if (!g_collectedStallReasonsCount)
+    {
+        stallReasonsCount = numSelectedStallReasons;
+        g_collectedStallReasonsCount = true;
+    }
+    g_stallReasonsCountMutex.unlock();
+
     // User buffer to hold collected PC Sampling data in PC-To-Counter format
     size_t pcSamplingDataSize = sizeof(CUpti_PCSamplingData);
     contextStateMapItr->second->pcSamplingData.size = pcSamplingDataSize;
@@ -460,15 +744,15 @@ void ConfigureActivity(CUcontext cuCtx)
     MEMORY_ALLOCATION_CALL(contextStateMapItr->second->pcSamplingData.pPcData);
     for (uint32_t i = 0; i < g_pcConfigBufRecordCount; i++)
     {
-        contextStateMapItr->second->pcSamplingData.pPcData[i].stallReason = (CUpti_PCSamplingStallReason *)malloc(numStallReasons * sizeof(CUpti_PCSamplingStallReason));
+        contextStateMapItr->second->pcSamplingData.pPcData[i].stallReason = (CUpti_PCSamplingStallReason *)malloc(numSelectedStallReasons * sizeof(CUpti_PCSamplingStallReason));
         MEMORY_ALLOCATION_CALL(contextStateMapItr->second->pcSamplingData.pPcData[i].stallReason);
     }
 
     std::vector<CUpti_PCSamplingConfigurationInfo> pcSamplingConfigurationInfo;
 
     stallReason.attributeType = CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_STALL_REASON;
-    stallReason.attributeData.stallReasonData.stallReasonCount = numStallReasons;
-    stallReason.attributeData.stallReasonData.pStallReasonIndex = pStallReasonIndex;
+    stallReason.attributeData.stallReasonData.stallReasonCount = numSelectedStallReasons;
+    stallReason.attributeData.stallReasonData.pStallReasonIndex = pSelectedStallReasonIndex;
 
     CUpti_PCSamplingConfigurationInfo samplingDataBuffer = {};
     samplingDataBuffer.attributeType = CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_SAMPLING_DATA_BUFFER;
@@ -499,6 +783,14 @@ void ConfigureActivity(CUcontext cuCtx)
     collectionMode.attributeData.collectionModeData.collectionMode = g_pcSamplingCollectionMode;
     pcSamplingConfigurationInfo.push_back(collectionMode);
 
+    // With selective sampling the launch callbacks start and stop sampling around the matching launches
+    enableStartStop.attributeType = CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_ENABLE_START_STOP_CONTROL;
+    if (g_selectiveSampling)
+    {
+        enableStartStop.attributeData.enableStartStopControlData.enableStartStopControl = 1;
+        pcSamplingConfigurationInfo.push_back(enableStartStop);
+    }
+
     pcSamplingConfigurationInfo.push_back(stallReason);
     pcSamplingConfigurationInfo.push_back(samplingDataBuffer);
 
@@ -559,7 +851,7 @@ void ConfigureActivity(CUcontext cuCtx)
     {
         std::cout << std::endl;
         std::cout << "============ Configuration Details : ============" << std::endl;
-        std::cout << "requested stall reason count : " << numStallReasons << std::endl;
+        std::cout << "requested stall reason count : " << numSelectedStallReasons << " of " << numStallReasons << std::endl;
         std::cout << "collection mode              : " << getPcSamplingConfigurationInfoParams.pPCSamplingConfigurationInfo[0].attributeData.collectionModeData.collectionMode << std::endl;
         std::cout << "sampling period              : " << getPcSamplingConfigurationInfoParams.pPCSamplingConfigurationInfo[1].attributeData.samplingPeriodData.samplingPeriod << std::endl;
         std::cout << "scratch buffer size (Bytes)  : " << getPcSamplingConfigurationInfoParams.pPCSamplingConfigurationInfo[2].attributeData.scratchBufferSizeData.scratchBufferSize << std::endl;
@@ -569,6 +861,16 @@ void ConfigureActivity(CUcontext cuCtx)
         std::cout << "circular buffer count        : " << g_circularbufCount << std::endl;
         std::cout << "circular buffer record count : " << g_circularbufSize << std::endl;
         std::cout << "File name                    : <context id>_" << g_fileName << std::endl;
+        if (g_selectiveSampling)
+        {
+            std::cout << "kernel name regex            : " << (g_kernelRegexString.empty() ? "<all>" : g_kernelRegexString) << std::endl;
+            std::cout << "launch index windows         : ";
+            for (auto& range: g_launchRanges)
+            {
+                std::cout << range.first << ":" << range.second << " ";
+            }
+            std::cout << (g_launchRanges.empty() ? "<all>" : "") << std::endl;
+        }
         std::cout << "=================================================" << std::endl;
         std::cout << std::endl;
     }
@@ -611,11 +913,9 @@ void AtExitHandler()
                               << "in the PC sampling buffer provided during the PC sampling configuration. Bigger buffer can mitigate this issue." << std::endl;
                 }
 
-                g_pcSampDataQueueMutex.lock();
                 // It is quite possible that after pc sampling disabled cupti fill remaining records
                 // collected lately from hardware in provided buffer during configuration.
-                g_pcSampDataQueue.push(std::make_pair(&itr.second->pcSamplingData, itr.second));
-                g_pcSampDataQueueMutex.unlock();
+                PushPcSampDataToQueue(&itr.second->pcSamplingData, itr.second);
             }
         }
 
@@ -732,6 +1032,65 @@ void CallbackHandler(void* userdata, CUpti_CallbackDomain domain, CUpti_Callback
                 case CUPTI_DRIVER_TRACE_CBID_cuLaunchCooperativeKernel_ptsz:
                 case CUPTI_DRIVER_TRACE_CBID_cuLaunchCooperativeKernelMultiDevice:
                 {
+                    if (cbInfo->callbackSite == CUPTI_API_ENTER)
+                    {
+                        std::map<CUcontext, ContextInfo*>::iterator contextStateMapItr = g_contextInfoMap.find(cbInfo->context);
+                        if (contextStateMapItr == g_contextInfoMap.end())
+                        {
+                            std::cout << "Error : Context not found in map" << std::endl;
+                            exit(EXIT_FAILURE);
+                        }
+                        if (!contextStateMapItr->second->contextUid)
+                        {
+                            contextStateMapItr->second->contextUid = cbInfo->contextUid;
+                        }
+                        // In continuous mode the previous kernels may have run until now, so their records are flushed before this launch is recorded.
+                        if (g_pcSamplingCollectionMode == CUPTI_PC_SAMPLING_COLLECTION_MODE_CONTINUOUS)
+                        {
+                            CUpti_PCSamplingGetDataParams pcSamplingGetDataParams = {};
+                            pcSamplingGetDataParams.size = CUpti_PCSamplingGetDataParamsSize;
+                            pcSamplingGetDataParams.ctx = cbInfo->context;
+
+                            if (g_flushEveryLaunch)
+                            {
+                                // wait for the previous kernels, still running asynchronously, and flush all their records,
+                                // so that every buffer only covers the launches it is tagged with.
+                                DRIVER_API_CALL(cuCtxSynchronize());
+                                while (contextStateMapItr->second->pcSamplingData.remainingNumPcs > 0)
+                                {
+                                    GetPcSamplingDataFromCupti(pcSamplingGetDataParams, contextStateMapItr->second);
+                                }
+                            }
+                            else if (contextStateMapItr->second->pcSamplingData.remainingNumPcs >= g_circularbufSize)
+                            {
+                                GetPcSamplingDataFromCupti(pcSamplingGetDataParams, contextStateMapItr->second);
+                            }
+                        }
+                        std::string kernelName = cbInfo->symbolName ? cbInfo->symbolName : "";
+                        uint64_t kernelLaunchIndex = CountKernelLaunch(kernelName);
+                        if (g_selectiveSampling)
+                        {
+                            // In continuous mode a previous matching kernel may still be running, so sampling is only stopped
+                            // once a launch which is not selected comes in, and after the running kernels have finished.
+                            bool selected = IsLaunchSelected(kernelName, kernelLaunchIndex);
+                            if (selected && !contextStateMapItr->second->samplingStarted)
+                            {
+                                StartPcSampling(cbInfo->context, contextStateMapItr->second);
+                            }
+                            else if (!selected && contextStateMapItr->second->samplingStarted)
+                            {
+                                if (g_pcSamplingCollectionMode == CUPTI_PC_SAMPLING_COLLECTION_MODE_CONTINUOUS)
+                                {
+                                    DRIVER_API_CALL(cuCtxSynchronize());
+                                }
+                                StopPcSampling(cbInfo->context, contextStateMapItr->second);
+                            }
+                        }
+                        if (!g_selectiveSampling || contextStateMapItr->second->samplingStarted)
+                        {
+                            RecordLaunch(contextStateMapItr->second, kernelLaunchIndex, cbInfo->correlationId, kernelName);
+                        }
+                    }
                     if (cbInfo->callbackSite == CUPTI_API_EXIT)
                     {
                         std::map<CUcontext, ContextInfo*>::iterator contextStateMapItr = g_contextInfoMap.find(cbInfo->context);
@@ -749,6 +1108,12 @@ void CallbackHandler(void* userdata, CUpti_CallbackDomain domain, CUpti_Callback
                         // For _KERNEL_SERIALIZED mode each kernel data is one range.
                         if (g_pcSamplingCollectionMode == CUPTI_PC_SAMPLING_COLLECTION_MODE_KERNEL_SERIALIZED)
                         {
+                            // the kernel has finished, so the range of a selected launch can be closed right away.
+                            if (contextStateMapItr->second->samplingStarted)
+                            {
+                                StopPcSampling(cbInfo->context, contextStateMapItr->second);
+                            }
+
                             // collect all available records.
                             CUpti_PCSamplingGetDataParams pcSamplingGetDataParams = {};
                             pcSamplingGetDataParams.size = CUpti_PCSamplingGetDataParamsSize;
@@ -765,14 +1130,6 @@ void CallbackHandler(void* userdata, CUpti_CallbackDomain domain, CUpti_Callback
                                 GetPcSamplingDataFromCupti(pcSamplingGetDataParams, contextStateMapItr->second);
                             }
                         }
-                        else if(contextStateMapItr->second->pcSamplingData.remainingNumPcs >= g_circularbufSize)
-                        {
-                            CUpti_PCSamplingGetDataParams pcSamplingGetDataParams = {};
-                            pcSamplingGetDataParams.size = CUpti_PCSamplingGetDataParamsSize;
-                            pcSamplingGetDataParams.ctx = cbInfo->context;
-
-                            GetPcSamplingDataFromCupti(pcSamplingGetDataParams, contextStateMapItr->second);
-                        }
                     }
                 }
                 break;
@@ -797,6 +1154,8 @@ void CallbackHandler(void* userdata, CUpti_CallbackDomain domain, CUpti_Callback
                         // insert new entry for context.
                         ContextInfo *contextInfo = (ContextInfo *)calloc(1, sizeof(ContextInfo));
                         MEMORY_ALLOCATION_CALL(contextInfo);
+                        CUPTI_CALL(cuptiGetContextId(resourceData->context, &contextInfo->contextUid));
+                        StoreDeviceInfoInFile(resourceData->context, contextInfo->contextUid);
                         g_contextInfoMutex.lock();
                         g_contextInfoMap.insert(std::make_pair(resourceData->context, contextInfo));
                         g_contextInfoMutex.unlock();
@@ -851,9 +1210,7 @@ void CallbackHandler(void* userdata, CUpti_CallbackDomain domain, CUpti_Callback
                     // collected lately from hardware in provided buffer during configuration.
                     if (!g_disableFileDump && itr->second->pcSamplingData.totalNumPcs > 0)
                     {
-                        g_pcSampDataQueueMutex.lock();
-                        g_pcSampDataQueue.push(std::make_pair(&itr->second->pcSamplingData, itr->second));
-                        g_pcSampDataQueueMutex.unlock();
+                        PushPcSampDataToQueue(&itr->second->pcSamplingData, itr->second);
                     }
 
                     g_contextInfoMutex.lock();
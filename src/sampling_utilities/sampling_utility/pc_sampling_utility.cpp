@@ -11,7 +11,12 @@ int main(int argc, char *argv[])
     FillCrcModuleMap();
     RetrievePcSampData();
 
-    if (!disableSourceCorrelation)
+    if (!launchFileName.empty())
+    {
+        ReadLaunchTags();
+        LaunchBucketSourceCorrelation();
+    }
+    else if (!disableSourceCorrelation)
     {
         if (!disableMerge && collectionMode != CUPTI_PC_SAMPLING_COLLECTION_MODE_KERNEL_SERIALIZED)
         {
@@ -8,6 +8,10 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <atomic>
 #include <string.h>
 #include <stdlib.h>
 
@@ -70,11 +74,23 @@ typedef struct moduleDetails {
     void* cubinImage;
 } ModuleDetails;
 
+typedef struct launchTag {
+    uint64_t launchId;
+    uint64_t kernelLaunchIndex;
+    uint32_t correlationId;
+    std::string kernelName;
+} LaunchTag;
+
 std::string fileName;
 PcSamplingStallReasons pcSamplingStallReasonsRetrieve;
 std::vector<CUpti_PCSamplingData> buffersRetrievedDataVector;
 std::map<uint64_t, ModuleDetails> crcModuleMap;
 CUpti_PCSamplingCollectionMode collectionMode;
+std::string launchFileName;
+size_t launchBucketSize;
+std::string launchContextId;
+size_t correlationThreads;
+std::map<size_t, std::vector<LaunchTag>> bufferLaunchTags;
 
 bool disableMerge;
 bool disablePcInfoPrints ;
@@ -86,6 +102,10 @@ static void Init()
     fileName = "";
     pcSamplingStallReasonsRetrieve = {};
     collectionMode = CUPTI_PC_SAMPLING_COLLECTION_MODE_CONTINUOUS;
+    launchFileName = "";
+    launchBucketSize = 1;
+    launchContextId = "";
+    correlationThreads = 1;
 
     disableMerge = false;
     disablePcInfoPrints = false;
@@ -101,6 +121,11 @@ static void PrintUsage()
     printf("       --disable-merge                   : Disable merge of buffers\n");
     printf("       --disable-pc-info-prints          : Disable PC records info prints\n");
     printf("       --disable-source-correlation      : Disable Source correlation\n");
+    printf("       --launch-file                     : Launch tags of the buffers (<file name>.launches), prints one merged profile per launch bucket\n");
+    printf("       --launch-bucket-size              : Number of consecutive launches merged into one launch bucket (default 1)\n");
+    printf("       --context-id                      : Context of the PC sampling file, printed with every launch bucket (launch ids are counted per context)\n");
+    printf("       --correlation-threads             : Number of threads resolving the source correlation (default 1). CUPTI does not document\n");
+    printf("                                           cuptiGetSassToSourceCorrelation() as thread safe, more threads rely on it being so\n");
     printf("       --verbose                         : Enable verbose prints\n");
 
     exit(EXIT_SUCCESS);
@@ -142,6 +167,46 @@ static void ParseCommandLineArgs(int argc, char *argv[])
         {
             disableSourceCorrelation = true;
         }
+        else if ((stricmp(argv[i], "--launch-file") == 0) || (stricmp(argv[i], "-launch-file") == 0))
+        {
+            if (argc < i+2)
+            {
+                std::cout << "ERROR : Pass launch file." << std::endl;
+                PrintUsage();
+            }
+            launchFileName = argv[i+1];
+            i++;
+        }
+        else if ((stricmp(argv[i], "--launch-bucket-size") == 0) || (stricmp(argv[i], "-launch-bucket-size") == 0))
+        {
+            if (argc < i+2 || atoi(argv[i+1]) < 1)
+            {
+                std::cout << "ERROR : Pass a launch bucket size of at least 1." << std::endl;
+                PrintUsage();
+            }
+            launchBucketSize = (size_t)atoi(argv[i+1]);
+            i++;
+        }
+        else if ((stricmp(argv[i], "--context-id") == 0) || (stricmp(argv[i], "-context-id") == 0))
+        {
+            if (argc < i+2)
+            {
+                std::cout << "ERROR : Pass context id." << std::endl;
+                PrintUsage();
+            }
+            launchContextId = argv[i+1];
+            i++;
+        }
+        else if ((stricmp(argv[i], "--correlation-threads") == 0) || (stricmp(argv[i], "-correlation-threads") == 0))
+        {
+            if (argc < i+2 || atoi(argv[i+1]) < 1)
+            {
+                std::cout << "ERROR : Pass a thread count of at least 1." << std::endl;
+                PrintUsage();
+            }
+            correlationThreads = (size_t)atoi(argv[i+1]);
+            i++;
+        }
         else if ((stricmp(argv[i], "--verbose") == 0) ||(stricmp(argv[i], "-verbose") == 0))
         {
             verbose = true;
@@ -473,113 +538,197 @@ static void MergePcSampDataBuffers(CUpti_PCSamplingData **mergedPcSampDataBuffer
     }
 }
 
+typedef struct correlationResult {
+    bool success;
+    uint32_t lineNumber;
+    std::string fileName;
+    std::string dirName;
+} CorrelationResult;
+
+// Source correlation only depends on the cubin, the function and the pc offset, which recur across buffers and launch buckets
+typedef std::pair<std::string, uint64_t> CorrelationKey;
+
+// One cache of resolved (functionName, pcOffset) per cubin (by cubin crc), kept for the whole run
+std::map<uint64_t, std::map<CorrelationKey, CorrelationResult>> cubinCorrelationCache;
+
+typedef struct unresolvedCorrelation {
+    ModuleDetails *module;
+    const CorrelationKey *key;
+    CorrelationResult *result;
+} UnresolvedCorrelation;
+
+/**
+ * Function Info :
+ * Collect the (functionName, pcOffset) pairs of all PC records which belong to a known cubin and are not in its cache yet.
+ * Resolve them using cuptiGetSassToSourceCorrelation() CUPTI API on correlationThreads threads.
+ * Every thread only writes the result of its own cache entry, the entries are created before the threads start.
+ */
+static void ResolveSourceCorrelation(CUpti_PCSamplingData *pPcSampDataBuffer, size_t numPcSampDataBuffer)
+{
+    std::vector<UnresolvedCorrelation> unresolved;
+    for (size_t pcSampBufferIndex = 0; pcSampBufferIndex < numPcSampDataBuffer; pcSampBufferIndex++)
+    {
+        for (size_t i = 0; i < pPcSampDataBuffer[pcSampBufferIndex].totalNumPcs; i++)
+        {
+            CUpti_PCSamplingPCData &pcData = pPcSampDataBuffer[pcSampBufferIndex].pPcData[i];
+            auto module = crcModuleMap.find(pcData.cubinCrc);
+            if (module == crcModuleMap.end())
+            {
+                continue;
+            }
+            auto entry = cubinCorrelationCache[pcData.cubinCrc].emplace(CorrelationKey(pcData.functionName, pcData.pcOffset), CorrelationResult());
+            if (entry.second)
+            {
+                unresolved.push_back({&module->second, &entry.first->first, &entry.first->second});
+            }
+        }
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&unresolved, &next]()
+    {
+        for (size_t index = next++; index < unresolved.size(); index = next++)
+        {
+            const CorrelationKey &key = *unresolved[index].key;
+            CorrelationResult &result = *unresolved[index].result;
+            ModuleDetails &module = *unresolved[index].module;
+
+            CUpti_GetSassToSourceCorrelationParams pCSamplingGetSassToSourceCorrelationParams = {0};
+            pCSamplingGetSassToSourceCorrelationParams.size = CUpti_GetSassToSourceCorrelationParamsSize;
+            pCSamplingGetSassToSourceCorrelationParams.functionName = key.first.c_str();
+            pCSamplingGetSassToSourceCorrelationParams.pcOffset = key.second;
+            pCSamplingGetSassToSourceCorrelationParams.cubin = module.cubinImage;
+            pCSamplingGetSassToSourceCorrelationParams.cubinSize = module.cubinSize;
+
+            result.success = cuptiGetSassToSourceCorrelation(&pCSamplingGetSassToSourceCorrelationParams) == CUPTI_SUCCESS;
+            if (result.success)
+            {
+                result.lineNumber = pCSamplingGetSassToSourceCorrelationParams.lineNumber;
+                result.fileName = pCSamplingGetSassToSourceCorrelationParams.fileName;
+                result.dirName = pCSamplingGetSassToSourceCorrelationParams.dirName;
+                free(pCSamplingGetSassToSourceCorrelationParams.fileName);
+                free(pCSamplingGetSassToSourceCorrelationParams.dirName);
+            }
+        }
+    };
+
+    size_t numThreads = std::max<size_t>(1, std::min(correlationThreads, unresolved.size()));
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; t++)
+    {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto& thread: threads)
+    {
+        thread.join();
+    }
+
+    if (verbose)
+    {
+        std::cout << "Resolved " << unresolved.size() << " new unique PCs on " << numThreads << " thread/s." << std::endl;
+    }
+}
+
+static void AppendStallReasons(std::string &output, CUpti_PCSamplingPCData &pcData)
+{
+    output += ", stallReasonCount: " + std::to_string(pcData.stallReasonCount);
+    for (size_t k=0; k < pcData.stallReasonCount; k++)
+    {
+        output += ", " + GetStallReason(pcData.stallReason[k].pcSamplingStallReasonIndex) + ": " + std::to_string(pcData.stallReason[k].samples);
+    }
+    output += '\n';
+}
+
 /**
  * Function Info :
+ * Resolve the source correlation of every unique PC once for the whole run (see ResolveSourceCorrelation()),
+ * also with --disable-pc-info-prints, so that the PCs without lineinfo are still counted.
  * Iterate over all PC samp data buffers
  *     Iterate over each PC record
  *         Find Cubin in which PC belongs using cubin crc.
- *         Do source correlation using cuptiGetSassToSourceCorrelation() CUPTI API.
+ *         Print the memoized source correlation into the output buffer, which is written once per PC samp data buffer.
  */
 static void SourceCorrelation(CUpti_PCSamplingData *pPcSampDataBuffer, size_t numPcSampDataBuffer)
 {
-    std::map<uint64_t, ModuleDetails>::iterator itr;
     size_t numPcNoCubin = 0;
     size_t numPcNoLineinfo = 0;
 
+    ResolveSourceCorrelation(pPcSampDataBuffer, numPcSampDataBuffer);
+
+    std::string output;
     for (size_t pcSampBufferIndex = 0; pcSampBufferIndex < numPcSampDataBuffer; pcSampBufferIndex++)
     {
-        std::cout << "========================== PC Records Buffer Info ==========================" << std::endl;
-        std::cout << "Buffer Number: " << pcSampBufferIndex + 1
-                  << ", Range Id: " << pPcSampDataBuffer[pcSampBufferIndex].rangeId
-                  << ", Count of PC records: " << pPcSampDataBuffer[pcSampBufferIndex].totalNumPcs
-                  << ", Total Samples: " << pPcSampDataBuffer[pcSampBufferIndex].totalSamples
-                  << ", Total Dropped Samples: " << pPcSampDataBuffer[pcSampBufferIndex].droppedSamples;
-        if (CHECK_PC_SAMPLING_STRUCT_FIELD_EXISTS(CUpti_PCSamplingData, nonUsrKernelsTotalSamples, buffersRetrievedDataVector[pcSampBufferIndex].size))
+        output.clear();
+        output += "========================== PC Records Buffer Info ==========================\n";
+        output += "Buffer Number: " + std::to_string(pcSampBufferIndex + 1)
+                + ", Range Id: " + std::to_string(pPcSampDataBuffer[pcSampBufferIndex].rangeId)
+                + ", Count of PC records: " + std::to_string(pPcSampDataBuffer[pcSampBufferIndex].totalNumPcs)
+                + ", Total Samples: " + std::to_string(pPcSampDataBuffer[pcSampBufferIndex].totalSamples)
+                + ", Total Dropped Samples: " + std::to_string(pPcSampDataBuffer[pcSampBufferIndex].droppedSamples);
+        if (CHECK_PC_SAMPLING_STRUCT_FIELD_EXISTS(CUpti_PCSamplingData, nonUsrKernelsTotalSamples, pPcSampDataBuffer[pcSampBufferIndex].size))
         {
-            std::cout << ", Non User Kernels Total Samples: " << buffersRetrievedDataVector[pcSampBufferIndex].nonUsrKernelsTotalSamples;
+            output += ", Non User Kernels Total Samples: " + std::to_string(pPcSampDataBuffer[pcSampBufferIndex].nonUsrKernelsTotalSamples);
         }
-        std::cout << std::endl;
-
-
+        output += '\n';
 
         for(size_t i=0 ; i < pPcSampDataBuffer[pcSampBufferIndex].totalNumPcs; i++)
         {
-            // find matching cubinCrc entry in map
-            itr = crcModuleMap.find(pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].cubinCrc);
+            CUpti_PCSamplingPCData &pcData = pPcSampDataBuffer[pcSampBufferIndex].pPcData[i];
 
-            if (itr == crcModuleMap.end())
+            // find matching cubinCrc entry in map
+            if (crcModuleMap.find(pcData.cubinCrc) == crcModuleMap.end())
             {
                 numPcNoCubin++;
 
                 if (!disablePcInfoPrints)
                 {
-                    std::cout << "functionName: " << pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].functionName
-                              << ", functionIndex: " << pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].functionIndex
-                              << ", pcOffset: " << pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].pcOffset
-                              << ", lineNumber:0"
-                              << ", fileName: " << "ERROR_NO_CUBIN"
-                              << ", dirName: "
-                              << ", stallReasonCount: " << pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].stallReasonCount;
-
-                    for (size_t k=0; k < pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].stallReasonCount; k++)
-                    {
-                        std::cout << ", " << GetStallReason(pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].stallReason[k].pcSamplingStallReasonIndex)
-                                  << ": " << pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].stallReason[k].samples;
-                    }
-                    std::cout << std::endl;
+                    output += "functionName: " + std::string(pcData.functionName)
+                            + ", functionIndex: " + std::to_string(pcData.functionIndex)
+                            + ", pcOffset: " + std::to_string(pcData.pcOffset)
+                            + ", lineNumber:0"
+                            + ", fileName: " + "ERROR_NO_CUBIN"
+                            + ", dirName: ";
+                    AppendStallReasons(output, pcData);
                 }
 
                 continue;
             }
 
-            if (!disablePcInfoPrints)
+            const CorrelationResult &correlation = cubinCorrelationCache[pcData.cubinCrc][CorrelationKey(pcData.functionName, pcData.pcOffset)];
+            if (!correlation.success)
             {
-                std::cout << "functionName: " << pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].functionName
-                          << ", functionIndex: " << pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].functionIndex
-                          << ", pcOffset: " << pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].pcOffset;
+                // It is possible that extracted cubins does not have lineinfo.
+                // It is recommended to build application/libraries with nvcc option lineinfo.
+                numPcNoLineinfo++;
             }
 
-            CUpti_GetSassToSourceCorrelationParams pCSamplingGetSassToSourceCorrelationParams = {0};
-            pCSamplingGetSassToSourceCorrelationParams.size = CUpti_GetSassToSourceCorrelationParamsSize;
-            pCSamplingGetSassToSourceCorrelationParams.functionName = pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].functionName;
-            pCSamplingGetSassToSourceCorrelationParams.pcOffset = pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].pcOffset;
-            pCSamplingGetSassToSourceCorrelationParams.cubin = itr->second.cubinImage;
-            pCSamplingGetSassToSourceCorrelationParams.cubinSize = itr->second.cubinSize;
-
-            CUptiResult cuptiResult = cuptiGetSassToSourceCorrelation(&pCSamplingGetSassToSourceCorrelationParams);
-
             if (!disablePcInfoPrints)
             {
-                if (cuptiResult == CUPTI_SUCCESS)
-                {
-                    std::cout << ", lineNumber: " << pCSamplingGetSassToSourceCorrelationParams.lineNumber
-                              << ", fileName: " << pCSamplingGetSassToSourceCorrelationParams.fileName
-                              << ", dirName: " << pCSamplingGetSassToSourceCorrelationParams.dirName;
+                output += "functionName: " + std::string(pcData.functionName)
+                        + ", functionIndex: " + std::to_string(pcData.functionIndex)
+                        + ", pcOffset: " + std::to_string(pcData.pcOffset);
 
-                    free(pCSamplingGetSassToSourceCorrelationParams.fileName);
-                    free(pCSamplingGetSassToSourceCorrelationParams.dirName);
+                if (correlation.success)
+                {
+                    output += ", lineNumber: " + std::to_string(correlation.lineNumber)
+                            + ", fileName: " + correlation.fileName
+                            + ", dirName: " + correlation.dirName;
                 }
                 else
                 {
-                    // It is possible that extracted cubins does not have lineinfo.
-                    // It is recommended to build application/libraries with nvcc option lineinfo.
-                    numPcNoLineinfo++;
-                    std::cout << ", lineNumber: 0"
-                              << ", fileName: " << "ERROR_NO_LINEINFO"
-                              << ", dirName: ";
+                    output += ", lineNumber: 0";
+                    output += ", fileName: ERROR_NO_LINEINFO";
+                    output += ", dirName: ";
                 }
 
-                std::cout << ", stallReasonCount: " <<pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].stallReasonCount;
-
-                for (size_t k=0; k < pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].stallReasonCount; k++)
-                {
-                    std::cout << ", " << GetStallReason(pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].stallReason[k].pcSamplingStallReasonIndex)
-                              << ": " << pPcSampDataBuffer[pcSampBufferIndex].pPcData[i].stallReason[k].samples;
-                }
-                std::cout << std::endl;
+                AppendStallReasons(output, pcData);
             }
         }
+
+        std::cout.write(output.data(), output.size());
     }
+    std::cout.flush();
 
     if (numPcNoCubin)
     {
@@ -614,6 +763,109 @@ static void FreePcSampDataBuffers(CUpti_PCSamplingData *pcSampData, size_t numBu
     }
 }
 
+/**
+ * Function Info :
+ * Read the launch tags written next to the PC sampling file by the injection library.
+ * Each line: <buffer number>,<launch id>,<launch index of the kernel>,<correlation id>,<kernel name>
+ */
+static void ReadLaunchTags()
+{
+    std::ifstream launchFile(launchFileName);
+    if (!launchFile)
+    {
+        std::cerr << "Cannot open file : " << launchFileName << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::string line;
+    while (std::getline(launchFile, line))
+    {
+        std::stringstream lineStream(line);
+        std::string bufferNumber, launchId, kernelLaunchIndex, correlationId, kernelName;
+        if (!std::getline(lineStream, bufferNumber, ',') || !std::getline(lineStream, launchId, ',') ||
+            !std::getline(lineStream, kernelLaunchIndex, ',') || !std::getline(lineStream, correlationId, ','))
+        {
+            continue;
+        }
+        std::getline(lineStream, kernelName);
+
+        LaunchTag launchTag = {strtoull(launchId.c_str(), NULL, 10), strtoull(kernelLaunchIndex.c_str(), NULL, 10),
+                               (uint32_t)strtoul(correlationId.c_str(), NULL, 10), kernelName};
+        bufferLaunchTags[strtoull(bufferNumber.c_str(), NULL, 10)].push_back(launchTag);
+    }
+}
+
+/**
+ * Function Info :
+ * Group the retrieved buffers into buckets of launchBucketSize consecutive launches (by the first launch of the buffer).
+ * Launch ids are counted per context, hence a bucket is identified by the context and the launches.
+ * For each bucket, merge its buffers and print the header of the bucket followed by its source correlated PC records.
+ */
+static void LaunchBucketSourceCorrelation()
+{
+    std::map<std::pair<std::string, uint64_t>, std::vector<size_t>> bucketBuffers;
+    size_t numUntaggedBuffers = 0;
+    for (size_t pcSampBufferIndex = 0; pcSampBufferIndex < buffersRetrievedDataVector.size(); pcSampBufferIndex++)
+    {
+        auto tags = bufferLaunchTags.find(pcSampBufferIndex);
+        if (tags == bufferLaunchTags.end() || tags->second.empty())
+        {
+            numUntaggedBuffers++;
+            continue;
+        }
+        bucketBuffers[{launchContextId, tags->second.front().launchId / launchBucketSize}].push_back(pcSampBufferIndex);
+    }
+
+    for (auto& bucket: bucketBuffers)
+    {
+        uint64_t firstLaunchId = UINT64_MAX, lastLaunchId = 0;
+        uint32_t firstCorrelationId = UINT32_MAX, lastCorrelationId = 0;
+        std::vector<CUpti_PCSamplingData> bucketData;
+        for (size_t pcSampBufferIndex: bucket.second)
+        {
+            bucketData.push_back(buffersRetrievedDataVector[pcSampBufferIndex]);
+            for (auto& launchTag: bufferLaunchTags[pcSampBufferIndex])
+            {
+                firstLaunchId = std::min(firstLaunchId, launchTag.launchId);
+                lastLaunchId = std::max(lastLaunchId, launchTag.launchId);
+                firstCorrelationId = std::min(firstCorrelationId, launchTag.correlationId);
+                lastCorrelationId = std::max(lastCorrelationId, launchTag.correlationId);
+            }
+        }
+
+        CUpti_PCSamplingData *mergedPcSampDataBuffer = NULL;
+        size_t numMergedPcSampDataBuffer = 0;
+        CUptiUtil_MergePcSampDataParams mergePcSampDataParams = {};
+        mergePcSampDataParams.size = CUptiUtil_MergePcSampDataParamsSize;
+        mergePcSampDataParams.numberOfBuffers = bucketData.size();
+        mergePcSampDataParams.PcSampDataBuffer = bucketData.data();
+        mergePcSampDataParams.MergedPcSampDataBuffers = &mergedPcSampDataBuffer;
+        mergePcSampDataParams.numMergedBuffer = &numMergedPcSampDataBuffer;
+        CUPTI_UTIL_CALL(CuptiUtilMergePcSampData(&mergePcSampDataParams));
+
+        std::cout << "========================== Launch Bucket Info ==========================" << std::endl;
+        std::cout << "Launch Bucket: " << bucket.first.second
+                  << ", First Launch Id: " << firstLaunchId
+                  << ", Last Launch Id: " << lastLaunchId
+                  << ", First Correlation Id: " << firstCorrelationId
+                  << ", Last Correlation Id: " << lastCorrelationId
+                  << ", Buffers: " << bucketData.size();
+        if (!bucket.first.first.empty())
+        {
+            std::cout << ", Context Id: " << bucket.first.first;
+        }
+        std::cout << std::endl;
+
+        SourceCorrelation(mergedPcSampDataBuffer, numMergedPcSampDataBuffer);
+        FreePcSampDataBuffers(mergedPcSampDataBuffer, numMergedPcSampDataBuffer);
+    }
+
+    if (numUntaggedBuffers)
+    {
+        std::cerr << std::endl << "WARNING :: These many buffers are not tagged with any launch: " << numUntaggedBuffers << std::endl;
+    }
+}
+
 static void FreeCrcModuleMapMemory()
 {
     for (auto itr = crcModuleMap.begin(); itr != crcModuleMap.end(); itr++)
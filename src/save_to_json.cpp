@@ -1,6 +1,7 @@
 #include "parser_metrics.hpp"
 #include "parser_pcsampling.hpp"
 #include "utilities/json.hpp"
+#include "gpuscout_runtime.hpp"
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
@@ -84,7 +85,7 @@ int main(int argc, char **argv)
     }
 
     // Add metrics
-    std::unordered_map<std::string, kernel_metrics> metric_map = create_metrics(metrics_file);
+    std::unordered_map<std::string, kernel_metrics> metric_map = profile_stage("create_metrics", [&] { return create_metrics(metrics_file); });
     json json_metrics = {};
     for (auto [k_metric, v_metric] : metric_map) {
         json_metrics[v_metric.kernel_name] = total_memory_flow(v_metric, sm_count);
@@ -93,7 +94,7 @@ int main(int argc, char **argv)
     result["metrics"] = json_metrics;
 
     // Add stall information to result file
-    std::unordered_map<std::string, std::vector<pc_issue_samples>> stall_map = get_warp_stalls(pc_samples_file, sass_file, analysis_kind::ALL);
+    std::unordered_map<std::string, std::vector<pc_issue_samples>> stall_map = profile_stage("get_warp_stalls", [&] { return get_warp_stalls(pc_samples_file, sass_file, analysis_kind::ALL); });
     for (auto [k_pc, v_pc] : stall_map) 
     {
         result["stalls"][k_pc] = json::array();
@@ -177,6 +178,12 @@ int main(int argc, char **argv)
     }
     sass_registers.close();
 
+    // Runtime of the GPUscout stages up to here, the record of save_to_json itself is only complete after the file is written
+    const char *runtime_file = std::getenv("GPUSCOUT_RUNTIME_FILE");
+    if (runtime_file != nullptr && runtime_file[0] != '\0') {
+        result["gpuscout_runtime"] = get_runtime_records(runtime_file);
+    }
+
     std::ofstream result_file;
     std::string save_file_path = output_file_path;
     int index = 1;
@@ -0,0 +1,73 @@
+/**
+ * Helpers of the tests on small SASS fixtures: every test case checks the results of a parser on the fixture <case>.sass
+ * Usage of a test executable: test_parser_sass_<parser> <case> <fixture directory>
+ *
+ * @author Soumya Sen
+ */
+
+#ifndef SASS_FIXTURE_TEST_HPP
+#define SASS_FIXTURE_TEST_HPP
+
+#include "parser_sass_ir.hpp"
+#include <functional>
+#include <iostream>
+
+int failures = 0;
+
+void check(bool condition, const std::string &message)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << message << std::endl;
+        failures++;
+    }
+}
+
+/// @brief Index of the instruction at the pcOffset, -1 if the kernel has none
+int find_instruction(const sass_kernel &kernel, const std::string &pc_offset)
+{
+    for (int i = 0; i < (int)kernel.instructions.size(); i++)
+    {
+        if (kernel.instructions[i].pcOffset == pc_offset)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// @brief Result of the parser for the instruction at the pcOffset, nullptr if there is none
+template <typename T>
+const T *find_result(const std::vector<T> &results, const std::string &pc_offset)
+{
+    auto result = std::find_if(results.begin(), results.end(), [&](const T &result_obj) { return result_obj.pcOffset == pc_offset; });
+    return result != results.end() ? &*result : nullptr;
+}
+
+/// @brief Run the test case given on the command line with the path of its fixture
+/// @param tests Test case -> function checking the fixture
+/// @return exit code, 0 if all checks passed
+int run_fixture_test(int argc, char **argv, const std::map<std::string, std::function<void(const std::string &)>> &tests)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <case> <fixture directory>" << std::endl;
+        return 2;
+    }
+    std::string test_case = argv[1];
+    auto test = tests.find(test_case);
+    if (test == tests.end())
+    {
+        std::cerr << "Unknown test case " << test_case << std::endl;
+        return 2;
+    }
+
+    test->second(std::string(argv[2]) + "/" + test_case + ".sass");
+    if (failures == 0)
+    {
+        std::cout << test_case << ": passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+#endif // SASS_FIXTURE_TEST_HPP
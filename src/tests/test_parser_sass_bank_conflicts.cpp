@@ -0,0 +1,42 @@
+/**
+ * Tests of the bank conflict analysis on small SASS fixtures: the predicted wavefronts and the padding of the shared memory accesses
+ *
+ * @author Soumya Sen
+ */
+
+#include "sass_fixture_test.hpp"
+#include "parser_sass_bank_conflicts.hpp"
+
+/// @brief Lanes accessing consecutive words, rows of 128 bytes, every second word, 8 byte words, an untraced address and the same word
+void test_shared_memory_strides(const std::string &filename)
+{
+    std::vector<shared_memory_access> accesses = bank_conflict_analysis(filename)["_Z4bankPf"];
+    const shared_memory_access *consecutive = find_result(accesses, "0030");
+    check(consecutive != nullptr && consecutive->stride_known && consecutive->stride == 4, "[R0.X4] has a stride of 4 bytes");
+    check(consecutive != nullptr && consecutive->wavefronts == 1 && consecutive->ideal_wavefronts == 1 && consecutive->padding_bytes == 0, "[R0.X4] has no bank conflicts");
+
+    const shared_memory_access *rows = find_result(accesses, "0040");
+    check(rows != nullptr && rows->stride == 128 && rows->wavefronts == 32, "rows of 128 bytes are a 32-way conflict");
+    check(rows != nullptr && rows->padding_bytes == 4, "rows of 128 bytes are padded by one word");
+
+    const shared_memory_access *every_second = find_result(accesses, "0050");
+    check(every_second != nullptr && every_second->stride == 8 && every_second->wavefronts == 2 && every_second->padding_bytes == 4, "every second word is a 2-way conflict, padded by one word");
+
+    const shared_memory_access *wide = find_result(accesses, "0060");
+    check(wide != nullptr && wide->access_bytes == 8 && wide->wavefronts == 2 && wide->ideal_wavefronts == 2 && wide->padding_bytes == 0, "LDS.64 of consecutive words needs its two ideal wavefronts");
+
+    const shared_memory_access *loaded = find_result(accesses, "0080");
+    check(loaded != nullptr && !loaded->stride_known, "address loaded from global memory has no known stride");
+
+    const shared_memory_access *broadcast = find_result(accesses, "00a0");
+    check(broadcast != nullptr && broadcast->stride == 0 && broadcast->wavefronts == 1, "the same word is broadcast to all lanes");
+
+    const shared_memory_access *atomic = find_result(accesses, "00b0");
+    check(atomic != nullptr && atomic->access_kind == "atomic" && atomic->wavefronts == 32 && atomic->padding_bytes == 0, "atomics on the same word are serialized, padding does not help");
+}
+
+int main(int argc, char **argv)
+{
+    return run_fixture_test(argc, argv, {
+        {"shared_memory_strides", test_shared_memory_strides}});
+}
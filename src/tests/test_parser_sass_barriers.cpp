@@ -0,0 +1,25 @@
+/**
+ * Tests of the barrier analysis on small SASS fixtures: the divergent branches around the barriers
+ *
+ * @author Soumya Sen
+ */
+
+#include "sass_fixture_test.hpp"
+#include "parser_sass_barriers.hpp"
+
+/// @brief A barrier behind a branch of the block index is reached by all threads of the block, one behind a branch of the thread index is not
+void test_uniform_barrier_branch(const std::string &filename)
+{
+    std::vector<barrier_instruction> barriers = barrier_analysis(filename)["_Z7barrierPf"];
+    const barrier_instruction *uniform = find_result(barriers, "0070");
+    check(uniform != nullptr && uniform->divergent_branch_pcOffset.empty(), "barrier behind @P0 of the block index is not in a divergent branch");
+
+    const barrier_instruction *divergent = find_result(barriers, "00a0");
+    check(divergent != nullptr && divergent->divergent_branch_pcOffset == "0080", "barrier behind @P1 of the thread index is in the divergent branch at 0080");
+}
+
+int main(int argc, char **argv)
+{
+    return run_fixture_test(argc, argv, {
+        {"uniform_barrier_branch", test_uniform_barrier_branch}});
+}
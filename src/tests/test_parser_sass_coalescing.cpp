@@ -0,0 +1,35 @@
+/**
+ * Tests of the coalescing analysis on small SASS fixtures: the access pattern and the predicted sectors per request
+ *
+ * @author Soumya Sen
+ */
+
+#include "sass_fixture_test.hpp"
+#include "parser_sass_coalescing.hpp"
+
+/// @brief Consecutive words, consecutive words off the sector, rows of 128 bytes, one address for the warp and an index loaded from memory
+void test_global_memory_strides(const std::string &filename)
+{
+    std::vector<global_memory_access> accesses = coalescing_analysis(filename)["_Z8coalescePf"];
+    const global_memory_access *coalesced = find_result(accesses, "0040");
+    check(coalesced != nullptr && coalesced->pattern == "coalesced" && coalesced->stride == 4, "consecutive words are coalesced");
+    check(coalesced != nullptr && coalesced->sectors == 4 && coalesced->ideal_sectors == 4 && coalesced->sector_offset == 0, "consecutive words touch 4 sectors");
+
+    const global_memory_access *offset = find_result(accesses, "0050");
+    check(offset != nullptr && offset->pattern == "coalesced" && offset->sector_offset == 4 && offset->sectors == 5, "consecutive words 4 bytes off the sector touch 5 sectors");
+
+    const global_memory_access *strided = find_result(accesses, "0070");
+    check(strided != nullptr && strided->access_kind == "store" && strided->pattern == "strided" && strided->stride == 128 && strided->sectors == 32, "rows of 128 bytes touch 32 sectors");
+
+    const global_memory_access *uniform = find_result(accesses, "00a0");
+    check(uniform != nullptr && uniform->pattern == "uniform" && uniform->sectors == 1, "one address for the warp touches 1 sector");
+
+    const global_memory_access *gather = find_result(accesses, "00c0");
+    check(gather != nullptr && gather->pattern == "gather/scatter" && !gather->stride_known && gather->sectors == 32, "index loaded from memory is a gather of 32 sectors");
+}
+
+int main(int argc, char **argv)
+{
+    return run_fixture_test(argc, argv, {
+        {"global_memory_strides", test_global_memory_strides}});
+}
@@ -0,0 +1,38 @@
+/**
+ * Tests of the device call analysis on small SASS fixtures: the moves around the calls and the ABI overhead of the called functions
+ *
+ * @author Soumya Sen
+ */
+
+#include "sass_fixture_test.hpp"
+#include "parser_sass_device_calls.hpp"
+
+/// @brief A device function saving two registers of its caller, and a direct, an external and an indirect call
+void test_device_function_abi(const std::string &filename)
+{
+    auto [call_map, function_map] = device_call_analysis(filename);
+    std::vector<device_call> calls = call_map["_Z6callerPf"];
+    const device_call *direct = find_result(calls, "0060");
+    check(direct != nullptr && direct->kind == "direct" && direct->callee == "_Z3devPf", "CALL.REL of a function with SASS is direct");
+    check(direct != nullptr && direct->argument_moves == 4 && direct->result_moves == 1, "the direct call moves 4 arguments and 1 result");
+
+    const device_call *external = find_result(calls, "0090");
+    check(external != nullptr && external->kind == "external" && external->callee == "vprintf", "CALL.ABS of vprintf is external");
+
+    const device_call *indirect = find_result(calls, "00a0");
+    check(indirect != nullptr && indirect->kind == "indirect" && indirect->callee.empty(), "CALL.ABS of a register is indirect");
+
+    check(function_map.size() == 1 && function_map.count("_Z3devPf"), "only the direct callee is a device function");
+    const device_function &function_obj = function_map["_Z3devPf"];
+    check(function_obj.instructions == 11 && function_obj.call_sites == 1, "the device function has 11 instructions and 1 call site");
+    check(function_obj.saved_registers == 2 && function_obj.restored_registers == 2, "the device function saves and restores R16 and R17");
+    check(function_obj.stack_adjustments == 2 && function_obj.returns == 1, "the device function moves the stack pointer twice and returns once");
+    check(function_obj.other_local_accesses == 1, "the store of R16 after it is written is not a save");
+    check(function_obj.overhead_pc_offsets == std::vector<std::string>({"0000", "0010", "0020", "0070", "0080", "0090", "00a0"}), "the overhead are the saves, restores, stack adjustments and RET");
+}
+
+int main(int argc, char **argv)
+{
+    return run_fixture_test(argc, argv, {
+        {"device_function_abi", test_device_function_abi}});
+}
@@ -0,0 +1,39 @@
+/**
+ * Tests of the generic memory analysis on small SASS fixtures: the origin of the pointers of the generic accesses
+ *
+ * @author Soumya Sen
+ */
+
+#include "sass_fixture_test.hpp"
+#include "parser_sass_generic_memory.hpp"
+
+/// @brief Pointers of the shared and local window, a kernel parameter, a loaded pointer, and arguments of a called and an uncalled device function
+void test_pointer_origins(const std::string &filename)
+{
+    std::unordered_map<std::string, std::vector<generic_access>> access_map = generic_memory_analysis(filename);
+    std::vector<generic_access> accesses = access_map["_Z7genericPfi"];
+    const generic_access *shared = find_result(accesses, "0040");
+    check(shared != nullptr && shared->origin == "shared" && shared->origin_pcOffset == "0010", "pointer of SR_SWINHI is shared");
+
+    const generic_access *local = find_result(accesses, "0070");
+    check(local != nullptr && local->opcode == "ST" && local->origin == "local" && local->origin_pcOffset == "0050", "pointer of SR_LWINHI is local");
+
+    const generic_access *global = find_result(accesses, "00a0");
+    check(global != nullptr && global->origin == "global" && global->origin_pcOffset == "0090", "pointer of a kernel parameter is global");
+
+    const generic_access *loaded = find_result(accesses, "00d0");
+    check(loaded != nullptr && loaded->origin == "loaded" && loaded->origin_pcOffset == "00b0", "pointer loaded from memory is loaded");
+
+    const generic_access *argument = find_result(access_map["_Z4readPf"], "0000");
+    check(argument != nullptr && argument->origin == "shared" && argument->origin_pcOffset == "0010" && argument->origin_function == "_Z7genericPfi",
+          "argument of a device function is traced to the shared window of its caller");
+
+    const generic_access *uncalled = find_result(access_map["_Z6unusedPf"], "0000");
+    check(uncalled != nullptr && uncalled->origin == "argument" && uncalled->origin_function == "_Z6unusedPf", "argument of a function without call sites stays an argument");
+}
+
+int main(int argc, char **argv)
+{
+    return run_fixture_test(argc, argv, {
+        {"pointer_origins", test_pointer_origins}});
+}
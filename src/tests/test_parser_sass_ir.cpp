@@ -0,0 +1,111 @@
+/**
+ * Tests of the SASS IR on small SASS fixtures: the values of the registers traced by get_register_value and the parsing of memory operands
+ *
+ * @author Soumya Sen
+ */
+
+#include "sass_fixture_test.hpp"
+
+/// @brief Address of the memory instruction at the pcOffset of the kernel
+sass_value get_fixture_address(const std::unordered_map<std::string, sass_kernel> &kernel_map, const std::string &kernel_name, const std::string &pc_offset)
+{
+    std::unordered_map<std::string, sass_value> cache;
+    const sass_kernel &kernel = kernel_map.at(kernel_name);
+    return get_address_value(kernel, find_instruction(kernel, pc_offset), cache);
+}
+
+/// @brief A pointer of the thread index advanced by a constant in every iteration keeps its lane stride, a pointer advanced by the thread index does not
+void test_loop_carried_pointer(const std::string &filename)
+{
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+    sass_value address = get_fixture_address(kernel_map, "_Z7advancePf", "0040");
+    long long stride = 0;
+    check(address.affine, "pointer advanced by a constant is affine");
+    check(get_lane_stride(address, stride) && stride == 4, "pointer advanced by a constant has a lane stride of 4 bytes");
+    check(address.uniform_terms.count("c[0x0][0x160]") == 1, "pointer advanced by a constant starts at the kernel parameter");
+    check(std::any_of(address.uniform_terms.begin(), address.uniform_terms.end(), [](const std::string &term) { return term.find("iteration of loop") != std::string::npos; }),
+          "pointer advanced by a constant changes with the loop iteration");
+
+    address = get_fixture_address(kernel_map, "_Z6gatherPf", "0040");
+    check(!address.affine && address.thread_dependent, "pointer advanced by the thread index is not affine");
+    check(!get_lane_stride(address, stride), "pointer advanced by the thread index has no lane stride");
+}
+
+/// @brief Memory operands with a memory descriptor of CUDA 12, e.g. desc[UR6][R2.64+0x10]
+void test_descriptor_operand(const std::string &filename)
+{
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+    const sass_kernel &kernel = kernel_map.at("_Z4descPf");
+    const sass_instruction &load = kernel.instructions[find_instruction(kernel, "0040")];
+    check(get_memory_operand_index(load) == 1, "memory operand of the load is found");
+    sass_memory_operand operand = parse_memory_operand(load.operands[1]);
+    check(operand.descriptor_register == "UR6", "descriptor register is UR6");
+    check(operand.base_register == "R2" && operand.wide && operand.offset == 0x10, "address is R2.64+0x10");
+    check(operand.uniform_register.empty(), "descriptor register is not added to the address");
+    check(get_destination_registers(load) == std::vector<std::string>({"R5"}), "load writes R5");
+
+    sass_value address = get_fixture_address(kernel_map, "_Z4descPf", "0040");
+    check(address.affine && address.thread_terms == std::map<std::string, long long>({{"tid.x", 4}}) && address.constant == 0x10, "load address is tid.x * 4 + 0x10");
+
+    const sass_instruction &store = kernel.instructions[find_instruction(kernel, "0050")];
+    check(get_memory_operand_index(store) == 0, "memory operand of the store is found");
+    check(get_destination_registers(store).empty(), "store writes no register");
+}
+
+/// @brief Pointers selected (SEL) or conditionally overwritten (@P MOV) by a predicate depend on the thread index if the predicate does
+void test_predicated_definitions(const std::string &filename)
+{
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+    sass_value address = get_fixture_address(kernel_map, "_Z6selectPfS_", "0050");
+    check(address.thread_dependent, "pointer selected by a predicate of the thread index is thread dependent");
+
+    address = get_fixture_address(kernel_map, "_Z6selectPfS_", "0090");
+    check(address.thread_dependent, "pointer overwritten under a predicate of the thread index is thread dependent");
+
+    address = get_fixture_address(kernel_map, "_Z6selectPfS_", "00d0");
+    check(address.affine && !address.thread_dependent && address.thread_terms.empty(), "pointer selected by a uniform predicate is uniform");
+
+    address = get_fixture_address(kernel_map, "_Z6selectPfS_", "0110");
+    check(address.affine && !address.thread_dependent && address.uniform_terms == std::set<std::string>({"c[0x0][0x170]"}),
+          "pointer overwritten with the same value under a predicate keeps its value");
+}
+
+/// @brief A 32 bit offset zero extended and added to a 64 bit uniform register, e.g. [R2.U32+UR4+0x8]
+void test_zero_extended_offset(const std::string &filename)
+{
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+    const sass_kernel &kernel = kernel_map.at("_Z6offsetPf");
+    const sass_instruction &load = kernel.instructions[find_instruction(kernel, "0040")];
+    sass_memory_operand operand = parse_memory_operand(load.operands[get_memory_operand_index(load)]);
+    check(operand.base_register == "R2" && !operand.wide && operand.zero_extended, "R2.U32 is a zero extended 32 bit register, not a register pair");
+    check(operand.uniform_register == "UR4" && operand.offset == 0x8, "uniform register UR4 and offset 0x8 are added");
+
+    sass_value address = get_fixture_address(kernel_map, "_Z6offsetPf", "0040");
+    long long stride = 0;
+    check(get_lane_stride(address, stride) && stride == 4, "address has a lane stride of 4 bytes");
+    check(address.uniform_terms.count("c[0x0][0x160]") == 1 && address.constant == 0x8, "address starts at the kernel parameter plus 0x8");
+}
+
+/// @brief Guards of branches, e.g. @P0, @!P0 and @UP0, diverge only if the compared values differ between the threads of a warp
+void test_divergent_predicates(const std::string &filename)
+{
+    std::unordered_map<std::string, sass_kernel> kernel_map = parse_sass_ir(filename);
+    const sass_kernel &kernel = kernel_map.at("_Z8branchesPf");
+    std::unordered_map<std::string, sass_value> cache;
+    check(get_sass_register_name("@P0") == "P0" && get_sass_register_name("@!P0") == "P0" && get_sass_register_name("@UP0") == "UP0", "guards are parsed as their predicate");
+    check(!is_divergent_predicate(kernel, find_instruction(kernel, "0060"), cache), "@P0 of the block index does not diverge");
+    check(!is_divergent_predicate(kernel, find_instruction(kernel, "0080"), cache), "@!P0 of the block index does not diverge");
+    check(is_divergent_predicate(kernel, find_instruction(kernel, "00a0"), cache), "@P1 of the thread index diverges");
+    check(is_divergent_predicate(kernel, find_instruction(kernel, "00c0"), cache), "@!P1 of the thread index diverges");
+    check(!is_divergent_predicate(kernel, find_instruction(kernel, "00e0"), cache), "@UP0 does not diverge");
+}
+
+int main(int argc, char **argv)
+{
+    return run_fixture_test(argc, argv, {
+        {"loop_carried_pointer", test_loop_carried_pointer},
+        {"descriptor_operand", test_descriptor_operand},
+        {"predicated_definitions", test_predicated_definitions},
+        {"zero_extended_offset", test_zero_extended_offset},
+        {"divergent_predicates", test_divergent_predicates}});
+}
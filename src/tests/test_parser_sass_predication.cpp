@@ -0,0 +1,35 @@
+/**
+ * Tests of the predication analysis on small SASS fixtures: the size, reconvergence and divergence of the conditional regions
+ *
+ * @author Soumya Sen
+ */
+
+#include "sass_fixture_test.hpp"
+#include "parser_sass_predication.hpp"
+
+/// @brief An if/else under BSSY, a branch of a uniform predicate and a branch around a barrier
+void test_predicated_regions(const std::string &filename)
+{
+    std::vector<conditional_region> regions = predication_analysis(filename)["_Z9predicatePfi"];
+    check(regions.size() == 3, "three forward conditional branches are found");
+
+    const conditional_region *if_else = find_result(regions, "0040");
+    check(if_else != nullptr && if_else->then_instructions == 1 && if_else->else_instructions == 1, "if/else at 0040 has one instruction in each part");
+    check(if_else != nullptr && if_else->uses_bssy && if_else->reconvergence_pcOffset == "0080", "if/else at 0040 reconverges at the BSYNC at 0080");
+    check(if_else != nullptr && if_else->overhead_pc_offsets == std::vector<std::string>({"0040", "0060", "0030", "0080"}), "overhead of the if/else is the BRA, the branch around the else, BSSY and BSYNC");
+    check(if_else != nullptr && if_else->divergent && if_else->predicable, "if/else of the thread index is divergent and predicable");
+
+    const conditional_region *uniform = find_result(regions, "00b0");
+    check(uniform != nullptr && uniform->then_instructions == 1 && uniform->else_instructions == 0 && !uniform->uses_bssy, "@UP0 branch skips one instruction without BSSY");
+    check(uniform != nullptr && !uniform->divergent && uniform->predicable, "@UP0 branch is not divergent");
+
+    const conditional_region *barrier = find_result(regions, "00e0");
+    check(barrier != nullptr && barrier->then_instructions == 2 && barrier->reconvergence_pcOffset == "0110", "@!P1 branch skips the STS and the barrier up to 0110");
+    check(barrier != nullptr && barrier->divergent && !barrier->predicable, "@!P1 branch of the thread index is divergent and not predicable because of the barrier");
+}
+
+int main(int argc, char **argv)
+{
+    return run_fixture_test(argc, argv, {
+        {"predicated_regions", test_predicated_regions}});
+}
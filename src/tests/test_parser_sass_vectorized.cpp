@@ -0,0 +1,38 @@
+/**
+ * Tests of the vectorization analysis on small SASS fixtures: the offsets, width and alignment of the accesses which can be vectorized
+ *
+ * @author Soumya Sen
+ */
+
+#include "sass_fixture_test.hpp"
+#include "parser_sass_vectorized.hpp"
+
+/// @brief Four words of a 16 byte aligned address, two words of a 4 byte aligned address, two words at negative offsets and two words of a loaded pointer
+void test_vectorizable_offsets(const std::string &filename)
+{
+    auto [counter_map, register_map] = vectorized_analysis(filename);
+    const load_counter &counter = counter_map["_Z6vectorPf"];
+    check(counter.access_count == 11 && counter.global_load_count == 8 && counter.vectorized_access_count == 1, "11 accesses, 8 scalar global loads and one LDG.E.64 are counted");
+
+    std::vector<register_data> accesses = register_map["_Z6vectorPf"];
+    check(accesses.size() == 3, "three vectorizable groups are found");
+
+    const register_data *aligned = find_result(accesses, "0040");
+    check(aligned != nullptr && aligned->reg_load_type == VEC_128 && aligned->vector_bytes == 16 && aligned->instructions_saved == 3, "four words of a 16 byte aligned address are one 128 bit load");
+    check(aligned != nullptr && aligned->alignment_known && aligned->unrolls == std::vector<long long>({0, 4, 8, 12}), "the 128 bit load covers the offsets 0 to 12 of an address of known alignment");
+
+    check(find_result(accesses, "0090") == nullptr && find_result(accesses, "00a0") == nullptr, "two words of a 4 byte aligned address are not vectorized");
+
+    const register_data *negative = find_result(accesses, "00c0");
+    check(negative != nullptr && negative->access_kind == "store" && negative->reg_load_type == VEC_64 && negative->unrolls == std::vector<long long>({-8, -4}),
+          "two words at the offsets -8 and -4 are one 64 bit store");
+
+    const register_data *loaded = find_result(accesses, "00f0");
+    check(loaded != nullptr && loaded->reg_load_type == VEC_64 && !loaded->alignment_known, "two words of a loaded pointer are one 64 bit load if the pointer is aligned");
+}
+
+int main(int argc, char **argv)
+{
+    return run_fixture_test(argc, argv, {
+        {"vectorizable_offsets", test_vectorizable_offsets}});
+}